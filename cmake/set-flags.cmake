@@ -45,6 +45,8 @@ function(momiji_set_target_flags target)
             -Wno-redundant-parens
             -Wno-used-but-marked-unused
             -ferror-limit=5
+            # The opcode table is generated at compile time
+            -fconstexpr-steps=33554432
         )
     endif()
 
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <momiji/DecodeCache.h>
+#include <momiji/Decoder.h>
+#include <momiji/Emulator.h>
+#include <momiji/System.h>
+
+#include <gsl/span>
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace momiji::aot
+{
+    // The system a binary written by momiji-as starts in, the same as
+    // after Emulator::newState
+    System load(gsl::span<const std::uint8_t> binary,
+                std::int64_t stackSize = utils::make_kb(4));
+
+    // What code written by momiji-aot runs against.
+    // Control flow is compiled, and so are the instructions momiji-aot
+    // writes out in C++. Every other one is decoded once and run by the
+    // same handler as in the emulator.
+    class Runtime
+    {
+    public:
+        Runtime(System& sys, RunLimits limits);
+
+        // Counts the n instructions from pc compiled by momiji-aot, which
+        // can't stop the program. False if they don't all fit before the
+        // limit: the ones that do are interpreted, and the program stops.
+        bool count(std::uint32_t pc, std::int64_t n)
+        {
+            if (m_maxInstructions - m_executed >= n)
+            {
+                m_executed += n;
+                return true;
+            }
+
+            m_sys->cpu.programCounter = pc;
+            interpret({});
+
+            return false;
+        }
+
+        // Runs the instruction at pc, which must have been translated.
+        // False once the translated code has to stop: the program stopped,
+        // the limit was reached, the code was written to or an exception
+        // handler was entered.
+        bool execute(std::uint32_t pc)
+        {
+            // Instructions written out leave the PC behind
+            m_sys->cpu.programCounter = pc;
+
+            if (m_executed == m_maxInstructions)
+            {
+                m_reason = StopReason::InstructionLimit;
+                return false;
+            }
+
+            const auto& instr = m_instructions[(pc - m_codeBegin) / 2];
+            const auto status = instr.exec(*m_sys, instr.data);
+
+            m_sys->cycles += cyclesOf(instr.data, status);
+            ++m_executed;
+
+            if (m_sys->mem.codeWriteMarker.begin >= 0)
+            {
+                codeWritten();
+            }
+
+            if (status != ExecutionStatus::Continue &&
+                status != ExecutionStatus::BranchTaken)
+            {
+                stop(status);
+                return false;
+            }
+
+            return !m_stale;
+        }
+
+        // Interprets from the PC until it reaches one of entries, which is
+        // sorted. False when the translated code has to stop.
+        bool interpret(gsl::span<const std::uint32_t> entries);
+
+        // Once execute or interpret returned false. If the code was written
+        // to, what is left of the program is interpreted first.
+        RunResult finish();
+
+    private:
+        // The translation may not match the code anymore
+        void codeWritten();
+
+        // For a status that stops the translated code. Traps with a handler
+        // leave the program running at the handler, returns false then.
+        bool stop(ExecutionStatus status);
+
+        System* m_sys;
+
+        // Indexed by (PC - m_codeBegin) / 2, as the translation last saw
+        // the code
+        std::vector<DecodedInstruction> m_instructions;
+        std::uint32_t m_codeBegin;
+
+        // Used by interpret
+        DecodeCache m_decodeCache;
+
+        std::int64_t m_executed { 0 };
+        std::int64_t m_maxInstructions;
+
+        std::optional<StopReason> m_reason;
+        bool m_stale { false };
+    };
+} // namespace momiji::aot
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <momiji/Decoder.h>
+#include <momiji/History.h>
+#include <momiji/Memory.h>
+#include <momiji/NativeCode.h>
+#include <momiji/System.h>
+#include <momiji/ThreadedCode.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace momiji
+{
+    // Adjacent instructions a block runs as one. The move of MoveTest is
+    // from a register or an immediate, it can't fault before the tst.
+    enum class FusedPair : std::int8_t
+    {
+        CompareBranch, // cmp or cmpi to a data register, then bcc
+        TestBranch,    // tst of a data register, then bcc
+        MoveTest,      // move to a data register, then tst of it
+    };
+
+    constexpr std::size_t fusedPairCount = 3;
+
+    // Basic blocks of the executable region, each translated once into a
+    // list of handlers bound to their operands.
+    // A block ends at the first bra, bcc, bsr, jmp, jsr or rts (or anything
+    // that stops the program), and remembers the blocks it led to so going
+    // from one block to the next usually skips the lookup.
+    // With native code enabled, blocks run often enough are compiled to
+    // host code on x86-64 hosts, unless every instruction has to be a step
+    // of history. Only move, add, sub, and, or, cmp, tst, mul and div are
+    // compiled, between data registers or from an immediate, and the
+    // shifts of a data register. Everything else, including eor, not and
+    // any memory operand, calls its bound handler from the host code, as
+    // do divisions by zero and quotients which don't fit in a word.
+    // The pairs of FusedPair are run by a single handler which goes
+    // straight to the branch decision, only when there is no history to
+    // journal and the instruction limit leaves room for both.
+    // With memory idioms enabled and no history to journal, a block which
+    // is the body of a loop copying or filling memory runs as many
+    // iterations as it can at once, as a bulk operation on the guest
+    // memory.
+    class BlockCache
+    {
+    public:
+        BlockCache() = default;
+
+        // Same as ThreadedCode::run
+        ThreadedCode::Exit
+        run(System& sys, History* history, std::int64_t maxInstructions);
+
+        // Drops every block that may overlap [begin, end), offsets from the
+        // beginning of the code, and every link to them
+        void invalidate(std::int64_t begin, std::int64_t end);
+        void clear();
+
+        // Off by default, blocks already compiled are only run again once
+        // it is back on
+        void enableNativeCode(bool enabled) noexcept;
+
+        // Off by default
+        void enableMemoryIdioms(bool enabled) noexcept;
+
+        [[nodiscard]] std::int64_t blockCount() const noexcept;
+        [[nodiscard]] std::int64_t nativeBlockCount() const noexcept;
+
+        // Times a pair was run as one, kept when the blocks are cleared
+        [[nodiscard]] std::int64_t fusionHits(FusedPair pair) const noexcept;
+
+    private:
+        struct Op;
+
+        using OpFn = ExecutionStatus (*)(System&, const Op&);
+
+        struct Op
+        {
+            OpFn run;
+
+            // Handler used when the instruction has no bound form
+            DecodedInstructionFn exec;
+            InstructionData data;
+            InstructionType type;
+
+            std::uint32_t pc;
+
+            // Immediate source operand or branch target, read at
+            // translation if resolved
+            std::int32_t value;
+            bool resolved;
+
+            // Address of the next instruction
+            std::uint32_t next;
+
+            // Runs this op and the next one of the block together, if set
+            OpFn fused { nullptr };
+            FusedPair pair { FusedPair::CompareBranch };
+        };
+
+        // Loop whose body is a block of three ops:
+        //     move.s (aS)+, (aD)+    or    move.s dS/#imm, (aD)+
+        //     sub.s #1, dC
+        //     beq exit
+        // followed by a jmp or bra back to the body
+        struct Idiom
+        {
+            enum class Kind : std::int8_t
+            {
+                Copy,
+                Fill,
+            } kind;
+
+            // Of the elements moved, and of the counter
+            std::int8_t size;
+            std::int8_t counterSize;
+
+            // aS for a copy, dS for a fill from a register, or -1 for a
+            // fill with value
+            std::int8_t src;
+            std::int8_t dst;
+            std::int8_t counter;
+
+            std::int32_t value;
+            std::uint32_t exit;
+
+            // Of an iteration going back to the body, and of the last one
+            // leaving at the beq
+            std::int32_t iterationCycles;
+            std::int32_t exitCycles;
+        };
+
+        struct Block;
+
+        // Returns the status of the last instruction it executed, in the
+        // low byte, and how many it executed
+        using NativeFn = std::uint64_t (*)(System*);
+
+        struct Link
+        {
+            std::int64_t pc { -1 };
+            Block* block { nullptr };
+        };
+
+        struct Block
+        {
+            std::int64_t begin;
+
+            // Conservative, includes the extension words of the last
+            // instruction
+            std::int64_t end;
+
+            std::vector<Op> ops;
+
+            // Taken and not taken branches, when known ahead of time
+            std::array<Link, 2> successors;
+
+            std::int32_t runs { 0 };
+            NativeFn native { nullptr };
+
+            std::optional<Idiom> idiom;
+        };
+
+        template <bool Journal>
+        ThreadedCode::Exit runBlocks(System& sys,
+                                     History* history,
+                                     std::int64_t maxInstructions);
+
+        // Block starting at the PC of sys, translated if needed. Null if
+        // the PC can't be translated (odd or outside the code).
+        Block* findBlock(System& sys);
+        Block* nextBlock(System& sys, Block& block);
+
+        Block* translate(System& sys, std::int64_t pc);
+
+        // Picks the ops of the block that are run in pairs
+        static void fuse(Block& block);
+
+        static std::optional<Idiom> findIdiom(ConstExecutableMemoryView mem,
+                                              const Block& block);
+
+        // Runs whole iterations of the loop while they fit in
+        // maxInstructions and before the next event, and returns how many
+        // instructions that was.
+        // 0 if the loop has to be run one instruction at a time.
+        static std::int64_t runIdiom(System& sys,
+                                     const Block& block,
+                                     std::int64_t maxInstructions);
+
+        // Host code for the whole block, instructions without a native
+        // form call their bound handler. False if it can't be generated.
+        bool compile(System& sys, Block& block);
+
+        std::vector<std::unique_ptr<Block>> m_blocks;
+
+        // Indexed by (PC - m_codeBegin) / 2
+        std::vector<Block*> m_entries;
+        std::int64_t m_codeBegin { 0 };
+
+        NativeCodeBuffer m_nativeCode;
+        bool m_nativeEnabled { false };
+        bool m_idiomsEnabled { false };
+
+        std::array<std::int64_t, fusedPairCount> m_fusionHits {};
+    };
+} // namespace momiji
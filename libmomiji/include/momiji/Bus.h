@@ -0,0 +1,122 @@
+#pragma once
+
+#include <momiji/System.h>
+
+#include <cstdint>
+#include <type_traits>
+
+// Keeps the fault paths out of the way of the accesses that succeed
+#if defined(__GNUC__) || defined(__clang__)
+    #define MOMIJI_COLD __attribute__((cold, noinline))
+#else
+    #define MOMIJI_COLD __declspec(noinline)
+#endif
+
+namespace momiji::bus
+{
+    namespace details
+    {
+        // Sets System::trap or goes to the device of the page, returns what
+        // the access gives back
+        MOMIJI_COLD std::uint32_t readSlow(System& sys,
+                                           std::int64_t address,
+                                           std::int64_t size);
+
+        MOMIJI_COLD void writeSlow(System& sys,
+                                   std::int64_t address,
+                                   std::int64_t size,
+                                   std::uint32_t val);
+
+        // Outside of memory, or a word or long word at an odd address
+        inline bool faults(const System& sys,
+                           std::int64_t address,
+                           std::int64_t size)
+        {
+            return address < 0 || address > asl::ssize(sys.mem) - size ||
+                   (size > 1 && (address & 0b1) != 0);
+        }
+
+        // Faults, or belongs to a device. Both are tested at once so memory
+        // accesses only take one branch.
+        template <typename T>
+        bool slowPath(const System& sys, std::int64_t address)
+        {
+            const bool outside = faults(sys, address, sizeof(T));
+            const bool mapped  = sys.devices->tag(address) != 0;
+
+            return outside | mapped;
+        }
+    } // namespace details
+
+    // Every access instructions make to guest memory goes through read and
+    // write. T is std::uint8_t, std::uint16_t or std::uint32_t.
+    // A fault sets System::trap, the read gives 0 and the write is dropped;
+    // the instruction carries on and reports ExecutionStatus::Trap.
+    // Pages claimed by a device of System::devices go to the device.
+
+    template <typename T>
+    [[nodiscard]] T read(System& sys, std::int64_t address)
+    {
+        static_assert(std::is_unsigned_v<T> && sizeof(T) <= 4);
+
+        if (details::slowPath<T>(sys, address))
+        {
+            return T(details::readSlow(sys, address, sizeof(T)));
+        }
+
+        return sys.mem.load<T>(address);
+    }
+
+    template <typename T>
+    void write(System& sys, std::int64_t address, T val)
+    {
+        static_assert(std::is_unsigned_v<T> && sizeof(T) <= 4);
+
+        if (details::slowPath<T>(sys, address))
+        {
+            details::writeSlow(sys, address, sizeof(T), val);
+            return;
+        }
+
+        sys.mem.store(val, address);
+    }
+
+    // Same as read and write, the size is given in bytes at run time
+    inline std::uint32_t read(System& sys,
+                              std::int64_t address,
+                              std::int64_t size)
+    {
+        switch (size)
+        {
+        case 1:
+            return read<std::uint8_t>(sys, address);
+
+        case 2:
+            return read<std::uint16_t>(sys, address);
+
+        default:
+            return read<std::uint32_t>(sys, address);
+        }
+    }
+
+    inline void write(System& sys,
+                      std::int64_t address,
+                      std::int64_t size,
+                      std::uint32_t val)
+    {
+        switch (size)
+        {
+        case 1:
+            write(sys, address, std::uint8_t(val));
+            break;
+
+        case 2:
+            write(sys, address, std::uint16_t(val));
+            break;
+
+        default:
+            write(sys, address, val);
+            break;
+        }
+    }
+} // namespace momiji::bus
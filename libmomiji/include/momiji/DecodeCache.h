@@ -0,0 +1,45 @@
+#pragma once
+
+#include <momiji/Decoder.h>
+#include <momiji/Memory.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace momiji
+{
+    // Keeps the decoded form of every instruction of the executable region,
+    // indexed by program counter, so hot code only hits the decoder once.
+    class DecodeCache
+    {
+    public:
+        DecodeCache() = default;
+
+        // Returns the instruction at pc, decoding it only if needed.
+        // The reference stays valid until the next call to any member.
+        const DecodedInstruction& fetch(ConstExecutableMemoryView mem,
+                                        std::int64_t pc);
+
+        // Drops every instruction that may overlap [begin, end)
+        void invalidate(std::int64_t begin, std::int64_t end);
+        void clear();
+
+        [[nodiscard]] std::int64_t hits() const noexcept;
+        [[nodiscard]] std::int64_t misses() const noexcept;
+
+    private:
+        struct Entry
+        {
+            DecodedInstruction instr;
+            bool valid { false };
+        };
+
+        std::vector<Entry> m_entries;
+
+        // Used for instructions that can't be cached (odd addresses)
+        DecodedInstruction m_uncached;
+
+        std::int64_t m_hits { 0 };
+        std::int64_t m_misses { 0 };
+    };
+} // namespace momiji
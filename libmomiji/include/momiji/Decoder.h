@@ -4,33 +4,96 @@
 #include <momiji/System.h>
 #include <momiji/Types.h>
 
+#include <gsl/span>
+
+#include <optional>
+
 namespace momiji
 {
     struct InstructionData
     {
         std::int8_t size { 2 };
 
-        std::array<OperandType, 2> operandType;
-        std::array<SpecialAddressingMode, 2> addressingMode;
+        std::array<OperandType, 2> operandType {};
+        std::array<SpecialAddressingMode, 2> addressingMode {};
+
+        // 68000 cycles taken when the instruction doesn't branch, then when
+        // it does, see cyclesOf()
+        std::uint16_t cycles { 0 };
+        std::uint16_t branchCycles { 0 };
+    };
+
+    // Instructions modify the system in place and only report what happened.
+    enum class ExecutionStatus : std::uint8_t
+    {
+        Continue,    // The PC points to the next instruction
+        BranchTaken, // The PC was moved somewhere else
+        Breakpoint,  // A breakpoint was hit, the PC already skips it
+        Trap,        // System::trap tells what went wrong
+        Halt,        // hcf
+        Returned,    // rts left CallStack::returnDepth frames
     };
 
-    using InstructionString = std::string;
+    // Cycles an instruction took given what its handler returned
+    constexpr std::int64_t cyclesOf(const InstructionData& data,
+                                    ExecutionStatus status)
+    {
+        return status == ExecutionStatus::BranchTaken ? data.branchCycles
+                                                      : data.cycles;
+    }
 
     using DecodedInstructionFn =
-        momiji::System (*)(momiji::System&, const InstructionData& data);
+        momiji::ExecutionStatus (*)(momiji::System&,
+                                    const InstructionData& data);
 
     struct DecodedInstruction
     {
         DecodedInstruction();
 
         InstructionData data;
-        InstructionString string;
+
+        // Only used to describe the instruction, see disassemble()
+        InstructionType type { InstructionType::Illegal };
+
+        // Extension words of each operand (immediates, displacements and
+        // absolute addresses) or the branch displacement, 0 if unused
+        std::array<std::int32_t, 2> operandValues {};
+
         DecodedInstructionFn exec;
     };
 
+    // Looks up the decoder of the opcode word at idx in a table generated at
+    // compile time
     DecodedInstruction decode(momiji::ConstExecutableMemoryView mem,
                               std::int64_t idx);
 
+    // Bytes the PC moves past instr when it doesn't branch
+    std::int64_t instructionSize(const DecodedInstruction& instr);
+
+    // Where bra, bsr, bcc (when taken), and jmp or jsr to an absolute
+    // address go from pc, the same way as their handlers. Empty for any
+    // other instruction, jumps through registers included.
+    std::optional<std::int64_t>
+    branchTarget(momiji::ConstExecutableMemoryView mem,
+                 std::int64_t pc,
+                 const DecodedInstruction& instr);
+
+    // Large enough for the text of any instruction
+    constexpr std::int64_t maxDisassemblySize = 64;
+
+    // Writes the text of instr to buffer, which is always null terminated,
+    // truncating it if needed. Returns the number of characters written.
+    std::int64_t disassemble(const DecodedInstruction& instr,
+                             gsl::span<char> buffer);
+
+    namespace details
+    {
+        // Walks the opcode groups one mask at a time, decode() must always
+        // agree with it
+        DecodedInstruction decodeBySwitch(momiji::ConstExecutableMemoryView mem,
+                                          std::int64_t idx);
+    } // namespace details
+
     namespace utils
     {
         inline std::int8_t isImmediate(const momiji::InstructionData& instr,
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <momiji/PagedStorage.h>
+#include <momiji/Scheduler.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gsl/span>
+
+namespace momiji
+{
+    struct System;
+
+    // Peripheral answering the accesses to the pages it is attached to.
+    // Offsets are from the first byte it claims, sizes are 1, 2 or 4 bytes
+    // and the accesses are aligned the same way memory accesses are.
+    // Registers are stored little-endian like guest memory, a byte access
+    // at offset 0 of a long word register gets its low byte.
+    // The system accessing it is given for the devices that keep time or
+    // request interrupts.
+    class Device
+    {
+    public:
+        Device()              = default;
+        Device(const Device&) = delete;
+        Device(Device&&)      = delete;
+
+        Device& operator=(const Device&) = delete;
+        Device& operator=(Device&&) = delete;
+
+        virtual ~Device() = default;
+
+        // Bytes claimed, accesses past it read 0 and are dropped
+        [[nodiscard]] virtual std::int64_t size() const noexcept = 0;
+
+        virtual std::uint32_t
+        read(System& sys, std::int64_t offset, std::int64_t size) = 0;
+
+        virtual void write(System& sys,
+                           std::int64_t offset,
+                           std::int64_t size,
+                           std::uint32_t val) = 0;
+    };
+
+    // Maps the pages of the address space to the devices answering them.
+    // Each page has a tag, 0 for plain memory, so the bus tells a memory
+    // access from a device access with a single lookup.
+    class DeviceBus
+    {
+    public:
+        DeviceBus() = default;
+
+        // Claims the pages covering [base, base + device->size()), base must
+        // be a multiple of memoryPageSize.
+        // Returns false if a page is already claimed or nothing is left to
+        // tag it with.
+        bool attach(std::shared_ptr<Device> device, std::int64_t base);
+
+        void detachAll();
+
+        [[nodiscard]] bool empty() const noexcept;
+
+        // 0 when the page of address is memory, addresses before 0 and past
+        // the last claimed page are memory
+        [[nodiscard]] std::uint8_t tag(std::int64_t address) const noexcept
+        {
+            const auto page =
+                std::min(std::uint64_t(address) / memoryPageSize, m_lastPage);
+
+            return m_tags[std::size_t(page)];
+        }
+
+        // Whether a device claims any page of [address, address + size)
+        [[nodiscard]] bool claimsAny(std::int64_t address,
+                                     std::int64_t size) const noexcept;
+
+        // address must be in a claimed page
+        std::uint32_t
+        read(System& sys, std::int64_t address, std::int64_t size) const;
+        void write(System& sys,
+                   std::int64_t address,
+                   std::int64_t size,
+                   std::uint32_t val) const;
+
+    private:
+        struct Mapping
+        {
+            std::shared_ptr<Device> device;
+            std::int64_t base;
+        };
+
+        // One more than the last claimed page, always 0
+        std::vector<std::uint8_t> m_tags { 0 };
+        std::uint64_t m_lastPage { 0 };
+
+        // Tag n is m_mappings[n - 1]
+        std::vector<Mapping> m_mappings;
+    };
+
+    // Bus of the systems without devices
+    extern const DeviceBus noDevices;
+
+    namespace devices
+    {
+        // Text terminal, what the program writes to data is kept for the
+        // host and input given by the host is read back from data.
+        class Console final : public Device
+        {
+        public:
+            // Byte registers
+            static constexpr std::int64_t data   = 0;
+            static constexpr std::int64_t status = 1; // Bit 0: input ready
+
+            [[nodiscard]] std::int64_t size() const noexcept override;
+
+            std::uint32_t read(System& sys,
+                               std::int64_t offset,
+                               std::int64_t size) override;
+            void write(System& sys,
+                       std::int64_t offset,
+                       std::int64_t size,
+                       std::uint32_t val) override;
+
+            void provideInput(const std::string& input);
+
+            [[nodiscard]] const std::string& output() const noexcept;
+
+            // Returns the output and forgets it
+            std::string takeOutput();
+
+        private:
+            std::string m_output;
+            std::string m_input;
+            std::size_t m_inputPos { 0 };
+        };
+
+        // Counter of System::cycles. Writing counter sets it. Every period
+        // cycles since any register was last written, bit 0 of status is
+        // set until a register is written again, and the interrupt of the
+        // level in control is requested.
+        class Timer final : public Device,
+                            public std::enable_shared_from_this<Timer>
+        {
+        public:
+            // Long word registers
+            static constexpr std::int64_t counter = 0;
+            static constexpr std::int64_t period  = 4; // 0 never expires
+            static constexpr std::int64_t status  = 8;
+            static constexpr std::int64_t control = 12; // Interrupt level
+
+            // Without a scheduler it never requests interrupts, otherwise
+            // it has to be the one of the emulator it's attached to
+            Timer() = default;
+            explicit Timer(EventScheduler& scheduler);
+
+            [[nodiscard]] std::int64_t size() const noexcept override;
+
+            std::uint32_t read(System& sys,
+                               std::int64_t offset,
+                               std::int64_t size) override;
+            void write(System& sys,
+                       std::int64_t offset,
+                       std::int64_t size,
+                       std::uint32_t val) override;
+
+        private:
+            // Latches the periods that ended by now
+            void expire(std::int64_t now);
+
+            // Schedules the end of the current period, if it interrupts
+            void scheduleExpiry(System& sys);
+
+            [[nodiscard]] std::uint32_t registerValue(std::int64_t reg,
+                                                      std::int64_t now) const;
+
+            EventScheduler* m_scheduler { nullptr };
+            EventScheduler::EventId m_expiry { 0 };
+
+            // Cycles when counter was 0
+            std::int64_t m_start { 0 };
+
+            // Cycles when the current period started
+            std::int64_t m_periodStart { 0 };
+            std::uint32_t m_period { 0 };
+            std::uint32_t m_level { 0 };
+            bool m_expired { false };
+        };
+
+        // Block of width * height pixels of one byte, kept by the host so it
+        // can draw them without going through guest memory
+        class Framebuffer final : public Device
+        {
+        public:
+            Framebuffer(std::int64_t width, std::int64_t height);
+
+            [[nodiscard]] std::int64_t size() const noexcept override;
+
+            std::uint32_t read(System& sys,
+                               std::int64_t offset,
+                               std::int64_t size) override;
+            void write(System& sys,
+                       std::int64_t offset,
+                       std::int64_t size,
+                       std::uint32_t val) override;
+
+            [[nodiscard]] std::int64_t width() const noexcept;
+            [[nodiscard]] std::int64_t height() const noexcept;
+
+            [[nodiscard]] gsl::span<const std::uint8_t> pixels() const
+                noexcept;
+
+            // Incremented by every write, the host redraws when it changed
+            [[nodiscard]] std::int64_t generation() const noexcept;
+
+        private:
+            std::int64_t m_width;
+            std::int64_t m_height;
+            std::vector<std::uint8_t> m_pixels;
+            std::int64_t m_generation { 0 };
+        };
+    } // namespace devices
+} // namespace momiji
@@ -1,9 +1,17 @@
 #pragma once
 
+#include <momiji/BlockCache.h>
+#include <momiji/DecodeCache.h>
 #include <momiji/Decoder.h>
+#include <momiji/Devices.h>
 #include <momiji/Parser.h>
+#include <momiji/History.h>
+#include <momiji/Scheduler.h>
 #include <momiji/System.h>
+#include <momiji/ThreadedCode.h>
+#include <momiji/TrapServices.h>
 
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
@@ -12,13 +20,26 @@ namespace momiji
 {
     struct EmulatorSettings
     {
-        std::int32_t programStart      = 0;
+        // Guest address space, 16 MiB for the 24 address lines of the
+        // MC68000. Only the pages a program writes to take host memory.
+        std::int64_t addressSpaceSize = utils::make_mb(16);
+
+        // Where the code is loaded and the PC starts, rounded up to a word.
+        // The vector table goes at 0 when there's room before the code,
+        // right after the code otherwise.
+        std::int32_t programStart = 0;
+
+        // Start of the region left to the program's data, -1 for right
+        // after the code and the vector table
         std::int32_t dataSectionOffset = -1;
 
+        // a7 starts at stackTop and the stack grows down from it for
+        // stackSize bytes. -1 for the end of the address space
+        std::int64_t stackTop  = -1;
         std::int64_t stackSize = utils::make_kb(4);
 
-        // Use Always to tell the emulator to always create new copies of the
-        // system state for each instruction execution.
+        // Use Always to tell the emulator to keep every past system state, by
+        // journaling what each instruction overwrites.
         //
         // Use Never to tell the emulator that every instruction should modify
         // the same system state.
@@ -45,13 +66,129 @@ namespace momiji
         }
 
         ParserSettings parserSettings;
+
+        // How run() executes instructions, step() always uses the
+        // interpreter.
+        // ThreadedInterpreter translates the whole executable region ahead
+        // of time and runs it without going back to the emulator between
+        // two instructions, with the same results.
+        // BasicBlocks translates basic blocks as they are reached, binding
+        // instructions to their operands, and chains them to each other.
+        // With RetainStates::Never it also runs the pairs of FusedPair as
+        // one.
+        // Jit also compiles hot basic blocks to host code on x86-64 hosts,
+        // when history doesn't need every instruction as a step. Register
+        // and immediate forms of move, add, sub, and, or, cmp, tst, mul and
+        // div, and shifts of a data register are compiled, the rest (eor,
+        // not, memory operands...) still goes through the BasicBlocks
+        // handlers.
+        enum class Backend : std::int8_t
+        {
+            Interpreter,
+            ThreadedInterpreter,
+            BasicBlocks,
+            Jit,
+        } backend = Backend::Interpreter;
+
+        // Whether the BasicBlocks and Jit backends run loops copying or
+        // filling memory with (a*)+ as bulk operations, leaving the same
+        // memory, registers and flags behind. Only with RetainStates::Never,
+        // history needs every iteration as steps.
+        bool accelerateMemoryIdioms = true;
+
+        // Steps between two full copies of the system kept by the history,
+        // older states are rebuilt by running again from the closest one
+        std::int64_t checkpointInterval = 1024;
+
+        // Memory the history may use, 0 means no limit.
+        // Past it, older checkpoints are moved to historySpillPath.
+        std::int64_t historyMemoryBudget = utils::make_mb(256);
+
+        // A temporary file is used if empty
+        std::string historySpillPath;
+
+        // Whether trap #15 runs the EASy68k text tasks on the host, see
+        // TrapServices. Other tasks, and every task when disabled, go to
+        // the handler in the vector table.
+        bool hostTrapServices = true;
+    };
+
+    struct EmulatorStatistics
+    {
+        // Instructions served by the decode cache
+        std::int64_t decodeCacheHits { 0 };
+
+        // Instructions that had to go through the decoder
+        std::int64_t decodeCacheMisses { 0 };
+
+        // Approximate bytes kept in memory by the history
+        std::int64_t historyMemoryUsage { 0 };
+
+        std::int64_t checkpoints { 0 };
+        std::int64_t spilledCheckpoints { 0 };
+
+        // Pairs of instructions run as one by the block backends with
+        // RetainStates::Never, see FusedPair
+        std::int64_t fusedCompareBranch { 0 };
+        std::int64_t fusedTestBranch { 0 };
+        std::int64_t fusedMoveTest { 0 };
+
+        // Pages of the address space the current state wrote to
+        std::int64_t guestMemoryPages { 0 };
+    };
+
+    struct RunLimits
+    {
+        // Instructions executed before giving up, negative means no limit
+        std::int64_t maxInstructions = -1;
+    };
+
+    enum class StopReason : std::uint8_t
+    {
+        InstructionLimit, // RunLimits::maxInstructions were executed
+        Breakpoint,       // The PC already skips the breakpoint
+        Trap,             // System::trap tells what went wrong
+        Halt,             // hcf, or trap #15 task 9
+        Returned,         // The subroutine stepOut or stepOver waited for
+        OutOfRange,       // The PC left the executable region, or no program
+    };
+
+    struct RunResult
+    {
+        StopReason reason;
+        std::int64_t executed;
     };
 
     struct Emulator
     {
     private:
-        std::vector<momiji::System> m_systemStates;
+        momiji::System m_system;
+        History m_history;
         EmulatorSettings m_settings;
+        DecodeCache m_decodeCache;
+        ThreadedCode m_threadedCode;
+        BlockCache m_blockCache;
+
+        // Shares identical pages between every program loaded
+        PageDeduplicator m_pageDeduplicator;
+
+        // Behind pointers so the states and the devices can refer to them
+        // wherever the emulator is moved. Devices go first, they may have
+        // events scheduled.
+        std::unique_ptr<EventScheduler> m_scheduler;
+        std::unique_ptr<DeviceBus> m_devices;
+
+        // The events as they were before the ones due at position ran,
+        // sorted by position. Only kept when retaining states.
+        struct SchedulerSnapshot
+        {
+            std::int64_t position;
+            EventScheduler scheduler;
+        };
+
+        std::vector<SchedulerSnapshot> m_schedulerSnapshots;
+
+        TrapServices m_trapServices;
 
         struct always_retain_states_tag
         {
@@ -60,23 +197,131 @@ namespace momiji
         {
         };
 
-        bool stepHandleMem(always_retain_states_tag, DecodedInstruction& instr);
-        bool stepHandleMem(never_retain_states_tag, DecodedInstruction& instr);
+        bool stepHandleMem(always_retain_states_tag,
+                           const DecodedInstruction& instr);
+        bool stepHandleMem(never_retain_states_tag,
+                           const DecodedInstruction& instr);
+
+        template <typename RetainStatesTag>
+        RunResult runLoop(RetainStatesTag tag, std::int64_t maxInstructions);
+
+        // Same as run, also stopping once rts leaves fewer than returnDepth
+        // frames in the call stack
+        RunResult runUntilDepth(RunLimits limits, std::int64_t returnDepth);
+
+        // Runs the handler of the pending trap from the next step on,
+        // recording the exception processing as a step of its own.
+        // Returns false if nothing handles it.
+        bool enterException();
+
+        // Serves the pending trap on the host when it can, as a step of its
+        // own, enters its handler otherwise. Returns why the program stops,
+        // if it does.
+        std::optional<StopReason> takeTrap();
+
+        // Points System::nextEventCycle to the next event, or to now when
+        // an interrupt can be taken
+        void updateNextEvent();
+
+        // Runs the events due, returns whether an interrupt can be taken
+        bool runDueEvents();
+
+        // Puts back the events that ran after the current state
+        void rewindScheduler();
+
+        // Enters the handler of the highest interrupt that can be taken,
+        // as a step of its own. Returns false if nothing handles it.
+        bool enterInterrupt();
+
+        void invalidateModifiedCode(momiji::System& sys);
+        bool applySeek(History::SeekResult result);
+
+        // Whether the last step can be undone without leaving the program
+        bool canReverseInProgram();
+        [[nodiscard]] bool atBreakpoint();
 
     public:
         Emulator();
         Emulator(EmulatorSettings);
 
-        [[nodiscard]] const std::vector<momiji::System>& getStates() const;
+        [[nodiscard]] StateHistoryView getStates() const;
 
         std::optional<momiji::ParserError> newState(const std::string& str);
         void newState(momiji::ExecutableMemory binary);
+
+        // Same as reverseStep
         bool rollback();
+
+        // Undoes the last step, loading a program counts as one.
+        // Returns false if there's nothing left to undo.
+        bool reverseStep();
+
+        // Undoes steps until the next instruction is a breakpoint or the
+        // program is back to its first instruction. Loading a program is
+        // never undone.
+        // Returns the number of steps undone.
+        std::int64_t reverseContinue();
+
+        // Undoes steps until the one that last wrote to any byte in
+        // [address, address + size) is undone, leaving the program right
+        // before the write. Stops at the first instruction otherwise.
+        // Returns the number of steps undone.
+        std::int64_t reverseUntilWrite(std::int64_t address,
+                                       std::int64_t size = 1);
+
+        // Moves to the state at position in getStates(). Going back forgets
+        // every later state, going forward runs the program.
+        // Returns false if position couldn't be reached.
+        bool seekTo(std::int64_t position);
+
+        // Returns false if nothing could be executed or if the executed
+        // instruction stopped the program (breakpoint, trap, hcf).
         bool step();
+
+        // Executes instructions until one of limits is reached or the
+        // program stops. Every instruction still makes a new state, same as
+        // step().
+        RunResult run(RunLimits limits = {});
+
+        // Runs until the subroutine the program is in returns, the same as
+        // run() outside of any subroutine.
+        // The call stack is checked by rts only, so it's as fast as run().
+        RunResult stepOut(RunLimits limits = {});
+
+        // Runs until the subroutine called by the next instruction returns
+        // if it is a bsr or a jsr, executes only that instruction otherwise
+        RunResult stepOver(RunLimits limits = {});
+
+        // Subroutines the program is in, innermost last
+        [[nodiscard]] const std::vector<CallFrame>& backtrace() const noexcept;
+
         bool reset();
 
         void loadNewSettings(EmulatorSettings);
         [[nodiscard]] EmulatorSettings getSettings() const noexcept;
+
+        // Maps device at base from the current state on, see
+        // DeviceBus::attach. Devices live outside of the states: going back
+        // doesn't undo what they did, and states rebuilt by running again
+        // from a checkpoint read their pages as memory.
+        bool attachDevice(std::shared_ptr<Device> device, std::int64_t base);
+        void detachDevices();
+
+        // Events run between two instructions at the cycles of the current
+        // state, which start over at 0 with every program loaded. Going back
+        // before events ran puts the scheduler back as it was then, events
+        // scheduled since are dropped.
+        [[nodiscard]] EventScheduler& scheduler() noexcept;
+
+        // Requests an interrupt of level 1 to 7, see momiji::requestInterrupt
+        void requestInterrupt(std::uint8_t level);
+
+        // Output and input of the trap #15 tasks. The output is flushed once
+        // the batch is full and whenever run() or step() stop. Like
+        // devices, what they did isn't undone by going back.
+        [[nodiscard]] TrapServices& trapServices() noexcept;
+
+        [[nodiscard]] EmulatorStatistics getStatistics() const noexcept;
     };
 
     template <typename F>
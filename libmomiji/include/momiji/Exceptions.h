@@ -0,0 +1,53 @@
+#pragma once
+
+#include <momiji/System.h>
+
+#include <cstdint>
+
+namespace momiji
+{
+    // Exception vector numbers, the handler of vector n is the long word at
+    // Cpu::vectorBase + n * 4
+    namespace vectors
+    {
+        constexpr std::uint8_t busError           = 2;
+        constexpr std::uint8_t addressError       = 3;
+        constexpr std::uint8_t illegalInstruction = 4;
+        constexpr std::uint8_t zeroDivide         = 5;
+        constexpr std::uint8_t privilegeViolation = 8;
+        constexpr std::uint8_t autovector         = 24; // Level 1 is 25
+        constexpr std::uint8_t trap               = 32; // trap #0 to #15
+    } // namespace vectors
+
+    // Bytes taken by the 256 vectors
+    constexpr std::int64_t vectorTableSize = 256 * 4;
+
+    [[nodiscard]] std::uint8_t vectorOf(const TrapType& trap);
+
+    // Address of the code handling sys.trap, 0 when there's no trap or the
+    // vector was left at 0
+    [[nodiscard]] std::uint32_t exceptionHandler(const System& sys);
+
+    // Whether raiseException would enter a handler
+    [[nodiscard]] bool canRaiseException(const System& sys);
+
+    // Exception processing for sys.trap: enters supervisor mode, pushes the
+    // exception frame on the supervisor stack and jumps to the handler,
+    // clearing the trap.
+    // Returns false and leaves sys as is when nothing handles it, or when
+    // the frame doesn't fit on the stack (a double fault halts the 68000).
+    // Charges the cycles of the exception processing to sys.cycles.
+    bool raiseException(System& sys);
+
+    // Marks an interrupt of level 1 to 7 as requested and makes the run loops
+    // stop once it can be taken. It's taken when its level is above the
+    // interrupt mask, or is 7, and stays requested until then.
+    void requestInterrupt(System& sys, std::uint8_t level);
+
+    // Highest requested level the interrupt mask lets through, 0 for none
+    [[nodiscard]] std::uint8_t pendingInterrupt(const System& sys);
+
+    // Makes the run loops stop if an interrupt can now be taken, for
+    // instructions lowering the interrupt mask
+    void checkInterrupts(System& sys);
+} // namespace momiji
@@ -0,0 +1,256 @@
+#pragma once
+
+#include <momiji/StateJournal.h>
+#include <momiji/System.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gsl/span>
+
+namespace momiji
+{
+    // Growable memory mapped file, used to keep checkpoints out of memory
+    class SpillFile
+    {
+    public:
+        SpillFile() = default;
+
+        SpillFile(const SpillFile& oth) = delete;
+        SpillFile(SpillFile&& oth) noexcept;
+
+        SpillFile& operator=(const SpillFile& oth) = delete;
+        SpillFile& operator=(SpillFile&& oth) noexcept;
+
+        ~SpillFile();
+
+        // Creates (or truncates) the file at path, an empty path creates a
+        // temporary file that goes away when closed
+        [[nodiscard]] bool open(const std::string& path);
+        void close();
+
+        [[nodiscard]] bool isOpen() const noexcept;
+
+        // Returns the offset bytes were written at, -1 if the file couldn't
+        // grow
+        [[nodiscard]] std::int64_t append(gsl::span<const std::uint8_t> bytes);
+
+        // Forgets everything from offset onwards
+        void truncate(std::int64_t offset) noexcept;
+
+        [[nodiscard]] gsl::span<const std::uint8_t>
+        view(std::int64_t offset, std::int64_t size) const noexcept;
+
+        [[nodiscard]] std::int64_t size() const noexcept;
+
+    private:
+        [[nodiscard]] bool reserve(std::int64_t capacity);
+        void unmap() noexcept;
+
+        std::uint8_t* m_data { nullptr };
+        std::int64_t m_size { 0 };
+        std::int64_t m_capacity { 0 };
+
+        // File descriptor, or file and mapping handles on Windows
+        std::intptr_t m_file { -1 };
+        std::intptr_t m_mapping { 0 };
+    };
+
+    // Every state an emulator went through.
+    // Recent steps are kept in a StateJournal, and a full copy of the system
+    // is taken every few steps. States the journal forgot are rebuilt by
+    // running the program again from the closest checkpoint.
+    // What the host did between two steps (interrupts requested, the next
+    // event moved, an interrupt entered) is logged apart, so running again
+    // does it at the same steps.
+    class History
+    {
+    public:
+        History();
+
+        // checkpointInterval is in steps, memoryBudget in bytes (0 means
+        // unlimited). Past the budget the oldest checkpoints are moved to a
+        // file at spillPath, then the journal drops the steps checkpoints
+        // can rebuild.
+        void configure(std::int64_t checkpointInterval,
+                       std::int64_t memoryBudget,
+                       std::string spillPath);
+
+        // Whether steps over a trap #15 ran its task on the host, see
+        // EmulatorSettings::hostTrapServices. Running them again prints
+        // nothing and reads the input they recorded.
+        void serveHostTraps(bool enabled) noexcept;
+
+        // Everything sys does between beginStep and endStep is a single step.
+        // An interrupt pending in sys.trap when the step begins is the one
+        // the step enters.
+        void beginStep(System& sys);
+        void endStep(System& sys);
+
+        // The step in progress served a task reading input, see
+        // TrapServices::replayInput
+        void recordHostInput(std::string_view input);
+
+        // Records that old was replaced as a whole by current
+        void replaceSystem(System old, const System& current);
+
+        // Index of the current state, the first one is 0
+        [[nodiscard]] std::int64_t position() const noexcept;
+
+        enum class SeekResult : std::uint8_t
+        {
+            Failed,   // position is after the current one or negative
+            Undone,   // Stores were undone one by one
+            Replaced, // The system was replaced as a whole
+        };
+
+        // Moves sys back to the state at position and forgets every later
+        // one. Costs the undo of the steps in between when the journal still
+        // has them, otherwise a binary search for the closest checkpoint and
+        // at most checkpointInterval steps.
+        SeekResult seekTo(System& sys, std::int64_t position);
+
+        // Makes sure the journal knows the step that led to the current
+        // state, running it again from a checkpoint if it was forgotten
+        SeekResult recallLastStep(System& sys);
+
+        // What the step that led to the current state did, recallLastStep
+        // must be called first. The initial state counts as a program load,
+        // there's nothing before it to go back to.
+        [[nodiscard]] bool lastStepLoadsProgram() const;
+        [[nodiscard]] bool lastStepWrites(std::int64_t begin,
+                                          std::int64_t end) const;
+
+        // Builds the state at position without changing anything
+        [[nodiscard]] System stateAt(const System& current,
+                                     std::int64_t position) const;
+
+        // Approximate number of bytes kept in memory
+        [[nodiscard]] std::int64_t memoryUsage() const noexcept;
+
+        [[nodiscard]] std::int64_t checkpointCount() const noexcept;
+        [[nodiscard]] std::int64_t spilledCheckpointCount() const noexcept;
+
+        // Back to a single empty state
+        void clear();
+
+    private:
+        struct Checkpoint
+        {
+            std::int64_t position;
+
+            // Empty once spilled
+            std::optional<System> system;
+
+            std::int64_t fileOffset { -1 };
+            std::int64_t fileSize { 0 };
+
+            // Bytes not shared with the previous checkpoint
+            std::int64_t cost { 0 };
+
+            // Taken right after a program was loaded
+            bool loadsProgram { false };
+        };
+
+        // What the step from position began with, when the host changed it
+        // since the previous step ended or the step enters an interrupt
+        struct HostStep
+        {
+            std::int64_t position;
+            std::int64_t nextEventCycle;
+            std::uint8_t interruptRequests;
+
+            // Level of the interrupt entered, 0 for none
+            std::uint8_t interrupt;
+        };
+
+        // Input the step from position read on the host
+        struct HostInput
+        {
+            std::int64_t position;
+            std::string input;
+        };
+
+        // Gives sys what the host did before the step from position, if
+        // anything
+        void applyHostStep(System& sys, std::int64_t position) const;
+
+        // Empty when the step from position read nothing
+        [[nodiscard]] std::string_view
+        hostInputAt(std::int64_t position) const;
+
+        // The step from the current position is new, the one it replaced
+        // is forgotten
+        void forgetHostStepsFrom(std::int64_t position);
+
+        // Restores checkpoint and runs from there up to target
+        void replayTo(System& sys,
+                      const Checkpoint& checkpoint,
+                      std::int64_t target);
+
+        // Adds a checkpoint once the interval since the last one is over
+        void addCheckpointIfDue(const System& sys);
+        void addCheckpoint(const System& sys);
+        void dropCheckpointsAfter(std::int64_t position);
+        void enforceBudget();
+        [[nodiscard]] bool spill(Checkpoint& checkpoint);
+
+        // Last checkpoint at or before position
+        [[nodiscard]] const Checkpoint&
+        closestCheckpoint(std::int64_t position) const;
+        [[nodiscard]] System load(const Checkpoint& checkpoint) const;
+
+        StateJournal m_journal;
+
+        // Position of the state the first journal entry undoes to
+        std::int64_t m_journalBase { 0 };
+
+        // Sorted by position, the first one is always the empty state
+        std::vector<Checkpoint> m_checkpoints;
+        std::int64_t m_checkpointBytes { 0 };
+
+        SpillFile m_spillFile;
+
+        // Sorted by position, kept when the journal forgets the steps
+        std::vector<HostStep> m_hostSteps;
+        std::vector<HostInput> m_hostInputs;
+
+        // What the step in progress began with, and whether it goes to the
+        // log. The first step after a seek or a program load always does,
+        // later ones when they don't begin the way the last one ended.
+        HostStep m_step {};
+        bool m_logStep { false };
+        bool m_logNextStep { true };
+        std::int64_t m_endNextEvent { 0 };
+        std::uint8_t m_endRequests { 0 };
+
+        std::int64_t m_checkpointInterval;
+        std::int64_t m_memoryBudget { 0 };
+        std::string m_spillPath;
+        bool m_hostTraps { false };
+    };
+
+    // Random access view over the states of an emulator: the first one is
+    // the initial state and the last one is the current state.
+    // Past states are rebuilt on demand from the history.
+    class StateHistoryView
+    {
+    public:
+        StateHistoryView(const System& current, const History& history);
+
+        [[nodiscard]] std::size_t size() const noexcept;
+
+        [[nodiscard]] const System& back() const noexcept;
+
+        // Costs either a copy of the current state plus the undo of every
+        // step after idx, or a checkpoint plus running the steps up to idx
+        [[nodiscard]] System operator[](std::size_t idx) const;
+
+    private:
+        const System* m_current;
+        const History* m_history;
+    };
+} // namespace momiji
@@ -1,16 +1,21 @@
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 
 #include <gsl/span>
 #include <stack>
+#include <utility>
 #include <vector>
 
 #include <asl/detect_features>
 #include <gsl/assert>
 
+#include <momiji/PagedStorage.h>
+
 #include <optional>
+#include <type_traits>
 
 namespace momiji
 {
@@ -19,6 +24,34 @@ namespace momiji
 #pragma clang diagnostic ignored "-Wsign-conversion"
 #endif
 
+    // Guest memory stores values little-endian. This is the only place that
+    // knows: every multi-byte access converts with these, which do nothing
+    // on little-endian hosts.
+    template <typename T>
+    constexpr T toGuestOrder(T val) noexcept
+    {
+        static_assert(std::is_unsigned_v<T>);
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        if constexpr (sizeof(T) == 2)
+        {
+            return __builtin_bswap16(val);
+        }
+        else if constexpr (sizeof(T) == 4)
+        {
+            return __builtin_bswap32(val);
+        }
+#endif
+
+        return val;
+    }
+
+    template <typename T>
+    constexpr T fromGuestOrder(T val) noexcept
+    {
+        return toGuestOrder(val);
+    }
+
     namespace details
     {
         // Instructions
@@ -41,6 +74,13 @@ namespace momiji
         std::int64_t end { -1 };
     };
 
+    // Old value of a byte overwritten by a store
+    struct MemoryUndoEntry
+    {
+        std::uint32_t offset;
+        std::uint8_t value;
+    };
+
     template <typename Tag>
     class MemorySpan;
 
@@ -87,28 +127,47 @@ namespace momiji
         [[nodiscard]] bool write8(std::uint8_t val,
                                   std::int64_t offset) noexcept;
 
-        [[nodiscard]] auto begin() const noexcept;
-        [[nodiscard]] auto end() const noexcept;
+        // Unchecked accesses of an unsigned T, the range must be inside the
+        // memory. store records the store.
+        template <typename T>
+        [[nodiscard]] T load(std::int64_t offset) const noexcept;
+
+        template <typename T>
+        void store(T val, std::int64_t offset);
 
         [[nodiscard]] auto size() const noexcept;
 
         [[nodiscard]] auto empty() const noexcept;
 
-        [[nodiscard]] auto data() noexcept;
-
         [[nodiscard]] Container& underlying();
+        [[nodiscard]] const Container& underlying() const;
+
+        // Must be called right before a store of size bytes at offset.
+        // Records whether it touches the executable region, so decoded
+        // instructions can be dropped later, and saves the old bytes in
+        // undoLog if there is one.
+        void recordStore(std::int64_t offset, std::int64_t size);
 
         MemoryMarker<details::ExecutableMemoryTag> executableMarker {};
         MemoryMarker<details::StackMemoryTag> stackMarker {};
         MemoryMarker<details::StaticMemoryTag> staticMarker {};
 
+        // Part of the executable region written since it was last reset,
+        // begin is -1 when no code was modified
+        MemoryMarker<details::ExecutableMemoryTag> codeWriteMarker {};
+
+        // Not owned, set only while someone needs to undo the stores
+        std::vector<MemoryUndoEntry>* undoLog { nullptr };
+
     protected:
         BasicMemory(std::int64_t size);
         Container m_data;
     };
 
+    // Guest memory lives in 4 KiB pages shared between copies, so copying a
+    // System only costs the pages written afterwards
     template <typename Tag>
-    class ModifiableMemory final : public BasicMemory<std::vector<std::uint8_t>>
+    class ModifiableMemory final : public BasicMemory<PagedStorage>
     {
     public:
         ModifiableMemory() = default;
@@ -141,26 +200,20 @@ namespace momiji
 
     // TODO(andry): Bad name
     template <typename Tag>
-    class MemorySpan final : public BasicMemory<gsl::span<std::uint8_t>>
+    class MemorySpan final : public BasicMemory<PagedStorageRef<PagedStorage>>
     {
     public:
         MemorySpan(ModifiableMemory<Tag>& mem)
         {
-            m_data = { mem.m_data.data(), asl::ssize(mem.m_data) };
+            m_data = { mem.m_data };
 
             executableMarker = mem.executableMarker;
             stackMarker      = mem.stackMarker;
             staticMarker     = mem.staticMarker;
         }
 
-        MemorySpan(gsl::span<std::uint8_t> span)
-        {
-            m_data = span;
-        }
-
         MemorySpan(NullMemoryView /*unused*/)
         {
-            m_data = { gsl::null_span {} };
         }
 
         template <typename T>
@@ -186,12 +239,13 @@ namespace momiji
     };
 
     template <typename Tag>
-    class MemoryView final : public BasicMemory<gsl::span<const std::uint8_t>>
+    class MemoryView final
+        : public BasicMemory<PagedStorageRef<const PagedStorage>>
     {
     public:
         MemoryView(const ModifiableMemory<Tag>& mem)
         {
-            m_data = { mem.m_data.data(), asl::ssize(mem.m_data) };
+            m_data = { mem.m_data };
 
             executableMarker = mem.executableMarker;
             stackMarker      = mem.stackMarker;
@@ -200,7 +254,10 @@ namespace momiji
 
         MemoryView(const MemorySpan<Tag>& mem)
         {
-            m_data = { mem.m_data.data(), asl::ssize(mem.m_data) };
+            if (mem.m_data.get() != nullptr)
+            {
+                m_data = { *mem.m_data.get() };
+            }
 
             executableMarker = mem.executableMarker;
             stackMarker      = mem.stackMarker;
@@ -231,39 +288,78 @@ namespace momiji
     }
 
     template <typename Container>
-    [[nodiscard]] auto BasicMemory<Container>::begin() const noexcept
+    [[nodiscard]] auto BasicMemory<Container>::size() const noexcept
     {
-        return m_data.begin();
+        return m_data.size();
     }
 
     template <typename Container>
-    [[nodiscard]] auto BasicMemory<Container>::end() const noexcept
+    [[nodiscard]] auto BasicMemory<Container>::empty() const noexcept
     {
-        return m_data.end();
+        return m_data.empty();
     }
 
     template <typename Container>
-    [[nodiscard]] auto BasicMemory<Container>::size() const noexcept
+    [[nodiscard]] Container& BasicMemory<Container>::underlying()
     {
-        return m_data.size();
+        return m_data;
     }
 
     template <typename Container>
-    [[nodiscard]] auto BasicMemory<Container>::empty() const noexcept
+    [[nodiscard]] const Container& BasicMemory<Container>::underlying() const
     {
-        return m_data.empty();
+        return m_data;
+    }
+
+    template <typename Container>
+    void BasicMemory<Container>::recordStore(std::int64_t offset,
+                                             std::int64_t size)
+    {
+        const std::int64_t last = offset + size;
+
+        if (undoLog != nullptr)
+        {
+            const auto first = std::max(offset, std::int64_t(0));
+            const auto end   = std::min(last, asl::ssize(m_data));
+
+            for (auto i = first; i < end; ++i)
+            {
+                undoLog->push_back(
+                    { std::uint32_t(i), std::as_const(m_data)[i] });
+            }
+        }
+
+        if (last <= executableMarker.begin || offset >= executableMarker.end)
+        {
+            return;
+        }
+
+        if (codeWriteMarker.begin < 0)
+        {
+            codeWriteMarker.begin = offset;
+            codeWriteMarker.end   = last;
+            return;
+        }
+
+        codeWriteMarker.begin = std::min(codeWriteMarker.begin, offset);
+        codeWriteMarker.end   = std::max(codeWriteMarker.end, last);
     }
 
     template <typename Container>
-    [[nodiscard]] auto BasicMemory<Container>::data() noexcept
+    template <typename T>
+    [[nodiscard]] T BasicMemory<Container>::load(std::int64_t offset) const
+        noexcept
     {
-        return m_data.data();
+        return fromGuestOrder(m_data.template load<T>(offset));
     }
 
     template <typename Container>
-    [[nodiscard]] Container& BasicMemory<Container>::underlying()
+    template <typename T>
+    void BasicMemory<Container>::store(T val, std::int64_t offset)
     {
-        return m_data;
+        recordStore(offset, sizeof(T));
+
+        m_data.store(offset, toGuestOrder(val));
     }
 
     template <typename Container>
@@ -275,9 +371,7 @@ namespace momiji
             return std::nullopt;
         }
 
-        return std::uint32_t((m_data[offset]) | (m_data[offset + 1] << 8) |
-                             (m_data[offset + 2] << 16) |
-                             (m_data[offset + 3] << 24));
+        return load<std::uint32_t>(offset);
     }
 
     template <typename Container>
@@ -289,7 +383,7 @@ namespace momiji
             return std::nullopt;
         }
 
-        return std::uint16_t((m_data[offset]) | (m_data[offset + 1] << 8));
+        return load<std::uint16_t>(offset);
     }
 
     template <typename Container>
@@ -314,15 +408,7 @@ namespace momiji
             return false;
         }
 
-        const std::uint8_t first  = (val & 0x000000FF);
-        const std::uint8_t second = (val & 0x0000FF00) >> 8;
-        const std::uint8_t third  = (val & 0x00FF0000) >> 16;
-        const std::uint8_t fourth = (val & 0xFF000000) >> 24;
-
-        m_data[offset]     = first;
-        m_data[offset + 1] = second;
-        m_data[offset + 2] = third;
-        m_data[offset + 3] = fourth;
+        store(val, offset);
 
         return true;
     }
@@ -337,11 +423,7 @@ namespace momiji
             return false;
         }
 
-        const std::uint8_t first  = (val & 0x00FF);
-        const std::uint8_t second = (val & 0xFF00) >> 8;
-
-        m_data[offset]     = first;
-        m_data[offset + 1] = second;
+        store(val, offset);
 
         return true;
     }
@@ -351,11 +433,13 @@ namespace momiji
     BasicMemory<Container>::write8(std::uint8_t val,
                                    std::int64_t offset) noexcept
     {
-        if (offset >= asl::ssize(m_data.size) || offset < 0)
+        if (offset >= asl::ssize(m_data) || offset < 0)
         {
             return false;
         }
 
+        recordStore(offset, 1);
+
         m_data[offset] = val;
 
         return true;
@@ -378,15 +462,8 @@ namespace momiji
             m_data.push_back(0);
         }
 
-        const std::uint8_t first  = (val & 0x0000'00FF);
-        const std::uint8_t second = (val & 0x0000'FF00) >> 8;
-        const std::uint8_t third  = (val & 0x00FF'0000) >> 16;
-        const std::uint8_t fourth = (val & 0xFF00'0000) >> 24;
-
-        m_data.push_back(first);
-        m_data.push_back(second);
-        m_data.push_back(third);
-        m_data.push_back(fourth);
+        m_data.resize(asl::ssize(m_data) + 4);
+        m_data.store(asl::ssize(m_data) - 4, toGuestOrder(val));
     }
 
     template <typename Tag>
@@ -398,11 +475,8 @@ namespace momiji
             m_data.push_back(0);
         }
 
-        const std::uint8_t first  = (val & 0x00FF);
-        const std::uint8_t second = (val & 0xFF00) >> 8;
-
-        m_data.push_back(first);
-        m_data.push_back(second);
+        m_data.resize(asl::ssize(m_data) + 2);
+        m_data.store(asl::ssize(m_data) - 2, toGuestOrder(val));
     }
 
     template <typename Tag>
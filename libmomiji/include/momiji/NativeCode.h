@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace momiji
+{
+    // Executable memory for host code generated at run time.
+    // Code is copied in once and never modified, the pages it lives in are
+    // never writable and executable at the same time.
+    class NativeCodeBuffer
+    {
+    public:
+        NativeCodeBuffer();
+        ~NativeCodeBuffer();
+
+        NativeCodeBuffer(const NativeCodeBuffer&) = delete;
+        NativeCodeBuffer(NativeCodeBuffer&&) noexcept;
+
+        NativeCodeBuffer& operator=(const NativeCodeBuffer&) = delete;
+        NativeCodeBuffer& operator=(NativeCodeBuffer&&) noexcept;
+
+        // Returns where code was copied, null if the host refuses to make
+        // it executable or the buffer is full
+        const void* add(const std::vector<std::uint8_t>& code);
+
+        // Every pointer returned so far becomes invalid
+        void clear();
+
+        // Bytes of code added since the last clear
+        [[nodiscard]] std::int64_t size() const noexcept;
+
+    private:
+        struct Chunk;
+
+        std::vector<std::unique_ptr<Chunk>> m_chunks;
+        std::int64_t m_size { 0 };
+    };
+} // namespace momiji
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <asl/types>
+#include <gsl/span>
+
+namespace momiji
+{
+    constexpr std::int64_t memoryPageSize = 4096;
+
+    class PageDeduplicator;
+
+    // Byte array split in pages shared by every copy of it.
+    // Copying only copies the page handles, a page is cloned the first time
+    // it is written while another storage still refers to it.
+    // Pages never written to all share a single zero page, so a large
+    // storage only costs the pages actually touched.
+    class PagedStorage
+    {
+    public:
+        using Page = std::array<std::uint8_t, memoryPageSize>;
+
+        PagedStorage() = default;
+        explicit PagedStorage(std::int64_t size);
+
+        [[nodiscard]] std::uint8_t operator[](std::int64_t idx) const noexcept
+        {
+            return (*m_pages[std::size_t(idx / memoryPageSize)])
+                [std::size_t(idx % memoryPageSize)];
+        }
+
+        // Gives the page holding idx to this storage alone
+        [[nodiscard]] std::uint8_t& operator[](std::int64_t idx)
+        {
+            return writablePage(idx / memoryPageSize)
+                [std::size_t(idx % memoryPageSize)];
+        }
+
+        // Host order copy of the sizeof(T) bytes at idx, which must be inside
+        // the storage. A single load unless they straddle two pages.
+        template <typename T>
+        [[nodiscard]] T load(std::int64_t idx) const noexcept
+        {
+            const auto at = std::size_t(idx % memoryPageSize);
+
+            T val;
+
+            if (at + sizeof(T) <= std::size_t(memoryPageSize))
+            {
+                const auto& page = *m_pages[std::size_t(idx / memoryPageSize)];
+                std::memcpy(&val, page.data() + at, sizeof(T));
+
+                return val;
+            }
+
+            std::array<std::uint8_t, sizeof(T)> bytes;
+
+            for (std::size_t i = 0; i < sizeof(T); ++i)
+            {
+                bytes[i] = (*this)[idx + std::int64_t(i)];
+            }
+
+            std::memcpy(&val, bytes.data(), sizeof(T));
+
+            return val;
+        }
+
+        // Same as load, the other way around
+        template <typename T>
+        void store(std::int64_t idx, T val)
+        {
+            const auto at = std::size_t(idx % memoryPageSize);
+
+            if (at + sizeof(T) <= std::size_t(memoryPageSize))
+            {
+                auto& page = writablePage(idx / memoryPageSize);
+                std::memcpy(page.data() + at, &val, sizeof(T));
+
+                return;
+            }
+
+            std::array<std::uint8_t, sizeof(T)> bytes;
+            std::memcpy(bytes.data(), &val, sizeof(T));
+
+            for (std::size_t i = 0; i < sizeof(T); ++i)
+            {
+                (*this)[idx + std::int64_t(i)] = bytes[i];
+            }
+        }
+
+        [[nodiscard]] std::int64_t size() const noexcept;
+        [[nodiscard]] bool empty() const noexcept;
+
+        void resize(std::int64_t size, std::uint8_t value = 0);
+        void push_back(std::uint8_t val);
+        void pop_back();
+
+        // Bulk copies, the range must be inside the storage
+        void read(std::int64_t offset, gsl::span<std::uint8_t> out) const;
+        void write(std::int64_t offset, gsl::span<const std::uint8_t> in);
+
+        [[nodiscard]] std::int64_t pageCount() const noexcept;
+
+        // Pages no other storage refers to
+        [[nodiscard]] std::int64_t privatePageCount() const noexcept;
+
+        // Whether the page at idx was written to since it was last zeroed
+        [[nodiscard]] bool materialized(std::int64_t idx) const noexcept;
+
+        [[nodiscard]] std::int64_t materializedPageCount() const noexcept;
+
+        // Whether both storages refer to the very same page at idx
+        [[nodiscard]] bool sharesPage(const PagedStorage& oth,
+                                      std::int64_t idx) const noexcept;
+
+    private:
+        friend class PageDeduplicator;
+
+        Page& writablePage(std::int64_t page);
+
+        std::vector<std::shared_ptr<Page>> m_pages;
+        std::int64_t m_size { 0 };
+    };
+
+    // Makes pages with the same content point to the same memory, within a
+    // storage and across every storage it has seen.
+    // Only weak references are kept, pages still go away with their last
+    // storage.
+    class PageDeduplicator
+    {
+    public:
+        PageDeduplicator() = default;
+
+        // Returns how many pages of storage now point to an earlier copy
+        std::int64_t deduplicate(PagedStorage& storage);
+
+    private:
+        std::unordered_map<std::uint64_t,
+                           std::vector<std::weak_ptr<PagedStorage::Page>>>
+            m_pages;
+    };
+
+    // Non owning handle used by memory views, Storage is either PagedStorage
+    // or const PagedStorage. A null handle is empty.
+    template <typename Storage>
+    class PagedStorageRef
+    {
+    public:
+        PagedStorageRef() = default;
+        PagedStorageRef(Storage& storage)
+            : m_storage(&storage)
+        {
+        }
+
+        [[nodiscard]] std::uint8_t operator[](std::int64_t idx) const noexcept
+        {
+            return std::as_const(*m_storage)[idx];
+        }
+
+        [[nodiscard]] decltype(auto) operator[](std::int64_t idx)
+        {
+            return (*m_storage)[idx];
+        }
+
+        template <typename T>
+        [[nodiscard]] T load(std::int64_t idx) const noexcept
+        {
+            return m_storage->template load<T>(idx);
+        }
+
+        template <typename T>
+        void store(std::int64_t idx, T val)
+        {
+            m_storage->store(idx, val);
+        }
+
+        [[nodiscard]] std::int64_t size() const noexcept
+        {
+            return m_storage != nullptr ? m_storage->size() : 0;
+        }
+
+        [[nodiscard]] bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        [[nodiscard]] Storage* get() const noexcept
+        {
+            return m_storage;
+        }
+
+    private:
+        Storage* m_storage { nullptr };
+    };
+} // namespace momiji
@@ -41,7 +41,8 @@ namespace momiji
         AbsoluteShort,
         AbsoluteLong,
         ProgramCounterOffset,
-        ProgramCounterIndex
+        ProgramCounterIndex,
+        ControlRegister
     };
 
     enum class ParserSection : std::int8_t
@@ -263,6 +264,12 @@ namespace momiji
         struct ProgramCounterIndex
         {
         };
+
+        // usp or vbr, only for movec. reg is the field of the extension word.
+        struct ControlRegister
+        {
+            std::int32_t reg;
+        };
     } // namespace operands
 
     // TODO(andry): The name is bad
@@ -277,7 +284,8 @@ namespace momiji
                                  operands::ProgramCounterOffset,
                                  operands::ProgramCounterIndex,
                                  operands::AbsoluteShort,
-                                 operands::AbsoluteLong>;
+                                 operands::AbsoluteLong,
+                                 operands::ControlRegister>;
 
     struct ParsedInstruction
     {
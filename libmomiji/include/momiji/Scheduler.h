@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+namespace momiji
+{
+    struct System;
+
+    // Host callbacks run between two instructions once System::cycles
+    // reaches the cycle they were scheduled at. Events due at the same cycle
+    // run in the order they were scheduled, so a program given the same
+    // events always sees them at the same instructions.
+    class EventScheduler
+    {
+    public:
+        using Callback = std::function<void(System&)>;
+        using EventId  = std::uint64_t;
+
+        // The largest cycle, of no event
+        static constexpr std::int64_t never =
+            std::numeric_limits<std::int64_t>::max();
+
+        EventScheduler() = default;
+
+        // Runs callback once the cycles reach cycle, on the next check if
+        // it's already past. The run loops only notice it once they give
+        // control back to the Emulator: scheduling from a device access has
+        // to lower System::nextEventCycle as well.
+        EventId schedule(std::int64_t cycle, Callback callback);
+
+        // Returns false if it already ran or was cancelled
+        bool cancel(EventId id);
+
+        void clear();
+
+        // Back to the events earlier had, ids given since stay unused
+        void restore(const EventScheduler& earlier);
+
+        [[nodiscard]] bool empty() const noexcept;
+
+        // Cycle of the earliest event, never when there are none
+        [[nodiscard]] std::int64_t nextCycle() const noexcept;
+
+        // Runs the events due at sys.cycles earliest first, the ones they
+        // schedule included. Returns how many ran.
+        std::int64_t runDue(System& sys);
+
+    private:
+        struct Event
+        {
+            std::int64_t cycle;
+            EventId id;
+            Callback callback;
+        };
+
+        // Heap with the earliest event, then the first scheduled, in front
+        std::vector<Event> m_events;
+        EventId m_nextId { 1 };
+    };
+} // namespace momiji
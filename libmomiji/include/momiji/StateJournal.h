@@ -0,0 +1,107 @@
+#pragma once
+
+#include <momiji/System.h>
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace momiji
+{
+    // Old value of a register overwritten by an instruction.
+    // index is [0, 7] for data registers, [8, 15] for address registers,
+    // then the program counter, the whole status register, the inactive
+    // stack pointer and the vector base.
+    struct RegisterUndoEntry
+    {
+        std::uint8_t index;
+        std::uint32_t value;
+    };
+
+    // Remembers what every step overwrote, so the system can be moved back
+    // in time without keeping a copy of it for each instruction.
+    class StateJournal
+    {
+    public:
+        StateJournal() = default;
+
+        // Everything sys does between beginStep and endStep is recorded as a
+        // single entry.
+        void beginStep(System& sys);
+        void endStep(System& sys);
+
+        // Records that sys was replaced as a whole (eg: a new program was
+        // loaded), old is kept as is
+        void replaceSystem(System old);
+
+        // Undoes the last entry on sys and forgets it.
+        // Returns false if there's nothing to undo.
+        bool undo(System& sys);
+
+        // Undoes the entry at idx on sys without forgetting it, entries must
+        // be undone from the last one to the first one
+        void undoInto(System& sys, std::size_t idx) const;
+
+        // Whether undoing the entry at idx replaces the whole system
+        [[nodiscard]] bool replacesSystem(std::size_t idx) const;
+
+        // Whether the step at idx stored anything in [begin, end)
+        [[nodiscard]] bool writes(std::size_t idx,
+                                  std::int64_t begin,
+                                  std::int64_t end) const;
+
+        [[nodiscard]] std::size_t size() const noexcept;
+        [[nodiscard]] bool empty() const noexcept;
+
+        // Forgets the count oldest entries, the states before them can't be
+        // rebuilt from the journal anymore
+        void dropOldest(std::size_t count);
+
+        // Approximate number of bytes kept
+        [[nodiscard]] std::int64_t memoryUsage() const noexcept;
+
+        void clear();
+
+    private:
+        struct Entry
+        {
+            // One past the last undo entry of this step
+            std::size_t registerEnd;
+            std::size_t memoryEnd;
+            std::size_t frameEnd;
+
+            // Frames in the call stack before this step
+            std::size_t depth;
+
+            // Index in m_systems, -1 for normal steps
+            std::int64_t system;
+
+            // Trap pending when the step began, the one an exception step
+            // handled
+            std::optional<TrapType> trap;
+
+            // System::cycles when the step began
+            std::int64_t cycles;
+
+            // Interrupts requested and next event when the step began, both
+            // can be changed by the host between two steps
+            std::int64_t nextEventCycle;
+            std::uint8_t interruptRequests;
+        };
+
+        std::vector<Entry> m_entries;
+        std::vector<RegisterUndoEntry> m_registers;
+        std::vector<MemoryUndoEntry> m_memory;
+        std::vector<CallFrame> m_frames; // Popped by rts, innermost first
+        std::vector<System> m_systems;
+
+        // CPU and call stack depth as they were when the current step began
+        Cpu m_stepCpu;
+        std::size_t m_stepDepth { 0 };
+        std::optional<TrapType> m_stepTrap;
+        std::int64_t m_stepCycles { 0 };
+        std::int64_t m_stepNextEvent { 0 };
+        std::uint8_t m_stepRequests { 0 };
+    };
+
+} // namespace momiji
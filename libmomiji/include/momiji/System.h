@@ -2,10 +2,13 @@
 
 #include <array>
 #include <cstdint>
+#include <limits>
 #include <momiji/Parser.h>
 #include <optional>
+#include <utility>
 #include <vector>
 
+#include <momiji/Devices.h>
 #include <momiji/Memory.h>
 #include <momiji/Utils.h>
 
@@ -31,12 +34,40 @@ namespace momiji
         struct IllegalInstruction
         {
         };
+
+        // A word or long word accessed at an odd address
+        struct AddressError
+        {
+            std::int32_t address;
+            bool write;
+        };
+
+        // trap #number
+        struct Trap
+        {
+            std::int32_t number;
+        };
+
+        // An instruction only allowed in supervisor mode ran in user mode
+        struct PrivilegeViolation
+        {
+        };
+
+        // A device or the host requested an interrupt of level 1 to 7
+        struct Interrupt
+        {
+            std::uint8_t level;
+        };
     } // namespace traps
 
     using TrapType = std::variant<traps::InvalidMemoryRead,
                                   traps::InvalidMemoryWrite,
                                   traps::DivisionByZero,
-                                  traps::IllegalInstruction>;
+                                  traps::IllegalInstruction,
+                                  traps::AddressError,
+                                  traps::Trap,
+                                  traps::PrivilegeViolation,
+                                  traps::Interrupt>;
 
     template <typename IntType, typename PhantomTag>
     struct Register
@@ -381,22 +412,249 @@ namespace momiji
     using AddressRegister = Register<std::int32_t, struct AddressRegisterTag>;
     using ProgramCounter  = Register<std::uint32_t, struct ProgramCounterTag>;
 
+    // How the condition codes were last set
+    enum class FlagsOp : std::uint8_t
+    {
+        None,    // StatusRegister::stored holds them as they are
+        Logical, // N and Z from the result, V and C cleared
+        Add,     // result = dst + src
+        Sub,     // result = dst - src
+    };
+
+    // What an instruction computed, the flags are only worked out from it
+    // when they are read
+    struct FlagsSource
+    {
+        std::int32_t src { 0 };
+        std::int32_t dst { 0 };
+        std::int32_t result { 0 };
+        FlagsOp op { FlagsOp::None };
+        std::int8_t size { 4 };
+    };
+
+    namespace details
+    {
+        constexpr std::uint32_t sizeMask(std::int8_t size)
+        {
+            switch (size)
+            {
+            case 1:
+                return 0x0000'00FF;
+
+            case 2:
+                return 0x0000'FFFF;
+
+            default:
+                return 0xFFFF'FFFF;
+            }
+        }
+
+        constexpr std::uint32_t signBit(std::int8_t size)
+        {
+            return (sizeMask(size) >> 1) + 1;
+        }
+
+        constexpr bool carryOf(const FlagsSource& source)
+        {
+            const auto mask = sizeMask(source.size);
+            const auto src  = std::uint32_t(source.src) & mask;
+            const auto dst  = std::uint32_t(source.dst) & mask;
+
+            switch (source.op)
+            {
+            case FlagsOp::Add:
+                return std::uint64_t(src) + dst > mask;
+
+            case FlagsOp::Sub:
+                return src > dst;
+
+            default:
+                return false;
+            }
+        }
+    } // namespace details
+
+    // Condition codes are evaluated lazily: instructions only record the
+    // operation that sets them, most are overwritten before being read
     struct StatusRegister
     {
-        StatusRegister()
-            : extend(0)
-            , negative(0)
-            , zero(0)
-            , overflow(0)
-            , carry(0)
+        // Bits of the condition code register
+        enum Flag : std::uint8_t
+        {
+            Carry    = 1 << 0, // C
+            Overflow = 1 << 1, // V
+            Zero     = 1 << 2, // Z
+            Negative = 1 << 3, // N
+            Extend   = 1 << 4, // E / X
+        };
+
+        // Bits of the system byte, the upper half of the status register
+        enum SystemFlag : std::uint8_t
+        {
+            InterruptMask = 0b111,  // I2 I1 I0
+            Supervisor    = 1 << 5, // S
+            Trace         = 1 << 7, // T
+        };
+
+        [[nodiscard]] constexpr bool extend() const
+        {
+            if (extendSource.op == FlagsOp::None)
+            {
+                return (stored & Extend) != 0;
+            }
+
+            return details::carryOf(extendSource);
+        }
+
+        [[nodiscard]] constexpr bool negative() const
         {
+            if (codes.op == FlagsOp::None)
+            {
+                return (stored & Negative) != 0;
+            }
+
+            return (std::uint32_t(codes.result) &
+                    details::signBit(codes.size)) != 0;
         }
 
-        std::uint8_t extend : 1;   // E / X
-        std::uint8_t negative : 1; // N
-        std::uint8_t zero : 1;     // Z
-        std::uint8_t overflow : 1; // V
-        std::uint8_t carry : 1;    // C
+        [[nodiscard]] constexpr bool zero() const
+        {
+            if (codes.op == FlagsOp::None)
+            {
+                return (stored & Zero) != 0;
+            }
+
+            return (std::uint32_t(codes.result) &
+                    details::sizeMask(codes.size)) == 0;
+        }
+
+        [[nodiscard]] constexpr bool overflow() const
+        {
+            const auto src = std::uint32_t(codes.src);
+            const auto dst = std::uint32_t(codes.dst);
+            const auto res = std::uint32_t(codes.result);
+
+            switch (codes.op)
+            {
+            case FlagsOp::None:
+                return (stored & Overflow) != 0;
+
+            case FlagsOp::Add:
+                return (((src ^ res) & (dst ^ res)) &
+                        details::signBit(codes.size)) != 0;
+
+            case FlagsOp::Sub:
+                return (((src ^ dst) & (res ^ dst)) &
+                        details::signBit(codes.size)) != 0;
+
+            default:
+                return false;
+            }
+        }
+
+        [[nodiscard]] constexpr bool carry() const
+        {
+            if (codes.op == FlagsOp::None)
+            {
+                return (stored & Carry) != 0;
+            }
+
+            return details::carryOf(codes);
+        }
+
+        // Every flag, laid out as in the condition code register
+        [[nodiscard]] constexpr std::uint8_t bits() const
+        {
+            return std::uint8_t((extend() ? Extend : 0) |
+                                (negative() ? Negative : 0) |
+                                (zero() ? Zero : 0) |
+                                (overflow() ? Overflow : 0) |
+                                (carry() ? Carry : 0));
+        }
+
+        constexpr void setBits(std::uint8_t value)
+        {
+            stored          = std::uint8_t(value & 0x1F);
+            codes.op        = FlagsOp::None;
+            extendSource.op = FlagsOp::None;
+        }
+
+        [[nodiscard]] constexpr bool supervisor() const
+        {
+            return (system & Supervisor) != 0;
+        }
+
+        // Interrupts of this level or lower wait, except level 7
+        [[nodiscard]] constexpr std::uint8_t interruptMask() const
+        {
+            return std::uint8_t(system & InterruptMask);
+        }
+
+        // The whole status register, system byte included
+        [[nodiscard]] constexpr std::uint16_t word() const
+        {
+            return std::uint16_t((system << 8) | bits());
+        }
+
+        // Only the status register, Cpu::setStatusWord also switches stacks
+        constexpr void setWord(std::uint16_t value)
+        {
+            system = std::uint8_t((value >> 8) &
+                                  (Trace | Supervisor | InterruptMask));
+            setBits(std::uint8_t(value));
+        }
+
+        constexpr void set(Flag flag, bool value)
+        {
+            const auto current = bits();
+
+            setBits(value ? std::uint8_t(current | flag)
+                          : std::uint8_t(current & ~flag));
+        }
+
+        // move and tst, X is left alone
+        constexpr void setLogical(std::int8_t size, std::int32_t result)
+        {
+            codes = { 0, 0, result, FlagsOp::Logical, size };
+        }
+
+        // add, X is the same as C
+        constexpr void setAdd(std::int8_t size,
+                              std::int32_t src,
+                              std::int32_t dst,
+                              std::int32_t result)
+        {
+            codes        = { src, dst, result, FlagsOp::Add, size };
+            extendSource = codes;
+        }
+
+        // sub, X is the same as C
+        constexpr void setSub(std::int8_t size,
+                              std::int32_t src,
+                              std::int32_t dst,
+                              std::int32_t result)
+        {
+            codes        = { src, dst, result, FlagsOp::Sub, size };
+            extendSource = codes;
+        }
+
+        // cmp, X is left alone
+        constexpr void setCompare(std::int8_t size,
+                                  std::int32_t src,
+                                  std::int32_t dst,
+                                  std::int32_t result)
+        {
+            codes = { src, dst, result, FlagsOp::Sub, size };
+        }
+
+        // Only meant to be accessed directly by generated code
+
+        FlagsSource codes;         // N, Z, V and C
+        FlagsSource extendSource;  // X
+        std::uint8_t stored { 0 }; // Flags whose source is FlagsOp::None
+
+        // Programs start in supervisor mode with every interrupt enabled
+        std::uint8_t system { Supervisor };
     };
 
     struct Cpu
@@ -404,6 +662,7 @@ namespace momiji
         Cpu()
             : dataRegisters({ 0 })
             , addressRegisters({ 0 })
+            , programCounter(0)
         {
         }
 
@@ -412,6 +671,50 @@ namespace momiji
 
         StatusRegister statusRegister;
         ProgramCounter programCounter;
+
+        // a7 of the mode not running: the user stack pointer in supervisor
+        // mode, the supervisor one in user mode
+        AddressRegister inactiveStackPointer { 0 };
+
+        // Where the exception vectors are, as on the 68010
+        std::uint32_t vectorBase { 0 };
+
+        // Switches a7 to the stack pointer of the new mode if it changes
+        void setStatusWord(std::uint16_t value)
+        {
+            const bool wasSupervisor = statusRegister.supervisor();
+
+            statusRegister.setWord(value);
+
+            if (wasSupervisor != statusRegister.supervisor())
+            {
+                std::swap(addressRegisters[7], inactiveStackPointer);
+            }
+        }
+    };
+
+    // A subroutine entered by bsr or jsr and not yet left by rts
+    struct CallFrame
+    {
+        std::uint32_t callSite; // Address of the bsr or jsr
+        std::uint32_t target;   // Address of the subroutine
+
+        // a7 once the return address was pushed
+        std::int32_t stackPointer;
+    };
+
+    // Kept next to the program's own stack, which only has return addresses
+    struct CallStack
+    {
+        // Innermost last
+        std::vector<CallFrame> frames;
+
+        // rts reports ExecutionStatus::Returned when it leaves fewer frames
+        // than this, negative means never
+        std::int64_t returnDepth { -1 };
+
+        // Not owned, rts saves the frames it pops there when set
+        std::vector<CallFrame>* undoLog { nullptr };
     };
 
     struct System
@@ -419,6 +722,22 @@ namespace momiji
         Cpu cpu;
         ExecutableMemory mem;
         std::optional<TrapType> trap;
+        CallStack callStack;
+
+        // Not owned, set by the Emulator to the devices of the state it runs
+        const DeviceBus* devices { &noDevices };
+
+        // 68000 cycles taken by the instructions and exceptions so far
+        std::int64_t cycles { 0 };
+
+        // The run loops hand control back to the Emulator once cycles
+        // reaches it, so it runs the events due and takes the interrupts
+        std::int64_t nextEventCycle {
+            std::numeric_limits<std::int64_t>::max()
+        };
+
+        // Bit n is set while an interrupt of level n waits to be taken
+        std::uint8_t interruptRequests { 0 };
     };
 
     inline momiji::ExecutableMemoryView make_memory_view(System& sys)
@@ -431,4 +750,18 @@ namespace momiji
         return sys.mem;
     }
 
+    // Whether the PC of sys points to an instruction that can be executed
+    inline bool canExecute(const System& sys)
+    {
+        if (sys.mem.empty() || sys.trap.has_value())
+        {
+            return false;
+        }
+
+        const auto pc = std::int64_t(sys.cpu.programCounter.raw());
+
+        return pc >= sys.mem.executableMarker.begin &&
+               pc < sys.mem.executableMarker.end;
+    }
+
 } // namespace momiji
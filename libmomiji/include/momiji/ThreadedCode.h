@@ -0,0 +1,78 @@
+#pragma once
+
+#include <momiji/Decoder.h>
+#include <momiji/History.h>
+#include <momiji/Memory.h>
+#include <momiji/System.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace momiji
+{
+    // The executable region translated ahead of time into an array of
+    // handlers, one slot per word, executed back to back without going
+    // through the emulator or the decode cache between two instructions.
+    // Moves, add, sub, cmp and tst to a data register from a register or an
+    // immediate, and bra, bcc and jmp to a known address are bound to their
+    // operands like the ops of a BlockCache: immediates, branch targets and
+    // the address of the next instruction are read once, at translation.
+    // Everything else calls the handler picked by the decoder.
+    class ThreadedCode
+    {
+    public:
+        ThreadedCode() = default;
+
+        struct Exit
+        {
+            // Status of the last instruction executed
+            ExecutionStatus status;
+            std::int64_t executed;
+        };
+
+        // Runs from the PC of sys until an instruction stops the program,
+        // the PC leaves the code (or is odd), the code is written to or
+        // maxInstructions were executed.
+        // Every instruction is a step of history, unless it is null.
+        Exit run(System& sys, History* history, std::int64_t maxInstructions);
+
+        // Translates again every slot that may overlap [begin, end)
+        void invalidate(ConstExecutableMemoryView mem,
+                        std::int64_t begin,
+                        std::int64_t end);
+        void clear();
+
+    private:
+        struct Slot;
+
+        using SlotFn = ExecutionStatus (*)(System&, const Slot&);
+
+        struct Slot
+        {
+            SlotFn run;
+
+            // Handler used when the instruction has no bound form
+            DecodedInstructionFn exec;
+            InstructionData data;
+
+            // Immediate source operand or branch target, read at
+            // translation if resolved
+            std::int32_t value;
+            bool resolved;
+
+            // Address of the next instruction
+            std::uint32_t next;
+        };
+
+        void translate(ConstExecutableMemoryView mem,
+                       std::int64_t first,
+                       std::int64_t last);
+
+        template <bool Journal>
+        Exit runSlots(System& sys,
+                      History* history,
+                      std::int64_t maxInstructions);
+
+        std::vector<Slot> m_slots;
+    };
+} // namespace momiji
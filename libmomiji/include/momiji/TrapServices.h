@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace momiji
+{
+    struct System;
+
+    // The text tasks of the EASy68k trap #15, served by the host instead of
+    // a guest handler. The task is in d0.b, its operands in d1, d2 and a1.
+    // What the program prints is kept until flushed in batches, what it
+    // reads comes from input given by the host.
+    class TrapServices
+    {
+    public:
+        using Sink = std::function<void(std::string_view)>;
+
+        enum class Result : std::uint8_t
+        {
+            Served,  // The program carries on after the trap
+            Halt,    // Task 9, the PC is left where hcf leaves it
+            Unknown, // Not a task served here, the trap is left pending
+        };
+
+        // Bytes of output kept before flushing them on their own
+        static constexpr std::size_t batchSize = 64 * 1024;
+
+        // Prints to stdout
+        TrapServices();
+        TrapServices(const TrapServices&) = delete;
+        TrapServices(TrapServices&&)      = default;
+
+        TrapServices& operator=(const TrapServices&) = delete;
+        TrapServices& operator=(TrapServices&&) = default;
+
+        // Flushes what's left
+        ~TrapServices();
+
+        // Where the output goes from now on, what was kept is flushed first
+        void setOutput(Sink sink);
+
+        // Appended to what the program still has to read
+        void provideInput(std::string_view input);
+
+        // Returns false if path can't be read
+        bool provideInputFile(const std::string& path);
+
+        // Gives the output kept so far to the sink
+        void flush();
+
+        // Whether the trap pending in sys is a trap #15 of a task served here
+        [[nodiscard]] static bool serves(const System& sys);
+
+        // Runs the task of the pending trap #15 and clears the trap.
+        // Guest memory is accessed through the bus, a fault leaves its
+        // trap pending instead.
+        Result run(System& sys);
+
+        // Input serving the task of the last run the same way: what it read,
+        // then the next byte if there was one, which task 7 checks for.
+        // Empty for tasks that don't read.
+        [[nodiscard]] const std::string& replayInput() const noexcept;
+
+    private:
+        void print(std::string_view text);
+
+        // The line the program reads next, without its newline
+        std::string readLine();
+
+        // Reads a line, gives the decimal number it starts with
+        std::int32_t readNumber();
+
+        Sink m_sink;
+        std::string m_output;
+        std::string m_input;
+        std::size_t m_inputPos { 0 };
+        std::string m_replayInput;
+    };
+} // namespace momiji
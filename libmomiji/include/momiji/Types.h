@@ -55,6 +55,10 @@ namespace momiji
 
         ReturnSubroutine, // rts
 
+        Trap,            // trap
+        ReturnException, // rte
+        MoveControl,     // movec
+
         ArithmeticShiftLeft,  // asl
         ArithmeticShiftRight, // asr
         LogicalShiftLeft,     // lsl
@@ -0,0 +1,162 @@
+#include <momiji/AotRuntime.h>
+
+#include <momiji/Exceptions.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace momiji::aot
+{
+    System load(gsl::span<const std::uint8_t> binary, std::int64_t stackSize)
+    {
+        EmulatorSettings settings;
+        settings.retainStates = EmulatorSettings::RetainStates::Never;
+        settings.stackSize    = stackSize;
+
+        ExecutableMemory mem { asl::ssize(binary) };
+        mem.underlying().write(0, binary);
+
+        Emulator emu { settings };
+        emu.newState(std::move(mem));
+
+        // The devices of the emulator go away with it
+        auto sys    = emu.getStates().back();
+        sys.devices = &noDevices;
+
+        return sys;
+    }
+
+    Runtime::Runtime(System& sys, RunLimits limits)
+        : m_sys(&sys)
+        , m_codeBegin(std::uint32_t(sys.mem.executableMarker.begin))
+        , m_maxInstructions(limits.maxInstructions < 0
+                                ? std::numeric_limits<std::int64_t>::max()
+                                : limits.maxInstructions)
+    {
+        const ConstExecutableMemoryView mem = sys.mem;
+
+        const auto codeSize =
+            mem.executableMarker.end - mem.executableMarker.begin;
+
+        m_instructions.resize(std::size_t((codeSize + 1) / 2));
+
+        for (std::size_t i = 0; i < m_instructions.size(); ++i)
+        {
+            m_instructions[i] = momiji::decode(
+                mem, mem.executableMarker.begin + std::int64_t(i * 2));
+        }
+    }
+
+    bool Runtime::interpret(gsl::span<const std::uint32_t> entries)
+    {
+        if (m_sys->trap.has_value() && stop(ExecutionStatus::Trap))
+        {
+            return false;
+        }
+
+        const ConstExecutableMemoryView mem = m_sys->mem;
+
+        while (true)
+        {
+            const auto pc = std::int64_t(m_sys->cpu.programCounter.raw());
+
+            if (pc < mem.executableMarker.begin ||
+                pc >= mem.executableMarker.end)
+            {
+                m_reason = StopReason::OutOfRange;
+                return false;
+            }
+
+            if (!m_stale && std::binary_search(entries.begin(),
+                                               entries.end(),
+                                               std::uint32_t(pc)))
+            {
+                return true;
+            }
+
+            if (m_executed == m_maxInstructions)
+            {
+                m_reason = StopReason::InstructionLimit;
+                return false;
+            }
+
+            const auto& instr = m_decodeCache.fetch(mem, pc);
+            const auto status = instr.exec(*m_sys, instr.data);
+
+            m_sys->cycles += cyclesOf(instr.data, status);
+            ++m_executed;
+
+            if (m_sys->mem.codeWriteMarker.begin >= 0)
+            {
+                codeWritten();
+            }
+
+            if (status != ExecutionStatus::Continue &&
+                status != ExecutionStatus::BranchTaken && stop(status))
+            {
+                return false;
+            }
+        }
+    }
+
+    RunResult Runtime::finish()
+    {
+        // Only the code was written to, nothing is translated anymore
+        if (!m_reason.has_value())
+        {
+            interpret({});
+        }
+
+        return { m_reason.value_or(StopReason::OutOfRange), m_executed };
+    }
+
+    void Runtime::codeWritten()
+    {
+        auto& written = m_sys->mem.codeWriteMarker;
+
+        const auto codeBegin = m_sys->mem.executableMarker.begin;
+        m_decodeCache.invalidate(written.begin - codeBegin,
+                                 written.end - codeBegin);
+
+        written = {};
+        m_stale = true;
+    }
+
+    bool Runtime::stop(ExecutionStatus status)
+    {
+        switch (status)
+        {
+        case ExecutionStatus::Continue:
+        case ExecutionStatus::BranchTaken:
+            break;
+
+        case ExecutionStatus::Breakpoint:
+            m_reason = StopReason::Breakpoint;
+            break;
+
+        case ExecutionStatus::Trap:
+            if (raiseException(*m_sys))
+            {
+                if (m_sys->mem.codeWriteMarker.begin >= 0)
+                {
+                    codeWritten();
+                }
+
+                return false;
+            }
+
+            m_reason = StopReason::Trap;
+            break;
+
+        case ExecutionStatus::Halt:
+            m_reason = StopReason::Halt;
+            break;
+
+        case ExecutionStatus::Returned:
+            m_reason = StopReason::Returned;
+            break;
+        }
+
+        return true;
+    }
+} // namespace momiji::aot
@@ -0,0 +1,641 @@
+#include <momiji/BlockCache.h>
+
+#include "Instructions/Bound.h"
+#include "Instructions/Utils.h"
+
+#include <algorithm>
+
+namespace momiji
+{
+    namespace
+    {
+        // Opcode word plus two long extension words
+        constexpr std::int64_t maxInstructionSize = 10;
+
+        // Long straight runs of code are split, so a block never costs much
+        // to translate again
+        constexpr std::size_t maxBlockSize = 64;
+
+        // Runs of a block before it is compiled to host code
+        constexpr std::int32_t nativeThreshold = 16;
+
+        bool endsBlock(InstructionType type)
+        {
+            switch (type)
+            {
+            case InstructionType::Branch:
+            case InstructionType::BranchSubroutine:
+            case InstructionType::BranchCondition:
+            case InstructionType::Jmp:
+            case InstructionType::JmpSubroutine:
+            case InstructionType::ReturnSubroutine:
+            case InstructionType::Trap:
+            case InstructionType::ReturnException:
+            case InstructionType::HaltCatchFire:
+            case InstructionType::Breakpoint:
+            case InstructionType::Illegal:
+                return true;
+
+            default:
+                return false;
+            }
+        }
+
+        // Fused pairs. The flags are still recorded since the bcc leaves
+        // them as they are, but the branch is decided on the operands.
+
+        template <typename Op>
+        const Op& secondOp(const Op& op)
+        {
+            // The ops of a block are contiguous
+            return *(&op + 1);
+        }
+
+        // Same as branchConditionHolds after dst was compared to src, both
+        // sign-extended from the size of the comparison
+        bool compareHolds(std::uint8_t condition,
+                          std::int32_t dst,
+                          std::int32_t src)
+        {
+            switch (condition)
+            {
+            // NE
+            case 0b0110:
+                return dst != src;
+
+            // EQ
+            case 0b0111:
+                return dst == src;
+
+            // GE
+            case 0b1100:
+                return dst >= src;
+
+            // LT
+            case 0b1101:
+                return dst < src;
+
+            // GT
+            case 0b1110:
+                return dst > src;
+
+            // LE
+            case 0b1111:
+                return dst <= src;
+            }
+
+            return false;
+        }
+
+        template <typename Op>
+        ExecutionStatus branchIf(System& sys,
+                                 const Op& branch,
+                                 std::int32_t dst,
+                                 std::int32_t src)
+        {
+            const auto condition = utils::to_val(branch.data.operandType[0]);
+
+            if (compareHolds(condition, dst, src))
+            {
+                sys.cpu.programCounter = std::uint32_t(branch.value);
+
+                return ExecutionStatus::BranchTaken;
+            }
+
+            sys.cpu.programCounter = branch.next;
+
+            return ExecutionStatus::Continue;
+        }
+
+        // instr::cmp from a register or instr::cmpi, then instr::bcc
+        template <typename To, typename Op>
+        ExecutionStatus runCompareBranch(System& sys, const Op& op)
+        {
+            const auto& data = op.data;
+
+            const auto srcnum = utils::to_val(data.addressingMode[0]);
+            const auto dstnum = utils::to_val(data.addressingMode[1]);
+
+            std::int32_t src = op.value;
+
+            if (!op.resolved)
+            {
+                src = data.operandType[0] == OperandType::DataRegister
+                          ? asl::saccess(sys.cpu.dataRegisters, srcnum).raw()
+                          : asl::saccess(sys.cpu.addressRegisters, srcnum)
+                                .raw();
+            }
+
+            src = To(src);
+
+            const std::int32_t dst =
+                To(asl::saccess(sys.cpu.dataRegisters, dstnum).raw());
+            const auto res =
+                std::int32_t(std::uint32_t(dst) - std::uint32_t(src));
+
+            sys.cpu.statusRegister.setCompare(data.size, src, dst, res);
+
+            return branchIf(sys, secondOp(op), dst, src);
+        }
+
+        // instr::tst of a data register, then instr::bcc
+        template <typename To, typename Op>
+        ExecutionStatus runTestBranch(System& sys, const Op& op)
+        {
+            const auto regnum = utils::to_val(op.data.addressingMode[0]);
+            const auto val = asl::saccess(sys.cpu.dataRegisters, regnum).raw();
+
+            sys.cpu.statusRegister.setLogical(op.data.size, val);
+
+            // A tst is a comparison to 0 which never overflows
+            return branchIf(sys, secondOp(op), To(val), 0);
+        }
+
+        // instr::move from a register or an immediate to a data register,
+        // then instr::tst of it
+        template <typename Op>
+        ExecutionStatus runMoveTest(System& sys, const Op& op)
+        {
+            // The bound move can't fault, and sets the same flags as the
+            // tst would
+            op.run(sys, op);
+
+            sys.cpu.programCounter = secondOp(op).next;
+
+            return ExecutionStatus::Continue;
+        }
+
+        template <typename Op>
+        using OpFn = ExecutionStatus (*)(System&, const Op&);
+
+        // Cycles of the first executed ops, the last of them returned status
+        template <typename Op>
+        std::int64_t cyclesOfOps(const std::vector<Op>& ops,
+                                 std::int64_t executed,
+                                 ExecutionStatus status)
+        {
+            if (executed <= 0)
+            {
+                return 0;
+            }
+
+            std::int64_t cycles = 0;
+
+            for (std::int64_t i = 0; i < executed - 1; ++i)
+            {
+                cycles += ops[std::size_t(i)].data.cycles;
+            }
+
+            const auto& last = ops[std::size_t(executed - 1)];
+
+            return cycles + cyclesOf(last.data, status);
+        }
+
+        template <typename Op>
+        OpFn<Op> compareBranchFn(std::int8_t size)
+        {
+            switch (size)
+            {
+            case 1:
+                return &runCompareBranch<std::int8_t, Op>;
+
+            case 2:
+                return &runCompareBranch<std::int16_t, Op>;
+
+            default:
+                return &runCompareBranch<std::int32_t, Op>;
+            }
+        }
+
+        template <typename Op>
+        OpFn<Op> testBranchFn(std::int8_t size)
+        {
+            switch (size)
+            {
+            case 1:
+                return &runTestBranch<std::int8_t, Op>;
+
+            case 2:
+                return &runTestBranch<std::int16_t, Op>;
+
+            default:
+                return &runTestBranch<std::int32_t, Op>;
+            }
+        }
+    } // namespace
+
+    ThreadedCode::Exit BlockCache::run(System& sys,
+                                       History* history,
+                                       std::int64_t maxInstructions)
+    {
+        const auto codeBegin  = sys.mem.executableMarker.begin;
+        const auto codeSize   = sys.mem.executableMarker.end - codeBegin;
+        const auto entryCount = std::size_t((codeSize + 1) / 2);
+
+        if (m_entries.size() != entryCount || m_codeBegin != codeBegin)
+        {
+            clear();
+            m_entries.resize(entryCount);
+            m_codeBegin = codeBegin;
+        }
+
+        if (history != nullptr)
+        {
+            return runBlocks<true>(sys, history, maxInstructions);
+        }
+
+        return runBlocks<false>(sys, history, maxInstructions);
+    }
+
+    template <bool Journal>
+    ThreadedCode::Exit BlockCache::runBlocks(System& sys,
+                                             History* history,
+                                             std::int64_t maxInstructions)
+    {
+        auto status           = ExecutionStatus::Continue;
+        std::int64_t executed = 0;
+
+        auto* block = findBlock(sys);
+
+        while (block != nullptr)
+        {
+            // Events are run between blocks, by the emulator
+            if (sys.cycles >= sys.nextEventCycle)
+            {
+                return { status, executed };
+            }
+
+            if constexpr (!Journal)
+            {
+                if (m_idiomsEnabled && block->idiom.has_value())
+                {
+                    executed +=
+                        runIdiom(sys, *block, maxInstructions - executed);
+
+                    if (sys.mem.codeWriteMarker.begin >= 0)
+                    {
+                        return { ExecutionStatus::BranchTaken, executed };
+                    }
+
+                    // Otherwise the iterations left are run as usual
+                    if (sys.cpu.programCounter.raw() == block->idiom->exit)
+                    {
+                        status = ExecutionStatus::BranchTaken;
+                        block  = nextBlock(sys, *block);
+                        continue;
+                    }
+                }
+
+                if (m_nativeEnabled && block->native == nullptr &&
+                    block->runs < nativeThreshold &&
+                    ++block->runs == nativeThreshold)
+                {
+                    compile(sys, *block);
+                }
+
+                // Host code only stops early when an instruction needs it
+                // to, so it runs only with room for the whole block
+                if (m_nativeEnabled && block->native != nullptr &&
+                    maxInstructions - executed >=
+                        std::int64_t(block->ops.size()))
+                {
+                    const auto exit = block->native(&sys);
+
+                    status = ExecutionStatus(exit & 0xFF);
+                    executed += std::int64_t(exit >> 8);
+                    sys.cycles += cyclesOfOps(
+                        block->ops, std::int64_t(exit >> 8), status);
+
+                    if (sys.mem.codeWriteMarker.begin >= 0 ||
+                        (status != ExecutionStatus::Continue &&
+                         status != ExecutionStatus::BranchTaken))
+                    {
+                        return { status, executed };
+                    }
+
+                    block = nextBlock(sys, *block);
+                    continue;
+                }
+            }
+
+            const auto& ops = block->ops;
+
+            for (std::size_t i = 0; i < ops.size(); ++i)
+            {
+                const auto& op = ops[i];
+
+                // Every op which carries on leaves the PC at instructionSize
+                Expects(sys.cpu.programCounter.raw() == op.pc,
+                        "The PC left the block without a branch");
+
+                if (executed == maxInstructions)
+                {
+                    return { status, executed };
+                }
+
+                // Both instructions of a pair have to fit in the limit
+                const bool fused = !Journal && op.fused != nullptr &&
+                                   maxInstructions - executed >= 2;
+
+                if constexpr (Journal)
+                {
+                    history->beginStep(sys);
+                }
+
+                status = fused ? op.fused(sys, op) : op.run(sys, op);
+                sys.cycles += fused ? op.data.cycles +
+                                          cyclesOf(ops[i + 1].data, status)
+                                    : cyclesOf(op.data, status);
+
+                if constexpr (Journal)
+                {
+                    history->endStep(sys);
+                }
+
+                if (fused)
+                {
+                    ++m_fusionHits[std::size_t(op.pair)];
+                    ++executed;
+                    ++i;
+                }
+
+                ++executed;
+
+                if (sys.mem.codeWriteMarker.begin >= 0 ||
+                    (status != ExecutionStatus::Continue &&
+                     status != ExecutionStatus::BranchTaken))
+                {
+                    return { status, executed };
+                }
+            }
+
+            block = nextBlock(sys, *block);
+        }
+
+        return { status, executed };
+    }
+
+    void BlockCache::invalidate(std::int64_t begin, std::int64_t end)
+    {
+        begin += m_codeBegin;
+        end += m_codeBegin;
+
+        const auto stale = [&](const std::unique_ptr<Block>& block) {
+            return block->begin < end && begin < block->end;
+        };
+
+        if (std::none_of(m_blocks.begin(), m_blocks.end(), stale))
+        {
+            return;
+        }
+
+        for (const auto& block : m_blocks)
+        {
+            if (stale(block))
+            {
+                m_entries[std::size_t((block->begin - m_codeBegin) / 2)] =
+                    nullptr;
+            }
+        }
+
+        m_blocks.erase(
+            std::remove_if(m_blocks.begin(), m_blocks.end(), stale),
+            m_blocks.end());
+
+        // Links are made again the next time they're followed
+        for (const auto& block : m_blocks)
+        {
+            for (auto& link : block->successors)
+            {
+                link.block = nullptr;
+            }
+        }
+    }
+
+    void BlockCache::clear()
+    {
+        m_blocks.clear();
+        m_entries.clear();
+        m_nativeCode.clear();
+    }
+
+    void BlockCache::enableNativeCode(bool enabled) noexcept
+    {
+        m_nativeEnabled = enabled;
+    }
+
+    std::int64_t BlockCache::fusionHits(FusedPair pair) const noexcept
+    {
+        return m_fusionHits[std::size_t(pair)];
+    }
+
+    void BlockCache::enableMemoryIdioms(bool enabled) noexcept
+    {
+        m_idiomsEnabled = enabled;
+    }
+
+    std::int64_t BlockCache::blockCount() const noexcept
+    {
+        return std::int64_t(m_blocks.size());
+    }
+
+    std::int64_t BlockCache::nativeBlockCount() const noexcept
+    {
+        return std::int64_t(
+            std::count_if(m_blocks.begin(), m_blocks.end(), [](auto& block) {
+                return block->native != nullptr;
+            }));
+    }
+
+    BlockCache::Block* BlockCache::findBlock(System& sys)
+    {
+        const auto pc     = std::int64_t(sys.cpu.programCounter.raw());
+        const auto offset = pc - m_codeBegin;
+
+        if ((pc & 0b1) != 0 || offset < 0 ||
+            offset / 2 >= std::int64_t(m_entries.size()))
+        {
+            return nullptr;
+        }
+
+        auto& entry = m_entries[std::size_t(offset / 2)];
+
+        if (entry == nullptr)
+        {
+            entry = translate(sys, pc);
+        }
+
+        return entry;
+    }
+
+    BlockCache::Block* BlockCache::nextBlock(System& sys, Block& block)
+    {
+        const auto pc = std::int64_t(sys.cpu.programCounter.raw());
+
+        for (const auto& link : block.successors)
+        {
+            if (link.pc == pc && link.block != nullptr)
+            {
+                return link.block;
+            }
+        }
+
+        auto* next = findBlock(sys);
+
+        if (next == nullptr)
+        {
+            return nullptr;
+        }
+
+        // Branches known ahead of time already have their own link, any
+        // other destination takes a free one or the last one
+        const auto matches = [pc](const Link& link) { return link.pc == pc; };
+        const auto isFree  = [](const Link& link) { return link.pc < 0; };
+
+        auto& successors = block.successors;
+        auto link = std::find_if(successors.begin(), successors.end(), matches);
+
+        if (link == successors.end())
+        {
+            link = std::find_if(successors.begin(), successors.end(), isFree);
+        }
+
+        if (link == successors.end())
+        {
+            link = std::prev(successors.end());
+        }
+
+        link->pc    = pc;
+        link->block = next;
+
+        return next;
+    }
+
+    BlockCache::Block* BlockCache::translate(System& sys, std::int64_t pc)
+    {
+        const auto codeEnd = sys.mem.executableMarker.end;
+        const auto mem     = make_memory_view(sys);
+
+        auto block   = std::make_unique<Block>();
+        block->begin = pc;
+
+        while (pc < codeEnd && block->ops.size() < maxBlockSize)
+        {
+            const auto instr = momiji::decode(mem, pc);
+            const auto& data = instr.data;
+            const auto next  = pc + momiji::instructionSize(instr);
+
+            Op op { nullptr,
+                    instr.exec,
+                    data,
+                    instr.type,
+                    std::uint32_t(pc),
+                    0,
+                    false,
+                    std::uint32_t(next) };
+
+            instr::bind(op, mem, pc, instr);
+
+            const bool jumps = instr.type == InstructionType::Branch ||
+                               instr.type == InstructionType::BranchCondition ||
+                               instr.type == InstructionType::Jmp;
+
+            // Branches known ahead of time have their own links
+            if (jumps && op.resolved)
+            {
+                block->successors[0].pc = std::uint32_t(op.value);
+
+                if (instr.type == InstructionType::BranchCondition)
+                {
+                    block->successors[1].pc = next;
+                }
+            }
+
+            block->ops.push_back(op);
+            block->end = pc + maxInstructionSize;
+
+            if (endsBlock(instr.type))
+            {
+                block->idiom = findIdiom(mem, *block);
+
+                fuse(*block);
+                m_blocks.push_back(std::move(block));
+                return m_blocks.back().get();
+            }
+
+            pc = next;
+        }
+
+        // Split by size or by the end of the code, it falls through
+        block->successors[0].pc = pc;
+
+        fuse(*block);
+        m_blocks.push_back(std::move(block));
+
+        return m_blocks.back().get();
+    }
+
+    void BlockCache::fuse(Block& block)
+    {
+        auto& ops = block.ops;
+
+        const auto isDataRegister = [](const Op& op, std::size_t i) {
+            return op.data.operandType[i] == OperandType::DataRegister;
+        };
+
+        const auto isRegister = [&](const Op& op, std::size_t i) {
+            return isDataRegister(op, i) ||
+                   op.data.operandType[i] == OperandType::AddressRegister;
+        };
+
+        for (std::size_t i = 0; i + 1 < ops.size(); ++i)
+        {
+            auto& op           = ops[i];
+            const auto& second = ops[i + 1];
+            const auto size    = op.data.size;
+
+            const bool branches =
+                second.type == InstructionType::BranchCondition &&
+                second.resolved;
+
+            if (branches && op.type == InstructionType::Compare &&
+                isRegister(op, 0) && isDataRegister(op, 1))
+            {
+                op.fused = compareBranchFn<Op>(size);
+                op.pair  = FusedPair::CompareBranch;
+            }
+            else if (branches && op.type == InstructionType::CompareI &&
+                     op.resolved && isDataRegister(op, 1))
+            {
+                op.fused = compareBranchFn<Op>(size);
+                op.pair  = FusedPair::CompareBranch;
+            }
+            else if (branches && op.type == InstructionType::Tst &&
+                     isDataRegister(op, 0))
+            {
+                op.fused = testBranchFn<Op>(size);
+                op.pair  = FusedPair::TestBranch;
+            }
+            // A move from memory can fault before the tst, only moves with
+            // a bound form are paired
+            else if (op.type == InstructionType::Move &&
+                     op.run != &instr::runHandler<Op> &&
+                     second.type == InstructionType::Tst &&
+                     isDataRegister(second, 0) &&
+                     second.data.addressingMode[0] ==
+                         op.data.addressingMode[1] &&
+                     second.data.size == size)
+            {
+                op.fused = &runMoveTest<Op>;
+                op.pair  = FusedPair::MoveTest;
+            }
+            else
+            {
+                continue;
+            }
+
+            // The second op of a pair doesn't start one
+            ++i;
+        }
+    }
+} // namespace momiji
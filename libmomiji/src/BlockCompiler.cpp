@@ -0,0 +1,1319 @@
+#include <momiji/BlockCache.h>
+
+#include "Instructions/Utils.h"
+#include "Instructions/bcc.h"
+
+#include <asl/detect_features>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <optional>
+
+// Host code is only generated for x86-64, other hosts keep running every
+// block through its bound handlers
+#if defined(__x86_64__) || defined(_M_X64)
+    #define MOMIJI_X86_64
+#endif
+
+namespace momiji
+{
+#ifdef MOMIJI_X86_64
+    namespace
+    {
+        enum Reg : std::uint8_t
+        {
+            rax,
+            rcx,
+            rdx,
+            rbx,
+            rsp,
+            rbp,
+            rsi,
+            rdi,
+            r8,
+            r9,
+            r10,
+            r11,
+            r12,
+            r13,
+            r14,
+            r15,
+        };
+
+        // Condition codes of jcc and setcc
+        enum Cond : std::uint8_t
+        {
+            Above        = 0x7,
+            Equal        = 0x4,
+            NotEqual     = 0x5,
+            Less         = 0xC,
+            GreaterEqual = 0xD,
+            LessEqual    = 0xE,
+            Greater      = 0xF,
+        };
+
+        // Opcodes of the two register forms of the integer instructions,
+        // 32 and 16 bits. The byte form is always one less.
+        enum Alu : std::uint8_t
+        {
+            AddOp  = 0x01,
+            OrOp   = 0x09,
+            AndOp  = 0x21,
+            SubOp  = 0x29,
+            XorOp  = 0x31,
+            CmpOp  = 0x39,
+            TestOp = 0x85,
+            MovOp  = 0x89,
+        };
+
+        // The same instructions with an immediate, as the reg field
+        enum AluImm : std::uint8_t
+        {
+            AddImm = 0,
+            OrImm  = 1,
+            AndImm = 4,
+            SubImm = 5,
+            CmpImm = 7,
+        };
+
+#ifdef ASL_WIN32
+        constexpr Reg firstArgument  = rcx;
+        constexpr Reg secondArgument = rdx;
+
+        // Shadow space for the callee, plus alignment
+        constexpr std::int8_t frameSize = 40;
+#else
+        constexpr Reg firstArgument  = rdi;
+        constexpr Reg secondArgument = rsi;
+
+        constexpr std::int8_t frameSize = 8;
+#endif
+
+        // Guest data registers live in these inside a block, they are
+        // preserved by the handlers called for everything else
+        constexpr std::array<Reg, 5> cacheRegisters { rbx, r12, r13, r14, r15 };
+
+        class Assembler
+        {
+        public:
+            [[nodiscard]] const std::vector<std::uint8_t>& code() const
+            {
+                return m_code;
+            }
+
+            [[nodiscard]] std::size_t position() const
+            {
+                return m_code.size();
+            }
+
+            // op dst, src
+            void alu(Alu opcode, Reg dst, Reg src, std::int16_t size = 4)
+            {
+                prefix(size, src, dst);
+                const auto code = std::uint8_t(opcode);
+                byte(size == 1 ? std::uint8_t(code - 1) : code);
+                direct(src, dst);
+            }
+
+            // op dst, imm
+            void
+            alu(AluImm ext, Reg dst, std::int32_t imm, std::int16_t size = 4)
+            {
+                prefix(size, rax, dst);
+                byte(size == 1 ? 0x80 : 0x81);
+                direct(ext, dst);
+                immediate(imm, size);
+            }
+
+            void mov(Reg dst, std::int32_t imm, std::int16_t size = 4)
+            {
+                prefix(size, rax, dst);
+                byte(std::uint8_t((size == 1 ? 0xB0 : 0xB8) + (dst & 7)));
+                immediate(imm, size);
+            }
+
+            // mov dst, dword [rbp + disp]
+            void load(Reg dst, std::int32_t disp)
+            {
+                prefix(4, dst, rbp);
+                byte(0x8B);
+                memory(dst, disp);
+            }
+
+            // movzx dst, byte [rbp + disp]
+            void loadByte(Reg dst, std::int32_t disp)
+            {
+                prefix(4, dst, rbp);
+                byte(0x0F);
+                byte(0xB6);
+                memory(dst, disp);
+            }
+
+            // mov dword [rbp + disp], src
+            void store(std::int32_t disp, Reg src)
+            {
+                prefix(4, src, rbp);
+                byte(0x89);
+                memory(src, disp);
+            }
+
+            // mov byte [rbp + disp], src
+            void storeByte(std::int32_t disp, Reg src)
+            {
+                prefix(1, src, rbp);
+                byte(0x88);
+                memory(src, disp);
+            }
+
+            // mov dword [rbp + disp], imm
+            void store(std::int32_t disp, std::int32_t imm)
+            {
+                byte(0xC7);
+                memory(0, disp);
+                immediate(imm, 4);
+            }
+
+            // mov byte [rbp + disp], imm
+            void storeByte(std::int32_t disp, std::uint8_t imm)
+            {
+                byte(0xC6);
+                memory(0, disp);
+                byte(imm);
+            }
+
+            // cmp dword or qword [rbp + disp], imm
+            void compare(std::int32_t disp, std::int32_t imm, bool wide)
+            {
+                if (wide)
+                {
+                    byte(0x48);
+                }
+
+                byte(0x81);
+                memory(CmpImm, disp);
+                immediate(imm, 4);
+            }
+
+            void set(Cond cond, Reg dst)
+            {
+                prefix(1, rax, dst);
+                byte(0x0F);
+                byte(std::uint8_t(0x90 | cond));
+                direct(0, dst);
+            }
+
+            // movzx dst, src (byte)
+            void zeroExtend(Reg dst, Reg src)
+            {
+                prefix(1, dst, src);
+                byte(0x0F);
+                byte(0xB6);
+                direct(dst, src);
+            }
+
+            // movsx dst, src (word)
+            void signExtend(Reg dst, Reg src)
+            {
+                prefix(4, dst, src);
+                byte(0x0F);
+                byte(0xBF);
+                direct(dst, src);
+            }
+
+            void imul(Reg dst, Reg src)
+            {
+                prefix(4, dst, src);
+                byte(0x0F);
+                byte(0xAF);
+                direct(dst, src);
+            }
+
+            void shl(Reg dst, std::uint8_t count)
+            {
+                shift(4, dst, count);
+            }
+
+            void shr(Reg dst, std::uint8_t count)
+            {
+                shift(5, dst, count);
+            }
+
+            void sar(Reg dst, std::uint8_t count)
+            {
+                shift(7, dst, count);
+            }
+
+            // shl dst, cl
+            void shl(Reg dst)
+            {
+                shiftByCount(4, dst);
+            }
+
+            // sar dst, cl
+            void sar(Reg dst)
+            {
+                shiftByCount(7, dst);
+            }
+
+            // div or idiv of edx:eax, or of rdx:rax when wide
+            void divide(Reg src, bool isSigned, bool wide)
+            {
+                if (wide)
+                {
+                    byte(std::uint8_t(0x48 | (src >> 3)));
+                }
+                else
+                {
+                    prefix(4, rax, src);
+                }
+
+                byte(0xF7);
+                direct(isSigned ? 7 : 6, src);
+            }
+
+            // movsxd dst, src
+            void signExtendLong(Reg dst, Reg src)
+            {
+                byte(std::uint8_t(0x48 | ((dst >> 3) << 2) | (src >> 3)));
+                byte(0x63);
+                direct(dst, src);
+            }
+
+            // Sign of rax into rdx
+            void cqo()
+            {
+                byte(0x48);
+                byte(0x99);
+            }
+
+            // 64 bits
+            void movq(Reg dst, Reg src)
+            {
+                byte(std::uint8_t(0x48 | ((src >> 3) << 2) | (dst >> 3)));
+                byte(0x89);
+                direct(src, dst);
+            }
+
+            void movq(Reg dst, std::uint64_t imm)
+            {
+                byte(std::uint8_t(0x48 | (dst >> 3)));
+                byte(std::uint8_t(0xB8 + (dst & 7)));
+
+                for (int i = 0; i < 8; ++i)
+                {
+                    byte(std::uint8_t(imm >> (i * 8)));
+                }
+            }
+
+            void push(Reg reg)
+            {
+                prefix(4, rax, reg);
+                byte(std::uint8_t(0x50 + (reg & 7)));
+            }
+
+            void pop(Reg reg)
+            {
+                prefix(4, rax, reg);
+                byte(std::uint8_t(0x58 + (reg & 7)));
+            }
+
+            // Negative to make room
+            void adjustStack(std::int8_t bytes)
+            {
+                byte(0x48);
+                byte(0x83);
+                direct(bytes < 0 ? SubImm : AddImm, rsp);
+                byte(std::uint8_t(bytes < 0 ? -bytes : bytes));
+            }
+
+            void call(Reg reg)
+            {
+                prefix(4, rax, reg);
+                byte(0xFF);
+                direct(2, reg);
+            }
+
+            void ret()
+            {
+                byte(0xC3);
+            }
+
+            // Both return the jump to give to bind
+            std::size_t jump(Cond cond)
+            {
+                byte(0x0F);
+                byte(std::uint8_t(0x80 | cond));
+                immediate(0, 4);
+
+                return position();
+            }
+
+            std::size_t jump()
+            {
+                byte(0xE9);
+                immediate(0, 4);
+
+                return position();
+            }
+
+            // The jump lands at the current position
+            void bind(std::size_t jump)
+            {
+                const auto rel = std::int32_t(position() - jump);
+
+                for (std::size_t i = 0; i < 4; ++i)
+                {
+                    m_code[jump - 4 + i] = std::uint8_t(rel >> (i * 8));
+                }
+            }
+
+        private:
+            void byte(std::uint8_t val)
+            {
+                m_code.push_back(val);
+            }
+
+            void immediate(std::int32_t imm, std::int16_t size)
+            {
+                for (std::int16_t i = 0; i < size; ++i)
+                {
+                    byte(std::uint8_t(std::uint32_t(imm) >> (i * 8)));
+                }
+            }
+
+            // Operand size prefix and REX, always present for bytes so the
+            // low byte of every register can be used
+            void prefix(std::int16_t size, std::uint8_t reg, std::uint8_t rm)
+            {
+                if (size == 2)
+                {
+                    byte(0x66);
+                }
+
+                const auto rex =
+                    std::uint8_t(0x40 | ((reg >> 3) << 2) | (rm >> 3));
+
+                if (rex != 0x40 || size == 1)
+                {
+                    byte(rex);
+                }
+            }
+
+            void direct(std::uint8_t reg, std::uint8_t rm)
+            {
+                byte(std::uint8_t(0xC0 | ((reg & 7) << 3) | (rm & 7)));
+            }
+
+            // [rbp + disp32]
+            void memory(std::uint8_t reg, std::int32_t disp)
+            {
+                byte(std::uint8_t(0x80 | ((reg & 7) << 3) | rbp));
+                immediate(disp, 4);
+            }
+
+            void shift(std::uint8_t ext, Reg dst, std::uint8_t count)
+            {
+                prefix(4, rax, dst);
+                byte(0xC1);
+                direct(ext, dst);
+                byte(count);
+            }
+
+            void shiftByCount(std::uint8_t ext, Reg dst)
+            {
+                prefix(4, rax, dst);
+                byte(0xD3);
+                direct(ext, dst);
+            }
+
+            std::vector<std::uint8_t> m_code;
+        };
+
+        // What a supported instruction does, read from its data once
+        struct NativeForm
+        {
+            InstructionType type;
+            std::int16_t size;
+
+            bool immediate;
+            std::int32_t value;
+
+            // Data registers, -1 when unused
+            std::int8_t src;
+            std::int8_t dst;
+        };
+
+        // Where a FlagsSource of the status register is
+        struct FlagsLayout
+        {
+            std::int32_t src;
+            std::int32_t dst;
+            std::int32_t result;
+            std::int32_t op;
+            std::int32_t size;
+        };
+
+        // The flags set last in the block, known when generating the code
+        struct KnownFlags
+        {
+            FlagsOp op;
+            std::int16_t size;
+        };
+
+        // For branches on flags set outside of the block
+        std::uint64_t conditionHolds(const System* sys, std::uint64_t condition)
+        {
+            return instr::branchConditionHolds(sys->cpu.statusRegister,
+                                               std::uint8_t(condition))
+                       ? 1
+                       : 0;
+        }
+
+        // The same condition on the host flags, after the operation the
+        // guest flags come from
+        std::optional<Cond> hostCondition(std::uint8_t condition)
+        {
+            switch (condition)
+            {
+            case 0b0110:
+                return NotEqual;
+
+            case 0b0111:
+                return Equal;
+
+            case 0b1100:
+                return GreaterEqual;
+
+            case 0b1101:
+                return Less;
+
+            case 0b1110:
+                return Greater;
+
+            case 0b1111:
+                return LessEqual;
+
+            default:
+                return std::nullopt;
+            }
+        }
+
+        class Compiler
+        {
+        public:
+            explicit Compiler(System& sys)
+            {
+                const auto offset = [&sys](const void* member) {
+                    return std::int32_t(static_cast<const char*>(member) -
+                                        reinterpret_cast<const char*>(&sys));
+                };
+
+                const auto layout = [&offset](const FlagsSource& source) {
+                    return FlagsLayout { offset(&source.src),
+                                         offset(&source.dst),
+                                         offset(&source.result),
+                                         offset(&source.op),
+                                         offset(&source.size) };
+                };
+
+                m_programCounter = offset(sys.cpu.programCounter.ptr());
+                m_codes          = layout(sys.cpu.statusRegister.codes);
+                m_extendSource = layout(sys.cpu.statusRegister.extendSource);
+                m_codeWriteBegin = offset(&sys.mem.codeWriteMarker.begin);
+
+                for (std::size_t i = 0; i < m_dataRegisters.size(); ++i)
+                {
+                    m_dataRegisters[i] =
+                        offset(sys.cpu.dataRegisters[i].ptr());
+                }
+            }
+
+            // Keeps the most used guest registers in host registers
+            void cache(const std::array<std::int32_t, 8>& uses)
+            {
+                std::array<std::int8_t, 8> order {};
+
+                for (std::size_t i = 0; i < order.size(); ++i)
+                {
+                    order[i] = std::int8_t(i);
+                }
+
+                std::stable_sort(
+                    order.begin(), order.end(), [&](auto lhs, auto rhs) {
+                        return uses[std::size_t(lhs)] > uses[std::size_t(rhs)];
+                    });
+
+                m_hosts.fill(-1);
+
+                for (std::size_t i = 0; i < cacheRegisters.size(); ++i)
+                {
+                    const auto guest = std::size_t(order[i]);
+
+                    if (uses[guest] > 0)
+                    {
+                        m_hosts[guest] = std::int8_t(cacheRegisters[i]);
+                    }
+                }
+            }
+
+            [[nodiscard]] bool cached(const NativeForm& form) const
+            {
+                const auto isCached = [this](std::int8_t guest) {
+                    return guest < 0 || m_hosts[std::size_t(guest)] >= 0;
+                };
+
+                return isCached(form.src) && isCached(form.dst);
+            }
+
+            void prologue()
+            {
+                m_as.push(rbp);
+                m_as.push(rbx);
+                m_as.push(r12);
+                m_as.push(r13);
+                m_as.push(r14);
+                m_as.push(r15);
+                m_as.adjustStack(-frameSize);
+                m_as.movq(rbp, firstArgument);
+
+                reload();
+            }
+
+            // Host code of the block, once every op was emitted
+            const std::vector<std::uint8_t>& finish()
+            {
+                for (const auto jump : m_exits)
+                {
+                    m_as.bind(jump);
+                }
+
+                m_as.adjustStack(frameSize);
+                m_as.pop(r15);
+                m_as.pop(r14);
+                m_as.pop(r13);
+                m_as.pop(r12);
+                m_as.pop(rbx);
+                m_as.pop(rbp);
+                m_as.ret();
+
+                return m_as.code();
+            }
+
+            void emit(const NativeForm& form)
+            {
+                switch (form.type)
+                {
+                case InstructionType::Move:
+                    move(form);
+                    break;
+
+                case InstructionType::Add:
+                case InstructionType::AddI:
+                    add(form);
+                    break;
+
+                case InstructionType::Sub:
+                case InstructionType::SubI:
+                    sub(form);
+                    break;
+
+                case InstructionType::And:
+                case InstructionType::AndI:
+                case InstructionType::Or:
+                case InstructionType::OrI:
+                    logical(form);
+                    break;
+
+                case InstructionType::Compare:
+                case InstructionType::CompareI:
+                    compare(form);
+                    break;
+
+                case InstructionType::Tst:
+                    m_as.store(m_codes.result, host(form.src));
+                    flagsOp(m_codes, FlagsOp::Logical, form.size);
+                    break;
+
+                case InstructionType::SignedMul:
+                case InstructionType::UnsignedMul:
+                    multiply(form);
+                    break;
+
+                case InstructionType::ArithmeticShiftLeft:
+                case InstructionType::ArithmeticShiftRight:
+                case InstructionType::LogicalShiftLeft:
+                case InstructionType::LogicalShiftRight:
+                    shift(form);
+                    break;
+
+                default:
+                    break;
+                }
+
+                if (form.dst >= 0 && form.type != InstructionType::Compare &&
+                    form.type != InstructionType::CompareI)
+                {
+                    m_dirty[std::size_t(form.dst)] = true;
+                }
+            }
+
+            // Calls the bound handler of an op with the guest state in
+            // memory, leaves its status in eax
+            template <typename Op>
+            void fallback(const Op& op)
+            {
+                sync();
+
+                m_as.store(m_programCounter, std::int32_t(op.pc));
+                m_as.movq(firstArgument, rbp);
+                const auto bound   = reinterpret_cast<std::uintptr_t>(&op);
+                const auto handler = reinterpret_cast<std::uintptr_t>(op.run);
+
+                m_as.movq(secondArgument, bound);
+                m_as.movq(rax, handler);
+                m_as.call(rax);
+                m_as.zeroExtend(rax, rax);
+
+                reload();
+
+                // The handler may have set them
+                m_knownFlags.reset();
+            }
+
+            // Leaves the block after a fallback, unless the handler let it
+            // go on to next
+            void continueAt(std::uint32_t next, std::int64_t executed)
+            {
+                m_as.alu(CmpImm,
+                         rax,
+                         std::int32_t(ExecutionStatus::BranchTaken));
+                const auto stopped = m_as.jump(Above);
+
+                m_as.compare(m_codeWriteBegin, 0, true);
+                const auto written = m_as.jump(GreaterEqual);
+
+                m_as.compare(m_programCounter, std::int32_t(next), false);
+                const auto same = m_as.jump(Equal);
+
+                m_as.bind(stopped);
+                m_as.bind(written);
+                exitWithStatus(executed);
+
+                m_as.bind(same);
+            }
+
+            // instr::divs and instr::divu. A division by zero or a quotient
+            // which doesn't fit in a word is left to the handler, which
+            // traps or only sets V.
+            template <typename Op>
+            void divide(const NativeForm& form,
+                        const Op& op,
+                        std::int64_t executed)
+            {
+                const bool isSigned = form.type == InstructionType::SignedDiv;
+                const auto dst      = host(form.dst);
+
+                // So the handler can be called on either way out
+                sync();
+
+                if (form.immediate)
+                {
+                    const auto value = isSigned ? std::int32_t(std::int16_t(
+                                                      form.value & 0xFFFF))
+                                                : form.value & 0xFFFF;
+
+                    m_as.mov(rcx, value);
+                }
+                else if (isSigned)
+                {
+                    m_as.signExtend(rcx, host(form.src));
+                }
+                else
+                {
+                    m_as.alu(MovOp, rcx, host(form.src));
+                    m_as.alu(AndImm, rcx, 0xFFFF);
+                }
+
+                m_as.alu(TestOp, rcx, rcx);
+                const auto byZero = m_as.jump(Equal);
+
+                if (isSigned)
+                {
+                    // 64 bits so that the most negative value over -1 can't
+                    // fault
+                    m_as.signExtendLong(rax, dst);
+                    m_as.signExtendLong(rcx, rcx);
+                    m_as.cqo();
+                    m_as.divide(rcx, true, true);
+
+                    // A word once moved up by 0x8000
+                    m_as.alu(MovOp, r8, rax);
+                    m_as.alu(AddImm, r8, 0x8000);
+                    m_as.alu(CmpImm, r8, 0xFFFF);
+                }
+                else
+                {
+                    m_as.alu(MovOp, rax, dst);
+                    m_as.alu(XorOp, rdx, rdx);
+                    m_as.divide(rcx, false, false);
+                    m_as.alu(CmpImm, rax, 0xFFFF);
+                }
+
+                const auto overflows = m_as.jump(Above);
+
+                // The quotient goes in the low word, the remainder in the
+                // high one
+                m_as.alu(AndImm, rax, 0xFFFF);
+                m_as.shl(rdx, 16);
+                m_as.alu(OrOp, rdx, rax);
+                m_as.alu(MovOp, dst, rdx);
+
+                m_as.store(m_codes.result, rax);
+                flagsOp(m_codes, FlagsOp::Logical, 2);
+
+                const auto done = m_as.jump();
+
+                m_as.bind(byZero);
+                m_as.bind(overflows);
+                fallback(op);
+                continueAt(op.next, executed);
+
+                m_as.bind(done);
+
+                m_dirty[std::size_t(form.dst)] = true;
+                m_knownFlags.reset();
+            }
+
+            void exit(ExecutionStatus status, std::int64_t executed)
+            {
+                sync();
+
+                m_as.mov(rax, std::int32_t(status));
+                exitWithStatus(executed);
+            }
+
+            void exitWithStatus(std::int64_t executed)
+            {
+                m_as.alu(OrImm, rax, std::int32_t(executed << 8));
+                m_exits.push_back(m_as.jump());
+            }
+
+            void jumpTo(std::uint32_t target, std::int64_t executed)
+            {
+                m_as.store(m_programCounter, std::int32_t(target));
+                exit(ExecutionStatus::BranchTaken, executed);
+            }
+
+            void fallThrough(std::uint32_t next, std::int64_t executed)
+            {
+                m_as.store(m_programCounter, std::int32_t(next));
+                exit(ExecutionStatus::Continue, executed);
+            }
+
+            // Same as instr::branchConditionHolds. When the flags were set
+            // in the block the operation is done again on the host, whose
+            // flags mean the same, otherwise they are worked out by a call.
+            void branch(std::uint8_t condition,
+                        std::uint32_t target,
+                        std::uint32_t next,
+                        std::int64_t executed)
+            {
+                // Both ways out share what was written back
+                sync();
+
+                std::optional<std::size_t> taken;
+
+                const auto cond = hostCondition(condition);
+
+                if (m_knownFlags && cond)
+                {
+                    const auto size = m_knownFlags->size;
+
+                    switch (m_knownFlags->op)
+                    {
+                    case FlagsOp::Logical:
+                        m_as.load(rax, m_codes.result);
+                        m_as.alu(TestOp, rax, rax, size);
+                        break;
+
+                    case FlagsOp::Add:
+                        m_as.load(rax, m_codes.dst);
+                        m_as.load(rcx, m_codes.src);
+                        m_as.alu(AddOp, rax, rcx, size);
+                        break;
+
+                    default:
+                        m_as.load(rax, m_codes.dst);
+                        m_as.load(rcx, m_codes.src);
+                        m_as.alu(CmpOp, rax, rcx, size);
+                        break;
+                    }
+
+                    taken = m_as.jump(*cond);
+                }
+                else if (cond)
+                {
+                    const auto helper =
+                        reinterpret_cast<std::uintptr_t>(&conditionHolds);
+
+                    m_as.movq(firstArgument, rbp);
+                    m_as.mov(secondArgument, condition);
+                    m_as.movq(rax, helper);
+                    m_as.call(rax);
+
+                    m_as.alu(TestOp, rax, rax, 1);
+                    taken = m_as.jump(NotEqual);
+                }
+
+                fallThrough(next, executed);
+
+                if (taken)
+                {
+                    m_as.bind(*taken);
+                    jumpTo(target, executed);
+                }
+            }
+
+        private:
+            [[nodiscard]] Reg host(std::int8_t guest) const
+            {
+                return Reg(m_hosts[std::size_t(guest)]);
+            }
+
+            // Writes the guest registers changed since the last sync
+            void sync()
+            {
+                for (std::size_t i = 0; i < m_hosts.size(); ++i)
+                {
+                    if (m_dirty[i])
+                    {
+                        m_as.store(m_dataRegisters[i], Reg(m_hosts[i]));
+                        m_dirty[i] = false;
+                    }
+                }
+            }
+
+            void reload()
+            {
+                for (std::size_t i = 0; i < m_hosts.size(); ++i)
+                {
+                    if (m_hosts[i] >= 0)
+                    {
+                        m_as.load(Reg(m_hosts[i]), m_dataRegisters[i]);
+                    }
+                }
+            }
+
+            // The source operand of form, as stored by the status register
+            void storeSource(std::int32_t disp, const NativeForm& form)
+            {
+                if (form.immediate)
+                {
+                    m_as.store(disp, form.value);
+                }
+                else
+                {
+                    m_as.store(disp, host(form.src));
+                }
+            }
+
+            // The rest of what the StatusRegister::set* members store
+            void flagsOp(const FlagsLayout& source,
+                         FlagsOp op,
+                         std::int16_t size)
+            {
+                m_as.storeByte(source.op, std::uint8_t(op));
+                m_as.storeByte(source.size, std::uint8_t(size));
+
+                m_knownFlags = KnownFlags { op, size };
+            }
+
+            // instr::move
+            void move(const NativeForm& form)
+            {
+                const auto dst = host(form.dst);
+
+                if (form.immediate)
+                {
+                    m_as.mov(dst, form.value, form.size);
+                }
+                else
+                {
+                    m_as.alu(MovOp, dst, host(form.src), form.size);
+                }
+
+                storeSource(m_codes.result, form);
+                flagsOp(m_codes, FlagsOp::Logical, form.size);
+            }
+
+            // instr::add and instr::sub
+            void arithmetic(const NativeForm& form, FlagsOp op)
+            {
+                const auto dst = host(form.dst);
+
+                for (const auto* source : { &m_codes, &m_extendSource })
+                {
+                    m_as.store(source->dst, dst);
+                    storeSource(source->src, form);
+                }
+
+                const bool isAdd = op == FlagsOp::Add;
+
+                if (form.immediate)
+                {
+                    m_as.alu(
+                        isAdd ? AddImm : SubImm, dst, form.value, form.size);
+                }
+                else
+                {
+                    m_as.alu(
+                        isAdd ? AddOp : SubOp, dst, host(form.src), form.size);
+                }
+
+                m_as.store(m_codes.result, dst);
+
+                flagsOp(m_extendSource, op, form.size);
+                flagsOp(m_codes, op, form.size);
+            }
+
+            void add(const NativeForm& form)
+            {
+                arithmetic(form, FlagsOp::Add);
+            }
+
+            void sub(const NativeForm& form)
+            {
+                arithmetic(form, FlagsOp::Sub);
+            }
+
+            // instr::and_instr and instr::or_instr, no flags
+            void logical(const NativeForm& form)
+            {
+                const bool isAnd = form.type == InstructionType::And ||
+                                   form.type == InstructionType::AndI;
+
+                const auto dst = host(form.dst);
+
+                if (form.immediate)
+                {
+                    m_as.alu(
+                        isAnd ? AndImm : OrImm, dst, form.value, form.size);
+                }
+                else
+                {
+                    m_as.alu(
+                        isAnd ? AndOp : OrOp, dst, host(form.src), form.size);
+                }
+            }
+
+            // instr::cmp and instr::cmpi, the flags only depend on the low
+            // bytes of the result
+            void compare(const NativeForm& form)
+            {
+                const auto dst = host(form.dst);
+
+                m_as.store(m_codes.dst, dst);
+                storeSource(m_codes.src, form);
+
+                m_as.alu(MovOp, rax, dst);
+
+                if (form.immediate)
+                {
+                    m_as.alu(SubImm, rax, form.value);
+                }
+                else
+                {
+                    m_as.alu(SubOp, rax, host(form.src));
+                }
+
+                m_as.store(m_codes.result, rax);
+                flagsOp(m_codes, FlagsOp::Sub, form.size);
+            }
+
+            // instr::muls and instr::mulu, no flags
+            void multiply(const NativeForm& form)
+            {
+                const bool isSigned = form.type == InstructionType::SignedMul;
+                const auto dst      = host(form.dst);
+
+                if (form.immediate)
+                {
+                    const auto value = isSigned ? std::int32_t(std::int16_t(
+                                                      form.value & 0xFFFF))
+                                                : form.value;
+
+                    m_as.mov(rcx, value);
+                }
+                else if (isSigned)
+                {
+                    m_as.signExtend(rcx, host(form.src));
+                }
+                else
+                {
+                    m_as.alu(MovOp, rcx, host(form.src));
+                }
+
+                if (isSigned)
+                {
+                    m_as.signExtend(dst, dst);
+                }
+
+                m_as.imul(dst, rcx);
+            }
+
+            // instr::shift of a data register, which shifts all of it as a
+            // signed value whatever the size and sets no flags. The host
+            // takes a count in a register modulo 32, like the handler's
+            // shift does.
+            void shift(const NativeForm& form)
+            {
+                const bool right =
+                    form.type == InstructionType::ArithmeticShiftRight ||
+                    form.type == InstructionType::LogicalShiftRight;
+                const bool keepsSign =
+                    form.type == InstructionType::ArithmeticShiftRight;
+
+                const auto dst = host(form.dst);
+
+                if (keepsSign)
+                {
+                    const auto signBit = std::int32_t(
+                        details::signBit(std::int8_t(form.size)));
+
+                    m_as.alu(MovOp, rax, dst);
+                    m_as.alu(AndImm, rax, signBit);
+                }
+
+                const auto count = std::uint8_t(form.value);
+
+                if (!form.immediate)
+                {
+                    m_as.alu(MovOp, rcx, host(form.src));
+                }
+
+                if (form.immediate && right)
+                {
+                    m_as.sar(dst, count);
+                }
+                else if (form.immediate)
+                {
+                    m_as.shl(dst, count);
+                }
+                else if (right)
+                {
+                    m_as.sar(dst);
+                }
+                else
+                {
+                    m_as.shl(dst);
+                }
+
+                if (keepsSign)
+                {
+                    m_as.alu(OrOp, dst, rax);
+                }
+            }
+
+            Assembler m_as;
+            std::vector<std::size_t> m_exits;
+
+            // Host register of each guest data register, -1 if not cached
+            std::array<std::int8_t, 8> m_hosts {};
+            std::array<bool, 8> m_dirty {};
+
+            std::int32_t m_programCounter;
+            FlagsLayout m_codes {};
+            FlagsLayout m_extendSource {};
+            std::int32_t m_codeWriteBegin;
+            std::array<std::int32_t, 8> m_dataRegisters {};
+
+            std::optional<KnownFlags> m_knownFlags;
+        };
+
+        template <typename Op>
+        std::optional<NativeForm> nativeForm(const Op& op)
+        {
+            const auto& data = op.data;
+
+            NativeForm form { op.type, data.size, false, 0, -1, -1 };
+
+            const auto isDataRegister = [&data](std::size_t i) {
+                return data.operandType[i] == OperandType::DataRegister;
+            };
+
+            switch (op.type)
+            {
+            // The count of a register shift is in the opcode word, it
+            // isn't an immediate operand
+            case InstructionType::ArithmeticShiftLeft:
+            case InstructionType::ArithmeticShiftRight:
+            case InstructionType::LogicalShiftLeft:
+            case InstructionType::LogicalShiftRight:
+                if (!isDataRegister(1))
+                {
+                    return std::nullopt;
+                }
+
+                form.immediate = !isDataRegister(0);
+                form.value     = utils::to_val(data.addressingMode[0]);
+                form.src       = form.immediate ? -1 : std::int8_t(form.value);
+                form.dst = std::int8_t(utils::to_val(data.addressingMode[1]));
+
+                return form;
+
+            default:
+                break;
+            }
+
+            if (isDataRegister(0))
+            {
+                form.src = std::int8_t(utils::to_val(data.addressingMode[0]));
+            }
+            else if (op.resolved &&
+                     data.operandType[0] == OperandType::Immediate &&
+                     data.addressingMode[0] == SpecialAddressingMode::Immediate)
+            {
+                form.immediate = true;
+                form.value     = op.value;
+            }
+            else
+            {
+                return std::nullopt;
+            }
+
+            if (op.type == InstructionType::Tst)
+            {
+                return form.immediate ? std::nullopt
+                                      : std::optional<NativeForm>(form);
+            }
+
+            if (!isDataRegister(1))
+            {
+                return std::nullopt;
+            }
+
+            form.dst = std::int8_t(utils::to_val(data.addressingMode[1]));
+
+            switch (op.type)
+            {
+            case InstructionType::Move:
+            case InstructionType::And:
+            case InstructionType::AndI:
+            case InstructionType::Or:
+            case InstructionType::OrI:
+            case InstructionType::SignedMul:
+            case InstructionType::UnsignedMul:
+            case InstructionType::SignedDiv:
+            case InstructionType::UnsignedDiv:
+            case InstructionType::Add:
+            case InstructionType::AddI:
+            case InstructionType::Sub:
+            case InstructionType::SubI:
+            case InstructionType::Compare:
+            case InstructionType::CompareI:
+                return form;
+
+            default:
+                return std::nullopt;
+            }
+        }
+    } // namespace
+
+    bool BlockCache::compile(System& sys, Block& block)
+    {
+        const auto& ops = block.ops;
+
+        std::vector<std::optional<NativeForm>> forms;
+        std::array<std::int32_t, 8> uses {};
+
+        for (const auto& op : ops)
+        {
+            forms.push_back(nativeForm(op));
+
+            if (const auto& form = forms.back())
+            {
+                for (const auto reg : { form->src, form->dst })
+                {
+                    if (reg >= 0)
+                    {
+                        ++uses[std::size_t(reg)];
+                    }
+                }
+            }
+        }
+
+        Compiler compiler(sys);
+        compiler.cache(uses);
+        compiler.prologue();
+
+        for (std::size_t i = 0; i < ops.size(); ++i)
+        {
+            const auto& op       = ops[i];
+            const auto executed  = std::int64_t(i + 1);
+            const bool last      = i + 1 == ops.size();
+            const auto condition = utils::to_val(op.data.operandType[0]);
+
+            if (op.resolved && (op.type == InstructionType::Branch ||
+                                op.type == InstructionType::Jmp))
+            {
+                compiler.jumpTo(std::uint32_t(op.value), executed);
+            }
+            else if (op.type == InstructionType::BranchCondition)
+            {
+                compiler.branch(
+                    condition, std::uint32_t(op.value), op.next, executed);
+            }
+            else if (forms[i] && compiler.cached(*forms[i]))
+            {
+                if (op.type == InstructionType::SignedDiv ||
+                    op.type == InstructionType::UnsignedDiv)
+                {
+                    compiler.divide(*forms[i], op, executed);
+                }
+                else
+                {
+                    compiler.emit(*forms[i]);
+                }
+
+                if (last)
+                {
+                    compiler.fallThrough(op.next, executed);
+                }
+            }
+            else
+            {
+                compiler.fallback(op);
+
+                if (last)
+                {
+                    compiler.exitWithStatus(executed);
+                }
+                else
+                {
+                    compiler.continueAt(ops[i + 1].pc, executed);
+                }
+            }
+        }
+
+        const auto* code = m_nativeCode.add(compiler.finish());
+
+        if (code == nullptr)
+        {
+            return false;
+        }
+
+        // Data to function pointer, supported by every host we generate
+        // code for
+        std::memcpy(&block.native, &code, sizeof(code));
+
+        return true;
+    }
+#else
+    bool BlockCache::compile(System& /*sys*/, Block& /*block*/)
+    {
+        return false;
+    }
+#endif
+} // namespace momiji
@@ -0,0 +1,323 @@
+#include <momiji/BlockCache.h>
+
+#include "Instructions/Utils.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+
+namespace momiji
+{
+    namespace
+    {
+        // move, sub, beq and the jump back, except for the last iteration
+        // which leaves at the beq
+        constexpr std::int64_t instructionsPerIteration = 4;
+
+        // EQ
+        constexpr std::uint8_t equal = 0b0111;
+
+        std::uint32_t counterMask(std::int8_t size)
+        {
+            return size == 4 ? 0xFFFF'FFFF
+                             : (std::uint32_t(1) << (size * 8)) - 1;
+        }
+
+        // The counter as instr::sub leaves it, with the flags it sets
+        template <typename To>
+        void decrementCounter(System& sys,
+                              DataRegister& reg,
+                              std::uint32_t before,
+                              std::uint32_t after)
+        {
+            *reg.template as<To>() = To(after);
+
+            sys.cpu.statusRegister.setSub(sizeof(To), 1, To(before), To(after));
+        }
+
+        // Element by element the copy reads what the earlier elements
+        // wrote whenever the destination is ahead of the source by less
+        // than the length. Chunks no longer than that distance read
+        // nothing they write themselves, so each is a plain copy.
+        bool copy(System& sys,
+                  std::int64_t src,
+                  std::int64_t dst,
+                  std::int64_t bytes,
+                  std::int8_t size)
+        {
+            auto chunk = bytes;
+
+            const auto distance = dst - src;
+
+            if (distance > 0 && distance < bytes)
+            {
+                chunk = distance / size * size;
+            }
+
+            // Elements partly overlapping the one written just before
+            if (chunk == 0)
+            {
+                return false;
+            }
+
+            std::vector<std::uint8_t> buffer(std::size_t(chunk), 0);
+
+            auto& storage = sys.mem.underlying();
+
+            for (std::int64_t done = 0; done < bytes; done += chunk)
+            {
+                const auto len = std::min(chunk, bytes - done);
+
+                storage.read(src + done, { buffer.data(), len });
+
+                sys.mem.recordStore(dst + done, len);
+                storage.write(dst + done, { buffer.data(), len });
+            }
+
+            return true;
+        }
+
+        void fill(System& sys,
+                  std::int64_t dst,
+                  std::int64_t bytes,
+                  std::int8_t size,
+                  std::uint32_t value)
+        {
+            std::vector<std::uint8_t> buffer(std::size_t(bytes), 0);
+
+            // One element as a store of its size leaves it
+            std::array<std::uint8_t, 4> element {};
+
+            switch (size)
+            {
+            case 1:
+                element[0] = std::uint8_t(value);
+                break;
+
+            case 2: {
+                const auto val = toGuestOrder(std::uint16_t(value));
+                std::memcpy(element.data(), &val, sizeof(val));
+            }
+            break;
+
+            default: {
+                const auto val = toGuestOrder(value);
+                std::memcpy(element.data(), &val, sizeof(val));
+            }
+            break;
+            }
+
+            for (std::size_t i = 0; i < buffer.size(); ++i)
+            {
+                buffer[i] = element[i % std::size_t(size)];
+            }
+
+            sys.mem.recordStore(dst, bytes);
+            sys.mem.underlying().write(dst, { buffer.data(), bytes });
+        }
+    } // namespace
+
+    std::optional<BlockCache::Idiom>
+    BlockCache::findIdiom(ConstExecutableMemoryView mem, const Block& block)
+    {
+        const auto& ops = block.ops;
+
+        if (ops.size() != 3)
+        {
+            return std::nullopt;
+        }
+
+        const auto& move   = ops[0];
+        const auto& sub    = ops[1];
+        const auto& branch = ops[2];
+
+        const auto regnum = [](const Op& op, std::size_t i) {
+            return std::int8_t(utils::to_val(op.data.addressingMode[i]));
+        };
+
+        if (move.type != InstructionType::Move ||
+            move.data.operandType[1] != OperandType::AddressPost)
+        {
+            return std::nullopt;
+        }
+
+        if ((sub.type != InstructionType::Sub &&
+             sub.type != InstructionType::SubI) ||
+            !sub.resolved || sub.value != 1 ||
+            sub.data.operandType[1] != OperandType::DataRegister)
+        {
+            return std::nullopt;
+        }
+
+        if (branch.type != InstructionType::BranchCondition ||
+            !branch.resolved ||
+            utils::to_val(branch.data.operandType[0]) != equal)
+        {
+            return std::nullopt;
+        }
+
+        // The jump back to the body
+        const auto back = momiji::decode(mem, branch.next);
+        const auto target =
+            momiji::branchTarget(mem, std::int64_t(branch.next), back);
+
+        if ((back.type != InstructionType::Jmp &&
+             back.type != InstructionType::Branch) ||
+            target != std::optional<std::int64_t>(block.begin))
+        {
+            return std::nullopt;
+        }
+
+        const auto bodyCycles = move.data.cycles + sub.data.cycles;
+
+        Idiom idiom { Idiom::Kind::Copy,
+                      move.data.size,
+                      sub.data.size,
+                      regnum(move, 0),
+                      regnum(move, 1),
+                      regnum(sub, 1),
+                      0,
+                      std::uint32_t(branch.value),
+                      bodyCycles + branch.data.cycles + back.data.branchCycles,
+                      bodyCycles + branch.data.branchCycles };
+
+        switch (move.data.operandType[0])
+        {
+        case OperandType::AddressPost:
+            if (idiom.src == idiom.dst)
+            {
+                return std::nullopt;
+            }
+            break;
+
+        case OperandType::DataRegister:
+            idiom.kind = Idiom::Kind::Fill;
+
+            if (idiom.src == idiom.counter)
+            {
+                return std::nullopt;
+            }
+            break;
+
+        default:
+            if (!move.resolved)
+            {
+                return std::nullopt;
+            }
+
+            idiom.kind  = Idiom::Kind::Fill;
+            idiom.src   = -1;
+            idiom.value = move.value;
+            break;
+        }
+
+        return idiom;
+    }
+
+    std::int64_t BlockCache::runIdiom(System& sys,
+                                      const Block& block,
+                                      std::int64_t maxInstructions)
+    {
+        const auto& idiom = *block.idiom;
+        auto& cpu         = sys.cpu;
+
+        // Events wait for the end of a block, not of the whole loop
+        maxInstructions = std::min(maxInstructions,
+                                   (sys.nextEventCycle - sys.cycles) /
+                                       idiom.iterationCycles *
+                                       instructionsPerIteration);
+
+        auto& counter    = cpu.dataRegisters[std::size_t(idiom.counter)];
+        const auto mask  = counterMask(idiom.counterSize);
+        const auto start = std::uint32_t(counter.raw()) & mask;
+
+        // A counter at 0 wraps around before reaching 0 again
+        const auto count = std::int64_t(start) + (start == 0 ? mask + 1 : 0);
+
+        const bool finishes =
+            count * instructionsPerIteration - 1 <= maxInstructions;
+
+        const auto iterations =
+            finishes ? count : maxInstructions / instructionsPerIteration;
+
+        if (iterations <= 0)
+        {
+            return 0;
+        }
+
+        auto& dstreg     = cpu.addressRegisters[std::size_t(idiom.dst)];
+        const auto dst   = std::int64_t(dstreg.raw());
+        const auto bytes = iterations * idiom.size;
+
+        // Anything the bus would fault on or give to a device is left to
+        // the handlers
+        const auto inMemory = [&](std::int64_t offset) {
+            return offset >= 0 && offset + bytes <= asl::ssize(sys.mem) &&
+                   (idiom.size == 1 || (offset & 0b1) == 0) &&
+                   !sys.devices->claimsAny(offset, bytes);
+        };
+
+        if (!inMemory(dst))
+        {
+            return 0;
+        }
+
+        if (idiom.kind == Idiom::Kind::Copy)
+        {
+            auto& srcreg   = cpu.addressRegisters[std::size_t(idiom.src)];
+            const auto src = std::int64_t(srcreg.raw());
+
+            if (!inMemory(src) || !copy(sys, src, dst, bytes, idiom.size))
+            {
+                return 0;
+            }
+
+            srcreg = std::int32_t(src + bytes);
+        }
+        else
+        {
+            const auto value =
+                idiom.src < 0
+                    ? idiom.value
+                    : cpu.dataRegisters[std::size_t(idiom.src)].raw();
+
+            fill(sys, dst, bytes, idiom.size, std::uint32_t(value));
+        }
+
+        dstreg = std::int32_t(dst + bytes);
+
+        // As left by the sub of the last iteration run
+        const auto before = std::uint32_t(count - iterations + 1) & mask;
+        const auto after  = std::uint32_t(count - iterations) & mask;
+
+        switch (idiom.counterSize)
+        {
+        case 1:
+            decrementCounter<std::int8_t>(sys, counter, before, after);
+            break;
+
+        case 2:
+            decrementCounter<std::int16_t>(sys, counter, before, after);
+            break;
+
+        default:
+            decrementCounter<std::int32_t>(sys, counter, before, after);
+            break;
+        }
+
+        if (finishes)
+        {
+            cpu.programCounter = idiom.exit;
+            sys.cycles += (iterations - 1) * idiom.iterationCycles +
+                          idiom.exitCycles;
+
+            return iterations * instructionsPerIteration - 1;
+        }
+
+        cpu.programCounter = std::uint32_t(block.begin);
+        sys.cycles += iterations * idiom.iterationCycles;
+
+        return iterations * instructionsPerIteration;
+    }
+} // namespace momiji
@@ -0,0 +1,47 @@
+#include <momiji/Bus.h>
+
+namespace momiji::bus::details
+{
+    std::uint32_t readSlow(System& sys,
+                           std::int64_t address,
+                           std::int64_t size)
+    {
+        if (!faults(sys, address, size))
+        {
+            return sys.devices->read(sys, address, size);
+        }
+
+        if (address >= 0 && address <= asl::ssize(sys.mem) - size)
+        {
+            sys.trap = traps::AddressError { std::int32_t(address), false };
+        }
+        else
+        {
+            sys.trap = traps::InvalidMemoryRead { std::int32_t(address) };
+        }
+
+        return 0;
+    }
+
+    void writeSlow(System& sys,
+                   std::int64_t address,
+                   std::int64_t size,
+                   std::uint32_t val)
+    {
+        if (!faults(sys, address, size))
+        {
+            sys.devices->write(sys, address, size, val);
+            return;
+        }
+
+        if (address >= 0 && address <= asl::ssize(sys.mem) - size)
+        {
+            sys.trap = traps::AddressError { std::int32_t(address), true };
+        }
+        else
+        {
+            sys.trap = traps::InvalidMemoryWrite { std::int32_t(address),
+                                                   std::int32_t(val) };
+        }
+    }
+} // namespace momiji::bus::details
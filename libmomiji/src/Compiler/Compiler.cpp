@@ -3,6 +3,7 @@
 #include "./Utils.h"
 
 #include <Utils.h>
+#include <algorithm>
 #include <iostream>
 
 #include "add.h"
@@ -24,17 +25,32 @@
 #include "shifts.h"
 #include "sub.h"
 #include "swap.h"
+#include "trap.h"
 #include "tst.h"
 #include "xor.h"
 
 namespace momiji
 {
     ExecutableMemory compile(const momiji::ParsingInfo& parsingInfo,
-                             CompilerSettings /*settings*/)
+                             CompilerSettings settings)
     {
         ExecutableMemory memory;
 
-        const auto& labels = parsingInfo.labels;
+        // Left at zero, the pages aren't allocated until written to
+        const auto programStart =
+            std::int64_t(std::max(settings.programStart, 0) + 1) & ~1;
+        memory.underlying().resize(programStart);
+
+        // Labels are parsed relative to the first instruction. Branches
+        // only need the distance, everything else the address.
+        const auto& offsets = parsingInfo.labels;
+
+        auto labels = parsingInfo.labels;
+
+        for (auto& label : labels)
+        {
+            label.idx += programStart;
+        }
 
         for (const auto& instr : parsingInfo.instructions)
         {
@@ -141,21 +157,33 @@ namespace momiji
                 break;
 
             case InstructionType::Branch:
-                momiji::enc::bra(instr, labels, opcode, additional_data);
+                momiji::enc::bra(instr, offsets, opcode, additional_data);
                 break;
 
             case InstructionType::BranchCondition:
-                momiji::enc::bcc(instr, labels, opcode, additional_data);
+                momiji::enc::bcc(instr, offsets, opcode, additional_data);
                 break;
 
             case InstructionType::BranchSubroutine:
-                momiji::enc::bsr(instr, labels, opcode, additional_data);
+                momiji::enc::bsr(instr, offsets, opcode, additional_data);
                 break;
 
             case InstructionType::ReturnSubroutine:
                 momiji::enc::rts(instr, labels, opcode, additional_data);
                 break;
 
+            case InstructionType::Trap:
+                momiji::enc::trap(instr, labels, opcode, additional_data);
+                break;
+
+            case InstructionType::ReturnException:
+                momiji::enc::rte(instr, labels, opcode, additional_data);
+                break;
+
+            case InstructionType::MoveControl:
+                momiji::enc::movec(instr, labels, opcode, additional_data);
+                break;
+
             case InstructionType::Swap:
                 momiji::enc::swap(instr, labels, opcode, additional_data);
                 break;
@@ -199,7 +227,7 @@ namespace momiji
                     for (const auto& x : instr.operands)
                     {
                         const std::uint8_t val =
-                            extractASTValue(x, parsingInfo.labels) &
+                            extractASTValue(x, labels) &
                             0x0000'00FF;
                         memory.push8(val);
                     }
@@ -209,7 +237,7 @@ namespace momiji
                     for (const auto& x : instr.operands)
                     {
                         const std::uint16_t val =
-                            extractASTValue(x, parsingInfo.labels) &
+                            extractASTValue(x, labels) &
                             0x0000'FFFF;
                         memory.push16(val);
                     }
@@ -219,7 +247,7 @@ namespace momiji
                     for (const auto& x : instr.operands)
                     {
                         const auto val = std::uint32_t(
-                            extractASTValue(x, parsingInfo.labels));
+                            extractASTValue(x, labels));
                         memory.push32(val);
                     }
                     break;
@@ -271,6 +299,9 @@ namespace momiji
             }
         }
 
+        memory.executableMarker.begin = programStart;
+        memory.executableMarker.end   = asl::ssize(memory);
+
         return memory;
     }
 } // namespace momiji
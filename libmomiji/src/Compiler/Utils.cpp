@@ -102,6 +102,10 @@ namespace momiji
                     val = utils::to_val(OperandType::ProgramCounterIndex);
                 },
 
+                [&] (const ops::ControlRegister&) {
+                    val = 0;
+                },
+
             }, op);
         // clang-format on
 
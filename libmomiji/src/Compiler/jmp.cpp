@@ -17,27 +17,25 @@ namespace momiji::enc
         bits.regtype = getCorrectOpType(op);
         bits.regmode = getCorrectOpMode(op);
 
-        if (matchOperand<operands::AbsoluteShort>(op) ||
-            matchOperand<operands::AbsoluteLong>(op))
-        {
-            additionalData[0].val = std::uint32_t(extractASTValue(op, labels));
-            additionalData[0].cnt = 4;
-        }
+        // As long as the parser and the decoder take them to be
+        handleAdditionalData(instr, labels, additionalData);
 
         opcode.val = std::uint16_t((bits.header << 6) | (bits.regtype << 3) |
                                    (bits.regmode));
     }
 
     void jsr(const momiji::ParsedInstruction& instr,
-             const momiji::LabelInfo& /*labels*/,
+             const momiji::LabelInfo& labels,
              OpcodeDescription& opcode,
-             std::array<AdditionalData, 2>& /*additionalData*/)
+             std::array<AdditionalData, 2>& additionalData)
     {
         repr::Jsr bits;
 
         bits.regtype = getCorrectOpType(instr.operands[0]);
         bits.regmode = getCorrectOpMode(instr.operands[0]);
 
+        handleAdditionalData(instr, labels, additionalData);
+
         opcode.val = std::uint16_t((bits.header << 6) | (bits.regtype << 3) |
                                    (bits.regmode));
     }
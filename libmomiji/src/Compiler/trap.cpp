@@ -0,0 +1,56 @@
+#include "trap.h"
+
+#include "../Instructions/Representations.h"
+#include <momiji/Utils.h>
+
+namespace momiji::enc
+{
+    void trap(const momiji::ParsedInstruction& instr,
+              const momiji::LabelInfo& labels,
+              OpcodeDescription& opcode,
+              std::array<AdditionalData, 2>& /*additionalData*/)
+    {
+        repr::Trap bits;
+
+        bits.vector =
+            std::uint16_t(extractASTValue(instr.operands[0], labels) & 0xF);
+
+        opcode.val = std::uint16_t((bits.header << 4) | bits.vector);
+    }
+
+    void rte(const momiji::ParsedInstruction& /*instr*/,
+             const momiji::LabelInfo& /*labels*/,
+             OpcodeDescription& opcode,
+             std::array<AdditionalData, 2>& /*additionalData*/)
+    {
+        repr::Rte bits;
+        opcode.val = bits.header;
+    }
+
+    void movec(const momiji::ParsedInstruction& instr,
+               const momiji::LabelInfo& /*labels*/,
+               OpcodeDescription& opcode,
+               std::array<AdditionalData, 2>& additionalData)
+    {
+        repr::Movec bits;
+
+        // dr is set when the general register is the source
+        const bool toControl =
+            matchOperand<operands::ControlRegister>(instr.operands[1]);
+
+        const auto& control = instr.operands[toControl ? 1 : 0];
+        const auto& reg     = instr.operands[toControl ? 0 : 1];
+
+        bits.dr = toControl ? 1 : 0;
+
+        const auto isAddress =
+            matchOperand<operands::AddressRegister>(reg) ? 1 : 0;
+
+        additionalData[0].arr16[0] = std::uint16_t(
+            (isAddress << 15) | (extractRegister(reg) << 12) |
+            std::get<operands::ControlRegister>(control).reg);
+        additionalData[0].cnt = 2;
+
+        opcode.val = std::uint16_t((bits.header << 1) | bits.dr);
+    }
+} // namespace momiji::enc
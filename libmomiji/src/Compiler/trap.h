@@ -0,0 +1,23 @@
+#pragma once
+
+#include "./Utils.h"
+#include <momiji/Parser.h>
+
+namespace momiji::enc
+{
+    void trap(const momiji::ParsedInstruction& instr,
+              const momiji::LabelInfo& labels,
+              OpcodeDescription& opcode,
+              std::array<AdditionalData, 2>& additionalData);
+
+    void rte(const momiji::ParsedInstruction& instr,
+             const momiji::LabelInfo& labels,
+             OpcodeDescription& opcode,
+             std::array<AdditionalData, 2>& additionalData);
+
+    void movec(const momiji::ParsedInstruction& instr,
+               const momiji::LabelInfo& labels,
+               OpcodeDescription& opcode,
+               std::array<AdditionalData, 2>& additionalData);
+
+} // namespace momiji::enc
@@ -0,0 +1,80 @@
+#include <momiji/DecodeCache.h>
+
+#include <algorithm>
+
+namespace momiji
+{
+    namespace
+    {
+        // Opcode word plus two long extension words
+        constexpr std::int64_t maxInstructionSize = 10;
+    } // namespace
+
+    const DecodedInstruction& DecodeCache::fetch(ConstExecutableMemoryView mem,
+                                                 std::int64_t pc)
+    {
+        const auto codeBegin = mem.executableMarker.begin;
+        const auto codeSize  = mem.executableMarker.end - codeBegin;
+        const auto offset    = pc - codeBegin;
+
+        // Instructions are always word aligned, anything else is decoded on
+        // the spot and left to the instruction itself to deal with
+        if ((pc & 0b1) != 0 || offset < 0 || offset >= codeSize)
+        {
+            ++m_misses;
+            m_uncached = momiji::decode(mem, pc);
+
+            return m_uncached;
+        }
+
+        const auto entryCount = std::size_t((codeSize + 1) / 2);
+
+        if (m_entries.size() != entryCount)
+        {
+            m_entries.clear();
+            m_entries.resize(entryCount);
+        }
+
+        auto& entry = m_entries[std::size_t(offset / 2)];
+
+        if (entry.valid)
+        {
+            ++m_hits;
+            return entry.instr;
+        }
+
+        ++m_misses;
+        entry.instr = momiji::decode(mem, pc);
+        entry.valid = true;
+
+        return entry.instr;
+    }
+
+    void DecodeCache::invalidate(std::int64_t begin, std::int64_t end)
+    {
+        const auto first =
+            std::max(begin - maxInstructionSize + 1, std::int64_t(0)) / 2;
+        const auto last =
+            std::min((end + 1) / 2, std::int64_t(m_entries.size()));
+
+        for (auto i = first; i < last; ++i)
+        {
+            m_entries[std::size_t(i)].valid = false;
+        }
+    }
+
+    void DecodeCache::clear()
+    {
+        m_entries.clear();
+    }
+
+    std::int64_t DecodeCache::hits() const noexcept
+    {
+        return m_hits;
+    }
+
+    std::int64_t DecodeCache::misses() const noexcept
+    {
+        return m_misses;
+    }
+} // namespace momiji
@@ -0,0 +1,326 @@
+#include "Cycles.h"
+
+#include <momiji/Utils.h>
+
+namespace momiji::dec
+{
+    namespace
+    {
+        // Cycles taken to reach an operand, MC68000 User's Manual table 8-1
+        std::int32_t effectiveAddress(const InstructionData& data,
+                                      std::int8_t opNum)
+        {
+            const bool isLong = data.size == 4;
+
+            const auto type = asl::saccess(data.operandType, opNum);
+            const auto mode = asl::saccess(data.addressingMode, opNum);
+
+            switch (utils::to_val(type))
+            {
+            // Dn and An
+            case 0b000:
+            case 0b001:
+                return 0;
+
+            // (An) and (An)+
+            case 0b010:
+            case 0b011:
+                return isLong ? 8 : 4;
+
+            // -(An)
+            case 0b100:
+                return isLong ? 10 : 6;
+
+            // d(An)
+            case 0b101:
+                return isLong ? 12 : 8;
+
+            // d(An, ix)
+            case 0b110:
+                return isLong ? 14 : 10;
+            }
+
+            switch (mode)
+            {
+            case SpecialAddressingMode::AbsoluteShort:
+            case SpecialAddressingMode::ProgramCounterOffset:
+                return isLong ? 12 : 8;
+
+            case SpecialAddressingMode::AbsoluteLong:
+                return isLong ? 16 : 12;
+
+            case SpecialAddressingMode::ProgramCounterIndex:
+                return isLong ? 14 : 10;
+
+            case SpecialAddressingMode::Immediate:
+                return isLong ? 8 : 4;
+            }
+
+            return 0;
+        }
+
+        bool isRegister(const InstructionData& data, std::int8_t opNum)
+        {
+            const auto type = asl::saccess(data.operandType, opNum);
+
+            return type == OperandType::DataRegister ||
+                   type == OperandType::AddressRegister;
+        }
+
+        // Dn, An or an immediate, the operands the long forms of the
+        // standard instructions take two more cycles for
+        bool isRegisterOrImmediate(const InstructionData& data,
+                                   std::int8_t opNum)
+        {
+            return isRegister(data, opNum) || utils::isImmediate(data, opNum);
+        }
+
+        // Tables 8-2 and 8-3, writing to memory costs what reading the same
+        // operand would, -(An) without its predecrement
+        std::int32_t move(const InstructionData& data)
+        {
+            const auto predecrement =
+                data.operandType[1] == OperandType::AddressPre ? 2 : 0;
+
+            return 4 + effectiveAddress(data, 0) + effectiveAddress(data, 1) -
+                   predecrement;
+        }
+
+        // add, sub, and, or and cmp, table 8-4
+        std::int32_t standard(const DecodedInstruction& instr)
+        {
+            const auto& data   = instr.data;
+            const bool isLong  = data.size == 4;
+            const bool compare = instr.type == InstructionType::Compare ||
+                                 instr.type == InstructionType::CompareA;
+
+            // To an address register
+            if (data.operandType[1] == OperandType::AddressRegister)
+            {
+                if (compare)
+                {
+                    return 6 + effectiveAddress(data, 0);
+                }
+
+                if (!isLong)
+                {
+                    return 8 + effectiveAddress(data, 0);
+                }
+
+                return (isRegisterOrImmediate(data, 0) ? 8 : 6) +
+                       effectiveAddress(data, 0);
+            }
+
+            // To a data register
+            if (data.operandType[1] == OperandType::DataRegister)
+            {
+                if (!isLong)
+                {
+                    return 4 + effectiveAddress(data, 0);
+                }
+
+                if (compare)
+                {
+                    return 6 + effectiveAddress(data, 0);
+                }
+
+                return (isRegisterOrImmediate(data, 0) ? 8 : 6) +
+                       effectiveAddress(data, 0);
+            }
+
+            // To memory
+            return (isLong ? 12 : 8) + effectiveAddress(data, 1);
+        }
+
+        // addi, subi, andi, ori and cmpi, table 8-5
+        std::int32_t immediate(const DecodedInstruction& instr)
+        {
+            const auto& data   = instr.data;
+            const bool isLong  = data.size == 4;
+            const bool compare = instr.type == InstructionType::CompareI;
+
+            if (isRegister(data, 1))
+            {
+                if (compare)
+                {
+                    return isLong ? 14 : 8;
+                }
+
+                return isLong ? 16 : 8;
+            }
+
+            if (compare)
+            {
+                return (isLong ? 12 : 8) + effectiveAddress(data, 1);
+            }
+
+            return (isLong ? 20 : 12) + effectiveAddress(data, 1);
+        }
+
+        // Table 8-7, shifts by a register count as shifts by 0
+        std::int32_t shift(const InstructionData& data)
+        {
+            // Memory shifts move one bit of a word
+            if (data.operandType[1] == OperandType::Address)
+            {
+                return 8 + effectiveAddress(data, 0);
+            }
+
+            const auto base = data.size == 4 ? 8 : 6;
+
+            if (data.operandType[0] != OperandType::Immediate)
+            {
+                return base;
+            }
+
+            const auto count = utils::to_val(data.addressingMode[0]);
+
+            return base + 2 * (count == 0 ? 8 : count);
+        }
+
+        // Table 8-9, (An) is the cheapest
+        std::int32_t jump(const InstructionData& data, bool subroutine)
+        {
+            const auto extra = subroutine ? 8 : 0;
+
+            switch (utils::to_val(data.operandType[0]))
+            {
+            case 0b010:
+                return 8 + extra;
+
+            case 0b101:
+                return 10 + extra;
+
+            case 0b110:
+                return 14 + extra;
+            }
+
+            switch (data.addressingMode[0])
+            {
+            case SpecialAddressingMode::AbsoluteLong:
+            case SpecialAddressingMode::Immediate:
+                return 12 + extra;
+
+            case SpecialAddressingMode::ProgramCounterIndex:
+                return 14 + extra;
+
+            default:
+                return 10 + extra;
+            }
+        }
+    } // namespace
+
+    void assignCycles(DecodedInstruction& instr)
+    {
+        auto& data = instr.data;
+
+        std::int32_t cycles = 0;
+
+        switch (instr.type)
+        {
+        case InstructionType::Move:
+            cycles = move(data);
+            break;
+
+        case InstructionType::Add:
+        case InstructionType::AddA:
+        case InstructionType::Sub:
+        case InstructionType::SubA:
+        case InstructionType::And:
+        case InstructionType::Or:
+        case InstructionType::Compare:
+        case InstructionType::CompareA:
+            cycles = standard(instr);
+            break;
+
+        case InstructionType::AddI:
+        case InstructionType::SubI:
+        case InstructionType::AndI:
+        case InstructionType::OrI:
+        case InstructionType::CompareI:
+            cycles = immediate(instr);
+            break;
+
+        // Worst cases of table 8-6, the real times depend on the operands
+        case InstructionType::SignedMul:
+        case InstructionType::UnsignedMul:
+            cycles = 70 + effectiveAddress(data, 0);
+            break;
+
+        case InstructionType::SignedDiv:
+            cycles = 158 + effectiveAddress(data, 0);
+            break;
+
+        case InstructionType::UnsignedDiv:
+            cycles = 140 + effectiveAddress(data, 0);
+            break;
+
+        case InstructionType::ArithmeticShiftLeft:
+        case InstructionType::ArithmeticShiftRight:
+        case InstructionType::LogicalShiftLeft:
+        case InstructionType::LogicalShiftRight:
+            cycles = shift(data);
+            break;
+
+        case InstructionType::Tst:
+            cycles = 4 + effectiveAddress(data, 0);
+            break;
+
+        case InstructionType::Swap:
+            cycles = 4;
+            break;
+
+        case InstructionType::Exchange:
+            cycles = 6;
+            break;
+
+        case InstructionType::Branch:
+            cycles = 10;
+            break;
+
+        case InstructionType::BranchSubroutine:
+            cycles = 18;
+            break;
+
+        // Not taken, then taken
+        case InstructionType::BranchCondition:
+            data.cycles = utils::to_val(data.operandType[1]) == 0 ? 12 : 8;
+            data.branchCycles = 10;
+            return;
+
+        case InstructionType::Jmp:
+            cycles = jump(data, false);
+            break;
+
+        case InstructionType::JmpSubroutine:
+            cycles = jump(data, true);
+            break;
+
+        case InstructionType::ReturnSubroutine:
+            cycles = 16;
+            break;
+
+        case InstructionType::ReturnException:
+            cycles = 20;
+            break;
+
+        case InstructionType::MoveControl:
+            cycles = 12;
+            break;
+
+        // Entering the handler is charged by raiseException, as for the
+        // illegal instructions
+        case InstructionType::Trap:
+        case InstructionType::Illegal:
+            cycles = 0;
+            break;
+
+        default:
+            cycles = 4;
+            break;
+        }
+
+        data.cycles       = std::uint16_t(cycles);
+        data.branchCycles = std::uint16_t(cycles);
+    }
+} // namespace momiji::dec
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <Decoder.h>
+
+namespace momiji::dec
+{
+    // Fills InstructionData::cycles and branchCycles from the 68000 timing
+    // tables, once everything else about instr is known
+    void assignCycles(DecodedInstruction& instr);
+} // namespace momiji::dec
@@ -1,9 +1,8 @@
 #include <Decoder.h>
 
-#include "../Instructions/add.h"
 #include "../Instructions/illegal.h"
-#include "../Instructions/noop.h"
-#include "../Instructions/sub.h"
+
+#include "Cycles.h"
 
 #include "add.h"
 #include "and.h"
@@ -18,14 +17,15 @@
 #include "mul.h"
 #include "not.h"
 #include "or.h"
-#include "rod.h"
-#include "roxd.h"
 #include "rts.h"
 #include "shifts.h"
 #include "sub.h"
 #include "swap.h"
+#include "trap.h"
 #include "tst.h"
 
+#include <array>
+
 namespace momiji
 {
     DecodedInstruction::DecodedInstruction()
@@ -33,341 +33,427 @@ namespace momiji
     {
     }
 
-    DecodedInstruction decodeFirstGroup(ConstExecutableMemoryView mem,
-                                        std::int64_t idx);
-    DecodedInstruction decodeSecondGroup(ConstExecutableMemoryView mem,
-                                         std::int64_t idx);
-    DecodedInstruction decodeThirdGroup(ConstExecutableMemoryView mem,
-                                        std::int64_t idx);
-    DecodedInstruction decodeFourthGroup(ConstExecutableMemoryView mem,
-                                         std::int64_t idx);
-
-    DecodedInstruction decode(momiji::ConstExecutableMemoryView mem,
-                              std::int64_t idx)
+    namespace
     {
-        // Find by groups
-        std::uint16_t mask = 0b11000000'00000000;
+        using DecoderFn = DecodedInstruction (*)(ConstExecutableMemoryView,
+                                                 std::int64_t);
 
-        const std::uint16_t val = *mem.read16(idx) & mask;
+        DecodedInstruction unknown(ConstExecutableMemoryView /*mem*/,
+                                   std::int64_t /*idx*/)
+        {
+            return {};
+        }
 
-        switch (val)
+        // The classifiers below follow the same rules as decodeBySwitch, one
+        // opcode word at a time, so they can run at compile time.
+
+        constexpr DecoderFn classifyFirstGroup(std::uint16_t val)
         {
-        case 0b00000000'00000000:
-            return decodeFirstGroup(mem, idx);
+            constexpr std::uint16_t firstmask  = 0b11110000'00000000;
+            constexpr std::uint16_t secondmask = 0b11111111'00000000;
 
-        case 0b01000000'00000000:
-            return decodeSecondGroup(mem, idx);
+            switch (val & firstmask)
+            {
+            case 0b00000000'00000000:
+                switch (val & secondmask)
+                {
+                // ANDI
+                case 0b00000010'00000000:
+                    return &dec::andi;
 
-        case 0b10000000'00000000:
-            return decodeThirdGroup(mem, idx);
+                    // SUBI
+                case 0b00000100'00000000:
+                    return &dec::subi;
 
-        case 0b11000000'00000000:
-            return decodeFourthGroup(mem, idx);
-        }
+                    // ADDI
+                case 0b00000110'00000000:
+                    return &dec::addi;
 
-        return {};
-    }
+                    // CMPI
+                case 0b00001100'00000000:
+                    return &dec::cmpi;
+                }
+                break;
 
-    DecodedInstruction decodeFirstGroup(ConstExecutableMemoryView mem,
-                                        std::int64_t idx)
-    {
-        constexpr std::uint16_t firstmask  = 0b11110000'00000000;
-        constexpr std::uint16_t secondmask = 0b11111111'00000000;
+                // MOVE / MOVEA
+            case 0b00010000'00000000:
+            case 0b00110000'00000000:
+            case 0b00100000'00000000:
+                return &dec::move;
+            }
 
-        const auto val = *mem.read16(idx);
+            return &unknown;
+        }
 
-        switch (val & firstmask)
+        constexpr DecoderFn classifySecondGroup(std::uint16_t val)
         {
-        case 0b00000000'00000000:
-            switch (val & secondmask)
+            constexpr std::uint16_t firstmask  = 0b11110000'00000000;
+            constexpr std::uint16_t bramask    = 0b11111111'00000000;
+            constexpr std::uint16_t secondmask = 0b11111111'11000000;
+
+            switch (val & firstmask)
             {
-            // ANDI
-            case 0b00000010'00000000:
-                return momiji::dec::andi(mem, idx);
+            // JMP / MOVEM
+            case 0b01000000'00000000:
+                switch (val & secondmask)
+                {
+                // TST
+                case 0b01001010'00000000:
+                case 0b01001010'01000000:
+                case 0b01001010'10000000:
+                    return &dec::tst;
+
+                    // SWAP / PEA
+                case 0b01001000'01000000:
+                    return &dec::swap;
+
+                    // TRAP / RTE / RTS / MOVEC
+                case 0b01001110'01000000:
+                    if ((val & 0b11111111'11110000) == 0b01001110'01000000)
+                    {
+                        return &dec::trap;
+                    }
+
+                    switch (val)
+                    {
+                    // RTE
+                    case 0b01001110'01110011:
+                        return &dec::rte;
+
+                        // RTS
+                    case 0b01001110'01110101:
+                        return &dec::rts;
+
+                        // MOVEC
+                    case 0b01001110'01111010:
+                    case 0b01001110'01111011:
+                        return &dec::movec;
+                    }
+                    break;
+
+                    // JSR
+                case 0b01001110'10000000:
+                    return &dec::jsr;
+
+                    // JMP
+                case 0b01001110'11000000:
+                    return &dec::jmp;
+                }
+                break;
 
-                // SUBI
-            case 0b00000100'00000000:
-                return momiji::dec::subi(mem, idx);
+                // BRA / BSR / Bcc
+            case 0b01100000'00000000:
+                switch (val & bramask)
+                {
+                // BRA
+                case 0b01100000'00000000:
+                    return &dec::bra;
 
-                // ADDI
-            case 0b00000110'00000000:
-                return momiji::dec::addi(mem, idx);
+                    // BSR
+                case 0b01100001'00000000:
+                    return &dec::bsr;
 
-                // CMPI
-            case 0b00001100'00000000:
-                return momiji::dec::cmpi(mem, idx);
+                    // Bcc, probably
+                default:
+                    return &dec::bcc;
+                }
             }
-            break;
 
-            // MOVE / MOVEA
-        case 0b00010000'00000000:
-        case 0b00110000'00000000:
-        case 0b00100000'00000000:
-            return momiji::dec::move(mem, idx);
+            return &unknown;
         }
 
-        return {};
-    }
+        constexpr DecoderFn classifyThirdGroup(std::uint16_t val)
+        {
+            constexpr std::uint16_t firstmask = 0b11110000'11000000;
+            constexpr std::uint16_t divmask   = 0b11110001'11000000;
 
-    DecodedInstruction decodeSecondGroup(ConstExecutableMemoryView mem,
-                                         std::int64_t idx)
-    {
-        constexpr std::uint16_t firstmask  = 0b11110000'00000000;
-        constexpr std::uint16_t bramask    = 0b11111111'00000000;
-        constexpr std::uint16_t secondmask = 0b11111111'11000000;
+            switch (val & firstmask)
+            {
+            // DIVU / DIVS
+            case 0b10000000'11000000:
+                switch (val & divmask)
+                {
+                // DIVU
+                case 0b10000000'11000000:
+                    return &dec::divu;
+
+                    // DIVS
+                case 0b10000001'11000000:
+                    return &dec::divs;
+                }
+                break;
+
+                // OR
+            case 0b10000000'00000000:
+            case 0b10000000'01000000:
+            case 0b10000000'10000000:
+                return &dec::or_instr;
+
+                // SUB
+            case 0b10010000'00000000:
+            case 0b10010000'01000000:
+            case 0b10010000'10000000:
+                return &dec::sub;
+
+                // SUBA
+            case 0b10010000'11000000:
+                return &dec::suba;
+
+                // CMP
+            case 0b10110000'00000000:
+            case 0b10110000'01000000:
+            case 0b10110000'10000000:
+                return &dec::cmp;
+
+                // CMPA
+            case 0b10110000'11000000:
+                return &dec::cmpa;
+            }
 
-        const std::uint16_t val = *mem.read16(idx);
+            return &unknown;
+        }
 
-        switch (val & firstmask)
+        constexpr DecoderFn classifyFourthGroup(std::uint16_t val)
         {
-        // JMP / MOVEM
-        case 0b01000000'00000000:
-            switch (val & secondmask)
+            // Momiji specific control code!
+            if (val == 0xFFFF)
             {
-            // TST
-            case 0b01001010'00000000:
-            case 0b01001010'01000000:
-            case 0b01001010'10000000:
-                return momiji::dec::tst(mem, idx);
-
-                // NOT
-            case 0b01000110'00000000:
-            case 0b01000110'01000000:
-            case 0b01000110'10000000:
-                // return momiji::dec::not_instr(mem, idx);
-                break;
+                return &dec::momijiInternal;
+            }
+
+            constexpr std::uint16_t firstmask = 0b11110000'11000000;
+            constexpr std::uint16_t mulmask   = 0b11110001'11000000;
+
+            // Used to discriminate between AND or EXG
+            constexpr std::uint16_t exgmask = 0b11110001'11001000;
 
-                // SWAP / PEA
-            case 0b01001000'01000000:
-                return momiji::dec::swap(mem, idx);
+            constexpr std::uint16_t memshiftmask = 0b11111111'11000000;
+            constexpr std::uint16_t regshiftmask = 0b11110001'00111000;
 
-                // RTE / RTS / TRAPV / RTR
-            case 0b01001110'01000000:
-                switch (val)
+            switch (val & firstmask)
+            {
+            // MULU / MULS
+            case 0b11000000'11000000:
+                switch (val & mulmask)
                 {
-                // RTS
-                case 0b01001110'01110101:
-                    return momiji::dec::rts(mem, idx);
+                // MULU
+                case 0b11000000'11000000:
+                    return &dec::mulu;
+
+                case 0b11000001'11000000:
+                    return &dec::muls;
                 }
                 break;
 
-                // JSR
-            case 0b01001110'10000000:
-                return momiji::dec::jsr(mem, idx);
+                // AND / EXG
+            case 0b11000000'00000000:
+            case 0b11000000'01000000:
+            case 0b11000000'10000000:
+                switch (val & exgmask)
+                {
+                // Probably an EXG
+                case 0b11000001'01000000:
+                case 0b11000001'01001000:
+                case 0b11000001'10001000:
+                    return &dec::exg;
+
+                    // Hoping for an AND
+                default:
+                    return &dec::and_instr;
+                }
 
-                // JMP
-            case 0b01001110'11000000:
-                return momiji::dec::jmp(mem, idx);
-            }
-            break;
+                // ADD
+            case 0b11010000'00000000:
+            case 0b11010000'01000000:
+            case 0b11010000'10000000:
+                return &dec::add;
 
-            // ADDQ / SUBQ / Scc / DBcc
-        case 0b01010000'00000000:
-            break;
+                // ADDA
+            case 0b11010000'11000000:
+                return &dec::adda;
+            }
 
-            // BRA / BSR / Bcc
-        case 0b01100000'00000000:
-            switch (val & bramask)
+            // Memory Shifts
+            switch (val & memshiftmask)
             {
-            // BRA
-            case 0b01100000'00000000:
-                return momiji::dec::bra(mem, idx);
-
-                // BSR
-            case 0b01100001'00000000:
-                return momiji::dec::bsr(mem, idx);
+            // AS* (mem)
+            case 0b11100000'11000000:
+            case 0b11100001'11000000:
+                return &dec::any_mem_shift<
+                    dec::details::ArithmeticShiftMetaType>;
+
+                // LS* (mem)
+            case 0b11100010'11000000:
+            case 0b11100011'11000000:
+                return &dec::any_mem_shift<dec::details::LogicalShiftMetaType>;
+            }
 
-                // Bcc, probably
-            default:
-                return momiji::dec::bcc(mem, idx);
+            switch (val & regshiftmask)
+            {
+            // AS* (reg)
+            case 0b11100000'00000000:
+            case 0b11100000'00100000:
+            case 0b11100001'00000000:
+            case 0b11100001'00100000:
+                return &dec::any_reg_shift<
+                    dec::details::ArithmeticShiftMetaType>;
+
+                // LS* (reg)
+            case 0b11100000'00001000:
+            case 0b11100000'00101000:
+            case 0b11100001'00001000:
+            case 0b11100001'00101000:
+                return &dec::any_reg_shift<dec::details::LogicalShiftMetaType>;
             }
 
-            // MOVEQ
-        case 0b011100000'00000000:
-            // return momiji::dec::moveq(mem, idx);
-            break;
+            return &unknown;
         }
 
-        return {};
-    }
+        constexpr DecoderFn classify(std::uint16_t val)
+        {
+            switch (val & 0b11000000'00000000)
+            {
+            case 0b00000000'00000000:
+                return classifyFirstGroup(val);
 
-    DecodedInstruction decodeThirdGroup(ConstExecutableMemoryView mem,
-                                        std::int64_t idx)
-    {
-        constexpr std::uint16_t firstmask = 0b11110000'11000000;
-        constexpr std::uint16_t divmask   = 0b11110001'11000000;
+            case 0b01000000'00000000:
+                return classifySecondGroup(val);
 
-        const std::uint16_t val = *mem.read16(idx);
+            case 0b10000000'00000000:
+                return classifyThirdGroup(val);
 
-        switch (val & firstmask)
+            case 0b11000000'00000000:
+                return classifyFourthGroup(val);
+            }
+
+            return &unknown;
+        }
+
+        constexpr auto makeDecoderTable()
         {
-        // DIVU / DIVS
-        case 0b10000000'11000000:
-            switch (val & divmask)
-            {
-            // DIVU
-            case 0b10000000'11000000:
-                return momiji::dec::divu(mem, idx);
+            std::array<DecoderFn, 0x10000> table {};
 
-                // DIVS
-            case 0b10000001'11000000:
-                return momiji::dec::divs(mem, idx);
+            for (std::size_t i = 0; i < table.size(); ++i)
+            {
+                table[i] = classify(std::uint16_t(i));
             }
-            break;
-
-            // OR
-        case 0b10000000'00000000:
-        case 0b10000000'01000000:
-        case 0b10000000'10000000:
-            return momiji::dec::or_instr(mem, idx);
-
-            // SUB
-        case 0b10010000'00000000:
-        case 0b10010000'01000000:
-        case 0b10010000'10000000:
-            return momiji::dec::sub(mem, idx);
-
-            // SUBA
-        case 0b10010000'11000000:
-            return momiji::dec::suba(mem, idx);
-
-            // CMP
-        case 0b10110000'00000000:
-        case 0b10110000'01000000:
-        case 0b10110000'10000000:
-            return momiji::dec::cmp(mem, idx);
-
-            // CMPA
-        case 0b10110000'11000000:
-            return momiji::dec::cmpa(mem, idx);
+
+            return table;
         }
 
-        return {};
-    }
+        // One entry for every opcode word
+        constexpr auto decoderTable = makeDecoderTable();
+    } // namespace
 
-    DecodedInstruction decodeFourthGroup(ConstExecutableMemoryView mem,
-                                         std::int64_t idx)
+    DecodedInstruction decode(momiji::ConstExecutableMemoryView mem,
+                              std::int64_t idx)
     {
-        // Momiji specific control code!
-        if (*mem.read16(idx) == 0xFFFF)
+        const auto val = mem.read16(idx);
+
+        if (!val)
         {
-            return momiji::dec::momijiInternal(mem, idx);
+            return {};
         }
 
-        constexpr std::uint16_t firstmask = 0b11110000'11000000;
-        constexpr std::uint16_t mulmask   = 0b11110001'11000000;
+        auto instr = decoderTable[*val](mem, idx);
+        dec::assignCycles(instr);
 
-        // Used to discriminate between AND or EXG
-        constexpr std::uint16_t exgmask = 0b11110001'11001000;
-
-        constexpr std::uint16_t memshiftmask = 0b11111111'11000000;
-        constexpr std::uint16_t regshiftmask = 0b11110001'00111000;
+        return instr;
+    }
 
-        const auto val = *mem.read16(idx);
+    std::int64_t instructionSize(const DecodedInstruction& instr)
+    {
+        const auto& data = instr.data;
 
-        switch (val & firstmask)
+        switch (instr.type)
         {
-        // MULU / MULS
-        case 0b11000000'11000000:
-            switch (val & mulmask)
+        case InstructionType::Branch:
+        case InstructionType::BranchSubroutine:
+            return utils::to_val(data.operandType[0]) == 0 ? 4 : 2;
+
+        case InstructionType::BranchCondition:
+            return utils::to_val(data.operandType[1]) == 0 ? 4 : 2;
+
+        case InstructionType::MoveControl:
+            return 4;
+
+        // Only memory shifts have an effective address, shifts of a data
+        // register keep their count in addressingMode[0] and an immediate
+        // count isn't an extension word
+        case InstructionType::ArithmeticShiftLeft:
+        case InstructionType::ArithmeticShiftRight:
+        case InstructionType::LogicalShiftLeft:
+        case InstructionType::LogicalShiftRight:
+            if (data.operandType[1] == OperandType::Address)
             {
-            // MULU
-            case 0b11000000'11000000:
-                return momiji::dec::mulu(mem, idx);
+                return 2 + utils::isImmediate(data, 0);
+            }
+
+            return 2;
 
-            case 0b11000001'11000000:
-                return momiji::dec::muls(mem, idx);
+        default:
+            return 2 + utils::isImmediate(data, 0) +
+                   utils::isImmediate(data, 1);
+        }
+    }
+
+    std::optional<std::int64_t>
+    branchTarget(momiji::ConstExecutableMemoryView mem,
+                 std::int64_t pc,
+                 const DecodedInstruction& instr)
+    {
+        const auto& data = instr.data;
+
+        switch (instr.type)
+        {
+        // instr::bra and instr::bsr
+        case InstructionType::Branch:
+        case InstructionType::BranchSubroutine: {
+            auto offset = std::int16_t(utils::to_val(data.operandType[0]));
+
+            if (offset == 0)
+            {
+                offset = std::int16_t(mem.read16(pc + 2).value_or(0));
             }
-            break;
 
-            // AND / EXG
-        case 0b11000000'00000000:
-        case 0b11000000'01000000:
-        case 0b11000000'10000000:
-            switch (val & exgmask)
+            return std::uint32_t(std::int32_t(pc) + offset);
+        }
+
+        // instr::bcc
+        case InstructionType::BranchCondition: {
+            auto offset = std::int16_t(utils::to_val(data.operandType[1]));
+
+            if (offset == 0)
             {
-            // Probably an EXG
-            case 0b11000001'01000000:
-            case 0b11000001'01001000:
-            case 0b11000001'10001000:
-                return momiji::dec::exg(mem, idx);
+                offset = std::int16_t(mem.read16(pc + 2).value_or(0));
+            }
 
-                // Hoping for an AND
-            default:
-                return momiji::dec::and_instr(mem, idx);
+            return std::uint32_t(std::int32_t(pc) + offset);
+        }
+
+        // instr::jmp and instr::jsr
+        case InstructionType::Jmp:
+        case InstructionType::JmpSubroutine:
+            if (data.operandType[0] != OperandType::Immediate)
+            {
+                return std::nullopt;
             }
 
-            // ADD
-        case 0b11010000'00000000:
-        case 0b11010000'01000000:
-        case 0b11010000'10000000:
-            return momiji::dec::add(mem, idx);
+            switch (data.addressingMode[0])
+            {
+            case SpecialAddressingMode::AbsoluteShort:
+                return mem.read16(pc + 2).value_or(0);
 
-            // ADDA
-        case 0b11010000'11000000:
-            return momiji::dec::adda(mem, idx);
-        }
+            case SpecialAddressingMode::AbsoluteLong:
+            case SpecialAddressingMode::Immediate:
+                return mem.read32(pc + 2).value_or(0);
 
-        // Memory Shifts
-        switch (val & memshiftmask)
-        {
-        // AS* (mem)
-        case 0b11100000'11000000:
-        case 0b11100001'11000000:
-            return momiji::dec::any_mem_shift<
-                dec::details::ArithmeticShiftMetaType>(mem, idx);
-
-            // LS* (mem)
-        case 0b11100010'11000000:
-        case 0b11100011'11000000:
-            return momiji::dec::any_mem_shift<
-                dec::details::LogicalShiftMetaType>(mem, idx);
-
-            // ROX* (mem)
-        case 0b11100100'11000000:
-        case 0b11100101'11000000:
-            // return momiji::dec::mem_roxd(mem, idx);
-
-            // RO* (mem)
-        case 0b11100110'11000000:
-        case 0b11100111'11000000:
-            // return momiji::dec::mem_rod(mem, idx);
-            break;
-        }
+            default:
+                return std::nullopt;
+            }
 
-        switch (val & regshiftmask)
-        {
-        // AS* (reg)
-        case 0b11100000'00000000:
-        case 0b11100000'00100000:
-        case 0b11100001'00000000:
-        case 0b11100001'00100000:
-            return momiji::dec::any_reg_shift<
-                dec::details::ArithmeticShiftMetaType>(mem, idx);
-
-            // LS* (reg)
-        case 0b11100000'00001000:
-        case 0b11100000'00101000:
-        case 0b11100001'00001000:
-        case 0b11100001'00101000:
-            return momiji::dec::any_reg_shift<
-                dec::details::LogicalShiftMetaType>(mem, idx);
-
-            // ROX* (reg)
-        case 0b11100000'00010000:
-        case 0b11100000'00110000:
-        case 0b11100001'00010000:
-        case 0b11100001'00110000:
-            // return momiji::dec::reg_roxd(mem, idx);
-
-        case 0b11100000'00011000:
-        case 0b11100000'00111000:
-        case 0b11100001'00011000:
-        case 0b11100001'00111000:
-            // return momiji::dec::reg_rod(mem, idx);
-            break;
+        default:
+            return std::nullopt;
         }
-
-        return {};
     }
 } // namespace momiji
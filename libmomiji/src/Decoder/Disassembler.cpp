@@ -0,0 +1,454 @@
+#include <Decoder.h>
+
+#include <momiji/Utils.h>
+
+#include <algorithm>
+#include <cstdio>
+
+namespace momiji
+{
+    namespace
+    {
+        // Appends formatted text to a caller supplied buffer, keeping room
+        // for the null terminator
+        class TextWriter
+        {
+        public:
+            explicit TextWriter(gsl::span<char> buffer)
+                : m_buffer(buffer)
+            {
+            }
+
+            char* current() noexcept
+            {
+                return m_buffer.data() + m_length;
+            }
+
+            std::size_t remaining() const noexcept
+            {
+                return std::size_t(m_buffer.size() - m_length);
+            }
+
+            void advance(int written) noexcept
+            {
+                if (written > 0)
+                {
+                    m_length = std::min(m_length + written,
+                                        std::int64_t(m_buffer.size() - 1));
+                }
+            }
+
+            std::int64_t length() const noexcept
+            {
+                return m_length;
+            }
+
+        private:
+            gsl::span<char> m_buffer;
+            std::int64_t m_length { 0 };
+        };
+
+        const char* mnemonic(InstructionType type)
+        {
+            switch (type)
+            {
+            case InstructionType::Add:
+                return "add";
+            case InstructionType::AddI:
+                return "addi";
+            case InstructionType::AddA:
+                return "adda";
+            case InstructionType::Sub:
+                return "sub";
+            case InstructionType::SubI:
+                return "subi";
+            case InstructionType::SubA:
+                return "suba";
+            case InstructionType::SignedMul:
+                return "muls";
+            case InstructionType::UnsignedMul:
+                return "mulu";
+            case InstructionType::SignedDiv:
+                return "divs";
+            case InstructionType::UnsignedDiv:
+                return "divu";
+            case InstructionType::Swap:
+                return "swap";
+            case InstructionType::Exchange:
+                return "exg";
+            case InstructionType::Move:
+                return "move";
+            case InstructionType::Or:
+                return "or";
+            case InstructionType::OrI:
+                return "ori";
+            case InstructionType::And:
+                return "and";
+            case InstructionType::AndI:
+                return "andi";
+            case InstructionType::Compare:
+                return "cmp";
+            case InstructionType::CompareI:
+                return "cmpi";
+            case InstructionType::CompareA:
+                return "cmpa";
+            case InstructionType::Tst:
+                return "tst";
+            case InstructionType::Jmp:
+                return "jmp";
+            case InstructionType::JmpSubroutine:
+                return "jsr";
+            case InstructionType::Branch:
+                return "bra";
+            case InstructionType::BranchSubroutine:
+                return "bsr";
+            case InstructionType::ReturnSubroutine:
+                return "rts";
+            case InstructionType::Trap:
+                return "trap";
+            case InstructionType::ReturnException:
+                return "rte";
+            case InstructionType::MoveControl:
+                return "movec";
+            case InstructionType::ArithmeticShiftLeft:
+                return "asl";
+            case InstructionType::ArithmeticShiftRight:
+                return "asr";
+            case InstructionType::LogicalShiftLeft:
+                return "lsl";
+            case InstructionType::LogicalShiftRight:
+                return "lsr";
+            case InstructionType::HaltCatchFire:
+                return "hcf";
+            case InstructionType::Breakpoint:
+                return "breakpoint";
+            default:
+                return "";
+            }
+        }
+
+        const char* branchMnemonic(BranchConditions cond)
+        {
+            switch (cond)
+            {
+            case BranchConditions::True:
+                return "bra";
+            case BranchConditions::False:
+                return "bsr";
+            case BranchConditions::Higher:
+                return "bhi";
+            case BranchConditions::LowerSame:
+                return "bls";
+            case BranchConditions::CarryClear:
+                return "bcc";
+            case BranchConditions::CarrySet:
+                return "bcs";
+            case BranchConditions::NotEqual:
+                return "bne";
+            case BranchConditions::Equal:
+                return "beq";
+            case BranchConditions::OverClear:
+                return "bvc";
+            case BranchConditions::OverSet:
+                return "bvs";
+            case BranchConditions::Plus:
+                return "bpl";
+            case BranchConditions::Minus:
+                return "bmi";
+            case BranchConditions::GreaterEq:
+                return "bge";
+            case BranchConditions::LessThan:
+                return "blt";
+            case BranchConditions::GreaterThan:
+                return "bgt";
+            case BranchConditions::LessEq:
+                return "ble";
+            }
+
+            return "b??";
+        }
+
+        const char* sizeSuffix(std::int8_t size)
+        {
+            switch (size)
+            {
+            case 1:
+                return ".b";
+
+            case 2:
+                return ".w";
+
+            case 4:
+                return ".l";
+            }
+
+            return "";
+        }
+
+        void writeOperand(TextWriter& out,
+                          const DecodedInstruction& instr,
+                          std::int8_t op)
+        {
+            const auto& data  = instr.data;
+            const auto mode   = asl::saccess(data.addressingMode, op);
+            const auto reg    = int(utils::to_val(mode));
+            const auto value  = asl::saccess(instr.operandValues, op);
+            const auto word   = unsigned(std::uint16_t(value));
+            const auto dword  = unsigned(std::uint32_t(value));
+            auto* const dst   = out.current();
+            const auto remain = out.remaining();
+
+            switch (asl::saccess(data.operandType, op))
+            {
+            case OperandType::DataRegister:
+                out.advance(std::snprintf(dst, remain, "d%d", reg));
+                return;
+
+            case OperandType::AddressRegister:
+                out.advance(std::snprintf(dst, remain, "a%d", reg));
+                return;
+
+            case OperandType::AddressPre:
+                out.advance(std::snprintf(dst, remain, "-(a%d)", reg));
+                return;
+
+            case OperandType::AddressPost:
+                out.advance(std::snprintf(dst, remain, "(a%d)+", reg));
+                return;
+
+            case OperandType::Address:
+                out.advance(std::snprintf(dst, remain, "(a%d)", reg));
+                return;
+
+            case OperandType::AddressOffset:
+                out.advance(std::snprintf(dst, remain, "%u(a%d)", word, reg));
+                return;
+
+            case OperandType::AddressIndex: {
+                const auto index  = int((value & 0xF000) >> 12);
+                const auto offset = unsigned(value & 0x00FF);
+
+                out.advance(std::snprintf(dst,
+                                          remain,
+                                          "(%u, a%d, %c%d)",
+                                          offset,
+                                          reg,
+                                          index < 8 ? 'd' : 'a',
+                                          index % 8));
+                return;
+            }
+
+            case OperandType::Immediate:
+                switch (mode)
+                {
+                case SpecialAddressingMode::Immediate:
+                    switch (data.size)
+                    {
+                    case 1:
+                    case 2:
+                        out.advance(std::snprintf(dst, remain, "#%u", word));
+                        return;
+
+                    case 4:
+                        out.advance(std::snprintf(dst, remain, "#%u", dword));
+                        return;
+                    }
+                    break;
+
+                case SpecialAddressingMode::AbsoluteShort:
+                    out.advance(std::snprintf(dst, remain, "%u", word));
+                    return;
+
+                case SpecialAddressingMode::AbsoluteLong:
+                    out.advance(std::snprintf(dst, remain, "%u", dword));
+                    return;
+
+                default:
+                    break;
+                }
+                break;
+            }
+
+            out.advance(std::snprintf(dst, remain, "???"));
+        }
+
+        void writeOperands(TextWriter& out, const DecodedInstruction& instr)
+        {
+            writeOperand(out, instr, 0);
+            out.advance(std::snprintf(out.current(), out.remaining(), ", "));
+            writeOperand(out, instr, 1);
+        }
+
+        void writeShift(TextWriter& out, const DecodedInstruction& instr)
+        {
+            const auto& data = instr.data;
+
+            // (mem)
+            if (data.operandType[1] == OperandType::Address)
+            {
+                writeOperand(out, instr, 0);
+                return;
+            }
+
+            const bool immediate =
+                data.operandType[0] == OperandType::Immediate;
+            const auto rotation = int(utils::to_val(data.addressingMode[0]));
+            const auto datareg  = int(utils::to_val(data.addressingMode[1]));
+
+            out.advance(std::snprintf(out.current(),
+                                      out.remaining(),
+                                      "%c%d, d%d",
+                                      immediate ? '#' : 'd',
+                                      rotation,
+                                      datareg));
+        }
+    } // namespace
+
+    std::int64_t disassemble(const DecodedInstruction& instr,
+                             gsl::span<char> buffer)
+    {
+        if (buffer.size() <= 0)
+        {
+            return 0;
+        }
+
+        buffer[0] = '\0';
+
+        TextWriter out { buffer };
+
+        switch (instr.type)
+        {
+        // op.size src, dst
+        case InstructionType::Add:
+        case InstructionType::AddI:
+        case InstructionType::AddA:
+        case InstructionType::Sub:
+        case InstructionType::SubI:
+        case InstructionType::SubA:
+        case InstructionType::Move:
+        case InstructionType::Or:
+        case InstructionType::OrI:
+        case InstructionType::And:
+        case InstructionType::AndI:
+        case InstructionType::Compare:
+        case InstructionType::CompareI:
+        case InstructionType::CompareA:
+            out.advance(std::snprintf(out.current(),
+                                      out.remaining(),
+                                      "%s%s ",
+                                      mnemonic(instr.type),
+                                      sizeSuffix(instr.data.size)));
+            writeOperands(out, instr);
+            break;
+
+        // op src, dst
+        case InstructionType::SignedMul:
+        case InstructionType::UnsignedMul:
+        case InstructionType::SignedDiv:
+        case InstructionType::UnsignedDiv:
+        case InstructionType::Exchange:
+            out.advance(std::snprintf(
+                out.current(), out.remaining(), "%s ", mnemonic(instr.type)));
+            writeOperands(out, instr);
+            break;
+
+        // op.size dst
+        case InstructionType::Tst:
+            out.advance(std::snprintf(out.current(),
+                                      out.remaining(),
+                                      "%s%s ",
+                                      mnemonic(instr.type),
+                                      sizeSuffix(instr.data.size)));
+            writeOperand(out, instr, 0);
+            break;
+
+        // op dst
+        case InstructionType::Jmp:
+        case InstructionType::JmpSubroutine:
+        case InstructionType::Swap:
+            out.advance(std::snprintf(
+                out.current(), out.remaining(), "%s ", mnemonic(instr.type)));
+            writeOperand(out, instr, 0);
+            break;
+
+        case InstructionType::ArithmeticShiftLeft:
+        case InstructionType::ArithmeticShiftRight:
+        case InstructionType::LogicalShiftLeft:
+        case InstructionType::LogicalShiftRight:
+            out.advance(std::snprintf(
+                out.current(), out.remaining(), "%s ", mnemonic(instr.type)));
+            writeShift(out, instr);
+            break;
+
+        case InstructionType::Branch:
+        case InstructionType::BranchSubroutine:
+            out.advance(std::snprintf(out.current(),
+                                      out.remaining(),
+                                      "%s %d",
+                                      mnemonic(instr.type),
+                                      instr.operandValues[0]));
+            break;
+
+        case InstructionType::BranchCondition: {
+            const auto cond = static_cast<BranchConditions>(
+                utils::to_val(instr.data.operandType[0]));
+
+            out.advance(std::snprintf(out.current(),
+                                      out.remaining(),
+                                      "%s %d",
+                                      branchMnemonic(cond),
+                                      instr.operandValues[0]));
+        }
+        break;
+
+        case InstructionType::Trap:
+            out.advance(std::snprintf(out.current(),
+                                      out.remaining(),
+                                      "%s #%d",
+                                      mnemonic(instr.type),
+                                      instr.operandValues[0]));
+            break;
+
+        // movec rc, reg or movec reg, rc
+        case InstructionType::MoveControl: {
+            const auto& data = instr.data;
+
+            const char* control =
+                utils::to_val(data.addressingMode[1]) != 0 ? "vbr" : "usp";
+            const bool toControl = utils::to_val(data.operandType[1]) != 0;
+
+            out.advance(std::snprintf(
+                out.current(), out.remaining(), "%s ", mnemonic(instr.type)));
+
+            if (!toControl)
+            {
+                out.advance(std::snprintf(
+                    out.current(), out.remaining(), "%s, ", control));
+            }
+
+            writeOperand(out, instr, 0);
+
+            if (toControl)
+            {
+                out.advance(std::snprintf(
+                    out.current(), out.remaining(), ", %s", control));
+            }
+        }
+        break;
+
+        case InstructionType::ReturnSubroutine:
+        case InstructionType::ReturnException:
+        case InstructionType::HaltCatchFire:
+        case InstructionType::Breakpoint:
+            out.advance(std::snprintf(
+                out.current(), out.remaining(), "%s", mnemonic(instr.type)));
+            break;
+
+        default:
+            // Nothing sensible to show
+            break;
+        }
+
+        return out.length();
+    }
+} // namespace momiji
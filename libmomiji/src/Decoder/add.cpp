@@ -41,10 +41,10 @@ namespace momiji::dec
                 static_cast<SpecialAddressingMode>(bits.othmode);
         }
 
-        ret.exec = instr::add;
+        ret.exec = instr::addHandler(ret.data);
 
-        ret.string = "add" + dataTypeToString(ret.data.size) + " " +
-                     commonStringConverter(ret.data, mem, idx);
+        ret.type = InstructionType::Add;
+        readOperandValues(ret, mem, idx);
 
         return ret;
     }
@@ -71,10 +71,10 @@ namespace momiji::dec
         ret.data.addressingMode[1] =
             static_cast<SpecialAddressingMode>(bits.addreg);
 
-        ret.exec = instr::adda;
+        ret.exec = instr::addHandler(ret.data);
 
-        ret.string = "adda" + dataTypeToString(ret.data.size) + " " +
-                     commonStringConverter(ret.data, mem, idx);
+        ret.type = InstructionType::AddA;
+        readOperandValues(ret, mem, idx);
 
         return ret;
     }
@@ -93,15 +93,15 @@ namespace momiji::dec
 
         momiji::assignNormalSize(ret, repr.size);
 
-        ret.exec                   = instr::addi;
         ret.data.operandType[0]    = OperandType::Immediate;
         ret.data.addressingMode[0] = SpecialAddressingMode::Immediate;
         ret.data.operandType[1]    = static_cast<OperandType>(repr.dsttype);
         ret.data.addressingMode[1] =
             static_cast<SpecialAddressingMode>(repr.dstmode);
+        ret.exec = instr::addHandler(ret.data);
 
-        ret.string = "addi" + dataTypeToString(ret.data.size) + " " +
-                     commonStringConverter(ret.data, mem, idx);
+        ret.type = InstructionType::AddI;
+        readOperandValues(ret, mem, idx);
 
         return ret;
     }
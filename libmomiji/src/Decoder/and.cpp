@@ -46,8 +46,8 @@ namespace momiji::dec
 
         ret.exec = instr::and_instr;
 
-        ret.string = "and" + dataTypeToString(ret.data.size) + " " +
-                     commonStringConverter(ret.data, mem, idx);
+        ret.type = InstructionType::And;
+        readOperandValues(ret, mem, idx);
 
         return ret;
     }
@@ -72,8 +72,8 @@ namespace momiji::dec
 
         ret.exec = instr::andi;
 
-        ret.string = "andi" + dataTypeToString(ret.data.size) + " " +
-                     commonStringConverter(ret.data, mem, idx);
+        ret.type = InstructionType::AndI;
+        readOperandValues(ret, mem, idx);
 
         return ret;
     }
@@ -20,64 +20,20 @@ namespace momiji::dec
         ret.data.operandType[1] = static_cast<OperandType>(bits.displacement);
 
         ret.exec = instr::bcc;
-
-        auto cond = static_cast<momiji::BranchConditions>(bits.condition);
-
-        switch (cond)
-        {
-        case BranchConditions::NotEqual:
-            ret.string = "bne ";
-            break;
-
-        case BranchConditions::Equal:
-            ret.string = "beq ";
-            break;
-
-        case BranchConditions::OverClear:
-            break;
-
-        case BranchConditions::OverSet:
-            break;
-
-        case BranchConditions::Plus:
-            break;
-
-        case BranchConditions::Minus:
-            break;
-
-        case BranchConditions::GreaterEq:
-            ret.string = "bge ";
-            break;
-
-        case BranchConditions::LessThan:
-            ret.string = "blt ";
-            break;
-
-        case BranchConditions::GreaterThan:
-            ret.string = "bgt ";
-            break;
-
-        case BranchConditions::LessEq:
-            ret.string = "beq ";
-            break;
-
-        default:
-            ret.string = "b?? ";
-            break;
-        }
+        ret.type = InstructionType::BranchCondition;
 
         const auto displ = [&]() -> std::int16_t {
             auto tmp = std::int16_t(bits.displacement);
 
             if (tmp == 0)
             {
-                tmp = std::int16_t(*mem.read16(idx + 2));
+                tmp = std::int16_t(mem.read16(idx + 2).value_or(0));
             }
 
             return tmp;
         }();
 
-        ret.string += std::to_string(displ);
+        ret.operandValues[0] = displ;
 
         return ret;
     }
@@ -18,15 +18,16 @@ namespace momiji::dec
         ret.data.operandType[0] = static_cast<OperandType>(bits.displacement);
 
         ret.exec = instr::bra;
+        ret.type = InstructionType::Branch;
 
         std::int16_t displ = bits.displacement;
 
         if (displ == 0)
         {
-            displ = std::int16_t(*mem.read16(idx + 2));
+            displ = std::int16_t(mem.read16(idx + 2).value_or(0));
         }
 
-        ret.string = "bra " + std::to_string(displ);
+        ret.operandValues[0] = displ;
 
         return ret;
     }
@@ -44,15 +45,16 @@ namespace momiji::dec
         ret.data.operandType[0] = static_cast<OperandType>(bits.displacement);
 
         ret.exec = instr::bsr;
+        ret.type = InstructionType::BranchSubroutine;
 
         std::int16_t displ = bits.displacement;
 
         if (displ == 0)
         {
-            displ = std::int16_t(*mem.read16(idx + 2));
+            displ = std::int16_t(mem.read16(idx + 2).value_or(0));
         }
 
-        ret.string = "bsr " + std::to_string(displ);
+        ret.operandValues[0] = displ;
 
         return ret;
     }
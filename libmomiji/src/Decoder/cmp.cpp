@@ -31,8 +31,8 @@ namespace momiji::dec
 
         ret.exec = instr::cmp;
 
-        ret.string = "cmp" + dataTypeToString(ret.data.size) + " " +
-                     commonStringConverter(ret.data, mem, idx);
+        ret.type = InstructionType::Compare;
+        readOperandValues(ret, mem, idx);
 
         return ret;
     }
@@ -70,8 +70,8 @@ namespace momiji::dec
 
         ret.exec = instr::cmpa;
 
-        ret.string = "cmpa" + dataTypeToString(ret.data.size) + " " +
-                     commonStringConverter(ret.data, mem, idx);
+        ret.type = InstructionType::CompareA;
+        readOperandValues(ret, mem, idx);
 
         return ret;
     }
@@ -97,8 +97,8 @@ namespace momiji::dec
         ret.data.addressingMode[1] =
             static_cast<SpecialAddressingMode>(bits.dstmode);
 
-        ret.string = "cmpi" + dataTypeToString(ret.data.size) + " " +
-                     commonStringConverter(ret.data, mem, idx);
+        ret.type = InstructionType::CompareI;
+        readOperandValues(ret, mem, idx);
 
         return ret;
     }
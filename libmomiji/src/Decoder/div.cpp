@@ -30,7 +30,8 @@ namespace momiji::dec
 
         ret.exec = instr::divs;
 
-        ret.string = "divs " + commonStringConverter(ret.data, mem, idx);
+        ret.type = InstructionType::SignedDiv;
+        readOperandValues(ret, mem, idx);
 
         return ret;
     }
@@ -57,7 +58,8 @@ namespace momiji::dec
             static_cast<SpecialAddressingMode>(bits.datareg);
         ret.exec = instr::divu;
 
-        ret.string = "divu " + commonStringConverter(ret.data, mem, idx);
+        ret.type = InstructionType::UnsignedDiv;
+        readOperandValues(ret, mem, idx);
 
         return ret;
     }
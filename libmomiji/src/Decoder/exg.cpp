@@ -48,6 +48,7 @@ namespace momiji::dec
         }
 
         ret.exec = instr::exg;
+        ret.type = InstructionType::Exchange;
 
         return ret;
     }
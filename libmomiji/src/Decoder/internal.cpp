@@ -14,12 +14,12 @@ namespace momiji::dec
         switch (controlcode)
         {
         case 0:
-            ret.exec   = instr::hcf;
-            ret.string = "hcf";
+            ret.exec = instr::hcf;
+            ret.type = InstructionType::HaltCatchFire;
             break;
         case 1:
-            ret.exec   = instr::handleBreakpoint;
-            ret.string = "breakpoint";
+            ret.exec = instr::handleBreakpoint;
+            ret.type = InstructionType::Breakpoint;
             break;
         }
 
@@ -24,7 +24,8 @@ namespace momiji::dec
 
         ret.exec = instr::jmp;
 
-        ret.string = "jmp " + opToString(ret.data, 0, mem, idx);
+        ret.type = InstructionType::Jmp;
+        readOperandValues(ret, mem, idx);
 
         return ret;
     }
@@ -46,7 +47,8 @@ namespace momiji::dec
 
         ret.exec = instr::jsr;
 
-        ret.string = "jsr " + opToString(ret.data, 0, mem, idx);
+        ret.type = InstructionType::JmpSubroutine;
+        readOperandValues(ret, mem, idx);
 
         return ret;
     }
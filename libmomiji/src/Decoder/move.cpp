@@ -48,10 +48,10 @@ namespace momiji::dec
         ret.data.operandType[1] = static_cast<OperandType>(repr.dsttype);
         ret.data.addressingMode[1] =
             static_cast<SpecialAddressingMode>(repr.dstmode);
-        ret.exec = momiji::instr::move;
+        ret.exec = momiji::instr::moveHandler(ret.data);
 
-        ret.string = "move" + dataTypeToString(ret.data.size) + " " +
-                     commonStringConverter(ret.data, mem, idx);
+        ret.type = InstructionType::Move;
+        readOperandValues(ret, mem, idx);
 
         return ret;
     }
@@ -31,7 +31,8 @@ namespace momiji::dec
 
         ret.exec = instr::muls;
 
-        ret.string = "muls " + commonStringConverter(ret.data, mem, idx);
+        ret.type = InstructionType::SignedMul;
+        readOperandValues(ret, mem, idx);
 
         return ret;
     }
@@ -60,7 +61,8 @@ namespace momiji::dec
             static_cast<SpecialAddressingMode>(bits.datareg);
         ret.exec = instr::mulu;
 
-        ret.string = "mulu " + commonStringConverter(ret.data, mem, idx);
+        ret.type = InstructionType::UnsignedMul;
+        readOperandValues(ret, mem, idx);
 
         return ret;
     }
@@ -46,8 +46,8 @@ namespace momiji::dec
 
         ret.exec = instr::or_instr;
 
-        ret.string = "or" + dataTypeToString(ret.data.size) + " " +
-                     commonStringConverter(ret.data, mem, idx);
+        ret.type = InstructionType::Or;
+        readOperandValues(ret, mem, idx);
 
         return ret;
     }
@@ -74,8 +74,8 @@ namespace momiji::dec
         ret.data.addressingMode[1] =
             static_cast<SpecialAddressingMode>(bits.dstmode);
 
-        ret.string = "ori" + dataTypeToString(ret.data.size) + " " +
-                     commonStringConverter(ret.data, mem, idx);
+        ret.type = InstructionType::OrI;
+        readOperandValues(ret, mem, idx);
 
         return ret;
     }
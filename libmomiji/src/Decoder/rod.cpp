@@ -9,8 +9,6 @@ namespace momiji::dec
     {
         DecodedInstruction ret;
 
-        ret.string = "rod ";
-
         return ret;
     }
 
@@ -18,8 +16,6 @@ namespace momiji::dec
     {
         DecodedInstruction ret;
 
-        ret.string = "rod ";
-
         return ret;
     }
 } // namespace momiji::dec
@@ -14,8 +14,7 @@ namespace momiji::dec
         ret.data.operandType[1] = OperandType::DataRegister;
 
         ret.exec = instr::rts;
-
-        ret.string = "rts";
+        ret.type = InstructionType::ReturnSubroutine;
 
         return ret;
     }
@@ -19,9 +19,9 @@ namespace momiji::dec
                 return &instr::shift<instr::details::ArithShiftRight>;
             }
 
-            static momiji::InstructionString RightStr()
+            static momiji::InstructionType RightType()
             {
-                return "asr ";
+                return InstructionType::ArithmeticShiftRight;
             }
 
             static momiji::DecodedInstructionFn LeftFn()
@@ -29,9 +29,9 @@ namespace momiji::dec
                 return &instr::shift<instr::details::ArithShiftLeft>;
             }
 
-            static momiji::InstructionString LeftStr()
+            static momiji::InstructionType LeftType()
             {
-                return "asl ";
+                return InstructionType::ArithmeticShiftLeft;
             }
         };
 
@@ -45,9 +45,9 @@ namespace momiji::dec
                 return &instr::shift<instr::details::LogicalShiftRight>;
             }
 
-            static momiji::InstructionString RightStr()
+            static momiji::InstructionType RightType()
             {
-                return "lsr ";
+                return InstructionType::LogicalShiftRight;
             }
 
             static momiji::DecodedInstructionFn LeftFn()
@@ -55,9 +55,9 @@ namespace momiji::dec
                 return &instr::shift<instr::details::LogicalShiftLeft>;
             }
 
-            static momiji::InstructionString LeftStr()
+            static momiji::InstructionType LeftType()
             {
-                return "lsl ";
+                return InstructionType::LogicalShiftLeft;
             }
         };
 
@@ -85,17 +85,17 @@ namespace momiji::dec
 
         if (bits.direction == 0)
         {
-            ret.exec   = ShiftType::RightFn();
-            ret.string = ShiftType::RightStr() +
-                         momiji::opToString(ret.data, 0, mem, idx);
+            ret.exec = ShiftType::RightFn();
+            ret.type = ShiftType::RightType();
         }
         else
         {
-            ret.exec   = ShiftType::LeftFn();
-            ret.string = ShiftType::LeftStr() +
-                         momiji::opToString(ret.data, 0, mem, idx);
+            ret.exec = ShiftType::LeftFn();
+            ret.type = ShiftType::LeftType();
         }
 
+        momiji::readOperandValues(ret, mem, idx);
+
         return ret;
     }
 
@@ -117,13 +117,13 @@ namespace momiji::dec
 
         if (bits.direction == 0)
         {
-            ret.exec   = ShiftType::RightFn();
-            ret.string = ShiftType::RightStr();
+            ret.exec = ShiftType::RightFn();
+            ret.type = ShiftType::RightType();
         }
         else
         {
-            ret.exec   = ShiftType::LeftFn();
-            ret.string = ShiftType::LeftStr();
+            ret.exec = ShiftType::LeftFn();
+            ret.type = ShiftType::LeftType();
         }
 
         ret.data.addressingMode[0] =
@@ -132,20 +132,16 @@ namespace momiji::dec
         if (bits.rotmode == 0)
         {
             ret.data.operandType[0] = OperandType::Immediate;
-            ret.string += "#" + std::to_string(bits.rotation);
         }
         else
         {
             ret.data.operandType[0] = OperandType::DataRegister;
-            ret.string += "d" + std::to_string(bits.rotation);
         }
 
         ret.data.operandType[1] = OperandType::DataRegister;
         ret.data.addressingMode[1] =
             static_cast<SpecialAddressingMode>(bits.datareg);
 
-        ret.string += ", d" + std::to_string(bits.datareg);
-
         return ret;
     }
 } // namespace momiji::dec
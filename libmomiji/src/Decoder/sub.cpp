@@ -45,8 +45,8 @@ namespace momiji::dec
 
         ret.exec = instr::sub;
 
-        ret.string = "sub" + dataTypeToString(ret.data.size) + " " +
-                     commonStringConverter(ret.data, mem, idx);
+        ret.type = InstructionType::Sub;
+        readOperandValues(ret, mem, idx);
 
         return ret;
     }
@@ -74,8 +74,8 @@ namespace momiji::dec
 
         ret.exec = instr::suba;
 
-        ret.string = "suba" + dataTypeToString(ret.data.size) + " " +
-                     commonStringConverter(ret.data, mem, idx);
+        ret.type = InstructionType::SubA;
+        readOperandValues(ret, mem, idx);
 
         return ret;
     }
@@ -101,8 +101,8 @@ namespace momiji::dec
         ret.data.addressingMode[1] =
             static_cast<SpecialAddressingMode>(bits.dstmode);
 
-        ret.string = "subi" + dataTypeToString(ret.data.size) + " " +
-                     commonStringConverter(ret.data, mem, idx);
+        ret.type = InstructionType::SubI;
+        readOperandValues(ret, mem, idx);
 
         return ret;
     }
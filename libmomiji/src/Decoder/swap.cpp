@@ -19,8 +19,8 @@ namespace momiji::dec
         ret.data.addressingMode[0] =
             static_cast<SpecialAddressingMode>(bits.datareg);
 
-        ret.exec   = instr::swap;
-        ret.string = "swap d" + std::to_string(bits.datareg);
+        ret.exec = instr::swap;
+        ret.type = InstructionType::Swap;
 
         return ret;
     }
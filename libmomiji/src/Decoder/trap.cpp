@@ -0,0 +1,74 @@
+#include "trap.h"
+
+#include "../Instructions/trap.h"
+
+namespace momiji::dec
+{
+    namespace
+    {
+        // Control register fields of the movec extension word
+        constexpr std::uint16_t userStackPointer = 0x800;
+        constexpr std::uint16_t vectorBase       = 0x801;
+    } // namespace
+
+    DecodedInstruction trap(ConstExecutableMemoryView mem, std::int64_t idx)
+    {
+        DecodedInstruction ret;
+
+        const std::uint16_t val = *mem.read16(idx);
+
+        // The vector number, as bcc keeps its condition
+        ret.data.operandType[0] = static_cast<OperandType>(val & 0x000F);
+        ret.operandValues[0]    = val & 0x000F;
+
+        ret.exec = instr::trap;
+        ret.type = InstructionType::Trap;
+
+        return ret;
+    }
+
+    DecodedInstruction rte(ConstExecutableMemoryView /*mem*/,
+                           std::int64_t /*idx*/)
+    {
+        DecodedInstruction ret;
+
+        ret.exec = instr::rte;
+        ret.type = InstructionType::ReturnException;
+
+        return ret;
+    }
+
+    DecodedInstruction movec(ConstExecutableMemoryView mem, std::int64_t idx)
+    {
+        const std::uint16_t val = *mem.read16(idx);
+        const std::uint16_t ext = mem.read16(idx + 2).value_or(0);
+
+        const auto control = std::uint16_t(ext & 0x0FFF);
+
+        // Other control registers don't exist on the 68010
+        if (control != userStackPointer && control != vectorBase)
+        {
+            return {};
+        }
+
+        DecodedInstruction ret;
+
+        ret.data.size = 4;
+
+        ret.data.operandType[0] = (ext & 0x8000) != 0
+                                      ? OperandType::AddressRegister
+                                      : OperandType::DataRegister;
+        ret.data.addressingMode[0] =
+            static_cast<SpecialAddressingMode>((ext & 0x7000) >> 12);
+
+        // Direction, then which control register
+        ret.data.operandType[1] = static_cast<OperandType>(val & 0b1);
+        ret.data.addressingMode[1] =
+            static_cast<SpecialAddressingMode>(control & 0b1);
+
+        ret.exec = instr::movec;
+        ret.type = InstructionType::MoveControl;
+
+        return ret;
+    }
+} // namespace momiji::dec
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <momiji/Decoder.h>
+
+namespace momiji::dec
+{
+    DecodedInstruction trap(ConstExecutableMemoryView mem, std::int64_t idx);
+
+    DecodedInstruction rte(ConstExecutableMemoryView mem, std::int64_t idx);
+
+    DecodedInstruction movec(ConstExecutableMemoryView mem, std::int64_t idx);
+} // namespace momiji::dec
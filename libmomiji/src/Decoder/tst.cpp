@@ -27,8 +27,8 @@ namespace momiji::dec
 
         ret.exec = instr::tst;
 
-        ret.string = "tst" + dataTypeToString(ret.data.size) + " " +
-                     opToString(ret.data, 0, mem, idx);
+        ret.type = InstructionType::Tst;
+        readOperandValues(ret, mem, idx);
 
         return ret;
     }
@@ -0,0 +1,385 @@
+#include <momiji/Devices.h>
+
+#include <momiji/Exceptions.h>
+
+#include <asl/types>
+
+#include <limits>
+#include <utility>
+
+namespace momiji
+{
+    namespace
+    {
+        std::uint32_t sizeMask(std::int64_t size)
+        {
+            return size >= 4 ? 0xFFFF'FFFF
+                             : (std::uint32_t(1) << (size * 8)) - 1;
+        }
+
+        // The bytes of a long word register an access at offset covers
+        std::uint32_t registerRead(std::uint32_t reg,
+                                   std::int64_t offset,
+                                   std::int64_t size)
+        {
+            return (reg >> ((offset & 0b11) * 8)) & sizeMask(size);
+        }
+
+        // reg with the bytes an access at offset covers replaced by val
+        std::uint32_t registerWrite(std::uint32_t reg,
+                                    std::int64_t offset,
+                                    std::int64_t size,
+                                    std::uint32_t val)
+        {
+            const auto shift = (offset & 0b11) * 8;
+            const auto mask  = sizeMask(size) << shift;
+
+            return (reg & ~mask) | ((val << shift) & mask);
+        }
+    } // namespace
+
+    const DeviceBus noDevices {};
+
+    bool DeviceBus::attach(std::shared_ptr<Device> device, std::int64_t base)
+    {
+        if (device == nullptr || base < 0 || base % memoryPageSize != 0 ||
+            m_mappings.size() == std::numeric_limits<std::uint8_t>::max())
+        {
+            return false;
+        }
+
+        const auto bytes = std::max(device->size(), std::int64_t(1));
+        const auto first = std::size_t(base / memoryPageSize);
+        const auto last =
+            std::size_t((base + bytes + memoryPageSize - 1) / memoryPageSize);
+
+        if (m_tags.size() <= last)
+        {
+            m_tags.resize(last + 1, 0);
+        }
+
+        if (std::any_of(m_tags.begin() + std::ptrdiff_t(first),
+                        m_tags.begin() + std::ptrdiff_t(last),
+                        [](std::uint8_t tag) { return tag != 0; }))
+        {
+            return false;
+        }
+
+        m_mappings.push_back({ std::move(device), base });
+
+        std::fill(m_tags.begin() + std::ptrdiff_t(first),
+                  m_tags.begin() + std::ptrdiff_t(last),
+                  std::uint8_t(m_mappings.size()));
+
+        m_lastPage = m_tags.size() - 1;
+
+        return true;
+    }
+
+    void DeviceBus::detachAll()
+    {
+        m_tags     = { 0 };
+        m_lastPage = 0;
+        m_mappings.clear();
+    }
+
+    bool DeviceBus::empty() const noexcept
+    {
+        return m_mappings.empty();
+    }
+
+    bool DeviceBus::claimsAny(std::int64_t address,
+                              std::int64_t size) const noexcept
+    {
+        if (m_mappings.empty() || size <= 0)
+        {
+            return false;
+        }
+
+        for (auto page = address / memoryPageSize;
+             page <= (address + size - 1) / memoryPageSize;
+             ++page)
+        {
+            if (tag(page * memoryPageSize) != 0)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    std::uint32_t DeviceBus::read(System& sys,
+                                  std::int64_t address,
+                                  std::int64_t size) const
+    {
+        const auto& mapping = m_mappings[std::size_t(tag(address) - 1)];
+        const auto offset   = address - mapping.base;
+
+        if (offset + size > mapping.device->size())
+        {
+            return 0;
+        }
+
+        return mapping.device->read(sys, offset, size);
+    }
+
+    void DeviceBus::write(System& sys,
+                          std::int64_t address,
+                          std::int64_t size,
+                          std::uint32_t val) const
+    {
+        const auto& mapping = m_mappings[std::size_t(tag(address) - 1)];
+        const auto offset   = address - mapping.base;
+
+        if (offset + size > mapping.device->size())
+        {
+            return;
+        }
+
+        mapping.device->write(sys, offset, size, val);
+    }
+
+    namespace devices
+    {
+        // Console
+
+        std::int64_t Console::size() const noexcept
+        {
+            return 2;
+        }
+
+        std::uint32_t Console::read(System& /*sys*/,
+                                    std::int64_t offset,
+                                    std::int64_t /*size*/)
+        {
+            const bool ready = m_inputPos < m_input.size();
+
+            if (offset == status)
+            {
+                return ready ? 1 : 0;
+            }
+
+            // Nothing to read gives 0
+            if (!ready)
+            {
+                return 0;
+            }
+
+            return std::uint8_t(m_input[m_inputPos++]);
+        }
+
+        void Console::write(System& /*sys*/,
+                            std::int64_t offset,
+                            std::int64_t /*size*/,
+                            std::uint32_t val)
+        {
+            if (offset == data)
+            {
+                m_output.push_back(char(val & 0xFF));
+            }
+        }
+
+        void Console::provideInput(const std::string& input)
+        {
+            // What was read already is dropped
+            m_input.erase(0, m_inputPos);
+            m_inputPos = 0;
+
+            m_input += input;
+        }
+
+        const std::string& Console::output() const noexcept
+        {
+            return m_output;
+        }
+
+        std::string Console::takeOutput()
+        {
+            return std::exchange(m_output, {});
+        }
+
+        // Timer
+
+        Timer::Timer(EventScheduler& scheduler)
+            : m_scheduler(&scheduler)
+        {
+        }
+
+        std::int64_t Timer::size() const noexcept
+        {
+            return 16;
+        }
+
+        void Timer::expire(std::int64_t now)
+        {
+            if (m_period == 0 || now - m_periodStart < m_period)
+            {
+                return;
+            }
+
+            // The next period starts where the last one that ended did
+            m_expired = true;
+            m_periodStart += (now - m_periodStart) / m_period * m_period;
+        }
+
+        void Timer::scheduleExpiry(System& sys)
+        {
+            if (m_scheduler == nullptr)
+            {
+                return;
+            }
+
+            m_scheduler->cancel(m_expiry);
+
+            if (m_period == 0 || m_level == 0)
+            {
+                return;
+            }
+
+            const auto cycle = m_periodStart + m_period;
+
+            // Does nothing once the timer is gone
+            m_expiry = m_scheduler->schedule(
+                cycle, [timer = weak_from_this()](System& sys) {
+                    if (const auto self = timer.lock())
+                    {
+                        self->expire(sys.cycles);
+                        requestInterrupt(sys, std::uint8_t(self->m_level));
+                        self->scheduleExpiry(sys);
+                    }
+                });
+
+            sys.nextEventCycle = std::min(sys.nextEventCycle, cycle);
+        }
+
+        std::uint32_t Timer::registerValue(std::int64_t reg,
+                                           std::int64_t now) const
+        {
+            switch (reg)
+            {
+            case counter:
+                return std::uint32_t(now - m_start);
+
+            case period:
+                return m_period;
+
+            case status:
+                return m_expired ? 1 : 0;
+
+            default:
+                return m_level;
+            }
+        }
+
+        std::uint32_t
+        Timer::read(System& sys, std::int64_t offset, std::int64_t size)
+        {
+            expire(sys.cycles);
+
+            return registerRead(
+                registerValue(offset & ~0b11, sys.cycles), offset, size);
+        }
+
+        void Timer::write(System& sys,
+                          std::int64_t offset,
+                          std::int64_t size,
+                          std::uint32_t val)
+        {
+            const auto now = sys.cycles;
+            const auto reg = offset & ~0b11;
+
+            expire(now);
+
+            const auto value =
+                registerWrite(registerValue(reg, now), offset, size, val);
+
+            switch (reg)
+            {
+            case counter:
+                m_start = now - value;
+                break;
+
+            case period:
+                m_period = value;
+                break;
+
+            case control:
+                m_level = value & StatusRegister::InterruptMask;
+                break;
+
+            default:
+                break;
+            }
+
+            m_periodStart = now;
+            m_expired     = false;
+
+            scheduleExpiry(sys);
+        }
+
+        // Framebuffer
+
+        Framebuffer::Framebuffer(std::int64_t width, std::int64_t height)
+            : m_width(width)
+            , m_height(height)
+            , m_pixels(std::size_t(width * height), 0)
+        {
+        }
+
+        std::int64_t Framebuffer::size() const noexcept
+        {
+            return asl::ssize(m_pixels);
+        }
+
+        std::uint32_t Framebuffer::read(System& /*sys*/,
+                                        std::int64_t offset,
+                                        std::int64_t size)
+        {
+            // Same byte order as memory
+            std::uint32_t val = 0;
+
+            for (std::int64_t i = 0; i < size; ++i)
+            {
+                val |= std::uint32_t(m_pixels[std::size_t(offset + i)])
+                       << (i * 8);
+            }
+
+            return val;
+        }
+
+        void Framebuffer::write(System& /*sys*/,
+                                std::int64_t offset,
+                                std::int64_t size,
+                                std::uint32_t val)
+        {
+            for (std::int64_t i = 0; i < size; ++i)
+            {
+                m_pixels[std::size_t(offset + i)] =
+                    std::uint8_t(val >> (i * 8));
+            }
+
+            ++m_generation;
+        }
+
+        std::int64_t Framebuffer::width() const noexcept
+        {
+            return m_width;
+        }
+
+        std::int64_t Framebuffer::height() const noexcept
+        {
+            return m_height;
+        }
+
+        gsl::span<const std::uint8_t> Framebuffer::pixels() const noexcept
+        {
+            return { m_pixels.data(), asl::ssize(m_pixels) };
+        }
+
+        std::int64_t Framebuffer::generation() const noexcept
+        {
+            return m_generation;
+        }
+    } // namespace devices
+} // namespace momiji
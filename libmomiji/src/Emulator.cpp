@@ -1,10 +1,15 @@
 #include <momiji/Emulator.h>
 
+#include <algorithm>
 #include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
 
 #include <iostream>
 #include <momiji/Compiler.h>
 #include <momiji/Decoder.h>
+#include <momiji/Exceptions.h>
 
 #include "Instructions/bcc.h"
 #include "Instructions/bra.h"
@@ -12,25 +17,107 @@
 
 namespace momiji
 {
+    namespace
+    {
+        bool canContinue(ExecutionStatus status)
+        {
+            switch (status)
+            {
+            case ExecutionStatus::Continue:
+            case ExecutionStatus::BranchTaken:
+            case ExecutionStatus::Returned:
+                return true;
+
+            case ExecutionStatus::Breakpoint:
+            case ExecutionStatus::Trap:
+            case ExecutionStatus::Halt:
+                return false;
+            }
+
+            return false;
+        }
+
+        // The next step serves the trap on the host or enters its handler
+        bool canContinue(const System& sys,
+                         ExecutionStatus status,
+                         bool hostTraps)
+        {
+            if (canContinue(status))
+            {
+                return true;
+            }
+
+            return status == ExecutionStatus::Trap &&
+                   ((hostTraps && TrapServices::serves(sys)) ||
+                    canRaiseException(sys));
+        }
+
+        // The code is already in place, the vector table goes at 0 when
+        // it fits before the code and right after it otherwise
+        void layoutMemory(System& sys, const EmulatorSettings& settings)
+        {
+            auto& mem = sys.mem;
+
+            const auto codeBegin = mem.executableMarker.begin;
+            const auto codeEnd   = mem.executableMarker.end;
+
+            const auto vectorBase =
+                codeBegin >= vectorTableSize ? 0 : (codeEnd + 3) & ~3;
+            const auto freeBegin =
+                std::max(codeEnd, vectorBase + vectorTableSize);
+
+            const auto stackTop = settings.stackTop < 0
+                                      ? settings.addressSpaceSize
+                                      : settings.stackTop & ~1;
+
+            mem.stackMarker.begin =
+                std::max(stackTop - settings.stackSize, std::int64_t(0));
+            mem.stackMarker.end = stackTop;
+
+            mem.staticMarker.begin = settings.dataSectionOffset < 0
+                                         ? freeBegin
+                                         : settings.dataSectionOffset;
+            mem.staticMarker.end =
+                std::max(mem.staticMarker.begin, mem.stackMarker.begin);
+
+            // Only what the program writes to gets allocated
+            mem.underlying().resize(
+                std::max({ settings.addressSpaceSize, stackTop, freeBegin }));
+
+            sys.cpu.vectorBase          = std::uint32_t(vectorBase);
+            sys.cpu.programCounter      = std::uint32_t(codeBegin);
+            sys.cpu.addressRegisters[7] = std::int32_t(stackTop);
+        }
+    } // namespace
+
     Emulator::Emulator()
-        : m_systemStates(1)
-        , m_settings({ 0,
-                       -1,
-                       utils::make_kb(4),
-                       EmulatorSettings::RetainStates::Always,
-                       {} })
+        : m_scheduler(std::make_unique<EventScheduler>())
+        , m_devices(std::make_unique<DeviceBus>())
     {
+        m_system.devices = m_devices.get();
+
+        m_history.configure(m_settings.checkpointInterval,
+                            m_settings.historyMemoryBudget,
+                            m_settings.historySpillPath);
+        m_history.serveHostTraps(m_settings.hostTrapServices);
     }
 
     Emulator::Emulator(EmulatorSettings settings)
-        : m_systemStates(1)
-        , m_settings(std::move(settings))
+        : m_settings(std::move(settings))
+        , m_scheduler(std::make_unique<EventScheduler>())
+        , m_devices(std::make_unique<DeviceBus>())
     {
+        m_system.devices = m_devices.get();
+
+        m_history.configure(m_settings.checkpointInterval,
+                            m_settings.historyMemoryBudget,
+                            m_settings.historySpillPath);
+        m_history.serveHostTraps(m_settings.hostTrapServices);
     }
 
-    const std::vector<momiji::System>& Emulator::getStates() const
+    StateHistoryView Emulator::getStates() const
     {
-        return m_systemStates;
+        return { m_system, m_history };
     }
 
     std::optional<momiji::ParserError>
@@ -45,27 +132,27 @@ namespace momiji
 
         if (res)
         {
-            auto mem = momiji::compile(*res);
+            auto mem = momiji::compile(*res, { m_settings.programStart });
 
             if ((m_settings.stackSize & 0b1) != 0)
             {
                 ++m_settings.stackSize;
             }
 
-            mem.executableMarker.begin = 0;
-            mem.executableMarker.end   = asl::ssize(mem);
-
-            mem.stackMarker.begin = asl::ssize(mem);
-            mem.stackMarker.end = mem.stackMarker.begin + m_settings.stackSize;
-
-            mem.underlying().resize(std::size_t(mem.stackMarker.end), 0);
+            auto lastSys              = m_system;
+            lastSys.mem               = std::move(mem);
+            lastSys.callStack         = {};
+            lastSys.cycles            = 0;
+            lastSys.interruptRequests = 0;
 
-            auto lastSys = m_systemStates.back();
-            lastSys.mem  = std::move(mem);
+            layoutMemory(lastSys, m_settings);
+            m_pageDeduplicator.deduplicate(lastSys.mem.underlying());
 
-            lastSys.cpu.addressRegisters[7] =
-                std::int32_t(lastSys.mem.size() - 2);
-            m_systemStates.emplace_back(std::move(lastSys));
+            auto old = std::exchange(m_system, std::move(lastSys));
+            m_history.replaceSystem(std::move(old), m_system);
+            m_decodeCache.clear();
+            m_threadedCode.clear();
+            m_blockCache.clear();
 
             return std::nullopt;
         }
@@ -75,32 +162,168 @@ namespace momiji
 
     void Emulator::newState(momiji::ExecutableMemory binary)
     {
-        auto lastSys = m_systemStates.back();
-        lastSys.mem  = std::move(binary);
-        auto& mem    = lastSys.mem;
+        auto lastSys              = m_system;
+        lastSys.callStack         = {};
+        lastSys.cycles            = 0;
+        lastSys.interruptRequests = 0;
+
+        // A raw image of the code, loaded at programStart
+        const auto start =
+            std::int64_t(std::max(m_settings.programStart, 0) + 1) & ~1;
+
+        if (binary.executableMarker.begin < 0 && start == 0)
+        {
+            binary.executableMarker.begin = 0;
+            binary.executableMarker.end   = asl::ssize(binary);
+        }
+        else if (binary.executableMarker.begin < 0)
+        {
+            std::vector<std::uint8_t> code(std::size_t(binary.size()), 0);
+            binary.underlying().read(0, { code.data(), asl::ssize(code) });
+
+            ExecutableMemory mem { start + asl::ssize(code) };
+            mem.underlying().write(start, { code.data(), asl::ssize(code) });
+
+            mem.executableMarker.begin = start;
+            mem.executableMarker.end   = asl::ssize(mem);
+
+            binary = std::move(mem);
+        }
+
+        lastSys.mem = std::move(binary);
 
         if ((m_settings.stackSize & 0b1) != 0)
         {
             ++m_settings.stackSize;
         }
 
-        mem.executableMarker.begin = 0;
-        mem.executableMarker.end   = asl::ssize(mem);
+        layoutMemory(lastSys, m_settings);
+        m_pageDeduplicator.deduplicate(lastSys.mem.underlying());
 
-        mem.stackMarker.begin = asl::ssize(mem);
-        mem.stackMarker.end   = mem.stackMarker.begin + m_settings.stackSize;
+        auto old = std::exchange(m_system, std::move(lastSys));
+        m_history.replaceSystem(std::move(old), m_system);
+        m_decodeCache.clear();
+        m_threadedCode.clear();
+        m_blockCache.clear();
+    }
 
-        mem.underlying().resize(std::size_t(mem.stackMarker.end), 0);
-        lastSys.cpu.addressRegisters[7] = std::int32_t(lastSys.mem.size() - 2);
+    bool Emulator::rollback()
+    {
+        return reverseStep();
+    }
+
+    bool Emulator::reverseStep()
+    {
+        if (m_history.position() == 0)
+        {
+            return false;
+        }
 
-        m_systemStates.emplace_back(std::move(lastSys));
+        return applySeek(
+            m_history.seekTo(m_system, m_history.position() - 1));
     }
 
-    bool Emulator::rollback()
+    std::int64_t Emulator::reverseContinue()
+    {
+        std::int64_t steps = 0;
+
+        while (canReverseInProgram() && reverseStep())
+        {
+            ++steps;
+
+            if (atBreakpoint())
+            {
+                break;
+            }
+        }
+
+        return steps;
+    }
+
+    std::int64_t Emulator::reverseUntilWrite(std::int64_t address,
+                                             std::int64_t size)
+    {
+        std::int64_t steps = 0;
+
+        while (canReverseInProgram())
+        {
+            const bool writes =
+                m_history.lastStepWrites(address, address + size);
+
+            if (!reverseStep())
+            {
+                break;
+            }
+
+            ++steps;
+
+            if (writes)
+            {
+                break;
+            }
+        }
+
+        return steps;
+    }
+
+    bool Emulator::canReverseInProgram()
     {
-        if (m_systemStates.size() > 1)
+        // Steps the journal already forgot are run again from a checkpoint
+        return applySeek(m_history.recallLastStep(m_system)) &&
+               !m_history.lastStepLoadsProgram();
+    }
+
+    bool Emulator::atBreakpoint()
+    {
+        if (!canExecute(m_system))
         {
-            m_systemStates.pop_back();
+            return false;
+        }
+
+        const auto& instr = m_decodeCache.fetch(
+            momiji::make_memory_view(m_system),
+            m_system.cpu.programCounter.raw());
+
+        return instr.type == InstructionType::Breakpoint;
+    }
+
+    bool Emulator::seekTo(std::int64_t position)
+    {
+        while (m_history.position() < position)
+        {
+            const auto before = m_history.position();
+            step();
+
+            // Nothing was recorded, it won't get any further
+            if (m_history.position() == before)
+            {
+                return false;
+            }
+        }
+
+        return applySeek(m_history.seekTo(m_system, position));
+    }
+
+    bool Emulator::applySeek(History::SeekResult result)
+    {
+        switch (result)
+        {
+        case History::SeekResult::Failed:
+            return false;
+
+        case History::SeekResult::Undone:
+            invalidateModifiedCode(m_system);
+            rewindScheduler();
+            return true;
+
+        case History::SeekResult::Replaced:
+            // The restored state doesn't have the code we decoded
+            m_system.mem.codeWriteMarker = {};
+            m_system.devices             = m_devices.get();
+            m_decodeCache.clear();
+            m_threadedCode.clear();
+            m_blockCache.clear();
+            rewindScheduler();
             return true;
         }
 
@@ -109,78 +332,423 @@ namespace momiji
 
     bool Emulator::step()
     {
-        auto& lastSys = m_systemStates.back();
+        // Serving or entering the handler of the last instruction's trap
+        // is a step
+        if (m_system.trap.has_value())
+        {
+            return !takeTrap().has_value();
+        }
 
-        if (lastSys.mem.empty())
+        if (!canExecute(m_system))
         {
+            m_trapServices.flush();
             return false;
         }
 
-        const auto pc = lastSys.cpu.programCounter.raw();
-        auto memview  = momiji::make_memory_view(lastSys);
+        // So is entering the handler of an interrupt
+        if (runDueEvents())
+        {
+            return enterInterrupt();
+        }
 
-        auto pcadd = memview.executableMarker.begin + pc;
+        const auto pc = m_system.cpu.programCounter.raw();
+        auto memview  = momiji::make_memory_view(m_system);
 
-        const auto membegin = memview.executableMarker.begin;
-        const auto memend   = memview.executableMarker.end;
+        const auto& instr = m_decodeCache.fetch(memview, pc);
 
-        if (pcadd < membegin || pcadd >= memend)
+        bool stepped = false;
+
+        switch (m_settings.retainStates)
         {
-            return false;
+        case EmulatorSettings::RetainStates::Never:
+            stepped = stepHandleMem(never_retain_states_tag {}, instr);
+            break;
+
+        case EmulatorSettings::RetainStates::Always:
+            stepped = stepHandleMem(always_retain_states_tag {}, instr);
+            break;
+        }
+
+        if (!stepped)
+        {
+            m_trapServices.flush();
+        }
+
+        return stepped;
+    }
+
+    RunResult Emulator::run(RunLimits limits)
+    {
+        return runUntilDepth(limits, -1);
+    }
+
+    RunResult Emulator::stepOut(RunLimits limits)
+    {
+        return runUntilDepth(limits, asl::ssize(m_system.callStack.frames));
+    }
+
+    RunResult Emulator::stepOver(RunLimits limits)
+    {
+        if (canExecute(m_system))
+        {
+            const auto& instr = m_decodeCache.fetch(
+                momiji::make_memory_view(m_system),
+                m_system.cpu.programCounter.raw());
+
+            if (instr.type == InstructionType::BranchSubroutine ||
+                instr.type == InstructionType::JmpSubroutine)
+            {
+                return runUntilDepth(
+                    limits, asl::ssize(m_system.callStack.frames) + 1);
+            }
+        }
+
+        return runUntilDepth({ 1 }, -1);
+    }
+
+    const std::vector<CallFrame>& Emulator::backtrace() const noexcept
+    {
+        return m_system.callStack.frames;
+    }
+
+    RunResult Emulator::runUntilDepth(RunLimits limits,
+                                      std::int64_t returnDepth)
+    {
+        const auto maxInstructions =
+            limits.maxInstructions < 0
+                ? std::numeric_limits<std::int64_t>::max()
+                : limits.maxInstructions;
+
+        // Serving a trap on the host may fault, leaving another one
+        while (m_system.trap.has_value())
+        {
+            if (const auto reason = takeTrap())
+            {
+                return { *reason, 0 };
+            }
         }
 
-        auto instr = momiji::decode(memview, pc);
+        RunResult res { StopReason::OutOfRange, 0 };
+
+        m_system.callStack.returnDepth = returnDepth;
+
+        // Anything scheduled since the last run
+        updateNextEvent();
 
         switch (m_settings.retainStates)
         {
         case EmulatorSettings::RetainStates::Never:
-            return stepHandleMem(never_retain_states_tag {}, instr);
+            res = runLoop(never_retain_states_tag {}, maxInstructions);
+            break;
 
         case EmulatorSettings::RetainStates::Always:
-            return stepHandleMem(always_retain_states_tag {}, instr);
+            res = runLoop(always_retain_states_tag {}, maxInstructions);
+            break;
         }
 
-        return false;
+        m_system.callStack.returnDepth = -1;
+        m_trapServices.flush();
+
+        return res;
     }
 
-    bool Emulator::stepHandleMem(never_retain_states_tag /*unused*/,
-                                 DecodedInstruction& instr)
+    template <typename RetainStatesTag>
+    RunResult Emulator::runLoop(RetainStatesTag /*unused*/,
+                                std::int64_t maxInstructions)
     {
-        auto& lastSys = m_systemStates.back();
+        constexpr bool retain =
+            std::is_same_v<RetainStatesTag, always_retain_states_tag>;
+
+        if (m_system.mem.empty())
+        {
+            return { StopReason::OutOfRange, 0 };
+        }
+
+        // Instructions never replace the memory, so neither the view nor the
+        // executable region move while running
+        const ConstExecutableMemoryView memview = m_system.mem;
+        const auto codeBegin = m_system.mem.executableMarker.begin;
+        const auto codeEnd   = m_system.mem.executableMarker.end;
+
+        const auto backend = m_settings.backend;
+        const bool blocks =
+            backend == EmulatorSettings::Backend::BasicBlocks ||
+            backend == EmulatorSettings::Backend::Jit;
+
+        auto* history = retain ? &m_history : nullptr;
+
+        m_blockCache.enableNativeCode(backend ==
+                                      EmulatorSettings::Backend::Jit);
+        m_blockCache.enableMemoryIdioms(m_settings.accelerateMemoryIdioms);
+
+        std::int64_t executed = 0;
+
+        while (executed < maxInstructions)
+        {
+            if (m_system.cycles >= m_system.nextEventCycle &&
+                runDueEvents() && !enterInterrupt())
+            {
+                return { StopReason::Trap, executed };
+            }
+
+            const auto pc = std::int64_t(m_system.cpu.programCounter.raw());
+
+            if (pc < codeBegin || pc >= codeEnd)
+            {
+                return { StopReason::OutOfRange, executed };
+            }
+
+            auto status = ExecutionStatus::Continue;
+
+            // Translated code only gives back control when something needs
+            // the emulator, odd addresses always go through the cache
+            if (backend != EmulatorSettings::Backend::Interpreter &&
+                (pc & 0b1) == 0)
+            {
+                const auto exit =
+                    blocks ? m_blockCache.run(
+                                 m_system, history, maxInstructions - executed)
+                           : m_threadedCode.run(
+                                 m_system, history, maxInstructions - executed);
+
+                status = exit.status;
+                executed += exit.executed;
+            }
+            else
+            {
+                const auto& instr = m_decodeCache.fetch(memview, pc);
+
+                if constexpr (retain)
+                {
+                    m_history.beginStep(m_system);
+                }
 
-        instr.exec(lastSys, instr.data);
+                status = instr.exec(m_system, instr.data);
+                m_system.cycles += cyclesOf(instr.data, status);
 
-        // handlePC(lastSys, instr);
+                if constexpr (retain)
+                {
+                    m_history.endStep(m_system);
+                }
 
-        return true;
+                ++executed;
+            }
+
+            invalidateModifiedCode(m_system);
+
+            switch (status)
+            {
+            case ExecutionStatus::Continue:
+            case ExecutionStatus::BranchTaken:
+                break;
+
+            case ExecutionStatus::Breakpoint:
+                return { StopReason::Breakpoint, executed };
+
+            case ExecutionStatus::Trap:
+                while (m_system.trap.has_value())
+                {
+                    if (const auto reason = takeTrap())
+                    {
+                        return { *reason, executed };
+                    }
+                }
+                break;
+
+            case ExecutionStatus::Halt:
+                return { StopReason::Halt, executed };
+
+            case ExecutionStatus::Returned:
+                return { StopReason::Returned, executed };
+            }
+        }
+
+        return { StopReason::InstructionLimit, executed };
+    }
+
+    bool Emulator::stepHandleMem(never_retain_states_tag /*unused*/,
+                                 const DecodedInstruction& instr)
+    {
+        const auto status = instr.exec(m_system, instr.data);
+        m_system.cycles += cyclesOf(instr.data, status);
+        invalidateModifiedCode(m_system);
+
+        return canContinue(m_system, status, m_settings.hostTrapServices);
     }
 
     bool Emulator::stepHandleMem(always_retain_states_tag /*unused*/,
-                                 DecodedInstruction& instr)
+                                 const DecodedInstruction& instr)
     {
-        auto& lastSys = m_systemStates.back();
+        // Only what the instruction overwrites is kept
+        m_history.beginStep(m_system);
 
-        // Copy the new state
-        auto newstate = lastSys;
+        const auto status = instr.exec(m_system, instr.data);
+        m_system.cycles += cyclesOf(instr.data, status);
 
-        instr.exec(newstate, instr.data);
+        m_history.endStep(m_system);
+        invalidateModifiedCode(m_system);
 
-        // handlePC(newstate, instr);
+        return canContinue(m_system, status, m_settings.hostTrapServices);
+    }
 
-        m_systemStates.emplace_back(std::move(newstate));
+    bool Emulator::enterException()
+    {
+        if (!canRaiseException(m_system))
+        {
+            return false;
+        }
 
-        return true;
+        const bool retain = m_settings.retainStates ==
+                            EmulatorSettings::RetainStates::Always;
+
+        if (retain)
+        {
+            m_history.beginStep(m_system);
+        }
+
+        const bool raised = raiseException(m_system);
+
+        if (retain)
+        {
+            m_history.endStep(m_system);
+        }
+
+        invalidateModifiedCode(m_system);
+
+        return raised;
     }
 
-    bool Emulator::reset()
+    std::optional<StopReason> Emulator::takeTrap()
+    {
+        if (!m_settings.hostTrapServices || !TrapServices::serves(m_system))
+        {
+            if (!enterException())
+            {
+                m_trapServices.flush();
+                return StopReason::Trap;
+            }
+
+            return std::nullopt;
+        }
+
+        const bool retain = m_settings.retainStates ==
+                            EmulatorSettings::RetainStates::Always;
+
+        if (retain)
+        {
+            m_history.beginStep(m_system);
+        }
+
+        const auto result = m_trapServices.run(m_system);
+
+        if (retain)
+        {
+            m_history.recordHostInput(m_trapServices.replayInput());
+            m_history.endStep(m_system);
+        }
+
+        // Task 2 may read a line over the code
+        invalidateModifiedCode(m_system);
+
+        if (result == TrapServices::Result::Halt)
+        {
+            m_trapServices.flush();
+            return StopReason::Halt;
+        }
+
+        return std::nullopt;
+    }
+
+    void Emulator::updateNextEvent()
+    {
+        m_system.nextEventCycle = pendingInterrupt(m_system) != 0
+                                      ? m_system.cycles
+                                      : m_scheduler->nextCycle();
+    }
+
+    bool Emulator::runDueEvents()
+    {
+        const auto position = m_history.position();
+
+        if (m_settings.retainStates == EmulatorSettings::RetainStates::Always &&
+            m_scheduler->nextCycle() <= m_system.cycles &&
+            (m_schedulerSnapshots.empty() ||
+             m_schedulerSnapshots.back().position < position))
+        {
+            m_schedulerSnapshots.push_back({ position, *m_scheduler });
+        }
+
+        m_scheduler->runDue(m_system);
+        updateNextEvent();
+
+        return pendingInterrupt(m_system) != 0;
+    }
+
+    void Emulator::rewindScheduler()
+    {
+        // States already show what the events due at their position did,
+        // the first events to put back ran after the current one
+        const auto it = std::find_if(
+            m_schedulerSnapshots.begin(),
+            m_schedulerSnapshots.end(),
+            [position = m_history.position()](const SchedulerSnapshot& snap) {
+                return snap.position > position;
+            });
+
+        if (it == m_schedulerSnapshots.end())
+        {
+            return;
+        }
+
+        m_scheduler->restore(it->scheduler);
+        m_schedulerSnapshots.erase(it, m_schedulerSnapshots.end());
+        updateNextEvent();
+    }
+
+    bool Emulator::enterInterrupt()
     {
-        bool ret = false;
-        while (m_systemStates.size() > 1)
+        m_system.trap = traps::Interrupt { pendingInterrupt(m_system) };
+
+        const bool entered = enterException();
+        updateNextEvent();
+
+        return entered;
+    }
+
+    void Emulator::invalidateModifiedCode(momiji::System& sys)
+    {
+        auto& written = sys.mem.codeWriteMarker;
+
+        if (written.begin < 0)
         {
-            m_systemStates.pop_back();
-            ret = true;
+            return;
         }
 
+        const auto codeBegin = sys.mem.executableMarker.begin;
+        m_decodeCache.invalidate(written.begin - codeBegin,
+                                 written.end - codeBegin);
+        m_threadedCode.invalidate(make_memory_view(std::as_const(sys)),
+                                  written.begin - codeBegin,
+                                  written.end - codeBegin);
+        m_blockCache.invalidate(written.begin - codeBegin,
+                                written.end - codeBegin);
+
+        written = {};
+    }
+
+    bool Emulator::reset()
+    {
+        // The first state is always an empty system
+        const bool ret = m_history.position() > 0;
+
+        m_system         = {};
+        m_system.devices = m_devices.get();
+        m_history.clear();
+        m_schedulerSnapshots.clear();
+        m_decodeCache.clear();
+        m_threadedCode.clear();
+        m_blockCache.clear();
+
         return ret;
     }
 
@@ -188,7 +756,11 @@ namespace momiji
     {
         reset();
 
-        m_settings = settings;
+        m_settings = std::move(settings);
+        m_history.configure(m_settings.checkpointInterval,
+                            m_settings.historyMemoryBudget,
+                            m_settings.historySpillPath);
+        m_history.serveHostTraps(m_settings.hostTrapServices);
     }
 
     [[nodiscard]] EmulatorSettings Emulator::getSettings() const noexcept
@@ -196,10 +768,47 @@ namespace momiji
         return m_settings;
     }
 
+    bool Emulator::attachDevice(std::shared_ptr<Device> device,
+                                std::int64_t base)
+    {
+        return m_devices->attach(std::move(device), base);
+    }
+
+    void Emulator::detachDevices()
+    {
+        m_devices->detachAll();
+    }
+
+    EventScheduler& Emulator::scheduler() noexcept
+    {
+        return *m_scheduler;
+    }
+
+    void Emulator::requestInterrupt(std::uint8_t level)
+    {
+        momiji::requestInterrupt(m_system, level);
+    }
+
+    TrapServices& Emulator::trapServices() noexcept
+    {
+        return m_trapServices;
+    }
+
+    [[nodiscard]] EmulatorStatistics Emulator::getStatistics() const noexcept
+    {
+        return { m_decodeCache.hits(),
+                 m_decodeCache.misses(),
+                 m_history.memoryUsage(),
+                 m_history.checkpointCount(),
+                 m_history.spilledCheckpointCount(),
+                 m_blockCache.fusionHits(FusedPair::CompareBranch),
+                 m_blockCache.fusionHits(FusedPair::TestBranch),
+                 m_blockCache.fusionHits(FusedPair::MoveTest),
+                 m_system.mem.underlying().materializedPageCount() };
+    }
+
     void continueEmulatorExecution(Emulator& emu) noexcept
     {
-        while (emu.step())
-        {
-        }
+        emu.run();
     }
 } // namespace momiji
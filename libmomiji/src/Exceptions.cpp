@@ -0,0 +1,278 @@
+#include <momiji/Exceptions.h>
+
+#include <momiji/Bus.h>
+#include <momiji/Utils.h>
+
+#include <algorithm>
+#include <optional>
+#include <variant>
+
+namespace momiji
+{
+    namespace
+    {
+        // PC and status register
+        constexpr std::int64_t shortFrameSize = 6;
+
+        // Bus and address errors also save the status word, the address
+        // accessed and the instruction register
+        constexpr std::int64_t longFrameSize = 14;
+
+        // Status word of the long frame: read or write, then the function
+        // code of a data access
+        constexpr std::uint16_t readAccess     = 1 << 4;
+        constexpr std::uint16_t userData       = 0b001;
+        constexpr std::uint16_t supervisorData = 0b101;
+
+        struct AccessFault
+        {
+            std::int32_t address;
+            bool write;
+        };
+
+        std::optional<AccessFault> accessFaultOf(const TrapType& trap)
+        {
+            if (const auto* read = std::get_if<traps::InvalidMemoryRead>(&trap))
+            {
+                return AccessFault { read->address, false };
+            }
+
+            if (const auto* write =
+                    std::get_if<traps::InvalidMemoryWrite>(&trap))
+            {
+                return AccessFault { write->address, true };
+            }
+
+            if (const auto* odd = std::get_if<traps::AddressError>(&trap))
+            {
+                return AccessFault { odd->address, odd->write };
+            }
+
+            return std::nullopt;
+        }
+
+        // Where the exception frame of sys.trap goes, nothing when there's
+        // no handler or the frame doesn't fit on the supervisor stack
+        std::optional<std::int64_t> frameAddress(const System& sys)
+        {
+            const auto handler = exceptionHandler(sys);
+
+            // A handler at an odd address would fault again right away
+            if (handler == 0 || (handler & 0b1) != 0)
+            {
+                return std::nullopt;
+            }
+
+            const auto& cpu = sys.cpu;
+
+            const auto sp =
+                std::int64_t(cpu.statusRegister.supervisor()
+                                 ? cpu.addressRegisters[7].raw()
+                                 : cpu.inactiveStackPointer.raw());
+
+            const auto frame =
+                sp - (accessFaultOf(*sys.trap) ? longFrameSize
+                                               : shortFrameSize);
+
+            if (frame < 0 || sp > asl::ssize(sys.mem) || (frame & 0b1) != 0)
+            {
+                return std::nullopt;
+            }
+
+            return frame;
+        }
+
+        // Exception processing times, table 8-14 of the MC68000 User's
+        // Manual with the instructions' own share left to them
+        std::int64_t exceptionCycles(const TrapType& trap)
+        {
+            if (accessFaultOf(trap))
+            {
+                return 50;
+            }
+
+            if (std::holds_alternative<traps::Interrupt>(trap))
+            {
+                return 44;
+            }
+
+            if (std::holds_alternative<traps::DivisionByZero>(trap))
+            {
+                return 38;
+            }
+
+            return 34;
+        }
+    } // namespace
+
+    std::uint8_t vectorOf(const TrapType& trap)
+    {
+        std::uint8_t vector = 0;
+
+        // clang-format off
+        std::visit(asl::overloaded {
+            [&](const traps::InvalidMemoryRead& /* unused */) {
+                vector = vectors::busError;
+            },
+
+            [&](const traps::InvalidMemoryWrite& /* unused */) {
+                vector = vectors::busError;
+            },
+
+            [&](const traps::AddressError& /* unused */) {
+                vector = vectors::addressError;
+            },
+
+            [&](const traps::IllegalInstruction& /* unused */) {
+                vector = vectors::illegalInstruction;
+            },
+
+            [&](const traps::DivisionByZero& /* unused */) {
+                vector = vectors::zeroDivide;
+            },
+
+            [&](const traps::PrivilegeViolation& /* unused */) {
+                vector = vectors::privilegeViolation;
+            },
+
+            [&](const traps::Trap& trap) {
+                vector = std::uint8_t(vectors::trap + (trap.number & 0xF));
+            },
+
+            [&](const traps::Interrupt& interrupt) {
+                vector = std::uint8_t(vectors::autovector +
+                                      (interrupt.level & 0b111));
+            },
+        }, trap);
+        // clang-format on
+
+        return vector;
+    }
+
+    std::uint32_t exceptionHandler(const System& sys)
+    {
+        if (!sys.trap.has_value())
+        {
+            return 0;
+        }
+
+        const auto entry =
+            std::int64_t(sys.cpu.vectorBase) + vectorOf(*sys.trap) * 4;
+
+        if (entry < 0 || entry > asl::ssize(sys.mem) - 4)
+        {
+            return 0;
+        }
+
+        return sys.mem.load<std::uint32_t>(entry);
+    }
+
+    bool canRaiseException(const System& sys)
+    {
+        return frameAddress(sys).has_value();
+    }
+
+    bool raiseException(System& sys)
+    {
+        const auto frame = frameAddress(sys);
+
+        if (!frame)
+        {
+            return false;
+        }
+
+        auto& cpu = sys.cpu;
+
+        const bool wasSupervisor = cpu.statusRegister.supervisor();
+        const auto status        = cpu.statusRegister.word();
+        const auto fault         = accessFaultOf(*sys.trap);
+        const auto handler       = exceptionHandler(sys);
+
+        auto newStatus = std::uint16_t(
+            (status | (StatusRegister::Supervisor << 8)) &
+            ~(StatusRegister::Trace << 8));
+
+        // Acknowledged, interrupts of the same level or lower wait for the
+        // handler
+        if (const auto* interrupt = std::get_if<traps::Interrupt>(&*sys.trap))
+        {
+            sys.interruptRequests = std::uint8_t(sys.interruptRequests &
+                                                 ~(1 << interrupt->level));
+
+            newStatus = std::uint16_t(
+                (newStatus & ~(StatusRegister::InterruptMask << 8)) |
+                ((interrupt->level & StatusRegister::InterruptMask) << 8));
+        }
+
+        sys.cycles += exceptionCycles(*sys.trap);
+        sys.trap = std::nullopt;
+
+        cpu.setStatusWord(newStatus);
+
+        auto& ssp = cpu.addressRegisters[7];
+        ssp       = std::int32_t(*frame);
+
+        auto offset = *frame;
+
+        if (fault)
+        {
+            const auto access =
+                std::uint16_t((fault->write ? 0 : readAccess) |
+                              (wasSupervisor ? supervisorData : userData));
+
+            bus::write(sys, offset, access);
+            bus::write(sys, offset + 2, std::uint32_t(fault->address));
+
+            // The opcode isn't kept once the instruction ran
+            bus::write(sys, offset + 6, std::uint16_t(0));
+
+            offset += longFrameSize - shortFrameSize;
+        }
+
+        bus::write(sys, offset, status);
+        bus::write(sys, offset + 2, cpu.programCounter.raw());
+
+        cpu.programCounter = handler;
+
+        return true;
+    }
+
+    void requestInterrupt(System& sys, std::uint8_t level)
+    {
+        if (level == 0 || level > 7)
+        {
+            return;
+        }
+
+        sys.interruptRequests =
+            std::uint8_t(sys.interruptRequests | (1 << level));
+
+        checkInterrupts(sys);
+    }
+
+    std::uint8_t pendingInterrupt(const System& sys)
+    {
+        const auto mask = sys.cpu.statusRegister.interruptMask();
+
+        for (std::uint8_t level = 7; level > 0; --level)
+        {
+            if ((sys.interruptRequests & (1 << level)) == 0)
+            {
+                continue;
+            }
+
+            // Level 7 can't be masked
+            return level > mask || level == 7 ? level : 0;
+        }
+
+        return 0;
+    }
+
+    void checkInterrupts(System& sys)
+    {
+        if (pendingInterrupt(sys) != 0)
+        {
+            sys.nextEventCycle = std::min(sys.nextEventCycle, sys.cycles);
+        }
+    }
+} // namespace momiji
@@ -0,0 +1,972 @@
+#include <momiji/History.h>
+
+#include <momiji/Decoder.h>
+#include <momiji/Exceptions.h>
+#include <momiji/TrapServices.h>
+
+#include <asl/detect_features>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <type_traits>
+#include <utility>
+
+#ifdef ASL_WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+namespace momiji
+{
+    namespace
+    {
+        constexpr std::int64_t defaultCheckpointInterval = 1024;
+        constexpr std::int64_t minimumSpillFileSize      = utils::make_mb(1);
+
+        // What comes before the memory of a spilled system, the frames of
+        // its call stack come after it
+        struct SpilledSystem
+        {
+            Cpu cpu;
+            std::optional<TrapType> trap;
+            std::int64_t cycles;
+            std::int64_t nextEventCycle;
+            std::uint8_t interruptRequests;
+
+            // executable, stack and static begin/end
+            std::array<std::int64_t, 6> markers;
+            std::int64_t memorySize;
+
+            // Pages written to, each one is its index then its bytes
+            std::int64_t pageCount;
+            std::int64_t frameCount;
+        };
+
+        constexpr auto spilledPageSize =
+            std::int64_t(sizeof(std::int64_t)) + memoryPageSize;
+
+        static_assert(std::is_trivially_copyable_v<SpilledSystem>);
+        static_assert(std::is_trivially_copyable_v<CallFrame>);
+
+        // Same as Emulator::step, without caching or recording anything
+        bool replayStep(System& sys, bool hostTraps, std::string_view input)
+        {
+            // With the input the step read, see serveHostTraps
+            if (hostTraps && TrapServices::serves(sys))
+            {
+                TrapServices services;
+                services.setOutput({});
+                services.provideInput(input);
+                services.run(sys);
+
+                return true;
+            }
+
+            // The step entering the handler of the trap
+            if (sys.trap.has_value())
+            {
+                return raiseException(sys);
+            }
+
+            if (!canExecute(sys))
+            {
+                return false;
+            }
+
+            const auto instr =
+                decode(make_memory_view(sys), sys.cpu.programCounter.raw());
+            sys.cycles += cyclesOf(instr.data, instr.exec(sys, instr.data));
+
+            return true;
+        }
+
+        std::int64_t unsharedBytes(const System& sys, const System& prev)
+        {
+            const auto& pages     = sys.mem.underlying();
+            const auto& prevPages = prev.mem.underlying();
+            const auto common = std::min(pages.pageCount(), prevPages.pageCount());
+
+            std::int64_t unshared = pages.pageCount() - common;
+
+            for (std::int64_t i = 0; i < common; ++i)
+            {
+                if (!pages.sharesPage(prevPages, i))
+                {
+                    ++unshared;
+                }
+            }
+
+            return std::int64_t(sizeof(System)) + unshared * memoryPageSize;
+        }
+    } // namespace
+
+    // SpillFile
+
+    SpillFile::SpillFile(SpillFile&& oth) noexcept
+        : m_data(std::exchange(oth.m_data, nullptr))
+        , m_size(std::exchange(oth.m_size, 0))
+        , m_capacity(std::exchange(oth.m_capacity, 0))
+        , m_file(std::exchange(oth.m_file, -1))
+        , m_mapping(std::exchange(oth.m_mapping, 0))
+    {
+    }
+
+    SpillFile& SpillFile::operator=(SpillFile&& oth) noexcept
+    {
+        if (this != &oth)
+        {
+            close();
+
+            m_data     = std::exchange(oth.m_data, nullptr);
+            m_size     = std::exchange(oth.m_size, 0);
+            m_capacity = std::exchange(oth.m_capacity, 0);
+            m_file     = std::exchange(oth.m_file, -1);
+            m_mapping  = std::exchange(oth.m_mapping, 0);
+        }
+
+        return *this;
+    }
+
+    SpillFile::~SpillFile()
+    {
+        close();
+    }
+
+    bool SpillFile::open(const std::string& path)
+    {
+        close();
+
+#ifdef ASL_WIN32
+        DWORD flags = FILE_ATTRIBUTE_TEMPORARY;
+        std::string name = path;
+
+        if (name.empty())
+        {
+            std::array<char, MAX_PATH + 1> dir {};
+            std::array<char, MAX_PATH + 1> file {};
+
+            if (GetTempPathA(DWORD(dir.size()), dir.data()) == 0 ||
+                GetTempFileNameA(dir.data(), "mji", 0, file.data()) == 0)
+            {
+                return false;
+            }
+
+            name = file.data();
+            flags |= FILE_FLAG_DELETE_ON_CLOSE;
+        }
+
+        const auto handle = CreateFileA(name.c_str(),
+                                        GENERIC_READ | GENERIC_WRITE,
+                                        0,
+                                        nullptr,
+                                        CREATE_ALWAYS,
+                                        flags,
+                                        nullptr);
+
+        if (handle == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        m_file = reinterpret_cast<std::intptr_t>(handle);
+#else
+        int fd = -1;
+
+        if (path.empty())
+        {
+            std::error_code error;
+            auto name = std::filesystem::temp_directory_path(error);
+
+            if (error)
+            {
+                return false;
+            }
+
+            auto tmpl = (name / "momiji-history-XXXXXX").string();
+
+            fd = ::mkstemp(tmpl.data());
+
+            if (fd >= 0)
+            {
+                ::unlink(tmpl.c_str());
+            }
+        }
+        else
+        {
+            fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        }
+
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        m_file = fd;
+#endif
+
+        return true;
+    }
+
+    void SpillFile::close()
+    {
+        unmap();
+
+        if (m_file != -1)
+        {
+#ifdef ASL_WIN32
+            CloseHandle(reinterpret_cast<HANDLE>(m_file));
+#else
+            ::close(int(m_file));
+#endif
+        }
+
+        m_file     = -1;
+        m_size     = 0;
+        m_capacity = 0;
+    }
+
+    bool SpillFile::isOpen() const noexcept
+    {
+        return m_file != -1;
+    }
+
+    std::int64_t SpillFile::append(gsl::span<const std::uint8_t> bytes)
+    {
+        const auto offset = m_size;
+        const auto needed = m_size + bytes.size();
+
+        if (needed > m_capacity &&
+            !reserve(std::max(needed, std::max(m_capacity * 2,
+                                               minimumSpillFileSize))))
+        {
+            return -1;
+        }
+
+        std::memcpy(m_data + offset, bytes.data(), std::size_t(bytes.size()));
+        m_size = needed;
+
+        return offset;
+    }
+
+    void SpillFile::truncate(std::int64_t offset) noexcept
+    {
+        m_size = std::min(m_size, std::max(offset, std::int64_t(0)));
+    }
+
+    gsl::span<const std::uint8_t>
+    SpillFile::view(std::int64_t offset, std::int64_t size) const noexcept
+    {
+        return { m_data + offset, size };
+    }
+
+    std::int64_t SpillFile::size() const noexcept
+    {
+        return m_size;
+    }
+
+    bool SpillFile::reserve(std::int64_t capacity)
+    {
+        if (!isOpen())
+        {
+            return false;
+        }
+
+        unmap();
+
+#ifdef ASL_WIN32
+        const auto file    = reinterpret_cast<HANDLE>(m_file);
+        const auto mapping = CreateFileMappingA(file,
+                                                nullptr,
+                                                PAGE_READWRITE,
+                                                DWORD(capacity >> 32),
+                                                DWORD(capacity & 0xFFFFFFFF),
+                                                nullptr);
+
+        if (mapping == nullptr)
+        {
+            return false;
+        }
+
+        auto* data = MapViewOfFile(
+            mapping, FILE_MAP_ALL_ACCESS, 0, 0, SIZE_T(capacity));
+
+        if (data == nullptr)
+        {
+            CloseHandle(mapping);
+            return false;
+        }
+
+        m_mapping = reinterpret_cast<std::intptr_t>(mapping);
+#else
+        if (::ftruncate(int(m_file), off_t(capacity)) != 0)
+        {
+            return false;
+        }
+
+        auto* data = ::mmap(nullptr,
+                            std::size_t(capacity),
+                            PROT_READ | PROT_WRITE,
+                            MAP_SHARED,
+                            int(m_file),
+                            0);
+
+        if (data == MAP_FAILED)
+        {
+            return false;
+        }
+#endif
+
+        m_data     = static_cast<std::uint8_t*>(data);
+        m_capacity = capacity;
+
+        return true;
+    }
+
+    void SpillFile::unmap() noexcept
+    {
+        if (m_data == nullptr)
+        {
+            return;
+        }
+
+#ifdef ASL_WIN32
+        UnmapViewOfFile(m_data);
+        CloseHandle(reinterpret_cast<HANDLE>(m_mapping));
+        m_mapping = 0;
+#else
+        ::munmap(m_data, std::size_t(m_capacity));
+#endif
+
+        m_data = nullptr;
+    }
+
+    // History
+
+    History::History()
+        : m_checkpointInterval(defaultCheckpointInterval)
+    {
+        clear();
+    }
+
+    void History::configure(std::int64_t checkpointInterval,
+                            std::int64_t memoryBudget,
+                            std::string spillPath)
+    {
+        m_checkpointInterval = std::max(checkpointInterval, std::int64_t(1));
+        m_memoryBudget       = memoryBudget;
+
+        if (spillPath != m_spillPath)
+        {
+            // Whatever was spilled to the old file must stay readable
+            m_spillPath = std::move(spillPath);
+
+            if (spilledCheckpointCount() == 0)
+            {
+                m_spillFile.close();
+            }
+        }
+
+        enforceBudget();
+    }
+
+    void History::serveHostTraps(bool enabled) noexcept
+    {
+        m_hostTraps = enabled;
+    }
+
+    void History::beginStep(System& sys)
+    {
+        const auto* interrupt =
+            sys.trap.has_value() ? std::get_if<traps::Interrupt>(&*sys.trap)
+                                 : nullptr;
+
+        m_step = { position(),
+                   sys.nextEventCycle,
+                   sys.interruptRequests,
+                   std::uint8_t(interrupt != nullptr ? interrupt->level : 0) };
+
+        m_logStep = m_logNextStep || interrupt != nullptr ||
+                    sys.nextEventCycle != m_endNextEvent ||
+                    sys.interruptRequests != m_endRequests;
+
+        m_journal.beginStep(sys);
+    }
+
+    void History::endStep(System& sys)
+    {
+        m_journal.endStep(sys);
+
+        if (m_logStep)
+        {
+            m_hostSteps.push_back(m_step);
+        }
+
+        m_logNextStep  = false;
+        m_endNextEvent = sys.nextEventCycle;
+        m_endRequests  = sys.interruptRequests;
+
+        addCheckpointIfDue(sys);
+    }
+
+    void History::recordHostInput(std::string_view input)
+    {
+        if (!input.empty())
+        {
+            m_hostInputs.push_back({ position(), std::string(input) });
+        }
+    }
+
+    void History::replaceSystem(System old, const System& current)
+    {
+        m_journal.replaceSystem(std::move(old));
+
+        // Loading a program can't be replayed
+        addCheckpoint(current);
+        m_checkpoints.back().loadsProgram = true;
+        m_logNextStep                     = true;
+
+        enforceBudget();
+    }
+
+    std::int64_t History::position() const noexcept
+    {
+        return m_journalBase + std::int64_t(m_journal.size());
+    }
+
+    History::SeekResult History::seekTo(System& sys, std::int64_t position)
+    {
+        if (position < 0 || position > this->position())
+        {
+            return SeekResult::Failed;
+        }
+
+        if (position >= m_journalBase)
+        {
+            auto result = SeekResult::Undone;
+
+            while (this->position() > position)
+            {
+                if (m_journal.replacesSystem(m_journal.size() - 1))
+                {
+                    result = SeekResult::Replaced;
+                }
+
+                m_journal.undo(sys);
+            }
+
+            dropCheckpointsAfter(position);
+            forgetHostStepsFrom(position);
+
+            return result;
+        }
+
+        replayTo(sys, closestCheckpoint(position), position);
+        forgetHostStepsFrom(position);
+
+        return SeekResult::Replaced;
+    }
+
+    History::SeekResult History::recallLastStep(System& sys)
+    {
+        if (!m_journal.empty() || lastStepLoadsProgram())
+        {
+            return SeekResult::Undone;
+        }
+
+        // What the host did since the last step isn't logged yet
+        const auto nextEvent = sys.nextEventCycle;
+        const auto requests  = sys.interruptRequests;
+
+        replayTo(sys, closestCheckpoint(position() - 1), position());
+
+        sys.nextEventCycle    = nextEvent;
+        sys.interruptRequests = requests;
+
+        return SeekResult::Replaced;
+    }
+
+    bool History::lastStepLoadsProgram() const
+    {
+        if (!m_journal.empty())
+        {
+            return m_journal.replacesSystem(m_journal.size() - 1);
+        }
+
+        // The journal forgot it, but loading a program always leaves a
+        // checkpoint behind. The very first state has nothing before it.
+        const auto& checkpoint = closestCheckpoint(position());
+
+        return position() == 0 ||
+               (checkpoint.position == position() && checkpoint.loadsProgram);
+    }
+
+    bool History::lastStepWrites(std::int64_t begin, std::int64_t end) const
+    {
+        return !m_journal.empty() &&
+               m_journal.writes(m_journal.size() - 1, begin, end);
+    }
+
+    System History::stateAt(const System& current, std::int64_t position) const
+    {
+        if (position >= m_journalBase)
+        {
+            // Undoing a replaced system gives it back as a whole, there's no
+            // need to undo anything after the first one
+            const auto first = std::size_t(position - m_journalBase);
+            auto last        = m_journal.size();
+            bool replaced    = false;
+
+            for (auto i = first; i < last; ++i)
+            {
+                if (m_journal.replacesSystem(i))
+                {
+                    last     = i + 1;
+                    replaced = true;
+                    break;
+                }
+            }
+
+            System sys = replaced ? System {} : current;
+
+            for (auto i = last; i > first; --i)
+            {
+                m_journal.undoInto(sys, i - 1);
+            }
+
+            return sys;
+        }
+
+        const auto& checkpoint = closestCheckpoint(position);
+        auto sys               = load(checkpoint);
+
+        for (auto i = checkpoint.position;; ++i)
+        {
+            applyHostStep(sys, i);
+
+            if (i == position ||
+                !replayStep(sys, m_hostTraps, hostInputAt(i)))
+            {
+                break;
+            }
+        }
+
+        return sys;
+    }
+
+    std::int64_t History::memoryUsage() const noexcept
+    {
+        auto bytes = m_journal.memoryUsage() + m_checkpointBytes +
+                     asl::ssize(m_hostSteps) * std::int64_t(sizeof(HostStep));
+
+        for (const auto& step : m_hostInputs)
+        {
+            bytes += std::int64_t(sizeof(HostInput)) + asl::ssize(step.input);
+        }
+
+        return bytes;
+    }
+
+    std::int64_t History::checkpointCount() const noexcept
+    {
+        return asl::ssize(m_checkpoints);
+    }
+
+    std::int64_t History::spilledCheckpointCount() const noexcept
+    {
+        return std::count_if(m_checkpoints.begin(),
+                             m_checkpoints.end(),
+                             [](const Checkpoint& checkpoint) {
+                                 return !checkpoint.system.has_value();
+                             });
+    }
+
+    void History::clear()
+    {
+        m_journal.clear();
+        m_journalBase = 0;
+
+        m_checkpoints.clear();
+        m_checkpoints.push_back({ 0, System {} });
+        m_checkpointBytes = 0;
+
+        m_spillFile.truncate(0);
+
+        m_hostSteps.clear();
+        m_hostInputs.clear();
+        m_logNextStep = true;
+    }
+
+    void History::replayTo(System& sys,
+                           const Checkpoint& checkpoint,
+                           std::int64_t target)
+    {
+        const auto start = checkpoint.position;
+
+        sys = load(checkpoint);
+
+        dropCheckpointsAfter(start);
+        m_journal.clear();
+        m_journalBase = start;
+
+        // Running again journals the steps, so going back from there is
+        // cheap. The host steps stay as they are.
+        while (true)
+        {
+            applyHostStep(sys, position());
+
+            if (position() >= target)
+            {
+                break;
+            }
+
+            m_journal.beginStep(sys);
+            const auto executed =
+                replayStep(sys, m_hostTraps, hostInputAt(position()));
+            m_journal.endStep(sys);
+
+            addCheckpointIfDue(sys);
+
+            if (!executed)
+            {
+                break;
+            }
+        }
+    }
+
+    void History::applyHostStep(System& sys, std::int64_t position) const
+    {
+        const auto it = std::lower_bound(
+            m_hostSteps.begin(),
+            m_hostSteps.end(),
+            position,
+            [](const HostStep& step, std::int64_t pos) {
+                return step.position < pos;
+            });
+
+        if (it == m_hostSteps.end() || it->position != position)
+        {
+            return;
+        }
+
+        sys.nextEventCycle    = it->nextEventCycle;
+        sys.interruptRequests = it->interruptRequests;
+
+        if (it->interrupt != 0)
+        {
+            sys.trap = traps::Interrupt { it->interrupt };
+        }
+    }
+
+    std::string_view History::hostInputAt(std::int64_t position) const
+    {
+        const auto it = std::lower_bound(
+            m_hostInputs.begin(),
+            m_hostInputs.end(),
+            position,
+            [](const HostInput& step, std::int64_t pos) {
+                return step.position < pos;
+            });
+
+        if (it == m_hostInputs.end() || it->position != position)
+        {
+            return {};
+        }
+
+        return it->input;
+    }
+
+    void History::forgetHostStepsFrom(std::int64_t position)
+    {
+        while (!m_hostSteps.empty() && m_hostSteps.back().position >= position)
+        {
+            m_hostSteps.pop_back();
+        }
+
+        while (!m_hostInputs.empty() &&
+               m_hostInputs.back().position >= position)
+        {
+            m_hostInputs.pop_back();
+        }
+
+        m_logNextStep = true;
+    }
+
+    void History::addCheckpointIfDue(const System& sys)
+    {
+        // The budget is only checked here, the journal can't grow much
+        // between two checkpoints
+        if (position() - m_checkpoints.back().position >= m_checkpointInterval)
+        {
+            addCheckpoint(sys);
+            enforceBudget();
+        }
+    }
+
+    void History::addCheckpoint(const System& sys)
+    {
+        const auto& prev = m_checkpoints.back();
+        const auto cost  = prev.system ? unsharedBytes(sys, *prev.system)
+                                       : unsharedBytes(sys, System {});
+
+        m_checkpoints.push_back({ position(), sys, -1, 0, cost });
+        m_checkpointBytes += cost;
+    }
+
+    void History::dropCheckpointsAfter(std::int64_t position)
+    {
+        while (m_checkpoints.size() > 1 &&
+               m_checkpoints.back().position > position)
+        {
+            const auto& checkpoint = m_checkpoints.back();
+
+            if (checkpoint.system)
+            {
+                m_checkpointBytes -= checkpoint.cost;
+            }
+            else
+            {
+                // Spilled checkpoints are always the oldest ones, so the
+                // file can shrink
+                m_spillFile.truncate(checkpoint.fileOffset);
+            }
+
+            m_checkpoints.pop_back();
+        }
+    }
+
+    void History::enforceBudget()
+    {
+        if (m_memoryBudget <= 0)
+        {
+            return;
+        }
+
+        // Oldest checkpoints first, the newest one always stays
+        for (std::size_t i = 0; i + 1 < m_checkpoints.size(); ++i)
+        {
+            if (memoryUsage() <= m_memoryBudget)
+            {
+                return;
+            }
+
+            if (m_checkpoints[i].system && !spill(m_checkpoints[i]))
+            {
+                break;
+            }
+        }
+
+        // Then the steps a checkpoint can rebuild
+        for (const auto& checkpoint : m_checkpoints)
+        {
+            if (memoryUsage() <= m_memoryBudget)
+            {
+                return;
+            }
+
+            if (checkpoint.position > m_journalBase &&
+                checkpoint.position <= position())
+            {
+                m_journal.dropOldest(
+                    std::size_t(checkpoint.position - m_journalBase));
+                m_journalBase = checkpoint.position;
+            }
+        }
+    }
+
+    bool History::spill(Checkpoint& checkpoint)
+    {
+        if (!m_spillFile.isOpen() && !m_spillFile.open(m_spillPath))
+        {
+            return false;
+        }
+
+        const auto& sys = *checkpoint.system;
+        const auto& mem = sys.mem;
+
+        SpilledSystem header {};
+        header.cpu               = sys.cpu;
+        header.trap              = sys.trap;
+        header.cycles            = sys.cycles;
+        header.nextEventCycle    = sys.nextEventCycle;
+        header.interruptRequests = sys.interruptRequests;
+        header.markers           = { mem.executableMarker.begin,
+                                     mem.executableMarker.end,
+                                     mem.stackMarker.begin,
+                                     mem.stackMarker.end,
+                                     mem.staticMarker.begin,
+                                     mem.staticMarker.end };
+        header.memorySize        = asl::ssize(mem);
+        header.frameCount        = asl::ssize(sys.callStack.frames);
+
+        // Pages left at zero aren't written, the address space is sparse
+        const auto& pages = mem.underlying();
+        header.pageCount  = pages.materializedPageCount();
+
+        const auto pageBytes = std::size_t(header.pageCount * spilledPageSize);
+        const auto frameBytes =
+            std::size_t(header.frameCount) * sizeof(CallFrame);
+
+        std::vector<std::uint8_t> bytes(
+            sizeof(SpilledSystem) + pageBytes + frameBytes, 0);
+
+        std::memcpy(bytes.data(), &header, sizeof(SpilledSystem));
+
+        auto* out = bytes.data() + sizeof(SpilledSystem);
+
+        for (std::int64_t i = 0; i < pages.pageCount(); ++i)
+        {
+            if (!pages.materialized(i))
+            {
+                continue;
+            }
+
+            const auto begin = i * memoryPageSize;
+            const auto count =
+                std::min(memoryPageSize, header.memorySize - begin);
+
+            std::memcpy(out, &i, sizeof(i));
+            pages.read(begin, { out + sizeof(i), count });
+
+            out += spilledPageSize;
+        }
+
+        if (frameBytes > 0)
+        {
+            std::memcpy(out, sys.callStack.frames.data(), frameBytes);
+        }
+
+        const auto offset = m_spillFile.append(
+            { bytes.data(), asl::ssize(bytes) });
+
+        if (offset < 0)
+        {
+            return false;
+        }
+
+        checkpoint.fileOffset = offset;
+        checkpoint.fileSize   = asl::ssize(bytes);
+        checkpoint.system.reset();
+        m_checkpointBytes -= checkpoint.cost;
+
+        return true;
+    }
+
+    const History::Checkpoint&
+    History::closestCheckpoint(std::int64_t position) const
+    {
+        // The first checkpoint is at 0, so there's always one
+        const auto it = std::upper_bound(
+            m_checkpoints.begin(),
+            m_checkpoints.end(),
+            position,
+            [](std::int64_t pos, const Checkpoint& checkpoint) {
+                return pos < checkpoint.position;
+            });
+
+        return *std::prev(it);
+    }
+
+    System History::load(const Checkpoint& checkpoint) const
+    {
+        // Replaying doesn't go to the devices again, their pages read as
+        // memory
+        if (checkpoint.system)
+        {
+            auto sys    = *checkpoint.system;
+            sys.devices = &noDevices;
+
+            return sys;
+        }
+
+        const auto bytes =
+            m_spillFile.view(checkpoint.fileOffset, checkpoint.fileSize);
+
+        SpilledSystem header;
+        std::memcpy(&header, bytes.data(), sizeof(SpilledSystem));
+
+        System sys;
+        sys.cpu               = header.cpu;
+        sys.trap              = header.trap;
+        sys.cycles            = header.cycles;
+        sys.nextEventCycle    = header.nextEventCycle;
+        sys.interruptRequests = header.interruptRequests;
+
+        const auto* pageData = bytes.data() + sizeof(SpilledSystem);
+        const auto* frameData =
+            pageData + header.pageCount * spilledPageSize;
+
+        sys.callStack.frames.resize(std::size_t(header.frameCount));
+
+        if (header.frameCount > 0)
+        {
+            std::memcpy(sys.callStack.frames.data(),
+                        frameData,
+                        sys.callStack.frames.size() * sizeof(CallFrame));
+        }
+
+        if (header.memorySize > 0)
+        {
+            // Pages that weren't spilled keep sharing the zero page
+            ExecutableMemory mem { header.memorySize };
+
+            for (std::int64_t i = 0; i < header.pageCount; ++i)
+            {
+                const auto* page = pageData + i * spilledPageSize;
+
+                std::int64_t idx = 0;
+                std::memcpy(&idx, page, sizeof(idx));
+
+                const auto begin = idx * memoryPageSize;
+                const auto count =
+                    std::min(memoryPageSize, header.memorySize - begin);
+
+                mem.underlying().write(begin, { page + sizeof(idx), count });
+            }
+
+            sys.mem = std::move(mem);
+        }
+
+        auto& mem                  = sys.mem;
+        mem.executableMarker.begin = header.markers[0];
+        mem.executableMarker.end   = header.markers[1];
+        mem.stackMarker.begin      = header.markers[2];
+        mem.stackMarker.end        = header.markers[3];
+        mem.staticMarker.begin     = header.markers[4];
+        mem.staticMarker.end       = header.markers[5];
+
+        return sys;
+    }
+
+    // StateHistoryView
+
+    StateHistoryView::StateHistoryView(const System& current,
+                                       const History& history)
+        : m_current(&current)
+        , m_history(&history)
+    {
+    }
+
+    std::size_t StateHistoryView::size() const noexcept
+    {
+        return std::size_t(m_history->position() + 1);
+    }
+
+    const System& StateHistoryView::back() const noexcept
+    {
+        return *m_current;
+    }
+
+    System StateHistoryView::operator[](std::size_t idx) const
+    {
+        return m_history->stateAt(*m_current, std::int64_t(idx));
+    }
+} // namespace momiji
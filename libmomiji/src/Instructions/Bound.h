@@ -0,0 +1,335 @@
+#pragma once
+
+#include "./Utils.h"
+#include "./bcc.h"
+
+#include <Decoder.h>
+#include <System.h>
+
+namespace momiji::instr
+{
+    // Handlers bound to their operands, for code translated ahead of time.
+    // They behave exactly like the handler they replace, with whatever it
+    // read from the code at run time read once at translation instead.
+    // Writes to the code have to drop the translation.
+    // Op is the entry of a translation, with at least:
+    //     BoundFn<Op> run;
+    //     DecodedInstructionFn exec; // Handler, when nothing is bound
+    //     InstructionData data;
+    //     std::int32_t value;        // Immediate source or branch target
+    //     bool resolved;             // Whether value was read
+    //     std::uint32_t next;        // Address of the next instruction
+    template <typename Op>
+    using BoundFn = ExecutionStatus (*)(System&, const Op&);
+
+    template <typename Op>
+    ExecutionStatus runHandler(System& sys, const Op& op)
+    {
+        return op.exec(sys, op.data);
+    }
+
+    // instr::bra, and instr::jmp to an absolute address
+    template <typename Op>
+    ExecutionStatus runJump(System& sys, const Op& op)
+    {
+        sys.cpu.programCounter = std::uint32_t(op.value);
+
+        return ExecutionStatus::BranchTaken;
+    }
+
+    // instr::bcc
+    template <typename Op>
+    ExecutionStatus runBranchCondition(System& sys, const Op& op)
+    {
+        const auto condition = utils::to_val(op.data.operandType[0]);
+
+        if (branchConditionHolds(sys.cpu.statusRegister, condition))
+        {
+            sys.cpu.programCounter = std::uint32_t(op.value);
+
+            return ExecutionStatus::BranchTaken;
+        }
+
+        sys.cpu.programCounter = op.next;
+
+        return ExecutionStatus::Continue;
+    }
+
+    namespace details
+    {
+        // Source operand, read the same way as utils::readOperandVal
+        template <utils::OperandKind Src, typename Op>
+        std::int32_t boundSource(const System& sys, const Op& op)
+        {
+            const auto regnum = utils::to_val(op.data.addressingMode[0]);
+
+            if constexpr (Src == utils::OperandKind::DataRegister)
+            {
+                return asl::saccess(sys.cpu.dataRegisters, regnum).raw();
+            }
+            else if constexpr (Src == utils::OperandKind::AddressRegister)
+            {
+                return asl::saccess(sys.cpu.addressRegisters, regnum).raw();
+            }
+            else
+            {
+                return op.value;
+            }
+        }
+
+        template <typename Op>
+        DataRegister& boundDestination(System& sys, const Op& op)
+        {
+            const auto regnum = utils::to_val(op.data.addressingMode[1]);
+
+            return asl::saccess(sys.cpu.dataRegisters, regnum);
+        }
+
+        // instr::move to a data register
+        struct BoundMove
+        {
+            template <typename To, utils::OperandKind Src, typename Op>
+            static ExecutionStatus run(System& sys, const Op& op)
+            {
+                const auto src = boundSource<Src>(sys, op);
+
+                *boundDestination(sys, op).template as<To>() = To(src);
+
+                sys.cpu.statusRegister.setLogical(sizeof(To), src);
+                sys.cpu.programCounter = op.next;
+
+                return ExecutionStatus::Continue;
+            }
+        };
+
+        // instr::add and instr::addi to a data register
+        struct BoundAdd
+        {
+            template <typename To, utils::OperandKind Src, typename Op>
+            static ExecutionStatus run(System& sys, const Op& op)
+            {
+                const auto src = boundSource<Src>(sys, op);
+                auto& reg      = boundDestination(sys, op);
+
+                const auto dst = To(reg.raw());
+                const auto res = To(std::uint32_t(dst) + std::uint32_t(src));
+
+                *reg.template as<To>() = res;
+
+                sys.cpu.statusRegister.setAdd(sizeof(To), src, dst, res);
+                sys.cpu.programCounter = op.next;
+
+                return ExecutionStatus::Continue;
+            }
+        };
+
+        // instr::sub and instr::subi to a data register
+        struct BoundSub
+        {
+            template <typename To, utils::OperandKind Src, typename Op>
+            static ExecutionStatus run(System& sys, const Op& op)
+            {
+                const auto src = boundSource<Src>(sys, op);
+                auto& reg      = boundDestination(sys, op);
+
+                const auto dst = To(reg.raw());
+                const auto res = To(std::uint32_t(dst) - std::uint32_t(src));
+
+                *reg.template as<To>() = res;
+
+                sys.cpu.statusRegister.setSub(sizeof(To), src, dst, res);
+                sys.cpu.programCounter = op.next;
+
+                return ExecutionStatus::Continue;
+            }
+        };
+
+        // instr::and_instr and instr::or_instr to a data register, which
+        // leave the flags as they are
+        template <bool Or>
+        struct BoundLogical
+        {
+            template <typename To, utils::OperandKind Src, typename Op>
+            static ExecutionStatus run(System& sys, const Op& op)
+            {
+                const auto src = To(boundSource<Src>(sys, op));
+                auto& reg      = boundDestination(sys, op);
+
+                const auto dst = To(reg.raw());
+
+                *reg.template as<To>() = Or ? To(dst | src) : To(dst & src);
+                sys.cpu.programCounter = op.next;
+
+                return ExecutionStatus::Continue;
+            }
+        };
+
+        // instr::cmp and instr::cmpi to a data register
+        struct BoundCompare
+        {
+            template <typename To, utils::OperandKind Src, typename Op>
+            static ExecutionStatus run(System& sys, const Op& op)
+            {
+                const std::int32_t src = To(boundSource<Src>(sys, op));
+                const std::int32_t dst = To(boundDestination(sys, op).raw());
+                const auto res =
+                    std::int32_t(std::uint32_t(dst) - std::uint32_t(src));
+
+                sys.cpu.statusRegister.setCompare(sizeof(To), src, dst, res);
+                sys.cpu.programCounter = op.next;
+
+                return ExecutionStatus::Continue;
+            }
+        };
+
+        // instr::tst of a data register
+        struct BoundTest
+        {
+            template <typename To, utils::OperandKind Src, typename Op>
+            static ExecutionStatus run(System& sys, const Op& op)
+            {
+                const auto val = boundSource<Src>(sys, op);
+
+                sys.cpu.statusRegister.setLogical(sizeof(To), val);
+                sys.cpu.programCounter = op.next;
+
+                return ExecutionStatus::Continue;
+            }
+        };
+
+        template <typename Bound, typename To, typename Op>
+        BoundFn<Op> boundFrom(utils::OperandKind src)
+        {
+            using utils::OperandKind;
+
+            switch (src)
+            {
+            case OperandKind::DataRegister:
+                return &Bound::template run<To, OperandKind::DataRegister, Op>;
+
+            case OperandKind::AddressRegister:
+                return &Bound::
+                    template run<To, OperandKind::AddressRegister, Op>;
+
+            case OperandKind::Immediate:
+                return &Bound::template run<To, OperandKind::Immediate, Op>;
+
+            default:
+                return nullptr;
+            }
+        }
+
+        // Bound::run for the size and the source of op, null if the source
+        // is neither a register nor an immediate
+        template <typename Bound, typename Op>
+        BoundFn<Op> bound(const Op& op)
+        {
+            const auto src = utils::operandKind(op.data, 0);
+
+            switch (op.data.size)
+            {
+            case 1:
+                return boundFrom<Bound, std::int8_t, Op>(src);
+
+            case 2:
+                return boundFrom<Bound, std::int16_t, Op>(src);
+
+            default:
+                return boundFrom<Bound, std::int32_t, Op>(src);
+            }
+        }
+
+        template <typename Op>
+        BoundFn<Op> boundForm(InstructionType type, const Op& op)
+        {
+            const auto& data = op.data;
+
+            const bool toDataRegister =
+                data.operandType[1] == OperandType::DataRegister;
+
+            switch (type)
+            {
+            case InstructionType::Move:
+                return toDataRegister ? bound<BoundMove>(op) : nullptr;
+
+            case InstructionType::Add:
+            case InstructionType::AddI:
+                return toDataRegister ? bound<BoundAdd>(op) : nullptr;
+
+            case InstructionType::Sub:
+            case InstructionType::SubI:
+                return toDataRegister ? bound<BoundSub>(op) : nullptr;
+
+            case InstructionType::And:
+                return toDataRegister ? bound<BoundLogical<false>>(op)
+                                      : nullptr;
+
+            case InstructionType::Or:
+                return toDataRegister ? bound<BoundLogical<true>>(op)
+                                      : nullptr;
+
+            case InstructionType::Compare:
+            case InstructionType::CompareI:
+                return toDataRegister ? bound<BoundCompare>(op) : nullptr;
+
+            case InstructionType::Tst:
+                return data.operandType[0] == OperandType::DataRegister
+                           ? bound<BoundTest>(op)
+                           : nullptr;
+
+            case InstructionType::Branch:
+            case InstructionType::Jmp:
+                return op.resolved ? &runJump<Op> : nullptr;
+
+            case InstructionType::BranchCondition:
+                return op.resolved ? &runBranchCondition<Op> : nullptr;
+
+            default:
+                return nullptr;
+            }
+        }
+    } // namespace details
+
+    // Reads the immediate source or the branch target of instr, at pc, into
+    // op and picks its bound form, runHandler if it has none. op.exec,
+    // op.data and op.next have to be set first.
+    template <typename Op>
+    void bind(Op& op,
+              ConstExecutableMemoryView mem,
+              std::int64_t pc,
+              const DecodedInstruction& instr)
+    {
+        const auto& data = op.data;
+
+        op.value    = 0;
+        op.resolved = false;
+
+        switch (instr.type)
+        {
+        case InstructionType::Branch:
+        case InstructionType::BranchCondition:
+        case InstructionType::Jmp:
+            if (const auto target = branchTarget(mem, pc, instr))
+            {
+                op.value    = std::int32_t(*target);
+                op.resolved = true;
+            }
+            break;
+
+        default:
+            // Read the same way as utils::readOperandVal
+            if (data.operandType[0] == OperandType::Immediate &&
+                data.addressingMode[0] == SpecialAddressingMode::Immediate)
+            {
+                const auto pcreg = ProgramCounter(std::uint32_t(pc));
+
+                op.value = utils::readImmediateFromPC(mem, pcreg, data.size);
+                op.resolved = true;
+            }
+            break;
+        }
+
+        const auto form = details::boundForm(instr.type, op);
+        op.run          = form != nullptr ? form : &runHandler<Op>;
+    }
+} // namespace momiji::instr
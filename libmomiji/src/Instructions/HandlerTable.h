@@ -0,0 +1,73 @@
+#pragma once
+
+#include "./Utils.h"
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+namespace momiji::instr
+{
+    namespace details
+    {
+        constexpr std::array<std::int8_t, 3> handlerSizes = { { 1, 2, 4 } };
+
+        constexpr std::size_t handlerTableSize =
+            handlerSizes.size() * utils::operandKindCount *
+            utils::operandKindCount;
+
+        template <typename Handler, std::size_t Idx>
+        constexpr DecodedInstructionFn handlerAt()
+        {
+            constexpr auto kinds = std::size_t(utils::operandKindCount);
+
+            constexpr auto size = handlerSizes[Idx / (kinds * kinds)];
+            constexpr auto src  = utils::OperandKind((Idx / kinds) % kinds);
+            constexpr auto dst  = utils::OperandKind(Idx % kinds);
+
+            return Handler::template run<size, src, dst>;
+        }
+
+        template <typename Handler, std::size_t... Idx>
+        constexpr std::array<DecodedInstructionFn, handlerTableSize>
+        makeHandlerTable(std::index_sequence<Idx...> /*unused*/)
+        {
+            return { { handlerAt<Handler, Idx>()... } };
+        }
+
+        constexpr std::size_t handlerSizeIndex(std::int8_t size)
+        {
+            switch (size)
+            {
+            case 1:
+                return 0;
+
+            case 2:
+                return 1;
+
+            default:
+                return 2;
+            }
+        }
+    } // namespace details
+
+    // Handler::run<Size, Src, Dst> is instantiated for every size and kind
+    // of both operands, so the decoder can pick the one matching data and
+    // nothing is left to switch on at run time for the common operands
+    template <typename Handler>
+    DecodedInstructionFn specialised(const InstructionData& data)
+    {
+        constexpr auto kinds = std::size_t(utils::operandKindCount);
+
+        static constexpr auto table = details::makeHandlerTable<Handler>(
+            std::make_index_sequence<details::handlerTableSize> {});
+
+        const auto idx =
+            (details::handlerSizeIndex(data.size) * kinds +
+             std::size_t(utils::operandKind(data, 0))) *
+                kinds +
+            std::size_t(utils::operandKind(data, 1));
+
+        return table[idx];
+    }
+} // namespace momiji::instr
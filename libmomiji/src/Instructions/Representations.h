@@ -119,8 +119,8 @@ namespace momiji::repr
 
         std::uint16_t header : 8;
         std::uint16_t size : 2;
-        std::uint16_t dsttype : 2;
-        std::uint16_t dstmode : 2;
+        std::uint16_t dsttype : 3;
+        std::uint16_t dstmode : 3;
     };
 
     struct SubQ
@@ -438,6 +438,33 @@ namespace momiji::repr
         std::uint16_t header { 0b01001110'01110101 };
     };
 
+    struct Trap
+    {
+        Trap()
+            : header { 0b01001110'0100 }
+        {
+        }
+
+        std::uint16_t header : 12;
+        std::uint16_t vector : 4;
+    };
+
+    struct Rte
+    {
+        std::uint16_t header { 0b01001110'01110011 };
+    };
+
+    struct Movec
+    {
+        Movec()
+            : header { 0b01001110'0111101 }
+        {
+        }
+
+        std::uint16_t header : 15;
+        std::uint16_t dr : 1;
+    };
+
     struct MemAsd
     {
         MemAsd()
@@ -3,6 +3,7 @@
 #include <Utils.h>
 #include <asl/types>
 
+#include <Bus.h>
 #include <Decoder.h>
 #include <Memory.h>
 #include <System.h>
@@ -16,7 +17,7 @@ namespace momiji::utils
 #pragma clang diagnostic ignored "-Wsign-conversion"
 #endif
 
-    inline std::int32_t readImmediateFromPC(ExecutableMemoryView base,
+    inline std::int32_t readImmediateFromPC(ConstExecutableMemoryView base,
                                             ProgramCounter pc,
                                             std::int16_t size)
     {
@@ -43,32 +44,28 @@ namespace momiji::utils
         return 0;
     }
 
-    inline std::int32_t readFromMemory(ExecutableMemoryView base,
-                                       std::int32_t offset,
-                                       std::int16_t size)
+    // The extension words of the instruction at pc, as the instruction sees
+    // them when it runs
+    inline std::int32_t readImmediateFromPC(momiji::System& sys,
+                                            ProgramCounter pc,
+                                            std::int16_t size)
     {
-        switch (size)
-        {
-        case 1: {
-            const auto correct_offset = utils::sign_extend<std::int8_t>(offset);
-            const auto val            = base.read8(correct_offset);
-            return std::int32_t(val.value_or(0));
-        }
+        const auto nextloc = std::int64_t((pc + 2).raw());
 
-        case 2: {
-            const auto correct_offset =
-                utils::sign_extend<std::int16_t>(offset);
-            const auto val = base.read16(correct_offset);
-            return std::int32_t(val.value_or(0));
+        // A byte immediate still takes a whole word
+        if (size == 1)
+        {
+            return std::int32_t(bus::read<std::uint16_t>(sys, nextloc) & 0xFF);
         }
 
-        case 4: {
-            const auto val = base.read32(offset);
-            return std::int32_t(val.value_or(0));
-        }
-        }
+        return std::int32_t(bus::read(sys, nextloc, size));
+    }
 
-        return 0;
+    inline std::int32_t readFromMemory(momiji::System& sys,
+                                       std::int32_t offset,
+                                       std::int16_t size)
+    {
+        return std::int32_t(bus::read(sys, std::uint32_t(offset), size));
     }
 
     inline std::int32_t readOperandVal(momiji::System& sys,
@@ -95,36 +92,36 @@ namespace momiji::utils
         // (a*)
         case OperandType::Address:
             val = asl::saccess(sys.cpu.addressRegisters, regnum).raw();
-            val = readFromMemory(sys.mem, val, instr.size);
+            val = readFromMemory(sys, val, instr.size);
             break;
 
         // -(a*)
         case OperandType::AddressPre:
             sys.cpu.addressRegisters[regnum] -= instr.size;
             val = asl::saccess(sys.cpu.addressRegisters, regnum).raw();
-            val = readFromMemory(sys.mem, val, instr.size);
+            val = readFromMemory(sys, val, instr.size);
             break;
 
         // (a*)+
         case OperandType::AddressPost:
             val = asl::saccess(sys.cpu.addressRegisters, regnum).raw();
-            val = readFromMemory(sys.mem, val, instr.size);
+            val = readFromMemory(sys, val, instr.size);
             sys.cpu.addressRegisters[regnum] += instr.size;
             break;
 
         // index(a*)
         case OperandType::AddressOffset:
-            val = readImmediateFromPC(sys.mem, pc, 2);
+            val = readImmediateFromPC(sys, pc, 2);
             val += asl::saccess(sys.cpu.addressRegisters, regnum).raw();
 
-            val = readFromMemory(sys.mem, val, instr.size);
+            val = readFromMemory(sys, val, instr.size);
             break;
 
         // (index, a*, d*)
         case OperandType::AddressIndex: {
             val = asl::saccess(sys.cpu.addressRegisters, regnum).raw();
 
-            const std::int32_t tmp = readImmediateFromPC(sys.mem, pc, 2);
+            const std::int32_t tmp = readImmediateFromPC(sys, pc, 2);
 
             const auto newreg = std::int8_t((tmp & 0xF000) >> 12);
             const auto index  = std::int8_t((tmp & 0x00FF));
@@ -140,7 +137,7 @@ namespace momiji::utils
 
             val += index;
 
-            val = readFromMemory(sys.mem, val, instr.size);
+            val = readFromMemory(sys, val, instr.size);
         }
         break;
 
@@ -148,21 +145,21 @@ namespace momiji::utils
             switch (asl::saccess(instr.addressingMode, op))
             {
             case SpecialAddressingMode::Immediate:
-                val = readImmediateFromPC(sys.mem, pc, instr.size);
+                val = readImmediateFromPC(sys, pc, instr.size);
                 break;
 
             case SpecialAddressingMode::AbsoluteShort: {
-                std::int32_t addr = readImmediateFromPC(sys.mem, pc, 2);
+                std::int32_t addr = readImmediateFromPC(sys, pc, 2);
 
                 addr = utils::sign_extend<std::int16_t>(addr);
 
-                val = readFromMemory(sys.mem, addr, instr.size);
+                val = readFromMemory(sys, addr, instr.size);
             }
             break;
 
             case SpecialAddressingMode::AbsoluteLong:
-                val = readImmediateFromPC(sys.mem, pc, 4);
-                val = readFromMemory(sys.mem, val, instr.size);
+                val = readImmediateFromPC(sys, pc, 4);
+                val = readFromMemory(sys, val, instr.size);
                 break;
 
             case SpecialAddressingMode::ProgramCounterIndex:
@@ -175,63 +172,113 @@ namespace momiji::utils
         return val;
     }
 
+    // Destination operand of an instruction: either the low part of a
+    // register or a location in guest memory, read and written through the
+    // bus.
+    template <typename To>
+    class OperandRef
+    {
+        using Unsigned = std::make_unsigned_t<To>;
+
+    public:
+        // Reads 0 and drops stores
+        OperandRef() = default;
+
+        explicit OperandRef(To* reg)
+            : m_reg(reg)
+        {
+        }
+
+        OperandRef(momiji::System& sys, std::int64_t offset)
+            : m_sys(&sys)
+            , m_offset(std::uint32_t(offset))
+        {
+        }
+
+        operator To() const noexcept
+        {
+            if (m_sys != nullptr)
+            {
+                return To(bus::read<Unsigned>(*m_sys, m_offset));
+            }
+
+            return m_reg != nullptr ? *m_reg : To(0);
+        }
+
+        OperandRef& operator=(To val) noexcept
+        {
+            if (m_sys != nullptr)
+            {
+                bus::write(*m_sys, m_offset, Unsigned(val));
+            }
+            else if (m_reg != nullptr)
+            {
+                *m_reg = val;
+            }
+
+            return *this;
+        }
+
+    private:
+        To* m_reg { nullptr };
+        momiji::System* m_sys { nullptr };
+        std::int64_t m_offset { 0 };
+    };
+
     template <typename To>
-    inline To* readOperandPtr(momiji::System& sys,
-                              const InstructionData& instr,
-                              std::int8_t op)
+    inline OperandRef<To> readOperandRef(momiji::System& sys,
+                                         const InstructionData& instr,
+                                         std::int8_t op)
     {
         const auto regnum =
             utils::to_val(asl::saccess(instr.addressingMode, op));
 
         const ProgramCounter pc = sys.cpu.programCounter;
         std::int32_t tmp        = 0;
-        To* val                 = nullptr;
 
         switch (asl::saccess(instr.operandType, op))
         {
         // d*
         case OperandType::DataRegister:
-            val = asl::saccess(sys.cpu.dataRegisters, regnum).as<To>();
-            break;
+            return OperandRef<To> {
+                asl::saccess(sys.cpu.dataRegisters, regnum).as<To>()
+            };
 
         // a*
         case OperandType::AddressRegister:
-            val = asl::saccess(sys.cpu.addressRegisters, regnum).as<To>();
-            break;
+            return OperandRef<To> {
+                asl::saccess(sys.cpu.addressRegisters, regnum).as<To>()
+            };
 
         // (a*)
         case OperandType::Address:
             tmp = asl::saccess(sys.cpu.addressRegisters, regnum).raw();
-            val = reinterpret_cast<To*>(sys.mem.data() + tmp);
-            break;
+            return { sys, tmp };
 
         // -(a*)
         case OperandType::AddressPre:
             asl::saccess(sys.cpu.addressRegisters, regnum) -= instr.size;
             tmp = asl::saccess(sys.cpu.addressRegisters, regnum).raw();
-            val = reinterpret_cast<To*>(sys.mem.data() + tmp);
-            break;
+            return { sys, tmp };
 
         // (a*)+
         case OperandType::AddressPost:
             tmp = asl::saccess(sys.cpu.addressRegisters, regnum).raw();
-            val = reinterpret_cast<To*>(sys.mem.data() + tmp);
             asl::saccess(sys.cpu.addressRegisters, regnum) += instr.size;
-            break;
+            return { sys, tmp };
 
         // offset(a*)
         case OperandType::AddressOffset:
             tmp = readImmediateFromPC(
-                sys.mem, pc + resolveOp1Size(instr, op), sizeof(To));
+                sys, pc + resolveOp1Size(instr, op), 2);
 
             tmp += asl::saccess(sys.cpu.addressRegisters, regnum).raw();
-            val = reinterpret_cast<To*>(sys.mem.data() + tmp);
-            break;
+            return { sys, tmp };
 
         // (offset, a*, **)
         case OperandType::AddressIndex: {
             tmp = readImmediateFromPC(
-                sys.mem, pc + resolveOp1Size(instr, op), sizeof(To));
+                sys, pc + resolveOp1Size(instr, op), 2);
 
             const auto newreg = std::int8_t((tmp & 0xF000) >> 12);
             const auto index  = std::int8_t(tmp & 0x00FF);
@@ -249,42 +296,204 @@ namespace momiji::utils
 
             tmp += index;
 
-            val = reinterpret_cast<To*>(sys.mem.data() + tmp);
+            return { sys, tmp };
         }
-        break;
 
         case OperandType::Immediate:
             switch (asl::saccess(instr.addressingMode, op))
             {
             case SpecialAddressingMode::AbsoluteShort: {
                 tmp = readImmediateFromPC(
-                    sys.mem, pc + resolveOp1Size(instr, op), 2);
+                    sys, pc + resolveOp1Size(instr, op), 2);
 
                 tmp = utils::sign_extend<std::int16_t>(tmp);
-                val = reinterpret_cast<To*>(sys.mem.data() + tmp);
+                return { sys, tmp };
             }
-            break;
 
             case SpecialAddressingMode::AbsoluteLong: {
                 tmp = readImmediateFromPC(
-                    sys.mem, pc + resolveOp1Size(instr, op), 4);
+                    sys, pc + resolveOp1Size(instr, op), 4);
 
-                val = reinterpret_cast<To*>(sys.mem.data() + tmp);
+                return { sys, tmp };
             }
-            break;
 
             case SpecialAddressingMode::ProgramCounterIndex:
             case SpecialAddressingMode::ProgramCounterOffset:
                 break;
 
             case SpecialAddressingMode::Immediate:
-                val = reinterpret_cast<To*>(sys.mem.data() + pc.raw());
-                break;
+                return { sys, pc.raw() };
             }
             break;
         }
 
-        return val;
+        // Not a destination, nothing will be stored
+        return {};
+    }
+
+    // Operands handlers can be specialised on at compile time. Dynamic
+    // leaves it to readOperandVal and readOperandRef.
+    enum class OperandKind : std::uint8_t
+    {
+        Dynamic,
+        DataRegister,    // d*
+        AddressRegister, // a*
+        AddressPost,     // (a*)+
+        Immediate,       // #imm
+    };
+
+    constexpr std::int8_t operandKindCount = 5;
+
+    constexpr OperandKind operandKind(const InstructionData& instr,
+                                      std::int8_t op)
+    {
+        switch (asl::saccess(instr.operandType, op))
+        {
+        case OperandType::DataRegister:
+            return OperandKind::DataRegister;
+
+        case OperandType::AddressRegister:
+            return OperandKind::AddressRegister;
+
+        case OperandType::AddressPost:
+            return OperandKind::AddressPost;
+
+        case OperandType::Immediate:
+            if (asl::saccess(instr.addressingMode, op) ==
+                SpecialAddressingMode::Immediate)
+            {
+                return OperandKind::Immediate;
+            }
+            return OperandKind::Dynamic;
+
+        default:
+            return OperandKind::Dynamic;
+        }
+    }
+
+    template <std::int8_t Size>
+    using sized_int_t = std::conditional_t<
+        Size == 1,
+        std::int8_t,
+        std::conditional_t<Size == 2, std::int16_t, std::int32_t>>;
+
+    // readOperandVal for an operand known at compile time
+    template <OperandKind Kind, std::int8_t Size>
+    inline std::int32_t readOperandVal(momiji::System& sys,
+                                       const InstructionData& instr,
+                                       std::int8_t op)
+    {
+        const auto regnum =
+            utils::to_val(asl::saccess(instr.addressingMode, op));
+
+        if constexpr (Kind == OperandKind::DataRegister)
+        {
+            return asl::saccess(sys.cpu.dataRegisters, regnum).raw();
+        }
+        else if constexpr (Kind == OperandKind::AddressRegister)
+        {
+            return asl::saccess(sys.cpu.addressRegisters, regnum).raw();
+        }
+        else if constexpr (Kind == OperandKind::AddressPost)
+        {
+            auto& reg = asl::saccess(sys.cpu.addressRegisters, regnum);
+
+            const auto val = readFromMemory(sys, reg.raw(), Size);
+            reg += Size;
+
+            return val;
+        }
+        else if constexpr (Kind == OperandKind::Immediate)
+        {
+            return readImmediateFromPC(sys, sys.cpu.programCounter, Size);
+        }
+        else
+        {
+            return readOperandVal(sys, instr, op);
+        }
+    }
+
+    // readOperandRef for an operand known at compile time
+    template <typename To, OperandKind Kind>
+    inline OperandRef<To> readOperandRef(momiji::System& sys,
+                                         const InstructionData& instr,
+                                         std::int8_t op)
+    {
+        const auto regnum =
+            utils::to_val(asl::saccess(instr.addressingMode, op));
+
+        if constexpr (Kind == OperandKind::DataRegister)
+        {
+            return OperandRef<To> {
+                asl::saccess(sys.cpu.dataRegisters, regnum).as<To>()
+            };
+        }
+        else if constexpr (Kind == OperandKind::AddressRegister)
+        {
+            return OperandRef<To> {
+                asl::saccess(sys.cpu.addressRegisters, regnum).as<To>()
+            };
+        }
+        else if constexpr (Kind == OperandKind::AddressPost)
+        {
+            auto& reg = asl::saccess(sys.cpu.addressRegisters, regnum);
+
+            const std::int32_t addr = reg.raw();
+            reg += std::int8_t(sizeof(To));
+
+            return { sys, addr };
+        }
+        else
+        {
+            return readOperandRef<To>(sys, instr, op);
+        }
+    }
+
+    // isImmediate for an operand known at compile time
+    template <OperandKind Kind, std::int8_t Size>
+    constexpr std::int8_t extensionSize(const InstructionData& instr,
+                                        std::int8_t op)
+    {
+        if constexpr (Kind == OperandKind::Immediate)
+        {
+            return (Size == 4) ? 4 : 2;
+        }
+        else if constexpr (Kind == OperandKind::Dynamic)
+        {
+            return isImmediate(instr, op);
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+    constexpr bool isRegister(OperandKind kind)
+    {
+        return kind == OperandKind::DataRegister ||
+               kind == OperandKind::AddressRegister;
+    }
+
+    // What an instruction reports once it's done: Trap if one of its memory
+    // accesses faulted. Registers never fault, so instructions known to use
+    // only registers have nothing to check.
+    template <OperandKind Src, OperandKind Dst>
+    inline ExecutionStatus completed(const momiji::System& sys)
+    {
+        if constexpr (isRegister(Src) && isRegister(Dst))
+        {
+            return ExecutionStatus::Continue;
+        }
+        else
+        {
+            return sys.trap.has_value() ? ExecutionStatus::Trap
+                                        : ExecutionStatus::Continue;
+        }
+    }
+
+    inline ExecutionStatus completed(const momiji::System& sys)
+    {
+        return completed<OperandKind::Dynamic, OperandKind::Dynamic>(sys);
     }
 
 #ifdef ASL_CLANG
@@ -1,74 +1,79 @@
 #include "add.h"
 
+#include "./HandlerTable.h"
 #include "./Utils.h"
-#include <Utils.h>
 
 namespace momiji::instr
 {
-    momiji::System add(momiji::System& sys, const InstructionData& data)
+    namespace
     {
-        auto& pc = sys.cpu.programCounter;
+        struct Add
+        {
+            template <std::int8_t Size,
+                      utils::OperandKind Src,
+                      utils::OperandKind Dst>
+            static momiji::ExecutionStatus run(momiji::System& sys,
+                                               const InstructionData& data)
+            {
+                using To = utils::sized_int_t<Size>;
+
+                auto& pc = sys.cpu.programCounter;
+
+                const std::int32_t srcval =
+                    utils::readOperandVal<Src, Size>(sys, data, 0);
+
+                auto dstreg = utils::readOperandRef<To, Dst>(sys, data, 1);
+
+                const To dst = dstreg;
+                const auto result =
+                    To(std::uint32_t(dst) + std::uint32_t(srcval));
+
+                dstreg = result;
 
-        const std::int32_t srcval = utils::readOperandVal(sys, data, 0);
+                sys.cpu.statusRegister.setAdd(Size, srcval, dst, result);
 
-        std::int32_t result = 0;
+                pc += 2;
+                pc += std::uint8_t(utils::extensionSize<Src, Size>(data, 0));
+                pc += std::uint8_t(utils::extensionSize<Dst, Size>(data, 1));
 
-        auto& statusReg = sys.cpu.statusRegister;
+                return utils::completed<Src, Dst>(sys);
+            }
+        };
+    } // namespace
+
+    momiji::ExecutionStatus add(momiji::System& sys,
+                                const InstructionData& data)
+    {
+        constexpr auto dyn = utils::OperandKind::Dynamic;
 
         switch (data.size)
         {
         case 1:
-        {
-            auto dstreg = utils::readOperandPtr<std::int8_t>(sys, data, 1);
-            *dstreg     = *dstreg + (srcval & 0x0000'00FF);
-            result      = utils::sign_extend<std::int8_t>(*dstreg);
-            statusReg.overflow =
-                utils::add_overflow(*dstreg, std::int8_t(srcval));
-        }
-        break;
+            return Add::run<1, dyn, dyn>(sys, data);
 
         case 2:
-        {
-            auto dstreg = utils::readOperandPtr<std::int16_t>(sys, data, 1);
-            *dstreg     = *dstreg + (srcval & 0x0000'FFFF);
-            result      = utils::sign_extend<std::int16_t>(*dstreg);
-            statusReg.overflow =
-                utils::add_overflow(*dstreg, std::int16_t(srcval));
-        }
-        break;
+            return Add::run<2, dyn, dyn>(sys, data);
 
-        case 4:
-        {
-            auto dstreg = utils::readOperandPtr<std::int32_t>(sys, data, 1);
-            *dstreg     = *dstreg + srcval;
-            result      = *dstreg;
-            statusReg.overflow = utils::add_overflow(*dstreg, srcval);
-        }
-        break;
+        default:
+            return Add::run<4, dyn, dyn>(sys, data);
         }
-
-        statusReg.negative = result < 0;
-        statusReg.zero     = result == 0;
-
-        // How the fuck do I detect a carry
-        statusReg.carry  = 0;
-        statusReg.extend = statusReg.carry;
-
-        pc += 2;
-        pc += std::uint8_t(utils::isImmediate(data, 0));
-        pc += std::uint8_t(utils::isImmediate(data, 1));
-
-        return sys;
     }
 
-    momiji::System adda(momiji::System& sys, const InstructionData& data)
+    momiji::ExecutionStatus adda(momiji::System& sys,
+                                 const InstructionData& data)
     {
 
         return instr::add(sys, data);
     }
 
-    momiji::System addi(momiji::System& sys, const InstructionData& data)
+    momiji::ExecutionStatus addi(momiji::System& sys,
+                                 const InstructionData& data)
     {
         return instr::add(sys, data);
     }
+
+    DecodedInstructionFn addHandler(const InstructionData& data)
+    {
+        return specialised<Add>(data);
+    }
 } // namespace momiji::instr
@@ -5,7 +5,14 @@
 
 namespace momiji::instr
 {
-    momiji::System add(momiji::System& sys, const InstructionData& data);
-    momiji::System addi(momiji::System& sys, const InstructionData& data);
-    momiji::System adda(momiji::System& sys, const InstructionData& data);
+    momiji::ExecutionStatus add(momiji::System& sys,
+                                const InstructionData& data);
+    momiji::ExecutionStatus addi(momiji::System& sys,
+                                 const InstructionData& data);
+    momiji::ExecutionStatus adda(momiji::System& sys,
+                                 const InstructionData& data);
+
+    // The instantiation of add specialised on the size and operands of data,
+    // used for add, adda and addi
+    DecodedInstructionFn addHandler(const InstructionData& data);
 } // namespace momiji::instr
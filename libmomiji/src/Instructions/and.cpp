@@ -6,7 +6,8 @@
 
 namespace momiji::instr
 {
-    momiji::System and_instr(momiji::System& sys, const InstructionData& data)
+    momiji::ExecutionStatus and_instr(momiji::System& sys,
+                                      const InstructionData& data)
     {
         auto& pc = sys.cpu.programCounter;
 
@@ -16,22 +17,22 @@ namespace momiji::instr
         {
         case 1:
         {
-            auto dstreg = utils::readOperandPtr<std::int8_t>(sys, data, 1);
-            *dstreg     = *dstreg & std::int8_t(srcval & 0x0000'00FF);
+            auto dstreg = utils::readOperandRef<std::int8_t>(sys, data, 1);
+            dstreg      = dstreg & std::int8_t(srcval & 0x0000'00FF);
         }
         break;
 
         case 2:
         {
-            auto dstreg = utils::readOperandPtr<std::int16_t>(sys, data, 1);
-            *dstreg     = *dstreg & std::int16_t(srcval & 0x0000'FFFF);
+            auto dstreg = utils::readOperandRef<std::int16_t>(sys, data, 1);
+            dstreg      = dstreg & std::int16_t(srcval & 0x0000'FFFF);
         }
         break;
 
         case 4:
         {
-            auto dstreg = utils::readOperandPtr<std::int32_t>(sys, data, 1);
-            *dstreg     = *dstreg & srcval;
+            auto dstreg = utils::readOperandRef<std::int32_t>(sys, data, 1);
+            dstreg      = dstreg & srcval;
         }
         break;
         }
@@ -40,10 +41,11 @@ namespace momiji::instr
         pc += std::uint8_t(utils::isImmediate(data, 0));
         pc += std::uint8_t(utils::isImmediate(data, 1));
 
-        return sys;
+        return utils::completed(sys);
     }
 
-    momiji::System andi(momiji::System& sys, const InstructionData& data)
+    momiji::ExecutionStatus andi(momiji::System& sys,
+                                 const InstructionData& data)
     {
         return and_instr(sys, data);
     }
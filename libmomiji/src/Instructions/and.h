@@ -5,6 +5,8 @@
 
 namespace momiji::instr
 {
-    momiji::System and_instr(momiji::System& sys, const InstructionData& data);
-    momiji::System andi(momiji::System& sys, const InstructionData& data);
+    momiji::ExecutionStatus and_instr(momiji::System& sys,
+                                      const InstructionData& data);
+    momiji::ExecutionStatus andi(momiji::System& sys,
+                                 const InstructionData& data);
 } // namespace momiji::instr
@@ -5,12 +5,14 @@
 
 namespace momiji::instr
 {
-    momiji::System bcc(momiji::System& sys, const InstructionData& data)
+    momiji::ExecutionStatus bcc(momiji::System& sys,
+                                const InstructionData& data)
     {
         const auto pc        = sys.cpu.programCounter;
         const auto condition = utils::to_val(data.operandType[0]);
 
-        ProgramCounter::value_type offset = utils::to_val(data.operandType[1]);
+        // Same as instr::bra, backward branches have negative offsets
+        auto offset = std::int16_t(utils::to_val(data.operandType[1]));
 
         bool skipTwoBytes = false;
 
@@ -18,85 +20,66 @@ namespace momiji::instr
         {
             skipTwoBytes = true;
 
-            const auto nextloc = pc + 2;
+            offset = std::int16_t(utils::readImmediateFromPC(sys, pc, 2));
 
-            offset = *sys.mem.read16(nextloc.raw());
+            if (sys.trap.has_value())
+            {
+                return ExecutionStatus::Trap;
+            }
         }
 
-        const auto& statReg = sys.cpu.statusRegister;
-
         const auto normalIncrement = [&]() {
             sys.cpu.programCounter += skipTwoBytes ? 4 : 2;
         };
 
-        bool shouldBranch = false;
+        const bool shouldBranch =
+            branchConditionHolds(sys.cpu.statusRegister, condition);
+
+        if (shouldBranch)
+        {
+            sys.cpu.programCounter =
+                std::uint32_t(std::int32_t(pc.raw()) + offset);
+
+            return ExecutionStatus::BranchTaken;
+        }
+
+        normalIncrement();
+
+        return ExecutionStatus::Continue;
+    }
+
+    bool branchConditionHolds(const StatusRegister& statReg,
+                              std::uint8_t condition)
+    {
+        // Only the flags the condition needs are worked out
         switch (condition)
         {
         // NE
         case 0b0110:
-            if (statReg.zero == 0)
-            {
-                shouldBranch = true;
-            }
-            break;
+            return !statReg.zero();
 
         // EQ
         case 0b0111:
-            if (statReg.zero == 1)
-            {
-                shouldBranch = true;
-            }
-            break;
+            return statReg.zero();
 
         // GE
         case 0b1100:
-            if ((statReg.negative == 0 && statReg.overflow == 0) ||
-                (statReg.negative == 1 && statReg.overflow == 1))
-            {
-                shouldBranch = true;
-            }
-            break;
+            return statReg.negative() == statReg.overflow();
 
         // LT
         case 0b1101:
-            if ((statReg.negative == 0 && statReg.overflow == 1) ||
-                (statReg.negative == 1 && statReg.overflow == 0))
-            {
-                shouldBranch = true;
-            }
-            break;
+            return statReg.negative() != statReg.overflow();
 
         // GT
         case 0b1110:
-            if ((statReg.zero == 0 && statReg.negative == 0 &&
-                 statReg.overflow == 0) ||
-                (statReg.zero == 0 && statReg.negative == 1 &&
-                 statReg.overflow == 1))
-            {
-                shouldBranch = true;
-            }
-            break;
+            return !statReg.zero() &&
+                   statReg.negative() == statReg.overflow();
 
         // LE
         case 0b1111:
-            if ((statReg.negative == 0 && statReg.overflow == 1) ||
-                (statReg.negative == 1 && statReg.overflow == 0) ||
-                (statReg.zero == 1))
-            {
-                shouldBranch = true;
-            }
-            break;
-        }
-
-        if (shouldBranch)
-        {
-            sys.cpu.programCounter += offset;
-        }
-        else
-        {
-            normalIncrement();
+            return statReg.zero() || statReg.negative() != statReg.overflow();
         }
 
-        return sys;
+        return false;
     }
 } // namespace momiji::instr
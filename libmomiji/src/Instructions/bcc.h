@@ -5,5 +5,10 @@
 
 namespace momiji::instr
 {
-    momiji::System bcc(momiji::System& sys, const InstructionData& data);
-}
+    momiji::ExecutionStatus bcc(momiji::System& sys,
+                                const InstructionData& data);
+
+    // Whether a bcc with this condition code branches
+    bool branchConditionHolds(const StatusRegister& statReg,
+                              std::uint8_t condition);
+} // namespace momiji::instr
@@ -4,54 +4,59 @@
 
 namespace momiji::instr
 {
-    momiji::System bra(momiji::System& sys, const InstructionData& data)
+    momiji::ExecutionStatus bra(momiji::System& sys,
+                                const InstructionData& data)
     {
         std::int16_t offset = utils::to_val(data.operandType[0]);
 
         auto& pc = sys.cpu.programCounter;
 
-        auto memview = momiji::make_memory_view(sys);
-
         if (offset == 0)
         {
-            const auto nextloc = pc + 2;
+            offset = std::int16_t(utils::readImmediateFromPC(sys, pc, 2));
 
-            offset = std::int16_t(*memview.read16(nextloc.raw()));
+            if (sys.trap.has_value())
+            {
+                return ExecutionStatus::Trap;
+            }
         }
 
         auto& signed_pc = *pc.as<std::int32_t>();
         signed_pc += std::int32_t(offset);
 
-        return sys;
+        return ExecutionStatus::BranchTaken;
     }
 
-    momiji::System bsr(momiji::System& sys, const InstructionData& data)
+    momiji::ExecutionStatus bsr(momiji::System& sys,
+                                const InstructionData& data)
     {
         auto& pc = sys.cpu.programCounter;
         auto& sp = sys.cpu.addressRegisters[7];
 
-        sp -= 4;
+        std::int16_t offset = utils::to_val(data.operandType[0]);
 
-        const auto writeRes = sys.mem.write32(pc.raw(), sp.raw());
+        // The address of the instruction after this one is pushed
+        auto ret = pc + 2;
 
-        if (!writeRes)
+        if (offset == 0)
         {
-            // Do something with this
+            offset = std::int16_t(utils::readImmediateFromPC(sys, pc, 2));
+            ret += 2;
         }
 
-        std::int16_t offset = utils::to_val(data.operandType[0]);
+        sp -= 4;
 
-        if (offset == 0)
-        {
-            const auto nextloc = pc + 2;
+        bus::write(sys, std::uint32_t(sp.raw()), ret.raw());
 
-            offset = std::int16_t(*sys.mem.read16(nextloc.raw()));
-        }
+        const auto callSite = pc.raw();
 
         auto& signed_pc = *pc.as<std::int32_t>();
 
         signed_pc += std::int32_t(offset);
 
-        return sys;
+        sys.callStack.frames.push_back({ callSite, pc.raw(), sp.raw() });
+
+        return sys.trap.has_value() ? ExecutionStatus::Trap
+                                    : ExecutionStatus::BranchTaken;
     }
 } // namespace momiji::instr
@@ -5,6 +5,8 @@
 
 namespace momiji::instr
 {
-    momiji::System bra(momiji::System& sys, const InstructionData& data);
-    momiji::System bsr(momiji::System& sys, const InstructionData& data);
+    momiji::ExecutionStatus bra(momiji::System& sys,
+                                const InstructionData& data);
+    momiji::ExecutionStatus bsr(momiji::System& sys,
+                                const InstructionData& data);
 } // namespace momiji::instr
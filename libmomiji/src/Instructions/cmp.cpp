@@ -5,7 +5,8 @@
 
 namespace momiji::instr
 {
-    momiji::System cmp(momiji::System& sys, const InstructionData& instr)
+    momiji::ExecutionStatus cmp(momiji::System& sys,
+                                const InstructionData& instr)
     {
         auto& pc = sys.cpu.programCounter;
 
@@ -24,6 +25,7 @@ namespace momiji::instr
             break;
 
         default:
+            srcreg = utils::readOperandVal(sys, instr, 0);
             break;
         }
 
@@ -47,20 +49,19 @@ namespace momiji::instr
             break;
         }
 
-        const std::int32_t res = dstreg - srcreg;
+        const auto res =
+            std::int32_t(std::uint32_t(dstreg) - std::uint32_t(srcreg));
 
-        sys.cpu.statusRegister.negative = (res < 0) ? 1 : 0;
-        sys.cpu.statusRegister.zero     = (res == 0) ? 1 : 0;
-        sys.cpu.statusRegister.overflow =
-            utils::sub_overflow(dstreg, srcreg) ? 1 : 0;
+        sys.cpu.statusRegister.setCompare(instr.size, srcreg, dstreg, res);
 
         pc += 2;
         pc += std::uint8_t(utils::isImmediate(instr, 0));
 
-        return sys;
+        return utils::completed(sys);
     }
 
-    momiji::System cmpa(momiji::System& sys, const InstructionData& instr)
+    momiji::ExecutionStatus cmpa(momiji::System& sys,
+                                 const InstructionData& instr)
     {
         auto& pc            = sys.cpu.programCounter;
         std::int32_t srcreg = 0;
@@ -78,6 +79,7 @@ namespace momiji::instr
             break;
 
         default:
+            srcreg = utils::readOperandVal(sys, instr, 0);
             break;
         }
 
@@ -102,26 +104,23 @@ namespace momiji::instr
             break;
         }
 
-        const std::int32_t res = dstreg - srcreg;
+        const auto res =
+            std::int32_t(std::uint32_t(dstreg) - std::uint32_t(srcreg));
 
-        sys.cpu.statusRegister.negative = (res < 0) ? 1 : 0;
-        sys.cpu.statusRegister.zero     = (res == 0) ? 1 : 0;
-        sys.cpu.statusRegister.overflow =
-            utils::sub_overflow(dstreg, srcreg) ? 1 : 0;
+        sys.cpu.statusRegister.setCompare(instr.size, srcreg, dstreg, res);
 
         pc += 2;
         pc += std::uint8_t(utils::isImmediate(instr, 0));
         pc += std::uint8_t(utils::isImmediate(instr, 1));
 
-        return sys;
+        return utils::completed(sys);
     }
 
-    momiji::System cmpi(momiji::System& sys, const InstructionData& instr)
+    momiji::ExecutionStatus cmpi(momiji::System& sys,
+                                 const InstructionData& instr)
     {
         auto& pc = sys.cpu.programCounter;
 
-        auto memview = momiji::make_memory_view(sys);
-
         const auto dstval = std::int8_t(utils::to_val(instr.addressingMode[1]));
         auto dstreg       = asl::saccess(sys.cpu.dataRegisters, dstval).raw();
 
@@ -139,39 +138,30 @@ namespace momiji::instr
             break;
         }
 
-        std::int32_t srcval = 0;
+        std::int32_t srcval = utils::readImmediateFromPC(sys, pc, instr.size);
 
-        const auto nextloc = pc + 2;
         switch (instr.size)
         {
         case 1:
-            srcval = *memview.read8(nextloc.raw());
             srcval = utils::sign_extend<std::int8_t>(srcval);
             dstreg = utils::sign_extend<std::int8_t>(dstreg);
             break;
 
         case 2:
-            srcval = *memview.read16(nextloc.raw());
             srcval = utils::sign_extend<std::int16_t>(srcval);
             dstreg = utils::sign_extend<std::int16_t>(dstreg);
             break;
-
-        case 4:
-            srcval = std::int32_t(*memview.read32(nextloc.raw()));
-            break;
         }
 
-        const std::int32_t res = dstreg - srcval;
+        const auto res =
+            std::int32_t(std::uint32_t(dstreg) - std::uint32_t(srcval));
 
-        sys.cpu.statusRegister.negative = (res < 0) ? 1 : 0;
-        sys.cpu.statusRegister.zero     = (res == 0) ? 1 : 0;
-        sys.cpu.statusRegister.overflow =
-            utils::sub_overflow(dstreg, srcval) ? 1 : 0;
+        sys.cpu.statusRegister.setCompare(instr.size, srcval, dstreg, res);
 
         pc += 2;
         pc += std::uint8_t(utils::isImmediate(instr, 0));
         pc += std::uint8_t(utils::isImmediate(instr, 1));
 
-        return sys;
+        return utils::completed(sys);
     }
 } // namespace momiji::instr
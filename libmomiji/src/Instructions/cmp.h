@@ -5,7 +5,10 @@
 
 namespace momiji::instr
 {
-    momiji::System cmp(momiji::System& sys, const InstructionData& instr);
-    momiji::System cmpa(momiji::System& sys, const InstructionData& instr);
-    momiji::System cmpi(momiji::System& sys, const InstructionData& instr);
+    momiji::ExecutionStatus cmp(momiji::System& sys,
+                                const InstructionData& instr);
+    momiji::ExecutionStatus cmpa(momiji::System& sys,
+                                 const InstructionData& instr);
+    momiji::ExecutionStatus cmpi(momiji::System& sys,
+                                 const InstructionData& instr);
 } // namespace momiji::instr
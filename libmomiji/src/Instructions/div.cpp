@@ -6,49 +6,105 @@
 
 namespace momiji::instr
 {
-
-    momiji::System divs(momiji::System& sys, const InstructionData& data)
+    namespace
+    {
+        // The quotient goes in the low word, the remainder in the high one.
+        // A quotient not fitting in a word only sets V.
+        template <typename Quotient>
+        void storeDivision(momiji::System& sys,
+                           std::int32_t dstreg,
+                           std::int64_t quot,
+                           std::int64_t rem)
+        {
+            auto& sr = sys.cpu.statusRegister;
+
+            if (quot != std::int64_t(Quotient(quot)))
+            {
+                sr.set(StatusRegister::Overflow, true);
+                sr.set(StatusRegister::Carry, false);
+
+                return;
+            }
+
+            asl::saccess(sys.cpu.dataRegisters, dstreg) =
+                std::int32_t(((rem & 0xFFFF) << 16) | (quot & 0xFFFF));
+
+            sr.setLogical(2, std::int32_t(quot));
+        }
+
+        momiji::ExecutionStatus divisionByZero(momiji::System& sys)
+        {
+            sys.trap = traps::DivisionByZero {};
+
+            return ExecutionStatus::Trap;
+        }
+    } // namespace
+
+    momiji::ExecutionStatus divs(momiji::System& sys,
+                                 const InstructionData& data)
     {
         auto& pc = sys.cpu.programCounter;
 
         std::int32_t srcval = utils::readOperandVal(sys, data, 0);
 
+        if (sys.trap.has_value())
+        {
+            return ExecutionStatus::Trap;
+        }
+
         srcval = utils::sign_extend<std::int16_t>(srcval);
 
         // Always a data register
         const std::int32_t dstreg = utils::to_val(data.addressingMode[1]);
 
-        const std::int32_t dstval =
-            asl::saccess(sys.cpu.dataRegisters, dstreg).raw();
-        const std::int32_t quot = (dstval / srcval) & 0x0000'FFFF;
-        const std::int32_t rem  = (dstval % srcval) & 0x0000'FFFF;
-
-        asl::saccess(sys.cpu.dataRegisters, dstreg) = (rem << 16) | (quot);
-
         pc += 2;
         pc += std::uint8_t(utils::isImmediate(data, 0));
 
-        return sys;
+        if (srcval == 0)
+        {
+            return divisionByZero(sys);
+        }
+
+        // 64 bits so that the most negative value over -1 can't overflow
+        const std::int64_t dstval =
+            asl::saccess(sys.cpu.dataRegisters, dstreg).raw();
+
+        storeDivision<std::int16_t>(
+            sys, dstreg, dstval / srcval, dstval % srcval);
+
+        return utils::completed(sys);
     }
 
-    momiji::System divu(momiji::System& sys, const InstructionData& data)
+    momiji::ExecutionStatus divu(momiji::System& sys,
+                                 const InstructionData& data)
     {
         auto& pc = sys.cpu.programCounter;
 
-        std::int32_t srcval = utils::readOperandVal(sys, data, 0);
+        const auto srcval =
+            std::uint16_t(utils::readOperandVal(sys, data, 0));
+
+        if (sys.trap.has_value())
+        {
+            return ExecutionStatus::Trap;
+        }
 
         // Always a data register
         const std::int32_t dstreg = utils::to_val(data.addressingMode[1]);
 
-        std::int32_t dstval = asl::saccess(sys.cpu.dataRegisters, dstreg).raw();
-        std::int32_t quot   = (dstval / srcval) & 0x0000'FFFF;
-        std::int32_t rem    = (dstval % srcval) & 0x0000'FFFF;
-
-        asl::saccess(sys.cpu.dataRegisters, dstreg) = (rem << 16) | (quot);
-
         pc += 2;
         pc += std::uint8_t(utils::isImmediate(data, 0));
 
-        return sys;
+        if (srcval == 0)
+        {
+            return divisionByZero(sys);
+        }
+
+        const auto dstval = std::uint32_t(
+            asl::saccess(sys.cpu.dataRegisters, dstreg).raw());
+
+        storeDivision<std::uint16_t>(
+            sys, dstreg, dstval / srcval, dstval % srcval);
+
+        return utils::completed(sys);
     }
 } // namespace momiji::instr
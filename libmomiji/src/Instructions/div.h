@@ -5,6 +5,8 @@
 
 namespace momiji::instr
 {
-    momiji::System divs(momiji::System& sys, const InstructionData& data);
-    momiji::System divu(momiji::System& sys, const InstructionData& data);
+    momiji::ExecutionStatus divs(momiji::System& sys,
+                                 const InstructionData& data);
+    momiji::ExecutionStatus divu(momiji::System& sys,
+                                 const InstructionData& data);
 } // namespace momiji::instr
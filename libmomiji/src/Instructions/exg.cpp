@@ -11,7 +11,8 @@ namespace momiji::instr
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wsign-conversion"
 #endif
-    momiji::System exg(momiji::System& sys, const InstructionData& instr)
+    momiji::ExecutionStatus exg(momiji::System& sys,
+                                const InstructionData& instr)
     {
         auto& pc = sys.cpu.programCounter;
 
@@ -57,7 +58,7 @@ namespace momiji::instr
         pc += std::uint32_t(utils::isImmediate(instr, 0));
         pc += std::uint32_t(utils::isImmediate(instr, 1));
 
-        return sys;
+        return ExecutionStatus::Continue;
     }
 #ifdef ASL_CLANG
 #pragma clang diagnostic pop
@@ -5,5 +5,6 @@
 
 namespace momiji::instr
 {
-    momiji::System exg(momiji::System& sys, const InstructionData& instr);
+    momiji::ExecutionStatus exg(momiji::System& sys,
+                                const InstructionData& instr);
 }
@@ -6,10 +6,10 @@
 
 namespace momiji::instr
 {
-    inline momiji::System illegal(momiji::System& sys,
-                                  const InstructionData& /*data*/)
+    inline momiji::ExecutionStatus illegal(momiji::System& sys,
+                                           const InstructionData& /*data*/)
     {
         sys.trap = traps::IllegalInstruction {};
-        return sys;
+        return ExecutionStatus::Trap;
     }
 } // namespace momiji::instr
@@ -1,20 +1,22 @@
 #include "internal.h"
 
-#include <iostream>
-
 namespace momiji::instr
 {
-    momiji::System handleBreakpoint(momiji::System& sys,
-                                    const InstructionData& /*instr*/)
+    momiji::ExecutionStatus handleBreakpoint(momiji::System& sys,
+                                             const InstructionData& /*instr*/)
     {
-        std::cout << "we\n";
-        return sys;
+        // Skip the control code too, resuming must not hit the same
+        // breakpoint again.
+        sys.cpu.programCounter += 4;
+
+        return ExecutionStatus::Breakpoint;
     }
 
-    momiji::System hcf(momiji::System& sys, const InstructionData& /*instr*/)
+    momiji::ExecutionStatus hcf(momiji::System& sys,
+                                const InstructionData& /*instr*/)
     {
         sys.cpu.programCounter = 0xFFFFFFFF;
 
-        return sys;
+        return ExecutionStatus::Halt;
     }
 } // namespace momiji::instr
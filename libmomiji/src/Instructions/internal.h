@@ -5,7 +5,8 @@
 
 namespace momiji::instr
 {
-    momiji::System handleBreakpoint(momiji::System& sys,
-                                    const InstructionData& instr);
-    momiji::System hcf(momiji::System& sys, const InstructionData& instr);
+    momiji::ExecutionStatus handleBreakpoint(momiji::System& sys,
+                                             const InstructionData& instr);
+    momiji::ExecutionStatus hcf(momiji::System& sys,
+                                const InstructionData& instr);
 } // namespace momiji::instr
@@ -20,7 +20,7 @@ namespace momiji::instr
         // offset(a*)
         case OperandType::AddressOffset: {
             const std::int32_t displacement =
-                utils::readImmediateFromPC(sys.mem, pc, 2);
+                utils::readImmediateFromPC(sys, pc, 2);
 
             return std::uint32_t(sys.cpu.addressRegisters[regnum].raw() +
                                  displacement);
@@ -29,7 +29,7 @@ namespace momiji::instr
         // (offset, a*, **)
         case OperandType::AddressIndex: {
             const std::int32_t immData =
-                utils::readImmediateFromPC(sys.mem, pc, 2);
+                utils::readImmediateFromPC(sys, pc, 2);
 
             const auto newreg       = std::int8_t((immData & 0xF000) >> 12);
             const auto displacement = std::int8_t(immData & 0x00FF);
@@ -55,12 +55,12 @@ namespace momiji::instr
             {
             case SpecialAddressingMode::AbsoluteShort:
                 return std::uint32_t(
-                    utils::readImmediateFromPC(sys.mem, pc, 2));
+                    utils::readImmediateFromPC(sys, pc, 2));
 
             case SpecialAddressingMode::AbsoluteLong:
             case SpecialAddressingMode::Immediate:
                 return std::uint32_t(
-                    utils::readImmediateFromPC(sys.mem, pc, 4));
+                    utils::readImmediateFromPC(sys, pc, 4));
 
             default:
                 // None
@@ -76,27 +76,35 @@ namespace momiji::instr
         return sys.cpu.programCounter.raw();
     }
 
-    momiji::System jmp(momiji::System& sys, const InstructionData& data)
+    momiji::ExecutionStatus jmp(momiji::System& sys,
+                                const InstructionData& data)
     {
         sys.cpu.programCounter = handleAddressResolution(sys, data);
 
-        return sys;
+        return sys.trap.has_value() ? ExecutionStatus::Trap
+                                    : ExecutionStatus::BranchTaken;
     }
 
-    momiji::System jsr(momiji::System& sys, const InstructionData& data)
+    momiji::ExecutionStatus jsr(momiji::System& sys,
+                                const InstructionData& data)
     {
         auto& sp = sys.cpu.addressRegisters[7];
         auto& pc = sys.cpu.programCounter;
 
+        // The address of the instruction after this one is pushed
+        const auto ret = pc + 2 + utils::isImmediate(data, 0);
+
         sp -= 4;
 
-        auto retaddr =
-            reinterpret_cast<std::uint32_t*>(sys.mem.data() + sp.raw());
+        bus::write(sys, std::uint32_t(sp.raw()), ret.raw());
 
-        *retaddr = pc.raw();
+        const auto callSite = pc.raw();
 
         pc = handleAddressResolution(sys, data);
 
-        return sys;
+        sys.callStack.frames.push_back({ callSite, pc.raw(), sp.raw() });
+
+        return sys.trap.has_value() ? ExecutionStatus::Trap
+                                    : ExecutionStatus::BranchTaken;
     }
 } // namespace momiji::instr
@@ -5,6 +5,8 @@
 
 namespace momiji::instr
 {
-    momiji::System jmp(momiji::System& sys, const InstructionData& data);
-    momiji::System jsr(momiji::System& sys, const InstructionData& data);
+    momiji::ExecutionStatus jmp(momiji::System& sys,
+                                const InstructionData& data);
+    momiji::ExecutionStatus jsr(momiji::System& sys,
+                                const InstructionData& data);
 } // namespace momiji::instr
@@ -1,54 +1,63 @@
 #include "move.h"
 
+#include "HandlerTable.h"
 #include "Utils.h"
 
-#include <iostream>
-
 namespace momiji::instr
 {
-    momiji::System move(momiji::System& sys, const InstructionData& data)
+    namespace
     {
-        // For data and address registers the value is already stored
-        std::int32_t srcval = utils::readOperandVal(sys, data, 0);
+        struct Move
+        {
+            template <std::int8_t Size,
+                      utils::OperandKind Src,
+                      utils::OperandKind Dst>
+            static momiji::ExecutionStatus run(momiji::System& sys,
+                                               const InstructionData& data)
+            {
+                using To = utils::sized_int_t<Size>;
+
+                // For data and address registers the value is already stored
+                const std::int32_t srcval =
+                    utils::readOperandVal<Src, Size>(sys, data, 0);
+
+                auto& pc = sys.cpu.programCounter;
+
+                auto dst = utils::readOperandRef<To, Dst>(sys, data, 1);
+                dst      = To(srcval);
+
+                sys.cpu.statusRegister.setLogical(Size, srcval);
 
-        auto& pc = sys.cpu.programCounter;
+                pc += 2;
+
+                pc += std::uint8_t(utils::extensionSize<Src, Size>(data, 0));
+                pc += std::uint8_t(utils::extensionSize<Dst, Size>(data, 1));
+
+                return utils::completed<Src, Dst>(sys);
+            }
+        };
+    } // namespace
+
+    momiji::ExecutionStatus move(momiji::System& sys,
+                                 const InstructionData& data)
+    {
+        constexpr auto dyn = utils::OperandKind::Dynamic;
 
         switch (data.size)
         {
         case 1:
-        {
-            auto dst = utils::readOperandPtr<std::int8_t>(sys, data, 1);
-            *dst     = std::int8_t((srcval & 0x0000'00FF));
-        }
-        break;
+            return Move::run<1, dyn, dyn>(sys, data);
 
         case 2:
-        {
-            auto dst = utils::readOperandPtr<std::int16_t>(sys, data, 1);
-            *dst     = std::int16_t((srcval & 0x0000'FFFF));
-        }
-        break;
+            return Move::run<2, dyn, dyn>(sys, data);
 
-        case 4:
-        {
-            auto dst = utils::readOperandPtr<std::int32_t>(sys, data, 1);
-            *dst     = srcval;
-        }
-        break;
+        default:
+            return Move::run<4, dyn, dyn>(sys, data);
         }
+    }
 
-        auto& statusReg = sys.cpu.statusRegister;
-
-        statusReg.negative = srcval < 0;
-        statusReg.zero     = srcval == 0;
-        statusReg.overflow = 0;
-        statusReg.carry    = 0;
-
-        pc += 2;
-
-        pc += std::uint8_t(utils::isImmediate(data, 0));
-        pc += std::uint8_t(utils::isImmediate(data, 1));
-
-        return sys;
+    DecodedInstructionFn moveHandler(const InstructionData& data)
+    {
+        return specialised<Move>(data);
     }
 } // namespace momiji::instr
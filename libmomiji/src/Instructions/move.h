@@ -5,5 +5,9 @@
 
 namespace momiji::instr
 {
-    momiji::System move(momiji::System& sys, const InstructionData& data);
-}
+    momiji::ExecutionStatus move(momiji::System& sys,
+                                 const InstructionData& data);
+
+    // The instantiation of move specialised on the size and operands of data
+    DecodedInstructionFn moveHandler(const InstructionData& data);
+} // namespace momiji::instr
@@ -8,7 +8,8 @@
 namespace momiji::instr
 {
 
-    momiji::System muls(momiji::System& sys, const InstructionData& data)
+    momiji::ExecutionStatus muls(momiji::System& sys,
+                                 const InstructionData& data)
     {
         auto& pc = sys.cpu.programCounter;
 
@@ -27,10 +28,11 @@ namespace momiji::instr
         pc += std::uint8_t(utils::isImmediate(data, 0));
         pc += std::uint8_t(utils::isImmediate(data, 1));
 
-        return sys;
+        return utils::completed(sys);
     }
 
-    momiji::System mulu(momiji::System& sys, const InstructionData& data)
+    momiji::ExecutionStatus mulu(momiji::System& sys,
+                                 const InstructionData& data)
     {
         auto& pc = sys.cpu.programCounter;
 
@@ -47,6 +49,6 @@ namespace momiji::instr
         pc += std::uint8_t(utils::isImmediate(data, 0));
         pc += std::uint8_t(utils::isImmediate(data, 1));
 
-        return sys;
+        return utils::completed(sys);
     }
 } // namespace momiji::instr
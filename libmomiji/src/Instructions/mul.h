@@ -5,6 +5,8 @@
 
 namespace momiji::instr
 {
-    momiji::System muls(momiji::System& sys, const InstructionData& data);
-    momiji::System mulu(momiji::System& sys, const InstructionData& data);
+    momiji::ExecutionStatus muls(momiji::System& sys,
+                                 const InstructionData& data);
+    momiji::ExecutionStatus mulu(momiji::System& sys,
+                                 const InstructionData& data);
 } // namespace momiji::instr
@@ -2,8 +2,9 @@
 
 namespace momiji::instr
 {
-    momiji::System noop(momiji::System& sys, const InstructionData& /*data*/)
+    momiji::ExecutionStatus noop(momiji::System& /*sys*/,
+                                 const InstructionData& /*data*/)
     {
-        return sys;
+        return ExecutionStatus::Continue;
     }
 } // namespace momiji::instr
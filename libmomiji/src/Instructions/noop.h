@@ -6,5 +6,6 @@
 
 namespace momiji::instr
 {
-    momiji::System noop(momiji::System& sys, const InstructionData& /*data*/);
+    momiji::ExecutionStatus noop(momiji::System& sys,
+                                 const InstructionData& /*data*/);
 } // namespace momiji::instr
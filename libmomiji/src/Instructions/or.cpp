@@ -7,7 +7,8 @@
 
 namespace momiji::instr
 {
-    momiji::System or_instr(momiji::System& sys, const InstructionData& data)
+    momiji::ExecutionStatus or_instr(momiji::System& sys,
+                                     const InstructionData& data)
     {
         auto& pc          = sys.cpu.programCounter;
         const auto srcval = utils::readOperandVal(sys, data, 0);
@@ -16,22 +17,22 @@ namespace momiji::instr
         {
         case 1:
         {
-            auto dstval = utils::readOperandPtr<std::int8_t>(sys, data, 1);
-            *dstval     = *dstval | (srcval & 0x0000'00FF);
+            auto dstval = utils::readOperandRef<std::int8_t>(sys, data, 1);
+            dstval      = dstval | (srcval & 0x0000'00FF);
         }
         break;
 
         case 2:
         {
-            auto dstval = utils::readOperandPtr<std::int16_t>(sys, data, 1);
-            *dstval     = *dstval | (srcval & 0x0000'FFFF);
+            auto dstval = utils::readOperandRef<std::int16_t>(sys, data, 1);
+            dstval      = dstval | (srcval & 0x0000'FFFF);
         }
         break;
 
         case 4:
         {
-            auto dstval = utils::readOperandPtr<std::int32_t>(sys, data, 1);
-            *dstval     = *dstval | srcval;
+            auto dstval = utils::readOperandRef<std::int32_t>(sys, data, 1);
+            dstval      = dstval | srcval;
         }
         break;
         }
@@ -40,10 +41,11 @@ namespace momiji::instr
         pc += std::uint8_t(utils::isImmediate(data, 0));
         pc += std::uint8_t(utils::isImmediate(data, 1));
 
-        return sys;
+        return utils::completed(sys);
     }
 
-    momiji::System ori(momiji::System& sys, const InstructionData& data)
+    momiji::ExecutionStatus ori(momiji::System& sys,
+                                const InstructionData& data)
     {
         return or_instr(sys, data);
     }
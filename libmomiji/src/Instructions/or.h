@@ -5,6 +5,8 @@
 
 namespace momiji::instr
 {
-    momiji::System or_instr(momiji::System& sys, const InstructionData& data);
-    momiji::System ori(momiji::System& sys, const InstructionData& data);
+    momiji::ExecutionStatus or_instr(momiji::System& sys,
+                                     const InstructionData& data);
+    momiji::ExecutionStatus ori(momiji::System& sys,
+                                const InstructionData& data);
 } // namespace momiji::instr
@@ -1,68 +1,42 @@
 #include "rts.h"
 
-// an hack
-#include "bra.h"
-#include "jmp.h"
-#include <Decoder.h>
+#include <momiji/Bus.h>
 
 namespace momiji::instr
 {
-    static int handleJsrData(const DecodedInstruction& instr)
+    // bsr and jsr push the address of the instruction after them
+    momiji::ExecutionStatus rts(momiji::System& sys,
+                                const momiji::InstructionData& /*instr*/)
     {
-        switch (instr.data.operandType[0])
-        {
-        case OperandType::AddressOffset:
-            [[fallthrough]];
-        case OperandType::AddressIndex:
-            return 2;
+        auto& sp     = sys.cpu.addressRegisters[7];
+        auto& pc     = sys.cpu.programCounter;
+        auto& frames = sys.callStack.frames;
 
-        case OperandType::Immediate:
-            switch (instr.data.addressingMode[0])
+        // Frames whose return address was already popped some other way
+        // are left too
+        while (!frames.empty() && frames.back().stackPointer <= sp.raw())
+        {
+            if (sys.callStack.undoLog != nullptr)
             {
-            case SpecialAddressingMode::AbsoluteShort:
-                return 2;
-
-            case SpecialAddressingMode::AbsoluteLong:
-                return 4;
-
-            case SpecialAddressingMode::Immediate:
-                return instr.data.size;
-
-            default:
-                return 0;
+                sys.callStack.undoLog->push_back(frames.back());
             }
 
-        default:
-            return 0;
+            frames.pop_back();
         }
-    }
 
-    momiji::System rts(momiji::System& sys,
-                       const momiji::InstructionData& /*instr*/)
-    {
-        auto& sp = sys.cpu.addressRegisters[7];
-        auto& pc = sys.cpu.programCounter;
-
-        pc = *sys.mem.read32(sp.raw());
+        pc = bus::read<std::uint32_t>(sys, std::uint32_t(sp.raw()));
         sp += 4;
 
-        auto retInstr = momiji::decode(sys.mem, pc.raw());
-
-        if (retInstr.exec == instr::bsr)
+        if (sys.trap.has_value())
         {
-            pc += 2;
-
-            std::int16_t offset = utils::to_val(retInstr.data.operandType[0]);
-            if (offset == 0)
-            {
-                pc += 2;
-            }
+            return ExecutionStatus::Trap;
         }
-        else if (retInstr.exec == instr::jsr)
+
+        if (std::int64_t(frames.size()) < sys.callStack.returnDepth)
         {
-            pc += std::uint32_t(2 + handleJsrData(retInstr));
+            return ExecutionStatus::Returned;
         }
 
-        return sys;
+        return ExecutionStatus::BranchTaken;
     }
 } // namespace momiji::instr
@@ -5,6 +5,6 @@
 
 namespace momiji::instr
 {
-    momiji::System rts(momiji::System& sys,
-                       const momiji::InstructionData& instr);
+    momiji::ExecutionStatus rts(momiji::System& sys,
+                                const momiji::InstructionData& instr);
 }
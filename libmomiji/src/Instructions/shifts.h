@@ -51,7 +51,8 @@ namespace momiji::instr
     } // namespace details
 
     template <typename ShiftType>
-    momiji::System shift(momiji::System& sys, const InstructionData& instr)
+    momiji::ExecutionStatus shift(momiji::System& sys,
+                                  const InstructionData& instr)
     {
         const auto mask = [&]() -> std::int32_t {
             switch (instr.size)
@@ -73,10 +74,11 @@ namespace momiji::instr
         if (instr.operandType[1] == OperandType::Address)
         {
             // Memory shift
-            auto dst = utils::readOperandPtr<std::int16_t>(sys, instr, 0);
+            auto dst = utils::readOperandRef<std::int16_t>(sys, instr, 0);
 
-            auto& dstref = *dst;
-            ShiftType::compute(dstref, 1, mask);
+            std::int16_t dstval = dst;
+            ShiftType::compute(dstval, 1, mask);
+            dst = dstval;
 
             pc += std::uint8_t(utils::isImmediate(instr, 0));
         }
@@ -102,15 +104,15 @@ namespace momiji::instr
             }
         }
 
-        return sys;
+        return ExecutionStatus::Continue;
     }
 
-    template System shift<details::ArithShiftLeft>(System&,
-                                                   const InstructionData&);
-    template System shift<details::ArithShiftRight>(System&,
-                                                    const InstructionData&);
-    template System shift<details::LogicalShiftLeft>(System&,
-                                                     const InstructionData&);
-    template System shift<details::LogicalShiftRight>(System&,
-                                                      const InstructionData&);
+    template ExecutionStatus
+    shift<details::ArithShiftLeft>(System&, const InstructionData&);
+    template ExecutionStatus
+    shift<details::ArithShiftRight>(System&, const InstructionData&);
+    template ExecutionStatus
+    shift<details::LogicalShiftLeft>(System&, const InstructionData&);
+    template ExecutionStatus
+    shift<details::LogicalShiftRight>(System&, const InstructionData&);
 } // namespace momiji::instr
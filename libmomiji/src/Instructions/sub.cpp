@@ -9,51 +9,67 @@ namespace momiji::instr
 
     // This functions will still check for an address register as a
     // destination
-    momiji::System sub(momiji::System& sys, const InstructionData& data)
+    momiji::ExecutionStatus sub(momiji::System& sys,
+                                const InstructionData& data)
     {
         auto& pc = sys.cpu.programCounter;
 
-        std::int32_t srcval = utils::readOperandVal(sys, data, 0);
+        const std::int32_t srcval = utils::readOperandVal(sys, data, 0);
 
         auto& statusReg = sys.cpu.statusRegister;
 
         switch (data.size)
         {
         case 1: {
-            auto dst = utils::readOperandPtr<std::int8_t>(sys, data, 1);
-            *dst     = *dst - std::int8_t(srcval & 0x0000'00FF);
+            auto dst = utils::readOperandRef<std::int8_t>(sys, data, 1);
+
+            const std::int8_t dstval = dst;
+            const auto result        = std::int8_t(dstval - srcval);
+            dst                      = result;
+
+            statusReg.setSub(1, srcval, dstval, result);
         }
         break;
 
         case 2: {
-            auto dst = utils::readOperandPtr<std::int16_t>(sys, data, 1);
-            *dst     = *dst - std::int8_t(srcval & 0x0000'FFFF);
+            auto dst = utils::readOperandRef<std::int16_t>(sys, data, 1);
+
+            const std::int16_t dstval = dst;
+            const auto result         = std::int16_t(dstval - srcval);
+            dst                       = result;
+
+            statusReg.setSub(2, srcval, dstval, result);
         }
         break;
 
         case 4: {
-            auto dst = utils::readOperandPtr<std::int32_t>(sys, data, 1);
-            *dst     = *dst - srcval;
+            auto dst = utils::readOperandRef<std::int32_t>(sys, data, 1);
+
+            const std::int32_t dstval = dst;
+            const auto result         = std::int32_t(std::uint32_t(dstval) -
+                                             std::uint32_t(srcval));
+            dst                       = result;
+
+            statusReg.setSub(4, srcval, dstval, result);
         }
         break;
         }
 
-        statusReg.carry  = 0;
-        statusReg.extend = statusReg.carry;
-
         pc += 2;
         pc += std::uint8_t(utils::isImmediate(data, 0));
         pc += std::uint8_t(utils::isImmediate(data, 1));
 
-        return sys;
+        return utils::completed(sys);
     }
 
-    momiji::System suba(momiji::System& sys, const InstructionData& data)
+    momiji::ExecutionStatus suba(momiji::System& sys,
+                                 const InstructionData& data)
     {
         return instr::sub(sys, data);
     }
 
-    momiji::System subi(momiji::System& sys, const InstructionData& data)
+    momiji::ExecutionStatus subi(momiji::System& sys,
+                                 const InstructionData& data)
     {
         return instr::sub(sys, data);
     }
@@ -5,7 +5,10 @@
 
 namespace momiji::instr
 {
-    momiji::System sub(momiji::System& sys, const InstructionData& data);
-    momiji::System subi(momiji::System& sys, const InstructionData& data);
-    momiji::System suba(momiji::System& sys, const InstructionData& data);
+    momiji::ExecutionStatus sub(momiji::System& sys,
+                                const InstructionData& data);
+    momiji::ExecutionStatus subi(momiji::System& sys,
+                                 const InstructionData& data);
+    momiji::ExecutionStatus suba(momiji::System& sys,
+                                 const InstructionData& data);
 } // namespace momiji::instr
@@ -11,7 +11,8 @@ namespace momiji::instr
 #pragma clang diagnostic ignored "-Wsign-conversion"
 #endif
 
-    momiji::System swap(momiji::System& sys, const InstructionData& instr)
+    momiji::ExecutionStatus swap(momiji::System& sys,
+                                 const InstructionData& instr)
     {
         const auto datareg =
             std::int8_t(utils::to_val(instr.addressingMode[0]));
@@ -25,7 +26,7 @@ namespace momiji::instr
 
         sys.cpu.programCounter += 2;
 
-        return sys;
+        return ExecutionStatus::Continue;
     }
 #ifdef ASL_CLANG
 #pragma clang diagnostic pop
@@ -5,5 +5,6 @@
 
 namespace momiji::instr
 {
-    momiji::System swap(momiji::System& sys, const InstructionData& instr);
+    momiji::ExecutionStatus swap(momiji::System& sys,
+                                 const InstructionData& instr);
 }
@@ -0,0 +1,106 @@
+#include "trap.h"
+
+#include "./Utils.h"
+
+#include <momiji/Exceptions.h>
+
+namespace momiji::instr
+{
+    namespace
+    {
+        momiji::ExecutionStatus privilegeViolation(momiji::System& sys)
+        {
+            sys.trap = traps::PrivilegeViolation {};
+            return ExecutionStatus::Trap;
+        }
+    } // namespace
+
+    // The emulator does the exception processing, the PC saved is the one
+    // of the next instruction
+    momiji::ExecutionStatus trap(momiji::System& sys,
+                                 const InstructionData& data)
+    {
+        sys.trap = traps::Trap { utils::to_val(data.operandType[0]) };
+
+        sys.cpu.programCounter += 2;
+
+        return ExecutionStatus::Trap;
+    }
+
+    // Only pops the short frame, handlers of bus and address errors skip
+    // the rest themselves as on the 68000
+    momiji::ExecutionStatus rte(momiji::System& sys,
+                                const InstructionData& /*data*/)
+    {
+        auto& cpu = sys.cpu;
+
+        if (!cpu.statusRegister.supervisor())
+        {
+            return privilegeViolation(sys);
+        }
+
+        auto& sp = cpu.addressRegisters[7];
+
+        const auto status = bus::read<std::uint16_t>(sys, sp.raw());
+        const auto pc     = bus::read<std::uint32_t>(sys, sp.raw() + 2);
+
+        if (sys.trap.has_value())
+        {
+            return ExecutionStatus::Trap;
+        }
+
+        sp += 6;
+
+        cpu.programCounter = pc;
+        cpu.setStatusWord(status);
+
+        // The mask may let a waiting interrupt through now
+        checkInterrupts(sys);
+
+        return ExecutionStatus::BranchTaken;
+    }
+
+    // operandType[0] and addressingMode[0] are the general register.
+    // operandType[1] is 1 when it is copied to the control register,
+    // addressingMode[1] is 0 for usp and 1 for vbr.
+    momiji::ExecutionStatus movec(momiji::System& sys,
+                                  const InstructionData& data)
+    {
+        auto& cpu = sys.cpu;
+
+        if (!cpu.statusRegister.supervisor())
+        {
+            return privilegeViolation(sys);
+        }
+
+        const auto regnum = utils::to_val(data.addressingMode[0]);
+
+        auto* reg = data.operandType[0] == OperandType::AddressRegister
+                        ? asl::saccess(cpu.addressRegisters, regnum).ptr()
+                        : asl::saccess(cpu.dataRegisters, regnum).ptr();
+
+        const bool toControl = utils::to_val(data.operandType[1]) != 0;
+        const bool vbr       = utils::to_val(data.addressingMode[1]) != 0;
+
+        if (toControl)
+        {
+            if (vbr)
+            {
+                cpu.vectorBase = std::uint32_t(*reg);
+            }
+            else
+            {
+                cpu.inactiveStackPointer = *reg;
+            }
+        }
+        else
+        {
+            *reg = vbr ? std::int32_t(cpu.vectorBase)
+                       : cpu.inactiveStackPointer.raw();
+        }
+
+        cpu.programCounter += 4;
+
+        return ExecutionStatus::Continue;
+    }
+} // namespace momiji::instr
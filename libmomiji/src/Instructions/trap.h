@@ -0,0 +1,16 @@
+#pragma once
+
+#include <momiji/Decoder.h>
+#include <momiji/System.h>
+
+namespace momiji::instr
+{
+    momiji::ExecutionStatus trap(momiji::System& sys,
+                                 const momiji::InstructionData& instr);
+
+    momiji::ExecutionStatus rte(momiji::System& sys,
+                                const momiji::InstructionData& instr);
+
+    momiji::ExecutionStatus movec(momiji::System& sys,
+                                  const momiji::InstructionData& instr);
+} // namespace momiji::instr
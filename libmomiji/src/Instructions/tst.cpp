@@ -4,19 +4,17 @@
 
 namespace momiji::instr
 {
-    momiji::System tst(momiji::System& sys, const InstructionData& instr)
+    momiji::ExecutionStatus tst(momiji::System& sys,
+                                const InstructionData& instr)
     {
-        auto& pc         = sys.cpu.programCounter;
-        std::int32_t val = utils::readOperandVal(sys, instr, 0);
+        auto& pc               = sys.cpu.programCounter;
+        const std::int32_t val = utils::readOperandVal(sys, instr, 0);
 
-        sys.cpu.statusRegister.negative = (val < 0) ? 0b1 : 0b0;
-        sys.cpu.statusRegister.zero     = (val == 0) ? 0b1 : 0b0;
-        sys.cpu.statusRegister.overflow = 0b0;
-        sys.cpu.statusRegister.carry    = 0b0;
+        sys.cpu.statusRegister.setLogical(instr.size, val);
 
         pc += 2;
         pc += std::uint8_t(utils::isImmediate(instr, 0));
 
-        return sys;
+        return utils::completed(sys);
     }
 } // namespace momiji::instr
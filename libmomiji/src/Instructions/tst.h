@@ -5,5 +5,6 @@
 
 namespace momiji::instr
 {
-    momiji::System tst(momiji::System& sys, const InstructionData& instr);
+    momiji::ExecutionStatus tst(momiji::System& sys,
+                                const InstructionData& instr);
 }
@@ -0,0 +1,154 @@
+#include <momiji/NativeCode.h>
+
+#include <asl/detect_features>
+
+#include <cstring>
+
+#ifdef ASL_WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+    #endif
+
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+#endif
+
+namespace momiji
+{
+    namespace
+    {
+        constexpr std::size_t chunkSize = 1024 * 1024;
+
+        // Blocks dropped by stores to the code leave their host code behind
+        // until the next clear, this bounds what that can cost
+        constexpr std::int64_t maxSize = 32 * 1024 * 1024;
+    } // namespace
+
+    struct NativeCodeBuffer::Chunk
+    {
+        Chunk()
+        {
+#ifdef ASL_WIN32
+            memory = static_cast<std::uint8_t*>(VirtualAlloc(
+                nullptr, chunkSize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+#else
+            void* mapped = mmap(nullptr,
+                                chunkSize,
+                                PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS,
+                                -1,
+                                0);
+
+            memory = mapped == MAP_FAILED ? nullptr
+                                          : static_cast<std::uint8_t*>(mapped);
+#endif
+        }
+
+        ~Chunk()
+        {
+            if (memory == nullptr)
+            {
+                return;
+            }
+
+#ifdef ASL_WIN32
+            VirtualFree(memory, 0, MEM_RELEASE);
+#else
+            munmap(memory, chunkSize);
+#endif
+        }
+
+        Chunk(const Chunk&) = delete;
+        Chunk& operator=(const Chunk&) = delete;
+
+        bool setWritable(bool writable)
+        {
+#ifdef ASL_WIN32
+            DWORD previous = 0;
+
+            const BOOL changed =
+                VirtualProtect(memory,
+                               chunkSize,
+                               writable ? PAGE_READWRITE : PAGE_EXECUTE_READ,
+                               &previous);
+
+            if (changed != 0 && !writable)
+            {
+                FlushInstructionCache(GetCurrentProcess(), memory, chunkSize);
+            }
+
+            return changed != 0;
+#else
+            const int protection =
+                writable ? PROT_READ | PROT_WRITE : PROT_READ | PROT_EXEC;
+
+            return mprotect(memory, chunkSize, protection) == 0;
+#endif
+        }
+
+        std::uint8_t* memory { nullptr };
+        std::size_t used { 0 };
+    };
+
+    NativeCodeBuffer::NativeCodeBuffer() = default;
+    NativeCodeBuffer::~NativeCodeBuffer() = default;
+
+    NativeCodeBuffer::NativeCodeBuffer(NativeCodeBuffer&&) noexcept = default;
+    NativeCodeBuffer&
+    NativeCodeBuffer::operator=(NativeCodeBuffer&&) noexcept = default;
+
+    const void* NativeCodeBuffer::add(const std::vector<std::uint8_t>& code)
+    {
+        if (code.empty() || code.size() > chunkSize ||
+            m_size + std::int64_t(code.size()) > maxSize)
+        {
+            return nullptr;
+        }
+
+        if (m_chunks.empty() ||
+            m_chunks.back()->used + code.size() > chunkSize)
+        {
+            auto chunk = std::make_unique<Chunk>();
+
+            if (chunk->memory == nullptr || !chunk->setWritable(false))
+            {
+                return nullptr;
+            }
+
+            m_chunks.push_back(std::move(chunk));
+        }
+
+        auto& chunk = *m_chunks.back();
+
+        if (!chunk.setWritable(true))
+        {
+            return nullptr;
+        }
+
+        auto* dst = chunk.memory + chunk.used;
+        std::memcpy(dst, code.data(), code.size());
+
+        if (!chunk.setWritable(false))
+        {
+            return nullptr;
+        }
+
+        // Keeps every entry point aligned
+        chunk.used += (code.size() + 15) & ~std::size_t(15);
+        m_size += std::int64_t(code.size());
+
+        return dst;
+    }
+
+    void NativeCodeBuffer::clear()
+    {
+        m_chunks.clear();
+        m_size = 0;
+    }
+
+    std::int64_t NativeCodeBuffer::size() const noexcept
+    {
+        return m_size;
+    }
+} // namespace momiji
@@ -0,0 +1,233 @@
+#include <momiji/PagedStorage.h>
+
+#include <asl/types>
+
+#include <algorithm>
+#include <cstring>
+
+namespace momiji
+{
+    namespace
+    {
+        using Page = PagedStorage::Page;
+
+        // Every page that was never written to is this one
+        const std::shared_ptr<Page>& zeroPage()
+        {
+            static const auto page = std::make_shared<Page>();
+            return page;
+        }
+
+        // FNV-1a
+        std::uint64_t hashPage(const Page& page)
+        {
+            std::uint64_t hash = 0xcbf29ce484222325;
+
+            for (const auto byte : page)
+            {
+                hash ^= byte;
+                hash *= 0x100000001b3;
+            }
+
+            return hash;
+        }
+    } // namespace
+
+    PagedStorage::PagedStorage(std::int64_t size)
+    {
+        resize(size);
+    }
+
+    std::int64_t PagedStorage::size() const noexcept
+    {
+        return m_size;
+    }
+
+    bool PagedStorage::empty() const noexcept
+    {
+        return m_size == 0;
+    }
+
+    void PagedStorage::resize(std::int64_t size, std::uint8_t value)
+    {
+        // Whatever is left in the last page from an earlier shrink
+        const auto tailEnd =
+            std::min(size, asl::ssize(m_pages) * memoryPageSize);
+
+        for (auto i = m_size; i < tailEnd; ++i)
+        {
+            (*this)[i] = value;
+        }
+
+        const auto pages = (size + memoryPageSize - 1) / memoryPageSize;
+
+        while (asl::ssize(m_pages) < pages)
+        {
+            if (value == 0)
+            {
+                m_pages.push_back(zeroPage());
+            }
+            else
+            {
+                auto page = std::make_shared<Page>();
+                page->fill(value);
+
+                m_pages.push_back(std::move(page));
+            }
+        }
+
+        m_pages.resize(std::size_t(pages));
+        m_size = size;
+    }
+
+    void PagedStorage::push_back(std::uint8_t val)
+    {
+        if (m_size == asl::ssize(m_pages) * memoryPageSize)
+        {
+            m_pages.push_back(zeroPage());
+        }
+
+        ++m_size;
+        (*this)[m_size - 1] = val;
+    }
+
+    void PagedStorage::pop_back()
+    {
+        --m_size;
+    }
+
+    void PagedStorage::read(std::int64_t offset,
+                            gsl::span<std::uint8_t> out) const
+    {
+        std::int64_t done = 0;
+
+        while (done < out.size())
+        {
+            const auto idx    = offset + done;
+            const auto inPage = idx % memoryPageSize;
+            const auto count =
+                std::min(out.size() - done, memoryPageSize - inPage);
+
+            const auto& page = *m_pages[std::size_t(idx / memoryPageSize)];
+            std::memcpy(
+                out.data() + done, page.data() + inPage, std::size_t(count));
+
+            done += count;
+        }
+    }
+
+    void PagedStorage::write(std::int64_t offset,
+                             gsl::span<const std::uint8_t> in)
+    {
+        std::int64_t done = 0;
+
+        while (done < in.size())
+        {
+            const auto idx    = offset + done;
+            const auto inPage = idx % memoryPageSize;
+            const auto count =
+                std::min(in.size() - done, memoryPageSize - inPage);
+
+            auto& page = writablePage(idx / memoryPageSize);
+            std::memcpy(
+                page.data() + inPage, in.data() + done, std::size_t(count));
+
+            done += count;
+        }
+    }
+
+    std::int64_t PagedStorage::pageCount() const noexcept
+    {
+        return asl::ssize(m_pages);
+    }
+
+    std::int64_t PagedStorage::privatePageCount() const noexcept
+    {
+        return std::count_if(
+            m_pages.begin(), m_pages.end(), [](const auto& page) {
+                return page.use_count() == 1;
+            });
+    }
+
+    bool PagedStorage::materialized(std::int64_t idx) const noexcept
+    {
+        return m_pages[std::size_t(idx)] != zeroPage();
+    }
+
+    std::int64_t PagedStorage::materializedPageCount() const noexcept
+    {
+        return std::count_if(
+            m_pages.begin(), m_pages.end(), [](const auto& page) {
+                return page != zeroPage();
+            });
+    }
+
+    bool PagedStorage::sharesPage(const PagedStorage& oth,
+                                  std::int64_t idx) const noexcept
+    {
+        return m_pages[std::size_t(idx)] == oth.m_pages[std::size_t(idx)];
+    }
+
+    PagedStorage::Page& PagedStorage::writablePage(std::int64_t page)
+    {
+        auto& ptr = m_pages[std::size_t(page)];
+
+        if (ptr.use_count() != 1)
+        {
+            ptr = std::make_shared<Page>(*ptr);
+        }
+
+        return *ptr;
+    }
+
+    std::int64_t PageDeduplicator::deduplicate(PagedStorage& storage)
+    {
+        std::int64_t merged = 0;
+
+        for (auto& page : storage.m_pages)
+        {
+            // Already shared with everything else left at zero
+            if (page == zeroPage())
+            {
+                continue;
+            }
+
+            auto& candidates = m_pages[hashPage(*page)];
+
+            candidates.erase(std::remove_if(candidates.begin(),
+                                            candidates.end(),
+                                            [](const auto& weak) {
+                                                return weak.expired();
+                                            }),
+                             candidates.end());
+
+            bool found = false;
+
+            for (const auto& weak : candidates)
+            {
+                auto known = weak.lock();
+
+                if (known == page)
+                {
+                    found = true;
+                    break;
+                }
+
+                if (*known == *page)
+                {
+                    ++merged;
+                    page  = std::move(known);
+                    found = true;
+                    break;
+                }
+            }
+
+            if (!found)
+            {
+                candidates.emplace_back(page);
+            }
+        }
+
+        return merged;
+    }
+} // namespace momiji
@@ -793,6 +793,24 @@ namespace momiji
         };
     }
 
+    // usp or vbr
+    constexpr auto ControlRegisterParser(momiji::ParsedInstruction& instr,
+                                         std::uint32_t opNum)
+    {
+        return
+            [&instr, opNum](std::string_view str) -> momiji::parser_metadata {
+                auto usp = Map(Str("usp"), [&](auto&) {
+                    instr.operands[opNum] = operands::ControlRegister { 0x800 };
+                });
+
+                auto vbr = Map(Str("vbr"), [&](auto&) {
+                    instr.operands[opNum] = operands::ControlRegister { 0x801 };
+                });
+
+                return AnyOf(usp, vbr)(str);
+            };
+    }
+
     inline auto MemoryAddress(momiji::ParsedInstruction& instr,
                               std::uint32_t opNum)
     {
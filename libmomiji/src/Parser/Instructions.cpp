@@ -777,6 +777,85 @@ namespace momiji::details
         return { true, str, "", {} };
     }
 
+    momiji::parser_metadata parseTrap(std::string_view str,
+                                      momiji::ParsedInstruction& instr)
+    {
+        auto res =
+            SeqNext(Whitespace(), momiji::OperandImmediate(instr, 0))(str);
+
+        instr.instructionType = InstructionType::Trap;
+
+        instr.operands.resize(1);
+
+        return res;
+    }
+
+    momiji::parser_metadata parseRte(std::string_view str,
+                                     momiji::ParsedInstruction& instr)
+    {
+        instr.instructionType = InstructionType::ReturnException;
+
+        return { true, str, "", {} };
+    }
+
+    // One operand is usp or vbr, the other one any register
+    momiji::parser_metadata parseMovec(std::string_view str,
+                                       momiji::ParsedInstruction& instr)
+    {
+        const auto operand = [&instr](std::uint32_t opNum) {
+            return AnyOf(momiji::ControlRegisterParser(instr, opNum),
+                         momiji::AnyRegister(instr, opNum));
+        };
+
+        auto res = SeqNext(AlwaysTrue(ParseDataType(instr)),
+                           Whitespace(),
+                           operand(0),
+                           AlwaysTrue(Whitespace()),
+                           Char(','),
+                           AlwaysTrue(Whitespace()),
+                           operand(1))(str);
+
+        instr.instructionType = InstructionType::MoveControl;
+        instr.dataType        = DataType::Long;
+
+        if (!res.result)
+        {
+            return res;
+        }
+
+        const bool fromControl =
+            matchOp<ops::ControlRegister>(instr.operands[0]);
+        const bool toControl = matchOp<ops::ControlRegister>(instr.operands[1]);
+
+        if (fromControl == toControl)
+        {
+            std::vector<momiji::ParserOperand> accepted {
+                momiji::ParserOperand::DataRegister,
+                momiji::ParserOperand::AddressRegister
+            };
+
+            if (!fromControl)
+            {
+                accepted = { momiji::ParserOperand::ControlRegister };
+            }
+
+            momiji::errors::OperandTypeMismatch error {
+                std::move(accepted),
+                momiji::convertOperand(instr.operands[1]),
+                1
+            };
+
+            res.result = false;
+            res.error  = std::move(error);
+
+            return res;
+        }
+
+        sanitizeRegisters(instr.operands[fromControl ? 1 : 0], res);
+
+        return res;
+    }
+
     momiji::parser_metadata parseBlt(std::string_view str,
                                      momiji::ParsedInstruction& instr)
     {
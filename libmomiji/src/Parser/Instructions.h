@@ -61,6 +61,13 @@ namespace momiji::details
     momiji::parser_metadata parseRts(std::string_view,
                                      momiji::ParsedInstruction&);
 
+    momiji::parser_metadata parseTrap(std::string_view,
+                                      momiji::ParsedInstruction&);
+    momiji::parser_metadata parseRte(std::string_view,
+                                     momiji::ParsedInstruction&);
+    momiji::parser_metadata parseMovec(std::string_view,
+                                       momiji::ParsedInstruction&);
+
     momiji::parser_metadata parseBlt(std::string_view,
                                      momiji::ParsedInstruction&);
     momiji::parser_metadata parseBle(std::string_view,
@@ -16,7 +16,7 @@ namespace momiji
         momiji::details::parserfn_t execfn;
     };
 
-    constexpr std::array<MappingType, 43> mappings = {
+    constexpr std::array<MappingType, 46> mappings = {
         {
             { utils::hash("move"), momiji::details::parseMove },
             { utils::hash("moveq"), momiji::details::parseMoveQ },
@@ -57,6 +57,10 @@ namespace momiji
             { utils::hash("bsr"), momiji::details::parseBsr },
             { utils::hash("rts"), momiji::details::parseRts },
 
+            { utils::hash("trap"), momiji::details::parseTrap },
+            { utils::hash("rte"), momiji::details::parseRte },
+            { utils::hash("movec"), momiji::details::parseMovec },
+
             { utils::hash("blt"), momiji::details::parseBlt },
             { utils::hash("ble"), momiji::details::parseBle },
             { utils::hash("bge"), momiji::details::parseBge },
@@ -85,6 +85,23 @@ namespace momiji
             return true;
         }
 
+        // Of a data register, by a count in the opcode or in a register,
+        // the other shifts only have the address they shift
+        bool isRegisterShift(const momiji::ParsedInstruction& instr) noexcept
+        {
+            switch (instr.instructionType)
+            {
+            case InstructionType::ArithmeticShiftLeft:
+            case InstructionType::ArithmeticShiftRight:
+            case InstructionType::LogicalShiftLeft:
+            case InstructionType::LogicalShiftRight:
+                return instr.operands.size() == 2;
+
+            default:
+                return false;
+            }
+        }
+
         constexpr int requiresImmediateData(const momiji::Operand& op,
                                             momiji::DataType dataType) noexcept
         {
@@ -111,8 +128,11 @@ namespace momiji
                 return 4;
             }
 
+            // The extension word of movec is counted with the control
+            // register
             if (std::holds_alternative<momiji::operands::AddressOffset>(op) ||
-                std::holds_alternative<momiji::operands::AddressIndex>(op))
+                std::holds_alternative<momiji::operands::AddressIndex>(op) ||
+                std::holds_alternative<momiji::operands::ControlRegister>(op))
             {
                 return 2;
             }
@@ -462,6 +482,16 @@ namespace momiji
             {
                 program_counter += 4;
             }
+            else if (instr.instructionType == InstructionType::Trap)
+            {
+                // The vector number is part of the opcode
+                program_counter += 2;
+            }
+            else if (isRegisterShift(instr))
+            {
+                // The count is part of the opcode
+                program_counter += 2;
+            }
             else if (isDirective(instr.instructionType))
             {
                 // Intentionally left blank
@@ -589,6 +619,10 @@ namespace momiji
             [&](const ops::ProgramCounterIndex& /* unused */) {
                 res = ParserOperand::ProgramCounterIndex;
             },
+
+            [&](const ops::ControlRegister& /* unused */) {
+                res = ParserOperand::ControlRegister;
+            },
         }, operand);
         // clang-format on
 
@@ -0,0 +1,89 @@
+#include <momiji/Scheduler.h>
+
+#include <momiji/System.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace momiji
+{
+    namespace
+    {
+        // Orders the heap so the earliest event comes out first
+        template <typename Event>
+        bool later(const Event& lhs, const Event& rhs)
+        {
+            return lhs.cycle != rhs.cycle ? lhs.cycle > rhs.cycle
+                                          : lhs.id > rhs.id;
+        }
+    } // namespace
+
+    EventScheduler::EventId EventScheduler::schedule(std::int64_t cycle,
+                                                     Callback callback)
+    {
+        const auto id = m_nextId++;
+
+        m_events.push_back({ cycle, id, std::move(callback) });
+        std::push_heap(m_events.begin(), m_events.end(), later<Event>);
+
+        return id;
+    }
+
+    bool EventScheduler::cancel(EventId id)
+    {
+        const auto it =
+            std::find_if(m_events.begin(),
+                         m_events.end(),
+                         [id](const Event& event) { return event.id == id; });
+
+        if (it == m_events.end())
+        {
+            return false;
+        }
+
+        m_events.erase(it);
+        std::make_heap(m_events.begin(), m_events.end(), later<Event>);
+
+        return true;
+    }
+
+    void EventScheduler::clear()
+    {
+        m_events.clear();
+    }
+
+    void EventScheduler::restore(const EventScheduler& earlier)
+    {
+        m_events = earlier.m_events;
+        m_nextId = std::max(m_nextId, earlier.m_nextId);
+    }
+
+    bool EventScheduler::empty() const noexcept
+    {
+        return m_events.empty();
+    }
+
+    std::int64_t EventScheduler::nextCycle() const noexcept
+    {
+        return m_events.empty() ? never : m_events.front().cycle;
+    }
+
+    std::int64_t EventScheduler::runDue(System& sys)
+    {
+        std::int64_t ran = 0;
+
+        while (!m_events.empty() && m_events.front().cycle <= sys.cycles)
+        {
+            std::pop_heap(m_events.begin(), m_events.end(), later<Event>);
+
+            // The callback may schedule more events
+            auto event = std::move(m_events.back());
+            m_events.pop_back();
+
+            event.callback(sys);
+            ++ran;
+        }
+
+        return ran;
+    }
+} // namespace momiji
@@ -0,0 +1,303 @@
+#include <momiji/StateJournal.h>
+
+#include <algorithm>
+
+namespace momiji
+{
+    namespace
+    {
+        // The status register comes right after the program counter
+        constexpr std::uint8_t programCounterIndex = 16;
+        constexpr std::uint8_t statusIndex         = 17;
+        constexpr std::uint8_t stackPointerIndex   = 18;
+        constexpr std::uint8_t registerCount       = 20;
+
+        std::uint32_t readRegister(const Cpu& cpu, std::uint8_t idx)
+        {
+            if (idx < 8)
+            {
+                return std::uint32_t(
+                    asl::saccess(cpu.dataRegisters, idx).raw());
+            }
+
+            if (idx < 16)
+            {
+                return std::uint32_t(
+                    asl::saccess(cpu.addressRegisters, idx - 8).raw());
+            }
+
+            if (idx == programCounterIndex)
+            {
+                return cpu.programCounter.raw();
+            }
+
+            if (idx == statusIndex)
+            {
+                return cpu.statusRegister.word();
+            }
+
+            if (idx == stackPointerIndex)
+            {
+                return std::uint32_t(cpu.inactiveStackPointer.raw());
+            }
+
+            return cpu.vectorBase;
+        }
+
+        void writeRegister(Cpu& cpu, std::uint8_t idx, std::uint32_t val)
+        {
+            if (idx < 8)
+            {
+                asl::saccess(cpu.dataRegisters, idx) = std::int32_t(val);
+            }
+            else if (idx < 16)
+            {
+                asl::saccess(cpu.addressRegisters, idx - 8) =
+                    std::int32_t(val);
+            }
+            else if (idx == programCounterIndex)
+            {
+                cpu.programCounter = val;
+            }
+            else if (idx == statusIndex)
+            {
+                // a7 is restored on its own
+                cpu.statusRegister.setWord(std::uint16_t(val));
+            }
+            else if (idx == stackPointerIndex)
+            {
+                cpu.inactiveStackPointer = std::int32_t(val);
+            }
+            else
+            {
+                cpu.vectorBase = val;
+            }
+        }
+    } // namespace
+
+    void StateJournal::beginStep(System& sys)
+    {
+        m_stepCpu             = sys.cpu;
+        m_stepDepth           = sys.callStack.frames.size();
+        m_stepTrap            = sys.trap;
+        m_stepCycles          = sys.cycles;
+        m_stepNextEvent       = sys.nextEventCycle;
+        m_stepRequests        = sys.interruptRequests;
+        sys.mem.undoLog       = &m_memory;
+        sys.callStack.undoLog = &m_frames;
+    }
+
+    void StateJournal::endStep(System& sys)
+    {
+        sys.mem.undoLog       = nullptr;
+        sys.callStack.undoLog = nullptr;
+
+        for (std::uint8_t i = 0; i < registerCount; ++i)
+        {
+            const auto old = readRegister(m_stepCpu, i);
+
+            if (old != readRegister(sys.cpu, i))
+            {
+                m_registers.push_back({ i, old });
+            }
+        }
+
+        m_entries.push_back({ m_registers.size(),
+                              m_memory.size(),
+                              m_frames.size(),
+                              m_stepDepth,
+                              -1,
+                              m_stepTrap,
+                              m_stepCycles,
+                              m_stepNextEvent,
+                              m_stepRequests });
+    }
+
+    void StateJournal::replaceSystem(System old)
+    {
+        m_systems.emplace_back(std::move(old));
+        m_entries.push_back({ m_registers.size(),
+                              m_memory.size(),
+                              m_frames.size(),
+                              0,
+                              std::int64_t(m_systems.size() - 1),
+                              std::nullopt,
+                              0,
+                              0,
+                              0 });
+    }
+
+    bool StateJournal::undo(System& sys)
+    {
+        if (m_entries.empty())
+        {
+            return false;
+        }
+
+        const auto& entry = m_entries.back();
+
+        if (entry.system >= 0)
+        {
+            sys = std::move(m_systems.back());
+            m_systems.pop_back();
+        }
+        else
+        {
+            undoInto(sys, m_entries.size() - 1);
+
+            const auto& prev = m_entries.size() > 1
+                                   ? m_entries[m_entries.size() - 2]
+                                   : Entry {};
+
+            m_registers.resize(prev.registerEnd);
+            m_memory.resize(prev.memoryEnd);
+            m_frames.resize(prev.frameEnd);
+        }
+
+        m_entries.pop_back();
+
+        return true;
+    }
+
+    void StateJournal::undoInto(System& sys, std::size_t idx) const
+    {
+        const auto& entry = m_entries[idx];
+
+        if (entry.system >= 0)
+        {
+            sys = m_systems[std::size_t(entry.system)];
+            return;
+        }
+
+        const auto& prev = idx > 0 ? m_entries[idx - 1] : Entry {};
+
+        for (auto i = entry.registerEnd; i > prev.registerEnd; --i)
+        {
+            const auto& reg = m_registers[i - 1];
+            writeRegister(sys.cpu, reg.index, reg.value);
+        }
+
+        for (auto i = entry.memoryEnd; i > prev.memoryEnd; --i)
+        {
+            const auto& byte = m_memory[i - 1];
+            const auto res   = sys.mem.write8(byte.value, byte.offset);
+
+            (void)res;
+        }
+
+        // Frames pushed by the step are dropped, popped ones come back
+        auto& frames = sys.callStack.frames;
+        frames.resize(entry.depth - (entry.frameEnd - prev.frameEnd));
+
+        for (auto i = entry.frameEnd; i > prev.frameEnd; --i)
+        {
+            frames.push_back(m_frames[i - 1]);
+        }
+
+        // Only exception steps start with a pending trap
+        sys.trap              = entry.trap;
+        sys.cycles            = entry.cycles;
+        sys.nextEventCycle    = entry.nextEventCycle;
+        sys.interruptRequests = entry.interruptRequests;
+    }
+
+    bool StateJournal::replacesSystem(std::size_t idx) const
+    {
+        return m_entries[idx].system >= 0;
+    }
+
+    bool StateJournal::writes(std::size_t idx,
+                              std::int64_t begin,
+                              std::int64_t end) const
+    {
+        const auto& entry = m_entries[idx];
+        const auto first  = idx > 0 ? m_entries[idx - 1].memoryEnd : 0;
+
+        return std::any_of(m_memory.begin() + std::int64_t(first),
+                           m_memory.begin() + std::int64_t(entry.memoryEnd),
+                           [&](const MemoryUndoEntry& byte) {
+                               return byte.offset >= begin &&
+                                      byte.offset < end;
+                           });
+    }
+
+    std::size_t StateJournal::size() const noexcept
+    {
+        return m_entries.size();
+    }
+
+    bool StateJournal::empty() const noexcept
+    {
+        return m_entries.empty();
+    }
+
+    void StateJournal::dropOldest(std::size_t count)
+    {
+        count = std::min(count, m_entries.size());
+
+        if (count == 0)
+        {
+            return;
+        }
+
+        const auto& last     = m_entries[count - 1];
+        const auto registers = last.registerEnd;
+        const auto memory    = last.memoryEnd;
+        const auto frames    = last.frameEnd;
+
+        std::int64_t systems = 0;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (m_entries[i].system >= 0)
+            {
+                ++systems;
+            }
+        }
+
+        m_entries.erase(m_entries.begin(), m_entries.begin() + count);
+        m_registers.erase(m_registers.begin(), m_registers.begin() + registers);
+        m_memory.erase(m_memory.begin(), m_memory.begin() + memory);
+        m_frames.erase(m_frames.begin(), m_frames.begin() + frames);
+        m_systems.erase(m_systems.begin(), m_systems.begin() + systems);
+
+        for (auto& entry : m_entries)
+        {
+            entry.registerEnd -= registers;
+            entry.memoryEnd -= memory;
+            entry.frameEnd -= frames;
+
+            if (entry.system >= 0)
+            {
+                entry.system -= systems;
+            }
+        }
+    }
+
+    std::int64_t StateJournal::memoryUsage() const noexcept
+    {
+        auto bytes = std::int64_t(m_entries.size() * sizeof(Entry) +
+                                  m_registers.size() *
+                                      sizeof(RegisterUndoEntry) +
+                                  m_memory.size() * sizeof(MemoryUndoEntry) +
+                                  m_frames.size() * sizeof(CallFrame));
+
+        // Pages shared with other systems are paid by someone else
+        for (const auto& sys : m_systems)
+        {
+            bytes += std::int64_t(sizeof(System)) +
+                     sys.mem.underlying().privatePageCount() * memoryPageSize;
+        }
+
+        return bytes;
+    }
+
+    void StateJournal::clear()
+    {
+        m_entries.clear();
+        m_registers.clear();
+        m_memory.clear();
+        m_frames.clear();
+        m_systems.clear();
+    }
+} // namespace momiji
@@ -0,0 +1,212 @@
+#include <momiji/ThreadedCode.h>
+
+#include "Instructions/Bound.h"
+
+#include <asl/detect_features>
+
+#include <algorithm>
+#include <array>
+
+// Labels as values are a GNU extension, other compilers get a plain loop
+#if defined(ASL_GCC) || defined(ASL_CLANG)
+    #define MOMIJI_COMPUTED_GOTO
+#endif
+
+namespace momiji
+{
+    namespace
+    {
+        // Opcode word plus two long extension words
+        constexpr std::int64_t maxInstructionSize = 10;
+    } // namespace
+
+    ThreadedCode::Exit ThreadedCode::run(System& sys,
+                                         History* history,
+                                         std::int64_t maxInstructions)
+    {
+        const ConstExecutableMemoryView mem = sys.mem;
+
+        const auto codeSize =
+            mem.executableMarker.end - mem.executableMarker.begin;
+        const auto slotCount = (codeSize + 1) / 2;
+
+        if (std::int64_t(m_slots.size()) != slotCount)
+        {
+            m_slots.resize(std::size_t(slotCount));
+            translate(mem, 0, slotCount);
+        }
+
+        if (history != nullptr)
+        {
+            return runSlots<true>(sys, history, maxInstructions);
+        }
+
+        return runSlots<false>(sys, history, maxInstructions);
+    }
+
+#ifdef MOMIJI_COMPUTED_GOTO
+    #ifdef ASL_CLANG
+        #pragma clang diagnostic push
+        #pragma clang diagnostic ignored "-Wgnu-label-as-value"
+    #else
+        #pragma GCC diagnostic push
+        #pragma GCC diagnostic ignored "-Wpedantic"
+    #endif
+#endif
+
+    template <bool Journal>
+    ThreadedCode::Exit ThreadedCode::runSlots(System& sys,
+                                              History* history,
+                                              std::int64_t maxInstructions)
+    {
+        const auto* const slots = m_slots.data();
+        const auto slotCount    = std::uint32_t(m_slots.size());
+
+        // PCs before the code wrap around past the last slot
+        const auto codeBegin = std::uint32_t(sys.mem.executableMarker.begin);
+
+        auto status           = ExecutionStatus::Continue;
+        std::int64_t executed = 0;
+
+#ifdef MOMIJI_COMPUTED_GOTO
+        // Indexed by ExecutionStatus
+        static const std::array<void*, 6> afterStatus { {
+            &&dispatch, // Continue
+            &&dispatch, // BranchTaken
+            &&stop,     // Breakpoint
+            &&stop,     // Trap
+            &&stop,     // Halt
+            &&stop,     // Returned
+        } };
+
+    dispatch:
+        {
+            const auto pc = sys.cpu.programCounter.raw();
+
+            // Odd addresses aren't translated and events are run, the
+            // emulator deals with them
+            if (executed == maxInstructions || (pc & 0b1) != 0 ||
+                ((pc - codeBegin) >> 1) >= slotCount ||
+                sys.cycles >= sys.nextEventCycle)
+            {
+                goto stop;
+            }
+
+            const auto& slot = slots[(pc - codeBegin) >> 1];
+
+            if constexpr (Journal)
+            {
+                history->beginStep(sys);
+            }
+
+            status = slot.run(sys, slot);
+            sys.cycles += cyclesOf(slot.data, status);
+
+            if constexpr (Journal)
+            {
+                history->endStep(sys);
+            }
+
+            ++executed;
+
+            // The slots after the store may be stale
+            if (sys.mem.codeWriteMarker.begin >= 0)
+            {
+                goto stop;
+            }
+
+            goto* afterStatus[std::size_t(status)];
+        }
+
+    stop:
+        return { status, executed };
+#else
+        while (executed < maxInstructions)
+        {
+            const auto pc = sys.cpu.programCounter.raw();
+
+            if ((pc & 0b1) != 0 || ((pc - codeBegin) >> 1) >= slotCount ||
+                sys.cycles >= sys.nextEventCycle)
+            {
+                break;
+            }
+
+            const auto& slot = slots[(pc - codeBegin) >> 1];
+
+            if constexpr (Journal)
+            {
+                history->beginStep(sys);
+            }
+
+            status = slot.run(sys, slot);
+            sys.cycles += cyclesOf(slot.data, status);
+
+            if constexpr (Journal)
+            {
+                history->endStep(sys);
+            }
+
+            ++executed;
+
+            if (sys.mem.codeWriteMarker.begin >= 0 ||
+                (status != ExecutionStatus::Continue &&
+                 status != ExecutionStatus::BranchTaken))
+            {
+                break;
+            }
+        }
+
+        return { status, executed };
+#endif
+    }
+
+#ifdef MOMIJI_COMPUTED_GOTO
+    #ifdef ASL_CLANG
+        #pragma clang diagnostic pop
+    #else
+        #pragma GCC diagnostic pop
+    #endif
+#endif
+
+    void ThreadedCode::invalidate(ConstExecutableMemoryView mem,
+                                  std::int64_t begin,
+                                  std::int64_t end)
+    {
+        const auto first =
+            std::max(begin - maxInstructionSize + 1, std::int64_t(0)) / 2;
+        const auto last =
+            std::min((end + 1) / 2, std::int64_t(m_slots.size()));
+
+        translate(mem, first, last);
+    }
+
+    void ThreadedCode::clear()
+    {
+        m_slots.clear();
+    }
+
+    void ThreadedCode::translate(ConstExecutableMemoryView mem,
+                                 std::int64_t first,
+                                 std::int64_t last)
+    {
+        const auto codeBegin = mem.executableMarker.begin;
+
+        for (auto i = first; i < last; ++i)
+        {
+            const auto pc    = codeBegin + i * 2;
+            const auto instr = momiji::decode(mem, pc);
+            const auto next  = pc + momiji::instructionSize(instr);
+
+            Slot slot { nullptr,
+                        instr.exec,
+                        instr.data,
+                        0,
+                        false,
+                        std::uint32_t(next) };
+
+            instr::bind(slot, mem, pc, instr);
+
+            m_slots[std::size_t(i)] = slot;
+        }
+    }
+} // namespace momiji
@@ -0,0 +1,373 @@
+#include <momiji/TrapServices.h>
+
+#include <momiji/Bus.h>
+#include <momiji/System.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <utility>
+#include <variant>
+
+namespace momiji
+{
+    namespace
+    {
+        // Longest string tasks 0 and 1 print, and line task 2 reads
+        constexpr std::int64_t maxPrinted = 255;
+        constexpr std::int64_t maxLine    = 80;
+
+        // MC68000 at 8 MHz
+        constexpr std::int64_t cyclesPerHundredth = 80000;
+
+        bool readsInput(std::uint8_t task)
+        {
+            switch (task)
+            {
+            case 2:
+            case 4:
+            case 5:
+            case 7:
+            case 18:
+                return true;
+
+            default:
+                return false;
+            }
+        }
+
+        bool knownTask(std::uint8_t task)
+        {
+            switch (task)
+            {
+            case 0:
+            case 1:
+            case 2:
+            case 3:
+            case 4:
+            case 5:
+            case 6:
+            case 7:
+            case 8:
+            case 9:
+            case 13:
+            case 14:
+            case 15:
+            case 17:
+            case 18:
+            case 20:
+                return true;
+
+            default:
+                return false;
+            }
+        }
+
+        // Up to the first 0, or maxLength bytes when it isn't negative.
+        // Stops at the first fault.
+        std::string
+        readString(System& sys, std::int64_t address, std::int64_t maxLength)
+        {
+            std::string res;
+
+            for (auto i = address; maxLength < 0 || i < address + maxLength;
+                 ++i)
+            {
+                const auto c = bus::read<std::uint8_t>(sys, i);
+
+                if (c == 0 || sys.trap.has_value())
+                {
+                    break;
+                }
+
+                res.push_back(char(c));
+            }
+
+            return res;
+        }
+
+        std::string toString(std::uint32_t val, std::uint32_t base)
+        {
+            constexpr std::string_view digits =
+                "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+            std::string res;
+
+            do
+            {
+                res.insert(res.begin(), digits[val % base]);
+                val /= base;
+            } while (val != 0);
+
+            return res;
+        }
+
+        std::string toString(std::int32_t val)
+        {
+            const auto magnitude =
+                val < 0 ? 0 - std::uint32_t(val) : std::uint32_t(val);
+
+            return (val < 0 ? "-" : "") + toString(magnitude, 10);
+        }
+    } // namespace
+
+    TrapServices::TrapServices()
+        : m_sink([](std::string_view text) {
+            std::fwrite(text.data(), 1, text.size(), stdout);
+            std::fflush(stdout);
+        })
+    {
+    }
+
+    TrapServices::~TrapServices()
+    {
+        flush();
+    }
+
+    void TrapServices::setOutput(Sink sink)
+    {
+        flush();
+
+        m_sink = std::move(sink);
+    }
+
+    void TrapServices::provideInput(std::string_view input)
+    {
+        // What was read already is dropped
+        m_input.erase(0, m_inputPos);
+        m_inputPos = 0;
+
+        m_input += input;
+    }
+
+    bool TrapServices::provideInputFile(const std::string& path)
+    {
+        std::ifstream file { path, std::ios::binary };
+
+        if (!file)
+        {
+            return false;
+        }
+
+        const std::string contents { std::istreambuf_iterator<char>(file),
+                                     {} };
+
+        if (file.bad())
+        {
+            return false;
+        }
+
+        provideInput(contents);
+
+        return true;
+    }
+
+    void TrapServices::flush()
+    {
+        if (m_output.empty() || !m_sink)
+        {
+            return;
+        }
+
+        m_sink(m_output);
+        m_output.clear();
+    }
+
+    bool TrapServices::serves(const System& sys)
+    {
+        const auto* trap =
+            sys.trap.has_value() ? std::get_if<traps::Trap>(&*sys.trap)
+                                 : nullptr;
+
+        return trap != nullptr && trap->number == 15 &&
+               knownTask(std::uint8_t(sys.cpu.dataRegisters[0].raw()));
+    }
+
+    TrapServices::Result TrapServices::run(System& sys)
+    {
+        if (!serves(sys))
+        {
+            return Result::Unknown;
+        }
+
+        sys.trap.reset();
+
+        auto& cpu = sys.cpu;
+        auto& d1  = cpu.dataRegisters[1];
+
+        const auto task = std::uint8_t(cpu.dataRegisters[0].raw());
+        const auto a1 =
+            std::int64_t(std::uint32_t(cpu.addressRegisters[1].raw()));
+
+        const auto readFrom = std::min(m_inputPos, m_input.size());
+        m_replayInput.clear();
+
+        switch (task)
+        {
+        // String of d1.w bytes at most, with and without a newline
+        case 0:
+        case 1: {
+            const auto length =
+                std::min(std::int64_t(std::uint16_t(d1.raw())), maxPrinted);
+
+            print(readString(sys, a1, length));
+
+            if (task == 0)
+            {
+                print("\n");
+            }
+            break;
+        }
+
+        // Line read to (a1) with a 0 after it, its length in d1.w
+        case 2: {
+            auto line = readLine();
+            line.resize(std::size_t(
+                std::min(std::int64_t(line.size()), maxLine)));
+
+            for (std::size_t i = 0; i <= line.size(); ++i)
+            {
+                const auto c = i < line.size() ? line[i] : '\0';
+                bus::write(sys, a1 + std::int64_t(i), std::uint8_t(c));
+            }
+
+            *d1.as<std::int16_t>() = std::int16_t(line.size());
+            break;
+        }
+
+        case 3:
+            print(toString(d1.raw()));
+            break;
+
+        case 4:
+            d1 = readNumber();
+            break;
+
+        // Character read to d1.b, 0 once the input ran out
+        case 5: {
+            const bool ready = m_inputPos < m_input.size();
+            *d1.as<std::int8_t>() =
+                ready ? std::int8_t(m_input[m_inputPos++]) : 0;
+            break;
+        }
+
+        case 6:
+            print(std::string(1, char(d1.raw())));
+            break;
+
+        case 7:
+            *d1.as<std::int8_t>() = m_inputPos < m_input.size() ? 1 : 0;
+            break;
+
+        // Hundredths of a second the program ran for, not since midnight,
+        // so it is the same every run
+        case 8:
+            d1 = std::int32_t(sys.cycles / cyclesPerHundredth);
+            break;
+
+        case 9:
+            cpu.programCounter = 0xFFFFFFFF;
+            return Result::Halt;
+
+        // String up to its 0, with and without a newline
+        case 13:
+        case 14:
+            print(readString(sys, a1, -1));
+
+            if (task == 13)
+            {
+                print("\n");
+            }
+            break;
+
+        // Unsigned d1.l in base d2.b, nothing for bases past 2 to 36
+        case 15: {
+            const auto base = std::uint8_t(cpu.dataRegisters[2].raw());
+
+            if (base >= 2 && base <= 36)
+            {
+                print(toString(std::uint32_t(d1.raw()), base));
+            }
+            break;
+        }
+
+        case 17:
+            print(readString(sys, a1, -1));
+            print(toString(d1.raw()));
+            break;
+
+        case 18:
+            print(readString(sys, a1, -1));
+            d1 = readNumber();
+            break;
+
+        // Signed d1.l right-justified in d2.b columns
+        case 20: {
+            const auto width = std::size_t(
+                std::uint8_t(cpu.dataRegisters[2].raw()));
+            const auto number = toString(d1.raw());
+
+            if (number.size() < width)
+            {
+                print(std::string(width - number.size(), ' '));
+            }
+
+            print(number);
+            break;
+        }
+
+        default:
+            break;
+        }
+
+        if (readsInput(task))
+        {
+            const auto end = std::min(m_inputPos + 1, m_input.size());
+            m_replayInput  = m_input.substr(readFrom, end - readFrom);
+        }
+
+        return Result::Served;
+    }
+
+    const std::string& TrapServices::replayInput() const noexcept
+    {
+        return m_replayInput;
+    }
+
+    void TrapServices::print(std::string_view text)
+    {
+        m_output += text;
+
+        if (m_output.size() >= batchSize)
+        {
+            flush();
+        }
+    }
+
+    std::string TrapServices::readLine()
+    {
+        const auto begin = std::min(m_inputPos, m_input.size());
+        const auto end   = std::min(m_input.find('\n', begin), m_input.size());
+
+        auto line = m_input.substr(begin, end - begin);
+
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+
+        m_inputPos = std::min(end + 1, m_input.size());
+
+        return line;
+    }
+
+    std::int32_t TrapServices::readNumber()
+    {
+        const auto line = readLine();
+
+        // Only the low 32 bits are kept, like a register would
+        return std::int32_t(std::strtoll(line.c_str(), nullptr, 10));
+    }
+} // namespace momiji
@@ -0,0 +1,356 @@
+#include "./testing.h"
+#include <momiji/Compiler.h>
+#include <momiji/Emulator.h>
+
+#include <cstdio>
+
+int testBackends();
+
+namespace
+{
+    using Backend = momiji::EmulatorSettings::Backend;
+
+    // Loops long enough for every block to be compiled, with forward
+    // branches only, pushes and calls for the handlers to deal with, pairs
+    // of instructions that are fused and bound forms of every size
+    constexpr const char* program = "    move.l #0, d0\n"
+                                    "    move.l #-5, d1\n"
+                                    "    move.l #30, d2\n"
+                                    "    move.l #0, d5\n"
+                                    "    move.l #0, d7\n"
+                                    "loop:\n"
+                                    "    add.l #1, d0\n"
+                                    "    move.l d0, d3\n"
+                                    "    muls d1, d3\n"
+                                    "    mulu #3, d3\n"
+                                    "    add.l d3, d5\n"
+                                    "    sub.l #7, d5\n"
+                                    "    and.l d2, d5\n"
+                                    "    or.w d1, d5\n"
+                                    "    move.b d0, d4\n"
+                                    "    tst.b d4\n"
+                                    "    move.w #-2, d6\n"
+                                    "    add.l d6, d6\n"
+                                    "    move.w a7, d6\n"
+                                    "    sub.b d1, d6\n"
+                                    "    add.w #$7FF0, d6\n"
+                                    "    cmpi.b #5, d6\n"
+                                    "    tst.l d5\n"
+                                    "    bge positive\n"
+                                    "    sub.l #1, d7\n"
+                                    "positive:\n"
+                                    "    cmpi.l #20, d0\n"
+                                    "    bgt below\n"
+                                    "    add.l #2, d7\n"
+                                    "below:\n"
+                                    "    cmpi.l #-150, d3\n"
+                                    "    ble notabove\n"
+                                    "    sub.l d1, d7\n"
+                                    "notabove:\n"
+                                    "    bsr bump\n"
+                                    "    jsr bump\n"
+                                    "    move.l d5, -(a7)\n"
+                                    "    cmpi.l #40, d0\n"
+                                    "    beq end\n"
+                                    "    jmp loop\n"
+                                    "end:\n"
+                                    "    hcf\n"
+                                    "bump:\n"
+                                    "    add.l #1, d7\n"
+                                    "    rts\n";
+
+    // The move faults on its first run, before the tst it would be fused
+    // with
+    constexpr const char* faulting = "    move.l #1, a0\n"
+                                     "loop:\n"
+                                     "    move.w (a0), d0\n"
+                                     "    tst.w d0\n"
+                                     "    beq loop\n"
+                                     "    hcf\n";
+
+    // Compiled sizes of arithmetic, shifts by immediates and by registers
+    // counting past the register, divisions whose quotient doesn't fit,
+    // and a division by zero once the loop is compiled. The divisions to
+    // d5 are turned into divu by toDivu.
+    constexpr const char* arithmetic = "    move.l #0, d0\n"
+                                       "    move.l #0, d7\n"
+                                       "loop:\n"
+                                       "    add.l #1, d0\n"
+                                       "    move.l #2000000, d5\n"
+                                       "    divs d0, d5\n"
+                                       "    add.l d5, d7\n"
+                                       "    move.l #$12345, d5\n"
+                                       "    move.l #-32765, d3\n"
+                                       "    divs d3, d5\n"
+                                       "    add.l d5, d7\n"
+                                       "    move.l #-1200000, d4\n"
+                                       "    divs d0, d4\n"
+                                       "    add.l d4, d7\n"
+                                       "    move.l #1200000, d4\n"
+                                       "    divs d0, d4\n"
+                                       "    add.l d4, d7\n"
+                                       "    move.l #$80000000, d4\n"
+                                       "    divs #-1, d4\n"
+                                       "    add.l d4, d7\n"
+                                       "    move.l #40, d3\n"
+                                       "    sub.l d0, d3\n"
+                                       "    move.l d7, d5\n"
+                                       "    divs d3, d5\n"
+                                       "    blt overflow\n"
+                                       "    add.l #1, d7\n"
+                                       "overflow:\n"
+                                       "    move.l d0, d2\n"
+                                       "    lsl.l #4, d2\n"
+                                       "    add.w #$8000, d2\n"
+                                       "    asr.w #3, d2\n"
+                                       "    move.l #-7, d3\n"
+                                       "    lsr.b d0, d3\n"
+                                       "    asl.w d0, d2\n"
+                                       "    add.b d3, d2\n"
+                                       "    sub.w d0, d2\n"
+                                       "    add.w #$7FF0, d2\n"
+                                       "    cmpi.w #-20, d2\n"
+                                       "    blt less\n"
+                                       "    add.l #1, d7\n"
+                                       "less:\n"
+                                       "    move.l #-100000, d1\n"
+                                       "    asr.l d0, d1\n"
+                                       "    add.l d1, d7\n"
+                                       "    sub.b #3, d4\n"
+                                       "    cmpi.b #100, d4\n"
+                                       "    bge loop\n"
+                                       "    bra loop\n";
+
+    // The parser reads divu as divs, the divisions to d5 are changed
+    // afterwards
+    bool toDivu(momiji::ExecutableMemory& mem)
+    {
+        for (std::int64_t i = 0; i < asl::ssize(mem); i += 2)
+        {
+            const auto word = mem.read16(i).value_or(0);
+
+            // divs dn, d5
+            if ((word & 0b11111111'11111000) == 0b10001011'11000000 &&
+                !mem.write16(std::uint16_t(word & ~0x100), i))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool sameState(const momiji::System& lhs, const momiji::System& rhs)
+    {
+        const auto& a = lhs.cpu;
+        const auto& b = rhs.cpu;
+
+        for (std::size_t i = 0; i < a.dataRegisters.size(); ++i)
+        {
+            if (a.dataRegisters[i].raw() != b.dataRegisters[i].raw() ||
+                a.addressRegisters[i].raw() != b.addressRegisters[i].raw())
+            {
+                return false;
+            }
+        }
+
+        if (a.programCounter.raw() != b.programCounter.raw() ||
+            a.statusRegister.bits() != b.statusRegister.bits() ||
+            lhs.cycles != rhs.cycles)
+        {
+            return false;
+        }
+
+        if (lhs.mem.size() != rhs.mem.size())
+        {
+            return false;
+        }
+
+        // Pages still shared, like the untouched ones, are equal
+        for (std::int64_t i = 0; i < std::int64_t(lhs.mem.size()); ++i)
+        {
+            if (i % momiji::memoryPageSize == 0 &&
+                lhs.mem.underlying().sharesPage(rhs.mem.underlying(),
+                                                i / momiji::memoryPageSize))
+            {
+                i += momiji::memoryPageSize - 1;
+                continue;
+            }
+
+            if (lhs.mem.read8(i) != rhs.mem.read8(i))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Far enough from 0 for the vector table to fit before the code
+    constexpr std::int32_t relocatedStart = 0x10000;
+
+    // Runs the program in slices of maxInstructions, so the backends also
+    // stop in the middle of blocks
+    momiji::Emulator runProgram(Backend backend,
+                                std::int64_t maxInstructions,
+                                std::int32_t programStart = 0)
+    {
+        momiji::EmulatorSettings settings;
+        settings.backend      = backend;
+        settings.programStart = programStart;
+        settings.retainStates = momiji::EmulatorSettings::RetainStates::Never;
+
+        momiji::Emulator emu { settings };
+        emu.newState(program);
+
+        while (emu.run({ maxInstructions }).reason ==
+               momiji::StopReason::InstructionLimit)
+        {
+        }
+
+        return emu;
+    }
+} // namespace
+
+int testBackends()
+{
+    const auto reference = runProgram(Backend::Interpreter, -1);
+    const auto& expected = reference.getStates().back();
+
+    MOMIJI_TEST_REQUIRE(expected.cpu.dataRegisters[0].raw() == 40);
+
+    // Every call returned right after itself, only the pushes are left
+    MOMIJI_TEST_REQUIRE(expected.cpu.addressRegisters[7].raw() ==
+                        std::int32_t(expected.mem.stackMarker.end) - 40 * 4);
+
+    // The code and the top of the stack, out of 16 MiB
+    MOMIJI_TEST_REQUIRE(reference.getStatistics().guestMemoryPages == 2);
+
+    // Labels follow the code, jmp and jsr land at the same instructions
+    const auto relocatedReference =
+        runProgram(Backend::Interpreter, -1, relocatedStart);
+    const auto& relocated = relocatedReference.getStates().back();
+
+    MOMIJI_TEST_REQUIRE(relocated.mem.executableMarker.begin ==
+                        relocatedStart);
+    MOMIJI_TEST_REQUIRE(relocated.cpu.vectorBase == 0);
+
+    for (std::size_t i = 0; i < expected.cpu.dataRegisters.size(); ++i)
+    {
+        MOMIJI_TEST_REQUIRE(relocated.cpu.dataRegisters[i].raw() ==
+                            expected.cpu.dataRegisters[i].raw());
+    }
+
+    for (const auto backend : { Backend::ThreadedInterpreter,
+                                Backend::BasicBlocks,
+                                Backend::Jit })
+    {
+        for (const std::int64_t maxInstructions : { -1, 1000, 7, 1 })
+        {
+            const auto emu = runProgram(backend, maxInstructions);
+
+            if (!sameState(emu.getStates().back(), expected))
+            {
+                std::printf("Backend %d, %d instructions at a time\n",
+                            int(backend),
+                            int(maxInstructions));
+                return 0;
+            }
+        }
+
+        const auto emu = runProgram(backend, 7, relocatedStart);
+
+        if (!sameState(emu.getStates().back(), relocated))
+        {
+            std::printf("Backend %d, relocated\n", int(backend));
+            return 0;
+        }
+    }
+
+    // The move is never run as a pair when it can fault, the backends stop
+    // at it like the interpreter does
+    const auto neverRetain = [](Backend backend) {
+        momiji::EmulatorSettings settings;
+        settings.backend      = backend;
+        settings.retainStates = momiji::EmulatorSettings::RetainStates::Never;
+
+        return settings;
+    };
+
+    momiji::Emulator faulted { neverRetain(Backend::Interpreter) };
+    faulted.newState(faulting);
+
+    const auto fault = faulted.run({ 100 });
+
+    MOMIJI_TEST_REQUIRE(fault.reason == momiji::StopReason::Trap);
+
+    for (const auto backend : { Backend::ThreadedInterpreter,
+                                Backend::BasicBlocks,
+                                Backend::Jit })
+    {
+        momiji::Emulator emu { neverRetain(backend) };
+        emu.newState(faulting);
+
+        const auto res = emu.run({ 100 });
+
+        if (res.reason != fault.reason || res.executed != fault.executed ||
+            !sameState(emu.getStates().back(), faulted.getStates().back()))
+        {
+            std::printf("Backend %d, %d instructions before the fault\n",
+                        int(backend),
+                        int(res.executed));
+            return 0;
+        }
+    }
+
+    auto divisions = momiji::compile(*momiji::parse(arithmetic));
+    MOMIJI_TEST_REQUIRE(toDivu(divisions));
+
+    momiji::Emulator divided { neverRetain(Backend::Interpreter) };
+    divided.newState(divisions);
+
+    MOMIJI_TEST_REQUIRE(divided.run().reason == momiji::StopReason::Trap);
+
+    for (const auto backend : { Backend::ThreadedInterpreter,
+                                Backend::BasicBlocks,
+                                Backend::Jit })
+    {
+        for (const std::int64_t maxInstructions : { -1, 1000, 7, 1 })
+        {
+            momiji::Emulator emu { neverRetain(backend) };
+            emu.newState(divisions);
+
+            while (emu.run({ maxInstructions }).reason ==
+                   momiji::StopReason::InstructionLimit)
+            {
+            }
+
+            if (!sameState(emu.getStates().back(),
+                           divided.getStates().back()))
+            {
+                std::printf("Backend %d, arithmetic %d at a time\n",
+                            int(backend),
+                            int(maxInstructions));
+                return 0;
+            }
+        }
+    }
+
+    // Pairs are never split by the limit, but still run one at a time
+    const auto fused  = runProgram(Backend::BasicBlocks, -1).getStatistics();
+    const auto single = runProgram(Backend::BasicBlocks, 1).getStatistics();
+
+    MOMIJI_TEST_REQUIRE(fused.fusedCompareBranch == 120);
+    MOMIJI_TEST_REQUIRE(fused.fusedTestBranch == 40);
+    MOMIJI_TEST_REQUIRE(fused.fusedMoveTest == 40);
+
+    MOMIJI_TEST_REQUIRE(single.fusedCompareBranch == 0);
+    MOMIJI_TEST_REQUIRE(single.fusedMoveTest == 0);
+
+    return 1;
+}
+
+int main()
+{
+    return static_cast<int>(!testBackends());
+}
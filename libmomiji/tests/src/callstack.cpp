@@ -0,0 +1,155 @@
+#include "./testing.h"
+#include <momiji/Emulator.h>
+
+int testCallStack();
+
+namespace
+{
+    using Backend      = momiji::EmulatorSettings::Backend;
+    using RetainStates = momiji::EmulatorSettings::RetainStates;
+
+    // Deep enough for the block backends to compile the subroutine
+    constexpr std::int32_t depth = 100;
+
+    constexpr const char* program = "    move.l #100, d0\n"
+                                    "    bsr rec\n"
+                                    "    move.l #1, d2\n"
+                                    "    hcf\n"
+                                    "rec:\n"
+                                    "    add.l #1, d1\n"
+                                    "    sub.l #1, d0\n"
+                                    "    beq base\n"
+                                    "    bsr rec\n"
+                                    "base:\n"
+                                    "    rts\n";
+
+    // move.l #100, d0 takes 6 bytes, the bsr after it 4
+    constexpr std::uint32_t firstCall = 6;
+    constexpr std::uint32_t afterCall = 10;
+
+    bool sameFrames(const std::vector<momiji::CallFrame>& lhs,
+                    const std::vector<momiji::CallFrame>& rhs)
+    {
+        if (lhs.size() != rhs.size())
+        {
+            return false;
+        }
+
+        for (std::size_t i = 0; i < lhs.size(); ++i)
+        {
+            if (lhs[i].callSite != rhs[i].callSite ||
+                lhs[i].target != rhs[i].target ||
+                lhs[i].stackPointer != rhs[i].stackPointer)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    int testBackend(Backend backend, RetainStates retain)
+    {
+        momiji::EmulatorSettings settings;
+        settings.backend            = backend;
+        settings.retainStates       = retain;
+        settings.checkpointInterval = 16;
+
+        momiji::Emulator emu { settings };
+        emu.newState(program);
+
+        // Not a call, only the move runs
+        auto res = emu.stepOver();
+        MOMIJI_TEST_REQUIRE(res.executed == 1);
+        MOMIJI_TEST_REQUIRE(emu.backtrace().empty());
+
+        while (emu.backtrace().size() < 4)
+        {
+            MOMIJI_TEST_REQUIRE(emu.step());
+        }
+
+        const auto frames = emu.backtrace();
+        MOMIJI_TEST_REQUIRE(frames[0].callSite == firstCall);
+        MOMIJI_TEST_REQUIRE(frames[1].callSite == frames[2].callSite);
+        MOMIJI_TEST_REQUIRE(frames[0].target == frames[3].target);
+        MOMIJI_TEST_REQUIRE(frames[0].stackPointer ==
+                            frames[1].stackPointer + 4);
+
+        // Every deeper call returns before the current one does
+        res = emu.stepOut();
+        MOMIJI_TEST_REQUIRE(res.reason == momiji::StopReason::Returned);
+        MOMIJI_TEST_REQUIRE(emu.backtrace().size() == 3);
+        MOMIJI_TEST_REQUIRE(
+            emu.getStates().back().cpu.dataRegisters[1].raw() == depth);
+
+        if (retain == RetainStates::Always)
+        {
+            MOMIJI_TEST_REQUIRE(emu.reverseStep());
+            MOMIJI_TEST_REQUIRE(sameFrames(emu.backtrace(), frames));
+
+            // Rebuilt from a checkpoint this time
+            const auto position = emu.getStates().size() - 1;
+            MOMIJI_TEST_REQUIRE(emu.seekTo(std::int64_t(position - 20)));
+            MOMIJI_TEST_REQUIRE(emu.seekTo(std::int64_t(position)));
+            MOMIJI_TEST_REQUIRE(sameFrames(emu.backtrace(), frames));
+
+            res = emu.stepOut();
+            MOMIJI_TEST_REQUIRE(res.reason == momiji::StopReason::Returned);
+        }
+
+        while (emu.backtrace().size() > 1)
+        {
+            res = emu.stepOut();
+            MOMIJI_TEST_REQUIRE(res.reason == momiji::StopReason::Returned);
+        }
+
+        res = emu.stepOut();
+        MOMIJI_TEST_REQUIRE(res.reason == momiji::StopReason::Returned);
+        MOMIJI_TEST_REQUIRE(res.executed == 1);
+        MOMIJI_TEST_REQUIRE(emu.backtrace().empty());
+
+        // Nothing left to return from
+        res = emu.stepOut();
+        MOMIJI_TEST_REQUIRE(res.reason == momiji::StopReason::Halt);
+        MOMIJI_TEST_REQUIRE(
+            emu.getStates().back().cpu.dataRegisters[2].raw() == 1);
+
+        // The whole recursion at once, stopping right after the call
+        momiji::Emulator over { settings };
+        over.newState(program);
+        over.step();
+
+        res = over.stepOver();
+        MOMIJI_TEST_REQUIRE(res.reason == momiji::StopReason::Returned);
+        MOMIJI_TEST_REQUIRE(res.executed == depth * 5);
+        MOMIJI_TEST_REQUIRE(over.backtrace().empty());
+        MOMIJI_TEST_REQUIRE(
+            over.getStates().back().cpu.programCounter.raw() == afterCall);
+
+        // Limits still apply
+        momiji::Emulator limited { settings };
+        limited.newState(program);
+        limited.step();
+
+        res = limited.stepOver({ 10 });
+        MOMIJI_TEST_REQUIRE(res.reason ==
+                            momiji::StopReason::InstructionLimit);
+        MOMIJI_TEST_REQUIRE(limited.backtrace().size() == 3);
+
+        // run() doesn't stop at returns
+        res = limited.run();
+        MOMIJI_TEST_REQUIRE(res.reason == momiji::StopReason::Halt);
+
+        return 1;
+    }
+} // namespace
+
+int testCallStack()
+{
+    return momiji::testing::forEachBackend(testBackend);
+}
+
+int main()
+{
+    return static_cast<int>(!testCallStack());
+}
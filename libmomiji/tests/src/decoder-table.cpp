@@ -0,0 +1,51 @@
+#include "./testing.h"
+#include <momiji/Decoder.h>
+
+#include <cstdio>
+
+int testAllOpcodes();
+
+int testAllOpcodes()
+{
+    momiji::ExecutableMemory mem;
+
+    // Opcode word followed by enough extension words for any instruction
+    for (const std::uint16_t word : { 0x0000, 0x1234, 0x5678, 0x9ABC, 0xDEF0 })
+    {
+        mem.push16(word);
+    }
+
+    mem.executableMarker.begin = 0;
+    mem.executableMarker.end   = std::int64_t(mem.size());
+
+    for (std::uint32_t opcode = 0; opcode <= 0xFFFF; ++opcode)
+    {
+        const bool written = mem.write16(std::uint16_t(opcode), 0);
+        MOMIJI_TEST_REQUIRE(written);
+
+        const momiji::ConstExecutableMemoryView view = mem;
+
+        const auto table    = momiji::decode(view, 0);
+        const auto switched = momiji::details::decodeBySwitch(view, 0);
+
+        if (table.exec != switched.exec ||
+            table.data.size != switched.data.size ||
+            table.data.operandType != switched.data.operandType ||
+            table.data.addressingMode != switched.data.addressingMode ||
+            table.data.cycles != switched.data.cycles ||
+            table.data.branchCycles != switched.data.branchCycles ||
+            table.type != switched.type ||
+            table.operandValues != switched.operandValues)
+        {
+            std::printf("Opcode 0x%04X decoded differently\n", opcode);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+int main()
+{
+    return static_cast<int>(!testAllOpcodes());
+}
@@ -0,0 +1,146 @@
+#include "./testing.h"
+#include <momiji/Emulator.h>
+
+#include <cstdio>
+
+int testDevices();
+
+namespace
+{
+    using Backend = momiji::EmulatorSettings::Backend;
+
+    constexpr std::int64_t consoleBase     = 0xF00000;
+    constexpr std::int64_t timerBase       = 0xF01000;
+    constexpr std::int64_t framebufferBase = 0xF02000;
+
+    // Echoes the input to the console until a 0, waits for the timer to
+    // expire twice, then fills the framebuffer with a loop the block
+    // backends would otherwise run as a bulk fill
+    constexpr const char* program = "    move.l #$F00000, a0\n"
+                                    "    move.l #$F01000, a1\n"
+                                    "    move.l #$F02000, a2\n"
+                                    "echo:\n"
+                                    "    move.b 0(a0), d0\n"
+                                    "    beq echoed\n"
+                                    "    move.b d0, 0(a0)\n"
+                                    "    bra echo\n"
+                                    "echoed:\n"
+                                    "    move.b 1(a0), d1\n"
+                                    "    move.l #10, 4(a1)\n"
+                                    "    move.l #0, d2\n"
+                                    "wait:\n"
+                                    "    move.l 8(a1), d3\n"
+                                    "    beq wait\n"
+                                    "    move.l d3, 8(a1)\n"
+                                    "    add.l #1, d2\n"
+                                    "    cmpi.l #2, d2\n"
+                                    "    bne wait\n"
+                                    "    move.l 0(a1), d4\n"
+                                    "    move.l #$01020304, d5\n"
+                                    "    move.l #15, d6\n"
+                                    "fill:\n"
+                                    "    move.l d5, (a2)+\n"
+                                    "    sub.l #1, d6\n"
+                                    "    beq filled\n"
+                                    "    bra fill\n"
+                                    "filled:\n"
+                                    "    hcf\n";
+
+    struct Devices
+    {
+        std::shared_ptr<momiji::devices::Console> console;
+        std::shared_ptr<momiji::devices::Framebuffer> framebuffer;
+    };
+
+    Devices attachDevices(momiji::Emulator& emu)
+    {
+        Devices res { std::make_shared<momiji::devices::Console>(),
+                      std::make_shared<momiji::devices::Framebuffer>(16, 4) };
+
+        auto timer = std::make_shared<momiji::devices::Timer>();
+
+        res.console->provideInput("Hi!");
+
+        emu.attachDevice(res.console, consoleBase);
+        emu.attachDevice(std::move(timer), timerBase);
+        emu.attachDevice(res.framebuffer, framebufferBase);
+
+        return res;
+    }
+} // namespace
+
+int testDevices()
+{
+    for (const auto backend : { Backend::Interpreter,
+                                Backend::ThreadedInterpreter,
+                                Backend::BasicBlocks,
+                                Backend::Jit })
+    {
+        momiji::EmulatorSettings settings;
+        settings.backend = backend;
+
+        momiji::Emulator emu { settings };
+        MOMIJI_TEST_REQUIRE(!emu.newState(program).has_value());
+
+        const auto devices = attachDevices(emu);
+
+        const auto res = emu.run({ 100000 });
+
+        if (res.reason != momiji::StopReason::Halt)
+        {
+            std::printf("Backend %d stopped early\n", int(backend));
+            return 0;
+        }
+
+        const auto& sys = emu.getStates().back();
+
+        MOMIJI_TEST_REQUIRE(devices.console->output() == "Hi!");
+        MOMIJI_TEST_REQUIRE(sys.cpu.dataRegisters[1].raw() == 0);
+
+        // Each expiry restarted the period, the counter kept going
+        MOMIJI_TEST_REQUIRE(sys.cpu.dataRegisters[4].raw() >= 20);
+
+        const auto pixels = devices.framebuffer->pixels();
+
+        for (std::int64_t i = 0; i < 60; ++i)
+        {
+            const auto expected = 4 - i % 4;
+            MOMIJI_TEST_REQUIRE(pixels[i] == expected);
+        }
+
+        MOMIJI_TEST_REQUIRE(pixels[60] == 0);
+        MOMIJI_TEST_REQUIRE(devices.framebuffer->generation() == 15);
+
+        // Nothing reached the memory under the devices
+        MOMIJI_TEST_REQUIRE(sys.mem.read8(consoleBase).value_or(1) == 0);
+        MOMIJI_TEST_REQUIRE(sys.mem.read8(framebufferBase).value_or(1) == 0);
+    }
+
+    momiji::DeviceBus bus;
+
+    const auto console = std::make_shared<momiji::devices::Console>();
+
+    // Pages are claimed whole, once
+    MOMIJI_TEST_REQUIRE(!bus.attach(console, consoleBase + 2));
+    MOMIJI_TEST_REQUIRE(bus.attach(console, consoleBase));
+    MOMIJI_TEST_REQUIRE(!bus.attach(console, consoleBase));
+
+    MOMIJI_TEST_REQUIRE(bus.tag(consoleBase + momiji::memoryPageSize - 1) != 0);
+    MOMIJI_TEST_REQUIRE(bus.tag(consoleBase + momiji::memoryPageSize) == 0);
+    MOMIJI_TEST_REQUIRE(bus.tag(consoleBase - 1) == 0);
+    MOMIJI_TEST_REQUIRE(bus.tag(-1) == 0);
+
+    // Past the registers of the device
+    momiji::System sys;
+
+    bus.write(sys, consoleBase + 8, 1, 'x');
+    MOMIJI_TEST_REQUIRE(console->output().empty());
+    MOMIJI_TEST_REQUIRE(bus.read(sys, consoleBase + 8, 1) == 0);
+
+    return 1;
+}
+
+int main()
+{
+    return static_cast<int>(!testDevices());
+}
@@ -0,0 +1,126 @@
+#include "./testing.h"
+#include <momiji/Emulator.h>
+#include <momiji/Exceptions.h>
+
+int testExceptions();
+
+namespace
+{
+    using Backend      = momiji::EmulatorSettings::Backend;
+    using RetainStates = momiji::EmulatorSettings::RetainStates;
+
+    // Handlers for trap #3 and division by zero, installed through the
+    // vector base register
+    constexpr const char* program = "    movec vbr, a0\n"
+                                    "    move.l #handler, 140(a0)\n"
+                                    "    move.l #zero, 20(a0)\n"
+                                    "    move.l #5, d0\n"
+                                    "    trap #3\n"
+                                    "    move.l #1, d2\n"
+                                    "    move.l #0, d3\n"
+                                    "    divu.w d3, d0\n"
+                                    "    move.l #1, d4\n"
+                                    "    hcf\n"
+                                    "handler:\n"
+                                    "    add.l #10, d0\n"
+                                    "    rte\n"
+                                    "zero:\n"
+                                    "    move.l #7, d5\n"
+                                    "    rte\n";
+
+    // Nothing handles the division
+    constexpr const char* unhandled = "    move.l #5, d0\n"
+                                      "    move.l #0, d3\n"
+                                      "    divu.w d3, d0\n"
+                                      "    hcf\n";
+
+    // movec takes 4 bytes, each move to memory 8 and the last move 6
+    constexpr std::uint32_t trapAddress = 26;
+
+    int testBackend(Backend backend, RetainStates retain)
+    {
+        momiji::EmulatorSettings settings;
+        settings.backend      = backend;
+        settings.retainStates = retain;
+
+        momiji::Emulator emu { settings };
+        emu.newState(program);
+
+        const auto stack =
+            emu.getStates().back().cpu.addressRegisters[7].raw();
+
+        auto res = emu.run();
+        MOMIJI_TEST_REQUIRE(res.reason == momiji::StopReason::Halt);
+
+        const auto& sys = emu.getStates().back();
+        const auto& cpu = sys.cpu;
+        MOMIJI_TEST_REQUIRE(cpu.dataRegisters[0].raw() == 15);
+        MOMIJI_TEST_REQUIRE(cpu.dataRegisters[2].raw() == 1);
+        MOMIJI_TEST_REQUIRE(cpu.dataRegisters[4].raw() == 1);
+        MOMIJI_TEST_REQUIRE(cpu.dataRegisters[5].raw() == 7);
+        MOMIJI_TEST_REQUIRE(cpu.addressRegisters[7].raw() == stack);
+        MOMIJI_TEST_REQUIRE(cpu.statusRegister.supervisor());
+
+        // Entering a handler isn't an instruction
+        MOMIJI_TEST_REQUIRE(res.executed == 14);
+
+        if (retain == RetainStates::Always)
+        {
+            // Back before the exception entered the handler of trap #3
+            while (emu.getStates().back().cpu.programCounter.raw() !=
+                   trapAddress)
+            {
+                MOMIJI_TEST_REQUIRE(emu.reverseStep());
+            }
+
+            MOMIJI_TEST_REQUIRE(emu.step());
+
+            const auto& trapped = emu.getStates().back();
+            MOMIJI_TEST_REQUIRE(trapped.trap.has_value());
+            MOMIJI_TEST_REQUIRE(trapped.cpu.addressRegisters[7].raw() ==
+                                stack);
+
+            MOMIJI_TEST_REQUIRE(emu.step());
+
+            const auto& entered = emu.getStates().back();
+            MOMIJI_TEST_REQUIRE(!entered.trap.has_value());
+            MOMIJI_TEST_REQUIRE(entered.cpu.addressRegisters[7].raw() ==
+                                stack - 6);
+            MOMIJI_TEST_REQUIRE(entered.mem.read32(stack - 4) ==
+                                trapAddress + 2);
+
+            MOMIJI_TEST_REQUIRE(emu.reverseStep());
+            MOMIJI_TEST_REQUIRE(emu.getStates().back().trap.has_value());
+
+            res = emu.run();
+            MOMIJI_TEST_REQUIRE(res.reason == momiji::StopReason::Halt);
+            MOMIJI_TEST_REQUIRE(
+                emu.getStates().back().cpu.dataRegisters[0].raw() == 15);
+        }
+
+        momiji::Emulator stopped { settings };
+        stopped.newState(unhandled);
+
+        res = stopped.run();
+        MOMIJI_TEST_REQUIRE(res.reason == momiji::StopReason::Trap);
+        MOMIJI_TEST_REQUIRE(std::holds_alternative<momiji::traps::DivisionByZero>(
+            *stopped.getStates().back().trap));
+
+        // Still nothing to run
+        res = stopped.run();
+        MOMIJI_TEST_REQUIRE(res.reason == momiji::StopReason::Trap);
+        MOMIJI_TEST_REQUIRE(res.executed == 0);
+
+        return 1;
+    }
+} // namespace
+
+int testExceptions()
+{
+    return momiji::testing::forEachBackend(testBackend);
+}
+
+int main()
+{
+    return static_cast<int>(!testExceptions());
+}
@@ -0,0 +1,120 @@
+#include "./testing.h"
+#include <momiji/System.h>
+
+#include <cstdio>
+
+int testLazyFlags();
+
+namespace
+{
+    constexpr std::uint32_t values[] = {
+        0x0000'0000, 0x0000'0001, 0x0000'007F, 0x0000'0080, 0x0000'00FF,
+        0x0000'7FFF, 0x0000'8000, 0x0000'FFFF, 0x7FFF'FFFF, 0x8000'0000,
+        0xFFFF'FFFF, 0x1234'5678, 0x89AB'CDEF, 0xFFFF'FF80, 0x0001'0000,
+    };
+
+    std::int64_t signedAt(std::uint32_t val, std::int8_t size)
+    {
+        const auto bits = 8 * size;
+        const auto mask = std::uint64_t(momiji::details::sizeMask(size));
+        const auto sign = std::uint64_t(1) << (bits - 1);
+
+        const auto low = std::uint64_t(val) & mask;
+
+        return (low & sign) != 0 ? std::int64_t(low) - std::int64_t(mask) - 1
+                                 : std::int64_t(low);
+    }
+
+    // The flags of dst + src or dst - src worked out the long way,
+    // laid out as in StatusRegister::bits without X
+    std::uint8_t expectedFlags(bool add,
+                               std::int8_t size,
+                               std::uint32_t src,
+                               std::uint32_t dst)
+    {
+        using Flag = momiji::StatusRegister::Flag;
+
+        const auto mask = std::uint64_t(momiji::details::sizeMask(size));
+        const auto max  = std::int64_t(mask >> 1);
+
+        const auto usrc = std::uint64_t(src) & mask;
+        const auto udst = std::uint64_t(dst) & mask;
+
+        const bool carry  = add ? (udst + usrc > mask) : (usrc > udst);
+        const auto result = (add ? udst + usrc : udst - usrc) & mask;
+
+        const auto wide = add ? signedAt(dst, size) + signedAt(src, size)
+                              : signedAt(dst, size) - signedAt(src, size);
+        const bool overflow = wide > max || wide < -max - 1;
+
+        return std::uint8_t((carry ? Flag::Carry : 0) |
+                            (overflow ? Flag::Overflow : 0) |
+                            (result == 0 ? Flag::Zero : 0) |
+                            (signedAt(std::uint32_t(result), size) < 0
+                                 ? Flag::Negative
+                                 : 0));
+    }
+} // namespace
+
+int testLazyFlags()
+{
+    using Flag = momiji::StatusRegister::Flag;
+
+    for (const std::int8_t size : { 1, 2, 4 })
+    {
+        for (const auto src : values)
+        {
+            for (const auto dst : values)
+            {
+                momiji::StatusRegister sr;
+
+                const auto sum = std::int32_t(dst + src);
+                sr.setAdd(size, std::int32_t(src), std::int32_t(dst), sum);
+
+                auto expected = expectedFlags(true, size, src, dst);
+                MOMIJI_TEST_REQUIRE(sr.bits() ==
+                                    (expected |
+                                     ((expected & Flag::Carry) != 0
+                                          ? Flag::Extend
+                                          : 0)));
+
+                const auto diff = std::int32_t(dst - src);
+                sr.setSub(size, std::int32_t(src), std::int32_t(dst), diff);
+
+                expected = expectedFlags(false, size, src, dst);
+                MOMIJI_TEST_REQUIRE(sr.bits() ==
+                                    (expected |
+                                     ((expected & Flag::Carry) != 0
+                                          ? Flag::Extend
+                                          : 0)));
+
+                // cmp and move leave X alone
+                sr.setBits(Flag::Extend);
+                sr.setCompare(
+                    size, std::int32_t(src), std::int32_t(dst), diff);
+                MOMIJI_TEST_REQUIRE(sr.bits() == (expected | Flag::Extend));
+
+                sr.setLogical(size, std::int32_t(dst));
+                MOMIJI_TEST_REQUIRE(sr.extend());
+                MOMIJI_TEST_REQUIRE(!sr.overflow() && !sr.carry());
+                MOMIJI_TEST_REQUIRE(sr.zero() ==
+                                    (signedAt(dst, size) == 0));
+                MOMIJI_TEST_REQUIRE(sr.negative() ==
+                                    (signedAt(dst, size) < 0));
+            }
+        }
+    }
+
+    momiji::StatusRegister sr;
+    sr.setAdd(4, 1, -1, 0);
+    sr.set(Flag::Zero, false);
+
+    MOMIJI_TEST_REQUIRE(sr.bits() == (Flag::Carry | Flag::Extend));
+
+    return 1;
+}
+
+int main()
+{
+    return static_cast<int>(!testLazyFlags());
+}
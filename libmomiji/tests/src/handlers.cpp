@@ -0,0 +1,170 @@
+#include "./testing.h"
+#include <momiji/Decoder.h>
+#include <momiji/System.h>
+
+#include "../../src/Instructions/add.h"
+#include "../../src/Instructions/move.h"
+
+#include <cstdio>
+
+int testSpecialisedHandlers();
+int testInstructionSizes();
+
+namespace
+{
+    bool sameState(const momiji::System& lhs, const momiji::System& rhs)
+    {
+        const auto& a = lhs.cpu;
+        const auto& b = rhs.cpu;
+
+        for (std::size_t i = 0; i < a.dataRegisters.size(); ++i)
+        {
+            if (a.dataRegisters[i].raw() != b.dataRegisters[i].raw() ||
+                a.addressRegisters[i].raw() != b.addressRegisters[i].raw())
+            {
+                return false;
+            }
+        }
+
+        if (a.programCounter.raw() != b.programCounter.raw() ||
+            a.statusRegister.bits() != b.statusRegister.bits())
+        {
+            return false;
+        }
+
+        if (lhs.mem.size() != rhs.mem.size())
+        {
+            return false;
+        }
+
+        // Pages still shared, like the untouched ones, are equal
+        for (std::int64_t i = 0; i < std::int64_t(lhs.mem.size()); ++i)
+        {
+            if (i % momiji::memoryPageSize == 0 &&
+                lhs.mem.underlying().sharesPage(rhs.mem.underlying(),
+                                                i / momiji::memoryPageSize))
+            {
+                i += momiji::memoryPageSize - 1;
+                continue;
+            }
+
+            if (lhs.mem.read8(i) != rhs.mem.read8(i))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Code at the start, followed by data every address register points to
+    momiji::System makeSystem()
+    {
+        momiji::System sys;
+
+        for (const std::uint16_t word :
+             { 0x0000, 0x1234, 0x5678, 0x9ABC, 0xDEF0 })
+        {
+            sys.mem.push16(word);
+        }
+
+        sys.mem.executableMarker.begin = 0;
+        sys.mem.executableMarker.end   = std::int64_t(sys.mem.size());
+
+        for (std::uint16_t i = 0; i < 128; ++i)
+        {
+            sys.mem.push16(std::uint16_t(i * 0x0301 + 0x80F0));
+        }
+
+        for (std::size_t i = 0; i < 8; ++i)
+        {
+            sys.cpu.dataRegisters[i] = std::int32_t(0x7F81'FE03 * (i + 1));
+            sys.cpu.addressRegisters[i] = std::int32_t(32 + i * 24);
+        }
+
+        return sys;
+    }
+} // namespace
+
+// Every form of move and add must behave like the generic handler
+int testSpecialisedHandlers()
+{
+    const auto initial = makeSystem();
+
+    for (std::uint32_t opcode = 0; opcode <= 0xFFFF; ++opcode)
+    {
+        auto specialised = initial;
+        MOMIJI_TEST_REQUIRE(specialised.mem.write16(std::uint16_t(opcode), 0));
+
+        const auto instr = momiji::decode(specialised.mem, 0);
+
+        momiji::DecodedInstructionFn generic = nullptr;
+
+        switch (instr.type)
+        {
+        case momiji::InstructionType::Move:
+            generic = momiji::instr::move;
+            break;
+
+        case momiji::InstructionType::Add:
+        case momiji::InstructionType::AddA:
+        case momiji::InstructionType::AddI:
+            generic = momiji::instr::add;
+            break;
+
+        default:
+            continue;
+        }
+
+        auto expected = specialised;
+
+        instr.exec(specialised, instr.data);
+        generic(expected, instr.data);
+
+        if (!sameState(specialised, expected))
+        {
+            std::printf("Opcode 0x%04X differs from the generic handler\n",
+                        opcode);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+// Translations walk the code with instructionSize, which must agree with
+// where the handler of every opcode leaves the PC when it carries on
+int testInstructionSizes()
+{
+    const auto initial = makeSystem();
+
+    for (std::uint32_t opcode = 0; opcode <= 0xFFFF; ++opcode)
+    {
+        auto sys = initial;
+        MOMIJI_TEST_REQUIRE(sys.mem.write16(std::uint16_t(opcode), 0));
+
+        const auto instr = momiji::decode(sys.mem, 0);
+
+        if (instr.exec(sys, instr.data) != momiji::ExecutionStatus::Continue)
+        {
+            continue;
+        }
+
+        if (sys.cpu.programCounter.raw() != momiji::instructionSize(instr))
+        {
+            std::printf("Opcode 0x%04X is %d bytes, its handler moved %u\n",
+                        opcode,
+                        int(momiji::instructionSize(instr)),
+                        sys.cpu.programCounter.raw());
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+int main()
+{
+    return static_cast<int>(!testSpecialisedHandlers() ||
+                            !testInstructionSizes());
+}
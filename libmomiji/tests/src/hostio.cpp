@@ -0,0 +1,269 @@
+#include "./testing.h"
+#include <momiji/Emulator.h>
+
+#include <string>
+
+int testHostIO();
+
+namespace
+{
+    using Backend      = momiji::EmulatorSettings::Backend;
+    using RetainStates = momiji::EmulatorSettings::RetainStates;
+
+    // Prints "Hi!" from $2000 and a few numbers, reads a number and a line,
+    // then stops with task 9
+    constexpr const char* program = "    move.l #$2000, a1\n"
+                                    "    move.l #$00216948, 0(a1)\n"
+                                    "    move.l #13, d0\n"
+                                    "    trap #15\n"
+                                    "    move.l #-42, d1\n"
+                                    "    move.l #3, d0\n"
+                                    "    trap #15\n"
+                                    "    move.l #32, d1\n"
+                                    "    move.l #6, d0\n"
+                                    "    trap #15\n"
+                                    "    move.l #255, d1\n"
+                                    "    move.l #16, d2\n"
+                                    "    move.l #15, d0\n"
+                                    "    trap #15\n"
+                                    "    move.l #7, d1\n"
+                                    "    move.l #5, d2\n"
+                                    "    move.l #20, d0\n"
+                                    "    trap #15\n"
+                                    "    move.l #4, d0\n"
+                                    "    trap #15\n"
+                                    "    move.l d1, d3\n"
+                                    "    move.l #$3000, a1\n"
+                                    "    move.l #2, d0\n"
+                                    "    trap #15\n"
+                                    "    move.l #$2000, a1\n"
+                                    "    move.l #2, d1\n"
+                                    "    move.l #1, d0\n"
+                                    "    trap #15\n"
+                                    "    move.l #9, d0\n"
+                                    "    trap #15\n"
+                                    "    move.l #1, d4\n"
+                                    "    hcf\n";
+
+    // Task 10 is the printer, left to the program
+    constexpr const char* unknownTask = "    move.l #10, d0\n"
+                                        "    trap #15\n"
+                                        "    hcf\n";
+
+    // Every task reading input: a number, a character after checking there
+    // is one, a line, a number after a prompt, then nothing left
+    constexpr const char* reading = "    move.l #4, d0\n"
+                                    "    trap #15\n"
+                                    "    move.l d1, d3\n"
+                                    "    move.l #7, d0\n"
+                                    "    trap #15\n"
+                                    "    move.l d1, d4\n"
+                                    "    move.l #5, d0\n"
+                                    "    trap #15\n"
+                                    "    move.l d1, d5\n"
+                                    "    move.l #$3000, a1\n"
+                                    "    move.l #2, d0\n"
+                                    "    trap #15\n"
+                                    "    move.l #$2000, a1\n"
+                                    "    move.l #0, 0(a1)\n"
+                                    "    move.l #18, d0\n"
+                                    "    trap #15\n"
+                                    "    move.l d1, d6\n"
+                                    "    move.l #7, d0\n"
+                                    "    trap #15\n"
+                                    "    hcf\n";
+
+    bool sameState(const momiji::System& lhs, const momiji::System& rhs)
+    {
+        for (std::size_t i = 0; i < lhs.cpu.dataRegisters.size(); ++i)
+        {
+            if (lhs.cpu.dataRegisters[i].raw() !=
+                rhs.cpu.dataRegisters[i].raw())
+            {
+                return false;
+            }
+        }
+
+        return lhs.cpu.programCounter.raw() == rhs.cpu.programCounter.raw() &&
+               lhs.mem.read32(0x3000) == rhs.mem.read32(0x3000);
+    }
+
+    // States rebuilt from checkpoints closer than the program is long read
+    // what the program read the first time
+    int testReplay(Backend backend, RetainStates retain)
+    {
+        if (retain == RetainStates::Never)
+        {
+            return 1;
+        }
+
+        momiji::EmulatorSettings settings;
+        settings.backend      = backend;
+        settings.retainStates = retain;
+
+        const auto load = [](momiji::Emulator& emu) {
+            emu.trapServices().setOutput({});
+            emu.trapServices().provideInput("123\nxabc\n-7\n");
+
+            return !emu.newState(reading).has_value() &&
+                   emu.run({ 1000 }).reason == momiji::StopReason::Halt;
+        };
+
+        momiji::Emulator reference { settings };
+        MOMIJI_TEST_REQUIRE(load(reference));
+
+        const auto& last = reference.getStates().back();
+        MOMIJI_TEST_REQUIRE(last.cpu.dataRegisters[3].raw() == 123);
+        MOMIJI_TEST_REQUIRE(last.cpu.dataRegisters[4].raw() == 1);
+        MOMIJI_TEST_REQUIRE(last.cpu.dataRegisters[5].raw() == 'x');
+        MOMIJI_TEST_REQUIRE(last.cpu.dataRegisters[6].raw() == -7);
+        MOMIJI_TEST_REQUIRE(std::uint8_t(last.cpu.dataRegisters[1].raw()) ==
+                            0);
+        MOMIJI_TEST_REQUIRE(last.mem.read32(0x3000).value_or(0) ==
+                            0x00636261);
+
+        settings.checkpointInterval  = 3;
+        settings.historyMemoryBudget = 1;
+
+        momiji::Emulator emu { settings };
+        MOMIJI_TEST_REQUIRE(load(emu));
+
+        const auto states = reference.getStates();
+        MOMIJI_TEST_REQUIRE(emu.getStates().size() == states.size());
+
+        for (std::size_t i = 0; i < states.size(); ++i)
+        {
+            MOMIJI_TEST_REQUIRE(sameState(emu.getStates()[i], states[i]));
+        }
+
+        // Going back one step at a time runs again from the checkpoints
+        for (auto i = states.size() - 1; i > 1; --i)
+        {
+            MOMIJI_TEST_REQUIRE(emu.seekTo(std::int64_t(i - 1)));
+            MOMIJI_TEST_REQUIRE(sameState(emu.getStates().back(),
+                                          states[i - 1]));
+        }
+
+        return 1;
+    }
+
+    int testBackend(Backend backend, RetainStates retain)
+    {
+        momiji::EmulatorSettings settings;
+        settings.backend      = backend;
+        settings.retainStates = retain;
+
+        momiji::Emulator emu { settings };
+        MOMIJI_TEST_REQUIRE(!emu.newState(program).has_value());
+
+        std::string output;
+        std::int64_t flushes = 0;
+
+        emu.trapServices().setOutput([&](std::string_view text) {
+            output += text;
+            ++flushes;
+        });
+        emu.trapServices().provideInput("123\nabc\n");
+
+        const auto res = emu.run({ 1000 });
+        MOMIJI_TEST_REQUIRE(res.reason == momiji::StopReason::Halt);
+
+        // All of it at once, when the program stopped
+        MOMIJI_TEST_REQUIRE(output == "Hi!\n-42 FF    7Hi");
+        MOMIJI_TEST_REQUIRE(flushes == 1);
+
+        const auto& sys = emu.getStates().back();
+        MOMIJI_TEST_REQUIRE(sys.cpu.dataRegisters[3].raw() == 123);
+        MOMIJI_TEST_REQUIRE(sys.cpu.dataRegisters[4].raw() == 0);
+        MOMIJI_TEST_REQUIRE(sys.mem.read32(0x3000).value_or(0) ==
+                            0x00636261);
+
+        if (retain == RetainStates::Always)
+        {
+            // Serving the trap was a step of its own
+            MOMIJI_TEST_REQUIRE(emu.reverseStep());
+            MOMIJI_TEST_REQUIRE(emu.getStates().back().cpu.dataRegisters[0]
+                                    .raw() == 9);
+            MOMIJI_TEST_REQUIRE(emu.getStates().back().trap.has_value());
+        }
+
+        momiji::Emulator unknown { settings };
+        MOMIJI_TEST_REQUIRE(!unknown.newState(unknownTask).has_value());
+        MOMIJI_TEST_REQUIRE(unknown.run({ 1000 }).reason ==
+                            momiji::StopReason::Trap);
+
+        // The guest handler gets every task
+        settings.hostTrapServices = false;
+
+        momiji::Emulator guest { settings };
+        MOMIJI_TEST_REQUIRE(!guest.newState(program).has_value());
+        MOMIJI_TEST_REQUIRE(guest.run({ 1000 }).reason ==
+                            momiji::StopReason::Trap);
+
+        return 1;
+    }
+
+    int testBatches()
+    {
+        momiji::TrapServices services;
+        momiji::System sys;
+
+        std::int64_t flushes = 0;
+        services.setOutput([&](std::string_view /*text*/) { ++flushes; });
+
+        // Task 6 prints the character in d1.b
+        sys.cpu.dataRegisters[0] = 6;
+        sys.cpu.dataRegisters[1] = 'x';
+
+        for (std::size_t i = 0; i < momiji::TrapServices::batchSize; ++i)
+        {
+            sys.trap = momiji::traps::Trap { 15 };
+            MOMIJI_TEST_REQUIRE(services.run(sys) ==
+                                momiji::TrapServices::Result::Served);
+        }
+
+        MOMIJI_TEST_REQUIRE(flushes == 1);
+        MOMIJI_TEST_REQUIRE(!sys.trap.has_value());
+
+        // Task 7 sees no input, task 5 reads 0 once it ran out
+        sys.trap                 = momiji::traps::Trap { 15 };
+        sys.cpu.dataRegisters[0] = 7;
+        MOMIJI_TEST_REQUIRE(services.run(sys) ==
+                            momiji::TrapServices::Result::Served);
+        MOMIJI_TEST_REQUIRE(sys.cpu.dataRegisters[1].raw() == 0);
+
+        services.provideInput("y");
+
+        for (const auto expected : { 'y', '\0' })
+        {
+            sys.trap                 = momiji::traps::Trap { 15 };
+            sys.cpu.dataRegisters[0] = 5;
+            MOMIJI_TEST_REQUIRE(services.run(sys) ==
+                                momiji::TrapServices::Result::Served);
+            MOMIJI_TEST_REQUIRE(sys.cpu.dataRegisters[1].raw() == expected);
+        }
+
+        // Not a trap #15
+        sys.trap = momiji::traps::Trap { 14 };
+        MOMIJI_TEST_REQUIRE(services.run(sys) ==
+                            momiji::TrapServices::Result::Unknown);
+        MOMIJI_TEST_REQUIRE(sys.trap.has_value());
+
+        MOMIJI_TEST_REQUIRE(!services.provideInputFile(""));
+
+        return 1;
+    }
+} // namespace
+
+int testHostIO()
+{
+    MOMIJI_TEST_REQUIRE(testBatches());
+    MOMIJI_TEST_REQUIRE(momiji::testing::forEachBackend(testReplay));
+
+    return momiji::testing::forEachBackend(testBackend);
+}
+
+int main()
+{
+    return static_cast<int>(!testHostIO());
+}
@@ -0,0 +1,185 @@
+#include "./testing.h"
+#include <momiji/Emulator.h>
+
+#include <cstdio>
+
+int testMemoryIdioms();
+
+namespace
+{
+    using Backend = momiji::EmulatorSettings::Backend;
+
+    // Fills and copies, one of them overlapping its own destination and
+    // one with elements too close to each other to be run in bulk
+    constexpr const char* program = "    move.l #1024, a1\n"
+                                    "    move.l #300, d0\n"
+                                    "fill:\n"
+                                    "    move.w #-2213, (a1)+\n"
+                                    "    sub.l #1, d0\n"
+                                    "    beq filled\n"
+                                    "    jmp fill\n"
+                                    "filled:\n"
+                                    "    move.l #1200, a1\n"
+                                    "    move.l #-559038737, d2\n"
+                                    "    move.w #50, d3\n"
+                                    "lfill:\n"
+                                    "    move.l d2, (a1)+\n"
+                                    "    sub.l #1, d3\n"
+                                    "    beq lfilled\n"
+                                    "    jmp lfill\n"
+                                    "lfilled:\n"
+                                    "    move.l #0, a0\n"
+                                    "    move.l #1600, a1\n"
+                                    "    move.l #64, d0\n"
+                                    "copy:\n"
+                                    "    move.b (a0)+, (a1)+\n"
+                                    "    sub.l #1, d0\n"
+                                    "    beq copied\n"
+                                    "    jmp copy\n"
+                                    "copied:\n"
+                                    "    move.l #1024, a0\n"
+                                    "    move.l #1027, a1\n"
+                                    "    move.l #200, d0\n"
+                                    "overlap:\n"
+                                    "    move.b (a0)+, (a1)+\n"
+                                    "    subi.l #1, d0\n"
+                                    "    beq overlapped\n"
+                                    "    jmp overlap\n"
+                                    "overlapped:\n"
+                                    "    move.l #1202, a0\n"
+                                    "    move.l #1200, a1\n"
+                                    "    move.l #100, d0\n"
+                                    "back:\n"
+                                    "    move.w (a0)+, (a1)+\n"
+                                    "    sub.l #1, d0\n"
+                                    "    beq behind\n"
+                                    "    jmp back\n"
+                                    "behind:\n"
+                                    "    move.l #1600, a0\n"
+                                    "    move.l #1602, a1\n"
+                                    "    move.l #20, d0\n"
+                                    "close:\n"
+                                    "    move.l (a0)+, (a1)+\n"
+                                    "    sub.l #1, d0\n"
+                                    "    beq end\n"
+                                    "    jmp close\n"
+                                    "end:\n"
+                                    "    hcf\n";
+
+    bool sameState(const momiji::System& lhs, const momiji::System& rhs)
+    {
+        const auto& a = lhs.cpu;
+        const auto& b = rhs.cpu;
+
+        for (std::size_t i = 0; i < a.dataRegisters.size(); ++i)
+        {
+            if (a.dataRegisters[i].raw() != b.dataRegisters[i].raw() ||
+                a.addressRegisters[i].raw() != b.addressRegisters[i].raw())
+            {
+                return false;
+            }
+        }
+
+        if (a.programCounter.raw() != b.programCounter.raw() ||
+            a.statusRegister.bits() != b.statusRegister.bits() ||
+            lhs.cycles != rhs.cycles)
+        {
+            return false;
+        }
+
+        if (lhs.mem.size() != rhs.mem.size())
+        {
+            return false;
+        }
+
+        // Pages still shared, like the untouched ones, are equal
+        for (std::int64_t i = 0; i < std::int64_t(lhs.mem.size()); ++i)
+        {
+            if (i % momiji::memoryPageSize == 0 &&
+                lhs.mem.underlying().sharesPage(rhs.mem.underlying(),
+                                                i / momiji::memoryPageSize))
+            {
+                i += momiji::memoryPageSize - 1;
+                continue;
+            }
+
+            if (lhs.mem.read8(i) != rhs.mem.read8(i))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Also returns how many instructions the whole program took
+    momiji::Emulator runProgram(Backend backend,
+                                bool idioms,
+                                std::int64_t maxInstructions,
+                                std::int64_t& executed)
+    {
+        momiji::EmulatorSettings settings;
+        settings.backend                = backend;
+        settings.accelerateMemoryIdioms = idioms;
+        settings.retainStates = momiji::EmulatorSettings::RetainStates::Never;
+
+        momiji::Emulator emu { settings };
+        emu.newState(program);
+
+        executed = 0;
+
+        while (true)
+        {
+            const auto res = emu.run({ maxInstructions });
+            executed += res.executed;
+
+            if (res.reason != momiji::StopReason::InstructionLimit)
+            {
+                break;
+            }
+        }
+
+        return emu;
+    }
+} // namespace
+
+int testMemoryIdioms()
+{
+    std::int64_t expectedCount = 0;
+
+    const auto reference =
+        runProgram(Backend::BasicBlocks, false, -1, expectedCount);
+    const auto& expected = reference.getStates().back();
+
+    // The overlapping copy repeats the first three bytes
+    MOMIJI_TEST_REQUIRE(expected.mem.read8(1024) == expected.mem.read8(1027));
+    MOMIJI_TEST_REQUIRE(expected.mem.read8(1025) == expected.mem.read8(1028));
+    MOMIJI_TEST_REQUIRE(expected.mem.read8(1024) != expected.mem.read8(1025));
+
+    for (const auto backend : { Backend::BasicBlocks, Backend::Jit })
+    {
+        for (const std::int64_t maxInstructions : { -1, 1000, 7, 1 })
+        {
+            std::int64_t executed = 0;
+
+            const auto emu =
+                runProgram(backend, true, maxInstructions, executed);
+
+            if (!sameState(emu.getStates().back(), expected) ||
+                executed != expectedCount)
+            {
+                std::printf("Backend %d, %d instructions at a time\n",
+                            int(backend),
+                            int(maxInstructions));
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+int main()
+{
+    return static_cast<int>(!testMemoryIdioms());
+}
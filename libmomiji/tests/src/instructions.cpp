@@ -0,0 +1,128 @@
+#include "./testing.h"
+#include <momiji/Emulator.h>
+
+#include <cstdio>
+
+int testInstructions();
+
+// Programs that went wrong once, each checked with every backend
+namespace
+{
+    using Backend = momiji::EmulatorSettings::Backend;
+
+    // bcc added its displacement unsigned, so backward branches jumped
+    // 64 KiB ahead instead
+    constexpr const char* backwardBranch = "    move.l #3, d0\n"
+                                           "    move.l #0, d1\n"
+                                           "loop:\n"
+                                           "    add.l #1, d1\n"
+                                           "    sub.l #1, d0\n"
+                                           "    tst.l d0\n"
+                                           "    bne loop\n"
+                                           "    hcf\n";
+
+    // Byte and word reads sign-extended their address, so they read the
+    // wrong bytes past 127
+    constexpr const char* highRead = "    move.l #$800, a0\n"
+                                     "    move.l #$12345678, d0\n"
+                                     "    move.l d0, (a0)+\n"
+                                     "    move.l #$800, a0\n"
+                                     "    move.w (a0)+, d2\n"
+                                     "    move.b (a0)+, d1\n"
+                                     "    hcf\n";
+
+    // cmp compared against 0 instead of its memory source. The parser only
+    // takes immediate sources, so cmp.l (a0), d1 is given as its opcode,
+    // twice since dc pads a single value to two
+    constexpr const char* compareMemory = "    move.l #$800, a0\n"
+                                          "    move.l #5, d0\n"
+                                          "    move.l d0, (a0)+\n"
+                                          "    move.l #$800, a0\n"
+                                          "    move.l #5, d1\n"
+                                          "    move.l #0, d7\n"
+                                          "    dc.w $B290, $B290\n"
+                                          "    beq same\n"
+                                          "    move.l #1, d7\n"
+                                          "same:\n"
+                                          "    hcf\n";
+
+    // offset(a*) destinations read their extension word with the size of
+    // the operand, long words went to another address
+    constexpr const char* offsetStore = "    move.l #$800, a0\n"
+                                        "    move.l #$11223344, d0\n"
+                                        "    move.l d0, 4(a0)\n"
+                                        "    move.l #$804, a1\n"
+                                        "    move.l (a1)+, d3\n"
+                                        "    hcf\n";
+
+    // subi kept 2 bits of its destination register, d6 was d2
+    constexpr const char* immediateToHighRegister = "    move.l #5, d6\n"
+                                                    "    move.l #7, d2\n"
+                                                    "    sub.l #1, d6\n"
+                                                    "    hcf\n";
+
+    // Runs program up to its hcf, check gets the registers it left
+    template <typename Check>
+    int testProgram(const char* program, Check check)
+    {
+        for (const auto backend : { Backend::Interpreter,
+                                    Backend::ThreadedInterpreter,
+                                    Backend::BasicBlocks,
+                                    Backend::Jit })
+        {
+            momiji::EmulatorSettings settings;
+            settings.backend = backend;
+
+            momiji::Emulator emu { settings };
+            MOMIJI_TEST_REQUIRE(!emu.newState(program).has_value());
+            MOMIJI_TEST_REQUIRE(emu.run({ 1000 }).reason ==
+                                momiji::StopReason::Halt);
+
+            if (check(emu.getStates().back().cpu) == 0)
+            {
+                std::printf("Backend %d\n", int(backend));
+                return 0;
+            }
+        }
+
+        return 1;
+    }
+} // namespace
+
+int testInstructions()
+{
+    MOMIJI_TEST_REQUIRE(testProgram(backwardBranch, [](const momiji::Cpu& cpu) {
+        MOMIJI_TEST_REQUIRE(cpu.dataRegisters[1].raw() == 3);
+        return 1;
+    }));
+
+    MOMIJI_TEST_REQUIRE(testProgram(highRead, [](const momiji::Cpu& cpu) {
+        MOMIJI_TEST_REQUIRE(cpu.dataRegisters[1].raw() == 0x34);
+        MOMIJI_TEST_REQUIRE(cpu.dataRegisters[2].raw() == 0x5678);
+        return 1;
+    }));
+
+    MOMIJI_TEST_REQUIRE(testProgram(compareMemory, [](const momiji::Cpu& cpu) {
+        MOMIJI_TEST_REQUIRE(cpu.dataRegisters[7].raw() == 0);
+        return 1;
+    }));
+
+    MOMIJI_TEST_REQUIRE(testProgram(offsetStore, [](const momiji::Cpu& cpu) {
+        MOMIJI_TEST_REQUIRE(cpu.dataRegisters[3].raw() == 0x11223344);
+        return 1;
+    }));
+
+    MOMIJI_TEST_REQUIRE(
+        testProgram(immediateToHighRegister, [](const momiji::Cpu& cpu) {
+            MOMIJI_TEST_REQUIRE(cpu.dataRegisters[2].raw() == 7);
+            MOMIJI_TEST_REQUIRE(cpu.dataRegisters[6].raw() == 4);
+            return 1;
+        }));
+
+    return 1;
+}
+
+int main()
+{
+    return static_cast<int>(!testInstructions());
+}
@@ -0,0 +1,284 @@
+#include "./testing.h"
+#include <momiji/Emulator.h>
+#include <momiji/Exceptions.h>
+
+#include <vector>
+
+int testInterrupts();
+
+namespace
+{
+    using Backend      = momiji::EmulatorSettings::Backend;
+    using RetainStates = momiji::EmulatorSettings::RetainStates;
+
+    constexpr std::int64_t timerBase = 0xF01000;
+
+    // move.l #3, d0 takes 12 cycles, each sub.l #1, d0 16, bne 10 when
+    // taken and 12 when not (with a word displacement), hcf 4
+    constexpr const char* counting = "    move.l #3, d0\n"
+                                     "loop:\n"
+                                     "    sub.l #1, d0\n"
+                                     "    bne loop\n"
+                                     "    hcf\n";
+
+    constexpr std::int64_t countingCycles = 12 + 3 * 16 + 2 * 10 + 12 + 4;
+
+    // The timer interrupts at level 3 every 200 cycles, the handler counts
+    // them until there were 3
+    constexpr const char* ticking = "    movec vbr, a0\n"
+                                    "    move.l #tick, 108(a0)\n"
+                                    "    move.l #$F01000, a1\n"
+                                    "    move.l #0, d1\n"
+                                    "    move.l #3, 12(a1)\n"
+                                    "    move.l #200, 4(a1)\n"
+                                    "spin:\n"
+                                    "    cmpi.l #3, d1\n"
+                                    "    bne spin\n"
+                                    "    hcf\n"
+                                    "tick:\n"
+                                    "    add.l #1, d1\n"
+                                    "    rte\n";
+
+    // Levels 2 and 5 at once, the level 2 handler waits for the level 5
+    // one to return
+    constexpr const char* nested = "    movec vbr, a0\n"
+                                   "    move.l #low, 104(a0)\n"
+                                   "    move.l #high, 116(a0)\n"
+                                   "    move.l #0, d2\n"
+                                   "spin:\n"
+                                   "    cmpi.l #2, d2\n"
+                                   "    bne spin\n"
+                                   "    hcf\n"
+                                   "low:\n"
+                                   "    move.l d5, d2\n"
+                                   "    add.l #1, d2\n"
+                                   "    rte\n"
+                                   "high:\n"
+                                   "    move.l #1, d5\n"
+                                   "    rte\n";
+
+    // Spins until the level 2 handler sets d2
+    constexpr const char* waiting = "    movec vbr, a0\n"
+                                    "    move.l #handler, 104(a0)\n"
+                                    "    move.l #0, d2\n"
+                                    "spin:\n"
+                                    "    add.l #1, d3\n"
+                                    "    cmpi.l #0, d2\n"
+                                    "    beq spin\n"
+                                    "    hcf\n"
+                                    "handler:\n"
+                                    "    move.l #1, d2\n"
+                                    "    rte\n";
+
+    bool sameState(const momiji::System& lhs, const momiji::System& rhs)
+    {
+        return lhs.cpu.programCounter.raw() == rhs.cpu.programCounter.raw() &&
+               lhs.cpu.statusRegister.word() == rhs.cpu.statusRegister.word() &&
+               lhs.cpu.dataRegisters[2].raw() ==
+                   rhs.cpu.dataRegisters[2].raw() &&
+               lhs.cpu.dataRegisters[3].raw() ==
+                   rhs.cpu.dataRegisters[3].raw() &&
+               lhs.interruptRequests == rhs.interruptRequests &&
+               lhs.cycles == rhs.cycles;
+    }
+
+    // Going back across an interrupt, with states rebuilt from checkpoints
+    // closer than the program is long
+    int testGoingBack(Backend backend, RetainStates retain)
+    {
+        if (retain == RetainStates::Never)
+        {
+            return 1;
+        }
+
+        momiji::EmulatorSettings settings;
+        settings.backend      = backend;
+        settings.retainStates = retain;
+
+        const auto load = [](momiji::Emulator& emu) {
+            if (emu.newState(waiting).has_value())
+            {
+                return false;
+            }
+
+            emu.scheduler().schedule(1000, [](momiji::System& sys) {
+                momiji::requestInterrupt(sys, 2);
+            });
+
+            return emu.run({ 1000 }).reason == momiji::StopReason::Halt;
+        };
+
+        momiji::Emulator reference { settings };
+        MOMIJI_TEST_REQUIRE(load(reference));
+
+        settings.checkpointInterval  = 7;
+        settings.historyMemoryBudget = 1;
+
+        momiji::Emulator emu { settings };
+        MOMIJI_TEST_REQUIRE(load(emu));
+
+        const auto states = reference.getStates();
+        MOMIJI_TEST_REQUIRE(emu.getStates().size() == states.size());
+
+        std::size_t entry = 0;
+
+        for (std::size_t i = 0; i < states.size(); ++i)
+        {
+            const auto sys = states[i];
+            MOMIJI_TEST_REQUIRE(sameState(emu.getStates()[i], sys));
+
+            if (entry == 0 && sys.cpu.statusRegister.interruptMask() == 2)
+            {
+                entry = i;
+            }
+        }
+
+        MOMIJI_TEST_REQUIRE(entry > 3);
+
+        const auto last = states.back();
+
+        // The interrupt is requested again on the way forward
+        for (auto* going : { &reference, &emu })
+        {
+            MOMIJI_TEST_REQUIRE(going->seekTo(std::int64_t(entry - 3)));
+            MOMIJI_TEST_REQUIRE(going->getStates().back().cpu.dataRegisters[2]
+                                    .raw() == 0);
+
+            const auto res = going->run({ 1000 });
+            MOMIJI_TEST_REQUIRE(res.reason == momiji::StopReason::Halt);
+            MOMIJI_TEST_REQUIRE(sameState(going->getStates().back(), last));
+
+            // And one step at a time
+            while (going->getStates().size() > entry)
+            {
+                MOMIJI_TEST_REQUIRE(going->reverseStep());
+            }
+
+            while (going->step())
+            {
+            }
+
+            MOMIJI_TEST_REQUIRE(sameState(going->getStates().back(), last));
+        }
+
+        return 1;
+    }
+
+    int testBackend(Backend backend, RetainStates retain)
+    {
+        momiji::EmulatorSettings settings;
+        settings.backend      = backend;
+        settings.retainStates = retain;
+
+        momiji::Emulator emu { settings };
+        MOMIJI_TEST_REQUIRE(!emu.newState(counting).has_value());
+
+        auto res = emu.run();
+        MOMIJI_TEST_REQUIRE(res.reason == momiji::StopReason::Halt);
+        MOMIJI_TEST_REQUIRE(emu.getStates().back().cycles == countingCycles);
+
+        if (retain == RetainStates::Always)
+        {
+            // Going back gives the cycles back
+            MOMIJI_TEST_REQUIRE(emu.reverseStep());
+            MOMIJI_TEST_REQUIRE(emu.getStates().back().cycles ==
+                                countingCycles - 4);
+        }
+
+        momiji::Emulator timed { settings };
+        MOMIJI_TEST_REQUIRE(!timed.newState(ticking).has_value());
+        MOMIJI_TEST_REQUIRE(timed.attachDevice(
+            std::make_shared<momiji::devices::Timer>(timed.scheduler()),
+            timerBase));
+
+        const auto stack =
+            timed.getStates().back().cpu.addressRegisters[7].raw();
+
+        res = timed.run({ 100000 });
+        MOMIJI_TEST_REQUIRE(res.reason == momiji::StopReason::Halt);
+
+        const auto& ticked = timed.getStates().back();
+        MOMIJI_TEST_REQUIRE(ticked.cpu.dataRegisters[1].raw() == 3);
+        MOMIJI_TEST_REQUIRE(ticked.cpu.addressRegisters[7].raw() == stack);
+        MOMIJI_TEST_REQUIRE(ticked.cpu.statusRegister.interruptMask() == 0);
+
+        // The period was written at cycle 84, the third tick came 600
+        // cycles later
+        MOMIJI_TEST_REQUIRE(ticked.cycles >= 84 + 3 * 200);
+        MOMIJI_TEST_REQUIRE(ticked.cycles < 84 + 4 * 200);
+
+        momiji::Emulator both { settings };
+        MOMIJI_TEST_REQUIRE(!both.newState(nested).has_value());
+
+        both.scheduler().schedule(100, [](momiji::System& sys) {
+            momiji::requestInterrupt(sys, 2);
+            momiji::requestInterrupt(sys, 5);
+        });
+
+        res = both.run({ 100000 });
+        MOMIJI_TEST_REQUIRE(res.reason == momiji::StopReason::Halt);
+
+        const auto& handled = both.getStates().back();
+        MOMIJI_TEST_REQUIRE(handled.cpu.dataRegisters[2].raw() == 2);
+        MOMIJI_TEST_REQUIRE(handled.interruptRequests == 0);
+
+        // Nothing handles level 4
+        momiji::Emulator unhandled { settings };
+        MOMIJI_TEST_REQUIRE(!unhandled.newState(nested).has_value());
+
+        unhandled.requestInterrupt(4);
+
+        res = unhandled.run({ 100000 });
+        MOMIJI_TEST_REQUIRE(res.reason == momiji::StopReason::Trap);
+        MOMIJI_TEST_REQUIRE(res.executed == 0);
+
+        return 1;
+    }
+
+    int testScheduler()
+    {
+        momiji::EventScheduler scheduler;
+        momiji::System sys;
+
+        std::vector<int> order;
+
+        const auto record = [&order](int n) {
+            return [&order, n](momiji::System& /*sys*/) { order.push_back(n); };
+        };
+
+        scheduler.schedule(50, record(1));
+        scheduler.schedule(20, record(2));
+        const auto cancelled = scheduler.schedule(30, record(3));
+        scheduler.schedule(50, record(4));
+
+        MOMIJI_TEST_REQUIRE(scheduler.nextCycle() == 20);
+        MOMIJI_TEST_REQUIRE(scheduler.cancel(cancelled));
+        MOMIJI_TEST_REQUIRE(!scheduler.cancel(cancelled));
+
+        sys.cycles = 49;
+        MOMIJI_TEST_REQUIRE(scheduler.runDue(sys) == 1);
+
+        // Same cycle, scheduling order
+        sys.cycles = 60;
+        MOMIJI_TEST_REQUIRE(scheduler.runDue(sys) == 2);
+        MOMIJI_TEST_REQUIRE((order == std::vector<int> { 2, 1, 4 }));
+        MOMIJI_TEST_REQUIRE(scheduler.empty());
+        MOMIJI_TEST_REQUIRE(scheduler.nextCycle() ==
+                            momiji::EventScheduler::never);
+
+        return 1;
+    }
+} // namespace
+
+int testInterrupts()
+{
+    MOMIJI_TEST_REQUIRE(testScheduler());
+    MOMIJI_TEST_REQUIRE(momiji::testing::forEachBackend(testGoingBack));
+
+    return momiji::testing::forEachBackend(testBackend);
+}
+
+int main()
+{
+    return static_cast<int>(!testInterrupts());
+}
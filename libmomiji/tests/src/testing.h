@@ -1,8 +1,44 @@
 #pragma once
 
+#include <momiji/Emulator.h>
+
+#include <cstdio>
+
 #define MOMIJI_TEST_REQUIRE(expr)                       \
     if (!(expr))                                        \
     {                                                   \
         std::printf("Failed! Checked for " #expr "\n"); \
         return 0;                                       \
     }
+
+namespace momiji::testing
+{
+    // Runs test(backend, retain) with every backend, retaining states and
+    // not, and tells which one failed first
+    template <typename Test>
+    int forEachBackend(Test test)
+    {
+        using Backend      = EmulatorSettings::Backend;
+        using RetainStates = EmulatorSettings::RetainStates;
+
+        for (const auto backend : { Backend::Interpreter,
+                                    Backend::ThreadedInterpreter,
+                                    Backend::BasicBlocks,
+                                    Backend::Jit })
+        {
+            for (const auto retain :
+                 { RetainStates::Always, RetainStates::Never })
+            {
+                if (test(backend, retain) == 0)
+                {
+                    std::printf("Backend %d, retaining states %d\n",
+                                int(backend),
+                                int(retain));
+                    return 0;
+                }
+            }
+        }
+
+        return 1;
+    }
+} // namespace momiji::testing
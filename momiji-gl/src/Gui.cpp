@@ -1,5 +1,6 @@
 #include "Gui.h"
 
+#include <array>
 #include <chrono>
 #include <thread>
 
@@ -62,6 +63,9 @@ namespace
 
         case momiji::ParserOperand::ProgramCounterOffset:
             return "PC with offset";
+
+        case momiji::ParserOperand::ControlRegister:
+            return "Control register";
         }
 
         return "???";
@@ -332,22 +336,23 @@ void gui()
 
                 for (std::uint32_t i = begin; i < end; i += 2)
                 {
-                    momiji::DecodedInstruction instr =
+                    const momiji::DecodedInstruction instr =
                         momiji::decode(memview, i);
 
+                    std::array<char, momiji::maxDisassemblySize> text;
+                    momiji::disassemble(instr,
+                                        { text.data(), asl::ssize(text) });
+
                     std::uint8_t higher = memview.read8(i).value_or(0);
                     std::uint8_t lower  = memview.read8(i + 1).value_or(0);
 
-                    auto pcadd   = memview.begin() + pc.raw();
-                    auto curradd = memview.begin() + i;
-
-                    ImGui::TextUnformatted(pcadd == curradd ? "=>" : "  ");
+                    ImGui::TextUnformatted(pc.raw() == i ? "=>" : "  ");
                     ImGui::SameLine();
                     ImGui::Text("%.8x: %.2x %.2x %s",
                                 i,
                                 higher,
                                 lower,
-                                instr.string.c_str());
+                                text.data());
                 }
             }
             else
@@ -367,12 +372,47 @@ void gui()
                 emu.step();
             }
 
+            ImGui::SameLine();
+            if (ImGui::Button("Step over"))
+            {
+                emu.stepOver();
+            }
+
+            ImGui::SameLine();
+            if (ImGui::Button("Step out"))
+            {
+                emu.stepOut();
+            }
+
             ImGui::SameLine();
             if (ImGui::Button("Rollback"))
             {
-                emu.rollback();
+                emu.reverseStep();
+            }
+
+            ImGui::SameLine();
+            if (ImGui::Button("Reverse continue"))
+            {
+                emu.reverseContinue();
+            }
+
+            static std::int32_t watchAddress = 0;
+
+            ImGui::SameLine();
+            if (ImGui::Button("Reverse to write"))
+            {
+                emu.reverseUntilWrite(watchAddress);
             }
 
+            ImGui::SameLine();
+            ImGui::PushItemWidth(70.0F);
+            ImGui::InputInt("##watch",
+                            &watchAddress,
+                            0,
+                            0,
+                            ImGuiInputTextFlags_CharsHexadecimal);
+            ImGui::PopItemWidth();
+
             ImGui::SameLine();
             if (ImGui::Button("Reset"))
             {
@@ -574,12 +614,12 @@ void gui()
 
             if (!last.mem.empty())
             {
+                // Opcode word at the PC
                 const auto memview = momiji::make_memory_view(last);
                 const auto pc      = last.cpu.programCounter;
-                const auto addr =
-                    reinterpret_cast<std::uint64_t>(memview.begin() + pc.raw());
+                const auto word    = memview.read16(pc.raw()).value_or(0);
                 ImGui::SameLine();
-                ImGui::Text("%lx", addr);
+                ImGui::Text("%.4x", word);
             }
 
             ImGui::PopItemWidth();
@@ -606,10 +646,9 @@ void gui()
                 const momiji::ConstExecutableMemoryView memview = lastSys.mem;
                 const auto sp = lastSys.cpu.addressRegisters[7];
 
-                const auto maxStackLength =
-                    memview.size() - emuSettings.stackSize;
+                const auto maxStackLength = memview.stackMarker.begin;
 
-                for (asl::isize i = asl::ssize(memview) - 2;
+                for (asl::isize i = memview.stackMarker.end - 2;
                      i >= maxStackLength;
                      i -= 2)
                 {
@@ -621,10 +660,7 @@ void gui()
                         higher = *memview.read8(i - 1);
                     }
 
-                    auto pcadd   = memview.begin() + sp.raw();
-                    auto curradd = memview.begin() + i;
-
-                    ImGui::TextUnformatted(pcadd == curradd ? "=>" : "  ");
+                    ImGui::TextUnformatted(sp.raw() == i ? "=>" : "  ");
                     ImGui::SameLine();
                     ImGui::Text("%.8lx: %x %x", i, higher, lower);
                 }
@@ -636,6 +672,27 @@ void gui()
             ImGui::End();
         }
 
+        {
+            ImGui::Begin("Call stack");
+
+            const auto& frames = emu.backtrace();
+
+            // Innermost first, the way debuggers show it
+            for (auto it = frames.rbegin(); it != frames.rend(); ++it)
+            {
+                ImGui::Text("%.8x called from %.8x, sp %.8x",
+                            it->target,
+                            it->callSite,
+                            std::uint32_t(it->stackPointer));
+            }
+
+            if (frames.empty())
+            {
+                ImGui::Text("Not in a subroutine\n");
+            }
+            ImGui::End();
+        }
+
         auto endtime = std::chrono::high_resolution_clock::now();
         auto as_millis =
             std::chrono::duration<double, std::milli>(endtime - begintime);
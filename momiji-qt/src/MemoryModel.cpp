@@ -4,6 +4,8 @@
 
 #include <momiji/Decoder.h>
 
+#include <array>
+
 const QBrush g_defColor { QColor { 200, 200, 100 } };
 
 MemoryModel::MemoryModel(MemoryType type)
@@ -97,7 +99,11 @@ QVariant MemoryModel::getExecData(const QModelIndex& index, int role) const
     case 2:
     {
         const auto decodedInstr = momiji::decode(m_memory, std::int64_t(begin));
-        return { QString::fromStdString(decodedInstr.string) };
+
+        std::array<char, momiji::maxDisassemblySize> text;
+        momiji::disassemble(decodedInstr, { text.data(), asl::ssize(text) });
+
+        return { QString::fromUtf8(text.data()) };
     }
     }
 
@@ -4,6 +4,8 @@
 
 #include "MemoryModel.h"
 
+#include <QInputDialog>
+
 #include <asl/types>
 #include <iostream>
 
@@ -51,6 +53,9 @@ namespace
 
         case momiji::ParserOperand::ProgramCounterOffset:
             return MainWindow::tr("PC with offset");
+
+        case momiji::ParserOperand::ControlRegister:
+            return MainWindow::tr("Control register");
         }
 
         return "???";
@@ -297,26 +302,94 @@ void MainWindow::on_actionBuild_triggered()
 
 void MainWindow::on_actionExecute_triggered()
 {
-    // Execute code
-    momiji::continueEmulatorExecution(m_emulator);
+    const auto result = m_emulator.run();
+
+    QString reason;
+
+    switch (result.reason)
+    {
+    case momiji::StopReason::InstructionLimit:
+        reason = MainWindow::tr("instruction limit reached");
+        break;
+
+    case momiji::StopReason::Breakpoint:
+        reason = MainWindow::tr("breakpoint");
+        break;
+
+    case momiji::StopReason::Trap:
+        reason = MainWindow::tr("trap");
+        break;
+
+    case momiji::StopReason::Halt:
+        reason = MainWindow::tr("halted");
+        break;
+
+    case momiji::StopReason::Returned:
+        reason = MainWindow::tr("returned");
+        break;
+
+    case momiji::StopReason::OutOfRange:
+        reason = MainWindow::tr("program counter out of range");
+        break;
+    }
+
+    ui->statusBar->showMessage(
+        MainWindow::tr("Stopped after %n instruction(s): %1",
+                       "",
+                       int(result.executed))
+            .arg(reason));
 
     updateEmuValues();
 }
 
 void MainWindow::on_actionStep_triggered()
 {
-    if (m_emulator.step())
+    // step() returns false after hcf or a breakpoint too, the state still
+    // changed.
+    m_emulator.step();
+
+    updateEmuValues();
+}
+
+void MainWindow::on_actionRollback_triggered()
+{
+    if (m_emulator.reverseStep())
     {
         updateEmuValues();
     }
 }
 
-void MainWindow::on_actionRollback_triggered()
+void MainWindow::on_actionReverse_continue_triggered()
+{
+    const auto steps = m_emulator.reverseContinue();
+
+    ui->statusBar->showMessage(
+        MainWindow::tr("Went back %n step(s)", "", int(steps)));
+
+    updateEmuValues();
+}
+
+void MainWindow::on_actionReverse_until_write_triggered()
 {
-    if (m_emulator.rollback())
+    bool ok = false;
+
+    const auto address =
+        QInputDialog::getText(this,
+                              MainWindow::tr("Reverse until write"),
+                              MainWindow::tr("Address (hexadecimal):"))
+            .toLongLong(&ok, 16);
+
+    if (!ok)
     {
-        updateEmuValues();
+        return;
     }
+
+    const auto steps = m_emulator.reverseUntilWrite(address);
+
+    ui->statusBar->showMessage(
+        MainWindow::tr("Went back %n step(s)", "", int(steps)));
+
+    updateEmuValues();
 }
 
 void MainWindow::on_actionReset_triggered()
@@ -39,6 +39,10 @@ private slots:
 
     void on_actionRollback_triggered();
 
+    void on_actionReverse_continue_triggered();
+
+    void on_actionReverse_until_write_triggered();
+
     void on_actionReset_triggered();
 
     void on_actionManual_triggered();
@@ -0,0 +1,723 @@
+#include "utils.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <momiji/Decoder.h>
+#include <momiji/Memory.h>
+
+constexpr std::string_view usage =
+    "USAGE: momiji-aot input_file [output_file]\n"
+    "Translates a binary made by momiji-as to C++, to be compiled against "
+    "libmomiji.\n"
+    "If output_file is not specified, the output file is named after the first "
+    "one but with the extension '.cpp'.\n"
+    "\n"
+    "The output has a main() unless MOMIJI_AOT_NO_MAIN is defined, and "
+    "MOMIJI_AOT_EXPORT\n"
+    "can be defined to export momijiAotRun() from a shared library.\n"
+    "\n"
+    "Example: \n"
+    "  'momiji-aot test.mb' yields the file 'test.cpp'.\n";
+
+namespace
+{
+    bool endsBlock(momiji::InstructionType type)
+    {
+        using momiji::InstructionType;
+
+        switch (type)
+        {
+        case InstructionType::Branch:
+        case InstructionType::BranchSubroutine:
+        case InstructionType::BranchCondition:
+        case InstructionType::Jmp:
+        case InstructionType::JmpSubroutine:
+        case InstructionType::ReturnSubroutine:
+        case InstructionType::Trap:
+        case InstructionType::ReturnException:
+        case InstructionType::HaltCatchFire:
+        case InstructionType::Breakpoint:
+        case InstructionType::Illegal:
+            return true;
+
+        default:
+            return false;
+        }
+    }
+
+    // Instructions the program carries on at after instr, when known
+    bool fallsThrough(momiji::InstructionType type)
+    {
+        using momiji::InstructionType;
+
+        return !endsBlock(type) || type == InstructionType::BranchCondition ||
+               type == InstructionType::BranchSubroutine ||
+               type == InstructionType::JmpSubroutine ||
+               type == InstructionType::Trap;
+    }
+
+    struct Instruction
+    {
+        std::int64_t pc;
+        momiji::DecodedInstruction decoded;
+    };
+
+    struct Block
+    {
+        std::int64_t begin;
+        std::vector<Instruction> instructions;
+
+        // Every place known to be reached from the last instruction
+        std::vector<std::int64_t> successors;
+    };
+
+    class ControlFlowGraph
+    {
+    public:
+        explicit ControlFlowGraph(momiji::ConstExecutableMemoryView mem)
+            : m_mem(mem)
+            , m_codeSize(mem.executableMarker.end - mem.executableMarker.begin)
+        {
+            // Every leader reachable from the first instruction
+            std::vector<std::int64_t> worklist { 0 };
+
+            while (!worklist.empty())
+            {
+                const auto leader = worklist.back();
+                worklist.pop_back();
+
+                if (!m_leaders.insert(leader).second)
+                {
+                    continue;
+                }
+
+                walk(leader, [&](const Instruction& instr, bool last) {
+                    if (!last)
+                    {
+                        return;
+                    }
+
+                    for (const auto succ : successorsOf(instr))
+                    {
+                        if (m_leaders.count(succ) == 0)
+                        {
+                            worklist.push_back(succ);
+                        }
+                    }
+                });
+            }
+
+            for (const auto leader : m_leaders)
+            {
+                Block block { leader, {}, {} };
+
+                walk(leader, [&](const Instruction& instr, bool last) {
+                    block.instructions.push_back(instr);
+
+                    if (last)
+                    {
+                        block.successors = successorsOf(instr);
+                    }
+                });
+
+                if (!block.instructions.empty())
+                {
+                    m_blocks.push_back(std::move(block));
+                }
+            }
+        }
+
+        [[nodiscard]] const std::vector<Block>& blocks() const
+        {
+            return m_blocks;
+        }
+
+    private:
+        // Only instructions which are fully inside the code are translated,
+        // anything else is left to the interpreter
+        bool translatable(std::int64_t pc) const
+        {
+            return pc >= 0 && pc % 2 == 0 && pc < m_codeSize;
+        }
+
+        template <typename Fn>
+        void walk(std::int64_t pc, Fn&& fn) const
+        {
+            while (translatable(pc))
+            {
+                const Instruction instr { pc, momiji::decode(m_mem, pc) };
+                const auto next = pc + momiji::instructionSize(instr.decoded);
+
+                if (next > m_codeSize)
+                {
+                    return;
+                }
+
+                const bool last = endsBlock(instr.decoded.type) ||
+                                  m_leaders.count(next) != 0 ||
+                                  !translatable(next);
+
+                fn(instr, last);
+
+                if (last)
+                {
+                    return;
+                }
+
+                pc = next;
+            }
+        }
+
+        std::vector<std::int64_t> successorsOf(const Instruction& instr) const
+        {
+            std::vector<std::int64_t> successors;
+
+            const auto target =
+                momiji::branchTarget(m_mem, instr.pc, instr.decoded);
+
+            if (target.has_value() && translatable(*target))
+            {
+                successors.push_back(*target);
+            }
+
+            const auto next = instr.pc + momiji::instructionSize(instr.decoded);
+
+            if (fallsThrough(instr.decoded.type) && translatable(next))
+            {
+                successors.push_back(next);
+            }
+
+            return successors;
+        }
+
+        momiji::ConstExecutableMemoryView m_mem;
+        std::int64_t m_codeSize;
+
+        std::set<std::int64_t> m_leaders;
+        std::vector<Block> m_blocks;
+    };
+
+    void writeBinary(std::ostream& out, momiji::ConstExecutableMemoryView mem)
+    {
+        const auto size = std::int64_t(mem.size());
+
+        out << "    constexpr std::uint8_t binary[] = {";
+
+        for (std::int64_t i = 0; i < size; ++i)
+        {
+            out << (i % 12 == 0 ? "\n        " : " ");
+
+            std::array<char, 8> byte {};
+            std::snprintf(byte.data(),
+                          byte.size(),
+                          "0x%.2x,",
+                          unsigned(mem.read8(i).value_or(0)));
+            out << byte.data();
+        }
+
+        out << "\n    };\n\n";
+    }
+
+    void writeEntries(std::ostream& out, const std::vector<Block>& blocks)
+    {
+        out << "    // Sorted, where translated code can be entered\n"
+            << "    constexpr std::uint32_t entries[] = {";
+
+        for (std::size_t i = 0; i < blocks.size(); ++i)
+        {
+            out << (i % 8 == 0 ? "\n        " : " ");
+            out << blocks[i].begin << ',';
+        }
+
+        out << "\n    };\n";
+    }
+
+    const char* intType(std::int8_t size)
+    {
+        switch (size)
+        {
+        case 1:
+            return "std::int8_t";
+
+        case 2:
+            return "std::int16_t";
+
+        default:
+            return "std::int32_t";
+        }
+    }
+
+    bool isDataRegister(const momiji::InstructionData& data, std::size_t op)
+    {
+        return data.operandType[op] == momiji::OperandType::DataRegister;
+    }
+
+    std::string registerOf(const momiji::InstructionData& data, std::size_t op)
+    {
+        return std::to_string(momiji::utils::to_val(data.addressingMode[op]));
+    }
+
+    // C++ reading the source operand of instr the same way as its handler:
+    // the whole register, or the immediate zero-extended from its size.
+    // Empty for operands in memory.
+    std::optional<std::string>
+    sourceOf(momiji::ConstExecutableMemoryView mem, const Instruction& instr)
+    {
+        using momiji::OperandType;
+        using momiji::SpecialAddressingMode;
+
+        const auto& data = instr.decoded.data;
+
+        switch (data.operandType[0])
+        {
+        case OperandType::DataRegister:
+            return "d[" + registerOf(data, 0) + "].raw()";
+
+        case OperandType::AddressRegister:
+            return "a[" + registerOf(data, 0) + "].raw()";
+
+        case OperandType::Immediate:
+            break;
+
+        default:
+            return std::nullopt;
+        }
+
+        if (data.addressingMode[0] != SpecialAddressingMode::Immediate)
+        {
+            return std::nullopt;
+        }
+
+        // A byte immediate still takes a whole word
+        const auto at = instr.pc + 2;
+        auto value    = data.size == 4 ? mem.read32(at).value_or(0)
+                                       : mem.read16(at).value_or(0);
+
+        if (data.size == 1)
+        {
+            value &= 0xFF;
+        }
+
+        return "std::int32_t(" + std::to_string(value) + "u)";
+    }
+
+    // Same as branchConditionHolds for the condition code of a bcc
+    std::string conditionOf(const momiji::InstructionData& data)
+    {
+        switch (momiji::utils::to_val(data.operandType[0]))
+        {
+        // NE
+        case 0b0110:
+            return "!sr.zero()";
+
+        // EQ
+        case 0b0111:
+            return "sr.zero()";
+
+        // GE
+        case 0b1100:
+            return "sr.negative() == sr.overflow()";
+
+        // LT
+        case 0b1101:
+            return "sr.negative() != sr.overflow()";
+
+        // GT
+        case 0b1110:
+            return "!sr.zero() && sr.negative() == sr.overflow()";
+
+        // LE
+        case 0b1111:
+            return "sr.zero() || sr.negative() != sr.overflow()";
+
+        default:
+            return "false";
+        }
+    }
+
+    // Leaves the block for pc, straight to its block when it has one
+    std::string jumpTo(std::int64_t pc,
+                       const std::set<std::int64_t>& leaders,
+                       const std::string& indent)
+    {
+        const auto target = std::to_string(pc);
+        const auto label = leaders.count(pc) != 0 ? "block_" + target
+                                                  : std::string("dispatch");
+
+        return indent + "sys.cpu.programCounter = " + target + ";\n" +
+               indent + "goto " + label + ";\n";
+    }
+
+    // C++ doing what the handler of instr does, for moves, arithmetic and
+    // comparisons between data registers and immediates, without the PC
+    // and the cycles. Empty if instr is left to its handler.
+    std::optional<std::string> inlineCode(momiji::ConstExecutableMemoryView mem,
+                                          const Instruction& instr)
+    {
+        using momiji::InstructionType;
+
+        const auto& data = instr.decoded.data;
+        const auto type  = std::string(intType(data.size));
+        const auto size  = std::to_string(data.size);
+
+        if (instr.decoded.type == InstructionType::Tst)
+        {
+            if (!isDataRegister(data, 0))
+            {
+                return std::nullopt;
+            }
+
+            return "    sr.setLogical(" + size + ", d[" + registerOf(data, 0) +
+                   "].raw());\n";
+        }
+
+        const auto src = sourceOf(mem, instr);
+
+        if (!src.has_value() || !isDataRegister(data, 1))
+        {
+            return std::nullopt;
+        }
+
+        const auto dst = "*d[" + registerOf(data, 1) + "].as<" + type + ">()";
+
+        std::string body;
+
+        switch (instr.decoded.type)
+        {
+        case InstructionType::Move:
+            body = "        " + dst + " = " + type + "(src);\n" +
+                   "        sr.setLogical(" + size + ", src);\n";
+            break;
+
+        case InstructionType::Add:
+        case InstructionType::AddI:
+        case InstructionType::Sub:
+        case InstructionType::SubI: {
+            const bool add = instr.decoded.type == InstructionType::Add ||
+                             instr.decoded.type == InstructionType::AddI;
+
+            body = "        auto& dst = " + dst + ";\n" +
+                   "        const " + type + " old = dst;\n" +
+                   "        const auto res = " + type +
+                   "(std::uint32_t(old) " + (add ? "+" : "-") +
+                   " std::uint32_t(src));\n" +
+                   "        dst = res;\n" +
+                   "        sr." + (add ? "setAdd" : "setSub") + "(" + size +
+                   ", src, old, res);\n";
+            break;
+        }
+
+        // Neither sets the flags
+        case InstructionType::And:
+        case InstructionType::AndI:
+        case InstructionType::Or:
+        case InstructionType::OrI: {
+            const bool isAnd = instr.decoded.type == InstructionType::And ||
+                               instr.decoded.type == InstructionType::AndI;
+
+            body = "        auto& dst = " + dst + ";\n" +
+                   "        dst = " + type + "(dst " + (isAnd ? "&" : "|") +
+                   " " + type + "(src));\n";
+            break;
+        }
+
+        // Both sides sign-extended from the size of the comparison
+        case InstructionType::Compare:
+        case InstructionType::CompareI:
+            body = "        const std::int32_t lhs = " + type + "(d[" +
+                   registerOf(data, 1) + "].raw());\n" +
+                   "        const std::int32_t rhs = " + type + "(src);\n" +
+                   "        const auto res = std::int32_t(std::uint32_t(lhs) - "
+                   "std::uint32_t(rhs));\n" +
+                   "        sr.setCompare(" + size + ", rhs, lhs, res);\n";
+            break;
+
+        default:
+            return std::nullopt;
+        }
+
+        return "    {\n"
+               "        const std::int32_t src = " +
+               *src + ";\n" + body + "    }\n";
+    }
+
+    // C++ of a bra or bcc going to a known place, with its cycles. Empty
+    // if instr is left to its handler.
+    std::optional<std::string>
+    branchCode(momiji::ConstExecutableMemoryView mem,
+               const Instruction& instr,
+               const std::set<std::int64_t>& leaders)
+    {
+        using momiji::InstructionType;
+
+        const auto& decoded = instr.decoded;
+        const auto& data    = decoded.data;
+
+        if (decoded.type != InstructionType::Branch &&
+            decoded.type != InstructionType::BranchCondition)
+        {
+            return std::nullopt;
+        }
+
+        const auto target = momiji::branchTarget(mem, instr.pc, decoded);
+
+        if (!target.has_value())
+        {
+            return std::nullopt;
+        }
+
+        const auto taken = std::to_string(data.branchCycles);
+
+        if (decoded.type == InstructionType::Branch)
+        {
+            return "    sys.cycles += " + taken + ";\n" +
+                   jumpTo(*target, leaders, "    ");
+        }
+
+        std::string code;
+
+        // The other conditions never hold
+        if (const auto condition = conditionOf(data); condition != "false")
+        {
+            code = "    if (" + condition + ")\n" + "    {\n" +
+                   "        sys.cycles += " + taken + ";\n" +
+                   jumpTo(*target, leaders, "        ") + "    }\n";
+        }
+
+        return code + "    sys.cycles += " + std::to_string(data.cycles) +
+               ";\n" +
+               jumpTo(instr.pc + momiji::instructionSize(decoded),
+                      leaders,
+                      "    ");
+    }
+
+    void writeBlock(std::ostream& out,
+                    momiji::ConstExecutableMemoryView mem,
+                    const Block& block,
+                    const std::set<std::int64_t>& leaders)
+    {
+        out << "block_" << block.begin << ":\n";
+
+        const auto& instructions = block.instructions;
+
+        // Written out, or run by the handler when empty. Only the last
+        // instruction can be a branch.
+        std::vector<std::optional<std::string>> code;
+
+        for (const auto& instr : instructions)
+        {
+            code.push_back(&instr == &instructions.back()
+                               ? branchCode(mem, instr, leaders)
+                               : std::nullopt);
+
+            if (!code.back().has_value())
+            {
+                code.back() = inlineCode(mem, instr);
+            }
+        }
+
+        for (std::size_t i = 0; i < instructions.size(); ++i)
+        {
+            const auto& instr = instructions[i];
+
+            if (!code[i].has_value())
+            {
+                std::array<char, momiji::maxDisassemblySize> text;
+                momiji::disassemble(instr.decoded,
+                                    { text.data(), asl::ssize(text) });
+
+                out << "    // " << text.data() << '\n'
+                    << "    if (!rt.execute(" << instr.pc << "))\n"
+                    << "        return rt.finish();\n";
+                continue;
+            }
+
+            // Instructions written out one after the other can't stop the
+            // program, they are counted and their cycles added at once
+            auto end = i;
+            std::int64_t cycles = 0;
+
+            for (; end < instructions.size() && code[end].has_value(); ++end)
+            {
+                if (end + 1 < instructions.size() || !endsBlock(
+                        instructions[end].decoded.type))
+                {
+                    cycles += instructions[end].decoded.data.cycles;
+                }
+            }
+
+            out << "    if (!rt.count(" << instr.pc << ", " << end - i
+                << "))\n"
+                << "        return rt.finish();\n"
+                << "    sys.cycles += " << cycles << ";\n";
+
+            for (; i < end; ++i)
+            {
+                std::array<char, momiji::maxDisassemblySize> text;
+                momiji::disassemble(instructions[i].decoded,
+                                    { text.data(), asl::ssize(text) });
+
+                out << "    // " << text.data() << '\n' << *code[i];
+            }
+
+            --i;
+        }
+
+        const auto& last = instructions.back();
+
+        // A branch written out already left the block
+        if (code.back().has_value())
+        {
+            if (!endsBlock(last.decoded.type))
+            {
+                out << jumpTo(last.pc + momiji::instructionSize(last.decoded),
+                              leaders,
+                              "    ");
+            }
+
+            out << '\n';
+            return;
+        }
+
+        for (const auto succ : block.successors)
+        {
+            out << "    if (pc() == " << succ << ")\n"
+                << "        goto block_" << succ << ";\n";
+        }
+
+        out << "    goto dispatch;\n\n";
+    }
+
+    void writeProgram(std::ostream& out,
+                      std::string_view source,
+                      momiji::ConstExecutableMemoryView mem,
+                      const std::vector<Block>& blocks)
+    {
+        out << "// Translated by momiji-aot from " << source << "\n"
+            << "// Moves, arithmetic and comparisons between data registers\n"
+            << "// and branches are written out, other instructions are run\n"
+            << "// by libmomiji's handlers, anything that couldn't be\n"
+            << "// translated is interpreted.\n\n"
+            << "#include <momiji/AotRuntime.h>\n\n"
+            << "#include <cstdio>\n"
+            << "#include <iterator>\n\n"
+            << "#ifndef MOMIJI_AOT_EXPORT\n"
+            << "#define MOMIJI_AOT_EXPORT\n"
+            << "#endif\n\n"
+            << "namespace\n"
+            << "{\n";
+
+        writeBinary(out, mem);
+        writeEntries(out, blocks);
+
+        out << "} // namespace\n\n"
+            << "MOMIJI_AOT_EXPORT gsl::span<const std::uint8_t> "
+               "momijiAotBinary()\n"
+            << "{\n"
+            << "    return { binary, std::ptrdiff_t(std::size(binary)) };\n"
+            << "}\n\n"
+            << "MOMIJI_AOT_EXPORT momiji::RunResult\n"
+            << "momijiAotRun(momiji::System& sys, momiji::RunLimits limits)\n"
+            << "{\n"
+            << "    momiji::aot::Runtime rt { sys, limits };\n\n"
+            << "    [[maybe_unused]] auto& d  = sys.cpu.dataRegisters;\n"
+            << "    [[maybe_unused]] auto& a  = sys.cpu.addressRegisters;\n"
+            << "    [[maybe_unused]] auto& sr = sys.cpu.statusRegister;\n\n"
+            << "    const auto pc = [&] {\n"
+            << "        return sys.cpu.programCounter.raw();\n"
+            << "    };\n\n"
+            << "dispatch:\n"
+            << "    if (!rt.interpret({ entries, "
+               "std::ptrdiff_t(std::size(entries)) }))\n"
+            << "        return rt.finish();\n\n"
+            << "    switch (pc())\n"
+            << "    {\n";
+
+        for (const auto& block : blocks)
+        {
+            out << "    case " << block.begin << ":\n"
+                << "        goto block_" << block.begin << ";\n";
+        }
+
+        out << "    default:\n"
+            << "        return rt.finish();\n"
+            << "    }\n\n";
+
+        std::set<std::int64_t> leaders;
+
+        for (const auto& block : blocks)
+        {
+            leaders.insert(block.begin);
+        }
+
+        for (const auto& block : blocks)
+        {
+            writeBlock(out, mem, block, leaders);
+        }
+
+        out << "}\n\n"
+            << "#ifndef MOMIJI_AOT_NO_MAIN\n"
+            << "int main()\n"
+            << "{\n"
+            << "    auto sys = momiji::aot::load(momijiAotBinary());\n"
+            << "    const auto res = momijiAotRun(sys, {});\n\n"
+            << "    std::printf(\"--- Data registers ---\\n\");\n"
+            << "    for (std::uint32_t i = 0; i < 8; ++i)\n"
+            << "    {\n"
+            << "        const auto val = sys.cpu.dataRegisters[i].raw();\n"
+            << "        std::printf(\"d%d: 0x%.8x %d\\n\", i, val, val);\n"
+            << "    }\n\n"
+            << "    std::printf(\"\\n--- Address registers ---\\n\");\n"
+            << "    for (std::uint32_t i = 0; i < 8; ++i)\n"
+            << "    {\n"
+            << "        const auto val = sys.cpu.addressRegisters[i].raw();\n"
+            << "        std::printf(\"a%d: 0x%.8x %d\\n\", i, val, val);\n"
+            << "    }\n\n"
+            << "    return res.reason == momiji::StopReason::Halt ? 0 : 1;\n"
+            << "}\n"
+            << "#endif\n";
+    }
+} // namespace
+
+int main(int argc, const char** argv)
+{
+    namespace fs = std::filesystem;
+
+    auto args = utils::convArgs(argc, argv);
+
+    if (args.empty() || args.size() > 2)
+    {
+        std::cout << usage;
+        return 1;
+    }
+
+    auto binary = utils::readBinary(args[0]);
+    binary.executableMarker.begin = 0;
+    binary.executableMarker.end   = asl::ssize(binary);
+
+    const auto output = args.size() == 2
+                            ? fs::path { args[1] }
+                            : fs::path { args[0] }.replace_extension("cpp");
+
+    const ControlFlowGraph cfg { binary };
+
+    if (cfg.blocks().empty())
+    {
+        std::cout << "Nothing to translate in " << args[0] << '\n';
+        return 1;
+    }
+
+    std::ofstream file { output };
+    writeProgram(file,
+                 fs::path { args[0] }.filename().string(),
+                 binary,
+                 cfg.blocks());
+
+    return 0;
+}
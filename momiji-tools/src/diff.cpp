@@ -76,11 +76,11 @@ int main(int argc, const char** argv)
 
         if (lower1 != lower2 || higher1 != higher2)
         {
-            std::printf("%p: %.2x %.2x \t %p: %.2x %.2x\n",
-                        (memview1.begin() + i),
+            std::printf("%.8lx: %.2x %.2x \t %.8lx: %.2x %.2x\n",
+                        i,
                         higher1,
                         lower1,
-                        (memview2.begin() + j),
+                        j,
                         higher2,
                         lower2);
         }
@@ -3,6 +3,7 @@
 #include <filesystem>
 #include <string_view>
 
+#include <momiji/Decoder.h>
 #include <momiji/Emulator.h>
 #include <momiji/Memory.h>
 
@@ -78,11 +79,15 @@ int main(int argc, const char** argv)
         }
         */
 
-        std::printf("%p: %.2x %.2x ", (memview.begin() + i), higher, lower);
+        std::printf("%.8lx: %.2x %.2x ", i, higher, lower);
         hackyPrintBin(higher);
         std::printf(" ");
         hackyPrintBin(lower);
-        std::printf("\n");
+
+        std::array<char, momiji::maxDisassemblySize> text;
+        momiji::disassemble(momiji::decode(memview, i),
+                            { text.data(), asl::ssize(text) });
+        std::printf(" %s\n", text.data());
     }
 
     std::printf("\n--- Data registers ---\n");
@@ -101,11 +106,11 @@ int main(int argc, const char** argv)
     }
 
     std::printf("\n--- Status registers ---\n");
-    std::printf("N: %d ", state.cpu.statusRegister.negative);
-    std::printf("\tZ: %d ", state.cpu.statusRegister.zero);
-    std::printf("\tV: %d ", state.cpu.statusRegister.overflow);
-    std::printf("\tX: %d ", state.cpu.statusRegister.extend);
-    std::printf("\tC: %d\n", state.cpu.statusRegister.carry);
+    std::printf("N: %d ", int(state.cpu.statusRegister.negative()));
+    std::printf("\tZ: %d ", int(state.cpu.statusRegister.zero()));
+    std::printf("\tV: %d ", int(state.cpu.statusRegister.overflow()));
+    std::printf("\tX: %d ", int(state.cpu.statusRegister.extend()));
+    std::printf("\tC: %d\n", int(state.cpu.statusRegister.carry()));
 
     return 0;
 }
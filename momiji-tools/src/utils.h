@@ -53,19 +53,29 @@ namespace utils
         const auto length = std::ftell(file);
         std::fseek(file, 0, SEEK_SET);
 
-        momiji::ExecutableMemory mem { length };
+        std::vector<std::uint8_t> content(std::size_t(length), 0);
 
-        std::fread(mem.data(), 1, std::size_t(length), file);
+        std::fread(content.data(), 1, content.size(), file);
         std::fclose(file);
 
+        momiji::ExecutableMemory mem { length };
+        mem.underlying().write(0, { content.data(), asl::ssize(content) });
+
         return mem;
     }
 
     inline void writeFile(std::string_view path,
                           momiji::ExecutableMemoryView memory)
     {
+        std::vector<char> content(std::size_t(memory.size()));
+
+        for (std::size_t i = 0; i < content.size(); ++i)
+        {
+            content[i] = char(memory.read8(std::int64_t(i)).value_or(0));
+        }
+
         std::fstream file { path.data(), std::ios::binary | std::ios::out };
-        file.write(reinterpret_cast<char*>(memory.data()), memory.size());
+        file.write(content.data(), asl::ssize(content));
         file.close();
     }
 
@@ -108,6 +118,9 @@ namespace utils
 
         case momiji::ParserOperand::ProgramCounterOffset:
             return "PC with offset";
+
+        case momiji::ParserOperand::ControlRegister:
+            return "Control register";
         }
 
         return "???";
@@ -0,0 +1,91 @@
+#include "../../../libmomiji/tests/src/testing.h"
+#include <momiji/AotRuntime.h>
+#include <momiji/Emulator.h>
+
+#include <cstdio>
+
+// Written by momiji-aot
+gsl::span<const std::uint8_t> momijiAotBinary();
+momiji::RunResult momijiAotRun(momiji::System& sys, momiji::RunLimits limits);
+
+int testTranslation();
+
+namespace
+{
+    bool sameState(const momiji::System& lhs, const momiji::System& rhs)
+    {
+        const auto& a = lhs.cpu;
+        const auto& b = rhs.cpu;
+
+        for (std::size_t i = 0; i < a.dataRegisters.size(); ++i)
+        {
+            if (a.dataRegisters[i].raw() != b.dataRegisters[i].raw() ||
+                a.addressRegisters[i].raw() != b.addressRegisters[i].raw())
+            {
+                return false;
+            }
+        }
+
+        return a.programCounter.raw() == b.programCounter.raw() &&
+               a.statusRegister.word() == b.statusRegister.word() &&
+               lhs.cycles == rhs.cycles;
+    }
+
+    momiji::EmulatorSettings interpreted()
+    {
+        momiji::EmulatorSettings settings;
+        settings.backend      = momiji::EmulatorSettings::Backend::Interpreter;
+        settings.retainStates = momiji::EmulatorSettings::RetainStates::Never;
+
+        return settings;
+    }
+
+    void load(momiji::Emulator& emu)
+    {
+        const auto binary = momijiAotBinary();
+
+        momiji::ExecutableMemory mem { asl::ssize(binary) };
+        mem.underlying().write(0, binary);
+
+        emu.newState(std::move(mem));
+    }
+} // namespace
+
+// The translation stops where the interpreter does, in the same state,
+// whatever the instruction limit
+int testTranslation()
+{
+    momiji::Emulator reference { interpreted() };
+    load(reference);
+
+    const auto whole = reference.run();
+
+    MOMIJI_TEST_REQUIRE(whole.reason == momiji::StopReason::Halt);
+
+    for (std::int64_t limit = -1; limit <= whole.executed; ++limit)
+    {
+        auto sys       = momiji::aot::load(momijiAotBinary());
+        const auto res = momijiAotRun(sys, { limit });
+
+        momiji::Emulator emu { interpreted() };
+        load(emu);
+
+        const auto expected = emu.run({ limit });
+
+        if (res.reason != expected.reason ||
+            res.executed != expected.executed ||
+            !sameState(sys, emu.getStates().back()))
+        {
+            std::printf("Differs with a limit of %d instructions\n",
+                        int(limit));
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+int main()
+{
+    return static_cast<int>(!testTranslation());
+}
@@ -0,0 +1,17 @@
+    move.l #0, d0
+    move.l #0, d4
+    move.l #$1234F0F1, d5
+    move.l #3, d1
+loop:
+    lsr.w #1, d5
+    add.l #7108, d4
+    lsl.l #4, d5
+    add.l #1, d0
+    asr.b #8, d5
+    add.l #2, d0
+    asl.w d1, d5
+    move.l d5, d6
+    lsr.l d1, d6
+    sub.l #1, d1
+    bne loop
+    hcf